@@ -53,6 +53,7 @@
 #include "grtdb/db_helpers.h"
 #include "grtdb/db_object_helpers.h"
 #include "grt/clipboard.h"
+#include "grt/validation_manager.h"
 
 #include "grtpp_notifications.h"
 
@@ -79,7 +80,8 @@ WBContextModel::WBContextModel()
     _locked_view_for_plugin_exec(0),
     _auto_save_point(0),
     _last_auto_save_time(0),
-    _auto_save_timer(NULL)
+    _auto_save_timer(NULL),
+    _validator(NULL)
 
 {
   _overview = new PhysicalOverviewBE(wb::WBContextUI::get()->get_wb());
@@ -147,6 +149,7 @@ WBContextModel::~WBContextModel() {
   cmdui->remove_builtin_command("addModelView");
   cmdui->remove_builtin_command("addModelRoutine");
   cmdui->remove_builtin_command("removeFigure");
+  delete _validator;
   _file = 0;
   delete _overview;
 }
@@ -205,8 +208,36 @@ void WBContextModel::option_changed(grt::internal::OwnedDict *dict, bool, const
       dict == wb::WBContextUI::get()->get_wb()->get_wb_options().valueptr()) {
     auto_save_document();
   }
+
+  if (key == "workbench:ContinuousModelValidation" &&
+      dict == wb::WBContextUI::get()->get_wb()->get_wb_options().valueptr())
+    update_continuous_validation();
 }
 
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Creates or removes the validator keeping the validation messages of the model up to date while it is edited.
+ * Nothing is tracked as long as no validators are registered.
+ */
+void WBContextModel::update_continuous_validation() {
+  bool enabled = wb::WBContextUI::get()->get_wb()->get_root()->options()->options().get_int(
+                   "workbench:ContinuousModelValidation", 0) != 0 &&
+                 bec::ValidationManager::has_validators();
+
+  if (enabled && _validator == NULL && _doc.is_valid()) {
+    std::vector<grt::Validator::Tag> tags = { CHECK_NAME,  CHECK_SYNTAX, CHECK_EFFICIENCY,
+                                              CHECK_LOGIC, "chk_fk_lgc", "columns-count" };
+    _validator = new bec::IncrementalValidator(tags);
+    _validator->attach(_doc->physicalModels()[0]->catalog(), grt::GRT::get()->get_undo_manager());
+  } else if (!enabled && _validator != NULL) {
+    delete _validator;
+    _validator = NULL;
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
 bool WBContextModel::auto_save_document() {
   WBContext *wb = wb::WBContextUI::get()->get_wb();
   ssize_t interval = wb->get_root()->options()->options().get_int("workbench:AutoSaveModelInterval", 60);
@@ -218,8 +249,8 @@ bool WBContextModel::auto_save_document() {
   mdc::Timestamp now = mdc::get_time();
   if (now - _last_auto_save_time > interval && _file && doc.is_valid() &&
       !bec::GRTManager::get()->get_dispatcher()->get_busy() &&
-      grt::GRT::get()->get_undo_manager()->get_latest_closed_undo_action() != _auto_save_point) {
-    _auto_save_point = grt::GRT::get()->get_undo_manager()->get_latest_closed_undo_action();
+      grt::GRT::get()->get_undo_manager()->get_latest_closed_undo_serial() != _auto_save_point) {
+    _auto_save_point = grt::GRT::get()->get_undo_manager()->get_latest_closed_undo_serial();
     _last_auto_save_time = now;
     try {
       // save the document in the same directory containing the expanded mwb file
@@ -260,7 +291,8 @@ void WBContextModel::detect_auto_save_files(const std::string &autosave_dir) {
     if (base::LockFile::check(base::makePath(*d, ModelFile::lock_filename.c_str())) != base::LockFile::NotLocked)
       continue;
 
-    if (g_file_test(base::makePath(*d, MAIN_DOCUMENT_AUTOSAVE_NAME).c_str(), G_FILE_TEST_EXISTS)) {
+    if (g_file_test(base::makePath(*d, MAIN_DOCUMENT_AUTOSAVE_NAME).c_str(), G_FILE_TEST_EXISTS) ||
+        g_file_test(base::makePath(*d, MAIN_DOCUMENT_AUTOSAVE_JOURNAL_NAME).c_str(), G_FILE_TEST_EXISTS)) {
       std::string path = base::makePath(*d, "real_path");
       gchar *orig_path;
       gsize length;
@@ -347,6 +379,8 @@ void WBContextModel::model_created(ModelFile *file, workbench_DocumentRef doc) {
       new mforms::DockingPoint(new mforms::TabViewDockingPoint(_secondary_sidebar, MODEL_DOCKING_POINT), true));
   _grtmodel_panel->commonSidebar(mforms_to_grt(_sidebar_dockpoint));
 
+  update_continuous_validation();
+
   grt::DictRef info(true);
   grt::GRTNotificationCenter::get()->send_grt("GRNModelCreated", _grtmodel_panel, info);
 }
@@ -382,11 +416,16 @@ void WBContextModel::model_loaded(ModelFile *file, workbench_DocumentRef doc) {
       new mforms::DockingPoint(new mforms::TabViewDockingPoint(_secondary_sidebar, MODEL_DOCKING_POINT), true));
   _grtmodel_panel->commonSidebar(mforms_to_grt(_sidebar_dockpoint));
 
+  update_continuous_validation();
+
   grt::DictRef info(true);
   grt::GRTNotificationCenter::get()->send_grt("GRNModelOpened", _grtmodel_panel, info);
 }
 
 void WBContextModel::model_closed() {
+  delete _validator;
+  _validator = NULL;
+
   grt::DictRef info(true);
   grt::GRTNotificationCenter::get()->send_grt("GRNModelClosed", _grtmodel_panel, info);
 }
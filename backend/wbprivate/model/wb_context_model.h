@@ -39,6 +39,10 @@ namespace grt {
   class UndoAction;
 };
 
+namespace bec {
+  class IncrementalValidator;
+};
+
 namespace mforms {
   class View;
   class TabView;
@@ -159,6 +163,7 @@ namespace wb {
     void diagram_object_list_changed(grt::internal::OwnedList *list, bool added, const grt::ValueRef &value,
                                      ModelDiagramForm *vform);
     void option_changed(grt::internal::OwnedDict *, bool, const std::string &);
+    void update_continuous_validation();
 
     bool has_selected_model();
     bool has_selected_schema();
@@ -196,11 +201,13 @@ namespace wb {
     workbench_DocumentRef _doc;
     boost::signals2::connection _page_settings_conn;
 
-    grt::UndoAction *_auto_save_point;
+    size_t _auto_save_point; // serial of the latest undo action at the last auto save
     mdc::Timestamp _last_auto_save_time;
     int _auto_save_interval;
     bec::GRTManager::Timer *_auto_save_timer;
 
+    bec::IncrementalValidator *_validator;
+
     std::map<std::string, ModelDiagramForm *> _model_forms;
   };
 };
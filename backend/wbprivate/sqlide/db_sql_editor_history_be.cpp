@@ -21,23 +21,14 @@
  * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
  */
 
-#include <fstream>
-#include <glib/gstdio.h>
-#include <stdlib.h>
-
 #include <boost/foreach.hpp>
-#include <pcre.h>
 
 #include "db_sql_editor_history_be.h"
+#include "sql_history_store.h"
 #include "sqlide/recordset_data_storage.h"
 
-#include "base/threading.h"
 #include "base/string_utilities.h"
-#include "base/util_functions.h"
 #include "base/log.h"
-#include "base/file_utilities.h"
-#include "base/scope_exit_trigger.h"
-#include "base/xml_functions.h"
 
 #include "mforms/utilities.h"
 
@@ -49,10 +40,13 @@ using namespace base;
 
 const char *SQL_HISTORY_DIR_NAME = "sql_history";
 
+// Number of history rows kept in memory by a details model.
+static const size_t DETAILS_PAGE_SIZE = 1000;
+
 DbSqlEditorHistory::DbSqlEditorHistory() : _current_entry_index(-1) {
+  _store = SqlHistoryStore::get();
   _entries_model = EntriesModel::create(this);
-  _details_model = DetailsModel::create();
-  _write_only_details_model = DetailsModel::create();
+  _details_model = DetailsModel::create(_store);
   load();
 }
 
@@ -69,24 +63,31 @@ void DbSqlEditorHistory::load() {
   _entries_model->load();
 }
 
-void DbSqlEditorHistory::add_entry(const std::list<std::string> &statements) {
+/**
+ * Adds the statements to the history. Returns an id for the last of them, which can be used to add
+ * the execution time once it's known.
+ */
+std::int64_t DbSqlEditorHistory::add_entry(const std::list<std::string> &statements) {
   size_t old_date_count = _details_model->count();
-  _entries_model->add_statements(statements);
+  std::int64_t entry = _entries_model->add_statements(statements);
 
   if (_entries_model->get_ui_usage()) {
     _entries_model->refresh_ui();
     if (old_date_count < _details_model->count())
       _details_model->refresh_ui();
   }
+  return entry;
+}
+
+void DbSqlEditorHistory::set_duration(std::int64_t entry, double duration) {
+  _store->setDuration(entry, duration);
 }
 
 void DbSqlEditorHistory::current_entry(int index) {
   if (index < 0)
     _details_model->reset();
-  else {
-    update_timestamp(_entries_model->entry_date(index));
-    _details_model->load(_entries_model->entry_path(index));
-  }
+  else
+    _details_model->load(_entries_model->entry_day(index));
 
   _current_entry_index = index;
 
@@ -97,21 +98,33 @@ void DbSqlEditorHistory::current_entry(int index) {
   _details_model->refresh();
 }
 
+/**
+ * Shows the statements from all days which contain the words in the given text in the details model.
+ */
+void DbSqlEditorHistory::search(const std::string &text) {
+  _current_entry_index = -1;
+  _entries_model->set_ui_usage(false);
+  _details_model->load_search(text);
+
+  _entries_model->refresh();
+  _details_model->refresh();
+}
+
 std::string DbSqlEditorHistory::restore_sql_from_history(int entry_index, std::list<int> &detail_indexes) {
+  DetailsModel::Ref details_model;
+  if (entry_index == _current_entry_index)
+    details_model = _details_model;
+  else if (entry_index >= 0) {
+    details_model = DetailsModel::create(_store);
+    details_model->load(_entries_model->entry_day(entry_index));
+  } else
+    return "";
+
   std::string sql;
-  if (entry_index >= 0) {
-    DetailsModel::Ref details_model;
-    if (entry_index == _current_entry_index)
-      details_model = _details_model;
-    else {
-      details_model = DetailsModel::create();
-      details_model->load(_entries_model->entry_path(entry_index));
-    }
-    std::string statement;
-    for (int row : detail_indexes) {
-      details_model->get_field(row, 1, statement);
-      sql += statement + ";\n";
-    }
+  std::string statement;
+  for (int row : detail_indexes) {
+    details_model->get_field(row, 1, statement);
+    sql += statement + ";\n";
   }
   return sql;
 }
@@ -136,76 +149,49 @@ void DbSqlEditorHistory::EntriesModel::reset() {
 }
 
 void DbSqlEditorHistory::EntriesModel::load() {
-  std::string sql_history_dir = base::makePath(bec::GRTManager::get()->get_user_datadir(), SQL_HISTORY_DIR_NAME);
-  g_mkdir_with_parents(sql_history_dir.c_str(), 0700);
-  {
-    GError *error = NULL;
-    GDir *dir = g_dir_open(sql_history_dir.c_str(), 0, &error);
-    if (!dir) {
-      grt::GRT::get()->send_error(_("Can't open SQL history directory"),
-                                  (error ? error->message : sql_history_dir.c_str()));
-      return;
-    }
-    // files are not read in alpha-order, so we need to sort them before inserting
-    std::set<std::string> entries;
-    base::ScopeExitTrigger on_scope_exit(std::bind(&g_dir_close, dir));
-    while (const char *name_ = g_dir_read_name(dir)) {
-      // file name is expected in "YYYY-MM-DD" format
-      std::string name(name_);
-      if (name.size() != 10)
-        continue;
-      name[4] = '\0';
-      name[7] = '\0';
-      entries.insert(name);
-    }
-
-    for (std::set<std::string>::const_iterator name = entries.begin(); name != entries.end(); ++name) {
-      tm t;
-      memset(&t, 0, sizeof(t));
-      t.tm_year = base::atoi<int>(&(*name)[0], 0) - 1900;
-      t.tm_mon = base::atoi<int>(&(*name)[5], 0) - 1;
-      t.tm_mday = base::atoi<int>(&(*name)[8], 0);
-      if (t.tm_year != 0)
-        insert_entry(t);
-    }
-  }
+  for (auto &day : _owner->_store->days())
+    insert_entry(day);
 }
 
-void DbSqlEditorHistory::EntriesModel::add_statements(const std::list<std::string> &statements) {
+std::int64_t DbSqlEditorHistory::EntriesModel::add_statements(const std::list<std::string> &statements) {
   if (statements.empty())
-    return;
+    return 0;
 
   std::tm timestamp = local_timestamp();
   bool new_date = insert_entry(timestamp);
 
   std::string time = format_time(timestamp, "%X");
+  std::list<std::string> stripped_statements;
   std::list<std::string> timed_statements;
 
   for (std::string statement : statements) {
+    stripped_statements.push_back(base::strip_text(statement));
     timed_statements.push_back(time);
-    timed_statements.push_back(base::strip_text(statement));
+    timed_statements.push_back(stripped_statements.back());
   }
 
   if (new_date) {
     refresh_ui();
     _owner->current_entry((int)_row_count - 1);
-    _owner->update_timestamp(timestamp);
   }
 
   if (_ui_usage)
     _owner->details_model()->add_entries(timed_statements);
-  else
-    _owner->write_only_details_model()->add_entries(timed_statements);
+
+  return _owner->_store->add(format_time(timestamp, "%Y-%m-%d"), time, stripped_statements, _owner->_connection_name);
 }
 
 bool DbSqlEditorHistory::EntriesModel::insert_entry(const std::tm &t) {
+  return insert_entry(format_time(t, "%Y-%m-%d"));
+}
+
+bool DbSqlEditorHistory::EntriesModel::insert_entry(const std::string &day) {
   std::string newest_date;
   if (_row_count > 0)
     get_field(NodeId(0), 0, newest_date);
-  std::string date = format_time(t, "%Y-%m-%d");
-  if (date != newest_date) {
+  if (day != newest_date) {
     base::RecMutexLock data_mutex(_data_mutex);
-    _data.insert(_data.begin(), date);
+    _data.insert(_data.begin(), day);
     ++_row_count;
     ++_data_frame_end;
     return true;
@@ -267,46 +253,29 @@ void DbSqlEditorHistory::EntriesModel::delete_entries(const std::vector<std::siz
   if (rows.empty())
     return;
   {
+    std::vector<std::string> days;
     std::vector<size_t> sorted_rows = rows;
     std::sort(sorted_rows.begin(), sorted_rows.end());
     BOOST_REVERSE_FOREACH(size_t row, sorted_rows) {
-      try {
-        base::remove(entry_path(row));
-      } catch (const std::exception &exc) {
-        logError("Error deleting log entry %s: %s\n", entry_path(row).c_str(), exc.what());
-      }
+      days.push_back(entry_day(row));
       Cell row_begin = _data.begin() + row * _column_count;
       _data.erase(row_begin, row_begin + _column_count);
       --_row_count;
     }
+    _owner->_store->removeDays(days);
   }
   refresh_ui();
   _owner->current_entry(-1);
 }
 
-std::string DbSqlEditorHistory::EntriesModel::entry_path(std::size_t index) {
-  std::string name;
-  get_field(index, 0, name);
-  std::string storage_file_path = base::makePath(bec::GRTManager::get()->get_user_datadir(), SQL_HISTORY_DIR_NAME);
-  storage_file_path = base::makePath(storage_file_path, name);
-  return storage_file_path;
-}
-
-std::tm DbSqlEditorHistory::EntriesModel::entry_date(std::size_t index) {
-  tm t;
-  std::string name;
-  get_field(index, 0, name);
-
-  memset(&t, 0, sizeof(t));
-  t.tm_year = base::atoi<int>(&name[0], 0) - 1900;
-  t.tm_mon = base::atoi<int>(&name[5], 0) - 1;
-  t.tm_mday = base::atoi<int>(&name[8], 0);
-
-  return t;
+std::string DbSqlEditorHistory::EntriesModel::entry_day(std::size_t index) {
+  std::string day;
+  get_field(index, 0, day);
+  return day;
 }
 
 //--------------------------------------------------------------------------------------------------
-DbSqlEditorHistory::DetailsModel::DetailsModel() : VarGridModel() {
+DbSqlEditorHistory::DetailsModel::DetailsModel(std::shared_ptr<SqlHistoryStore> store) : VarGridModel(), _store(store) {
   reset();
 
   _context_menu.add_item(_("Copy Row To Clipboard"), "copy_row");
@@ -318,10 +287,8 @@ DbSqlEditorHistory::DetailsModel::DetailsModel() : VarGridModel() {
 void DbSqlEditorHistory::DetailsModel::reset() {
   VarGridModel::reset();
 
-  _last_loaded_row = -1;
-  _last_timestamp = std::string("");
-  _last_statement = std::string("");
-  _datestamp = local_timestamp();
+  _day.clear();
+  _search_text.clear();
 
   _readonly = true;
 
@@ -334,170 +301,100 @@ void DbSqlEditorHistory::DetailsModel::reset() {
   refresh_ui();
 }
 
-void DbSqlEditorHistory::DetailsModel::load(const std::string &storage_file_path) {
-  if (base::file_exists(storage_file_path)) {
-    std::ifstream historyXml(storage_file_path);
-    if (historyXml.is_open()) {
-      std::string line;
-
-      // Skips the first line in the file as is the xml header
-      std::getline(historyXml, line);
-      _row_count = 0;
-
-      base::RecMutexLock data_mutex(_data_mutex);
-      _data.clear();
-      _data.reserve(_data.size() + _column_count);
-      while (historyXml.good()) {
-        std::getline(historyXml, line);
-
-        if (line.empty())
-          continue;
-
-        xmlDocPtr xmlDoc = base::xml::xmlParseFragment(line);
-        if (xmlDoc == nullptr) {
-          logError("Can't parse %s, of file: %s\n", line.c_str(), storage_file_path.c_str());
-          continue;
-        }
-
-        // In history we've got one element per line.
-        auto element = xmlDoc->children;
-        if (element->next !=
-            nullptr) // If there's something more, we log proper information and parse only that one element.
-          logError("History line contains too many elements %s, of file: %s\n", line.c_str(),
-                   storage_file_path.c_str());
-
-        std::string timestamp = base::xml::getProp(element, "timestamp");
-        std::string statement = base::xml::getContent(element);
-        // decides whether to use or not the existing data
-        if (timestamp != _last_timestamp.toString() && timestamp != "~")
-          _last_timestamp = timestamp;
-
-        if (statement != _last_statement.toString() && statement != "~")
-          _last_statement = statement;
+void DbSqlEditorHistory::DetailsModel::load(const std::string &day) {
+  base::RecMutexLock data_mutex(_data_mutex);
+  _day = day;
+  _search_text.clear();
+  _row_count = _store->dayCount(day);
 
-        _data.push_back(_last_statement);
-        _data.push_back(_last_timestamp);
-
-        _row_count++;
+  // Rows are read on first access.
+  _data.clear();
+  _data_frame_begin = 0;
+  _data_frame_end = 0;
+}
 
-        xmlFree(xmlDoc);
-      }
+void DbSqlEditorHistory::DetailsModel::load_search(const std::string &text) {
+  base::RecMutexLock data_mutex(_data_mutex);
+  _day.clear();
+  _search_text = text;
+  _row_count = _search_text.empty() ? 0 : _store->searchCount(text);
 
-      std::reverse(_data.begin(), _data.end());
+  _data.clear();
+  _data_frame_begin = 0;
+  _data_frame_end = 0;
+}
 
-      _data_frame_end = _row_count;
+/**
+ * Same as in VarGridModel, but the rows come from the history store instead of the data swap db.
+ */
+VarGridModel::Cell DbSqlEditorHistory::DetailsModel::cell(RowId row, ColumnId column) {
+  if (row >= _row_count)
+    return _data.end();
 
-      _last_loaded_row = (int)_row_count - 1;
-    }
-  } else
-    logError("Can't open SQL history file %s\n", storage_file_path.c_str());
-}
+  if ((_data_frame_begin > row) || (_data_frame_end <= row))
+    load_frame(row);
 
-std::string DbSqlEditorHistory::DetailsModel::storage_file_path() const {
-  std::string storage_file_path = base::makePath(bec::GRTManager::get()->get_user_datadir(), SQL_HISTORY_DIR_NAME);
-  storage_file_path = base::makePath(storage_file_path, format_time(_datestamp, "%Y-%m-%d"));
-  return storage_file_path;
+  RowId cell_index = (row - _data_frame_begin) * _column_count + column;
+  return _data.begin() + cell_index;
 }
 
-void DbSqlEditorHistory::DetailsModel::save() {
-  std::string storage_file_path = this->storage_file_path();
-  std::ofstream ofs;
-  {
-    std::string storage_file_dir = base::makePath(bec::GRTManager::get()->get_user_datadir(), SQL_HISTORY_DIR_NAME);
-    if (g_mkdir_with_parents(storage_file_dir.c_str(), 0700) != -1) {
-      bool is_file_new = (g_file_test(storage_file_path.c_str(), G_FILE_TEST_EXISTS) == 0);
-      if (is_file_new || g_file_test(storage_file_path.c_str(), G_FILE_TEST_IS_REGULAR)) {
-        ofs.open(base::path_from_utf8(storage_file_path).c_str(), std::ios_base::app);
-        if (is_file_new)
-          ofs << "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>\n";
-      }
-    }
-  }
-
-  if (!ofs.is_open() || !ofs) {
-    grt::GRT::get()->send_error("Can't write to SQL history file", storage_file_path);
-    return;
+void DbSqlEditorHistory::DetailsModel::load_frame(RowId row) {
+  RowId begin = (row < DETAILS_PAGE_SIZE / 2) ? 0 : row - DETAILS_PAGE_SIZE / 2;
+
+  std::vector<SqlHistoryStore::Entry> entries;
+  if (!_search_text.empty())
+    entries = _store->searchEntries(_search_text, begin, DETAILS_PAGE_SIZE);
+  else if (!_day.empty())
+    entries = _store->dayEntries(_day, begin, DETAILS_PAGE_SIZE);
+
+  _data.clear();
+  _data.reserve(entries.size() * _column_count);
+  for (auto &entry : entries) {
+    // Search results come from different days, so show the day too.
+    _data.push_back(_search_text.empty() ? entry.time : entry.day + " " + entry.time);
+    _data.push_back(entry.statement);
   }
 
-  {
-
-    base::RecMutexLock data_mutex(_data_mutex);
-    std::reverse(_data.begin(), _data.end());
-    std::string last_saved_timestamp;
-    std::string last_saved_statement;
-    get_field(NodeId(_last_loaded_row), 1, last_saved_timestamp);
-    get_field(NodeId(_last_loaded_row), 0, last_saved_statement);
-
-    for (RowId row = _last_loaded_row + 1; row < _row_count; ++row) {
-      std::string time, sql;
-      get_field(NodeId((int)row), 1, time);
-      get_field(NodeId((int)row), 0, sql);
-
-      if (time == last_saved_timestamp)
-        time = "~";
-      else
-        last_saved_timestamp = time;
-
-      if (sql == last_saved_statement)
-        sql = "~";
-      else
-        last_saved_statement = sql;
-
-      std::string xml_time, xml_sql;
-      xml_time = base::xml::encodeEntities(time);
-      xml_sql = base::xml::encodeEntities(sql);
-      xml_sql = base::replaceString(xml_sql, "\n", "&#x0A;");
-      ofs << "<ENTRY timestamp=\'" << xml_time << "\'>" << xml_sql << "</ENTRY>\n";
-    }
-    _last_loaded_row = (int)_row_count - 1;
-    std::reverse(_data.begin(), _data.end());
+  // The store might have fewer rows than expected (e.g. the day was deleted in another instance).
+  _data_frame_begin = begin;
+  _data_frame_end = begin + entries.size();
+  if (_data_frame_end <= row) {
+    _data.resize((row - begin + 1) * _column_count, std::string());
+    _data_frame_end = row + 1;
   }
-  ofs.flush();
 }
 
+/**
+ * Adds new statements (pairs of time and statement text) at the top of the list. They are written to
+ * the history store by the owner.
+ */
 void DbSqlEditorHistory::DetailsModel::add_entries(const std::list<std::string> &statements) {
   if (statements.empty())
     return;
 
-  {
-    base::RecMutexLock data_mutex(_data_mutex);
+  base::RecMutexLock data_mutex(_data_mutex);
 
-    _data.reserve(_data.size() + _column_count);
-
-    try {
-      int index = 0;
-      for (auto rit = statements.rbegin(); rit != statements.rend(); rit++) {
-        if (index % 2) {
-          // decides whether to use or not the existing data
-          if (*rit != _last_timestamp.toString())
-            _last_timestamp = *rit;
-
-          _data.insert(_data.begin(), _last_timestamp);
-        } else {
-          if (*rit != _last_statement.toString())
-            _last_statement = *rit;
-
-          _data.insert(_data.begin(), _last_statement);
-        }
-        index++;
-      }
-
-    } catch (...) {
-      _data.resize(_row_count * _column_count);
-      throw;
-    }
+  // If the top rows are not in memory, they are read from the store on next access, which then includes the new ones.
+  if (_data_frame_begin == 0 && _data_frame_end > 0) {
+    std::vector<sqlite::variant_t> rows;
+    rows.reserve(statements.size());
+    for (auto &value : statements)
+      rows.push_back(value);
 
-    _row_count += statements.size() / 2;
-    _data_frame_end = _row_count;
+    // The list contains oldest statement first, but the model shows the newest first.
+    for (size_t i = rows.size(); i >= 2; i -= 2) {
+      _data.insert(_data.end(), rows[i - 2]);
+      _data.insert(_data.end(), rows[i - 1]);
+    }
+    std::rotate(_data.begin(), _data.end() - rows.size(), _data.end());
+    _data_frame_end += statements.size() / 2;
+  } else {
+    _data.clear();
+    _data_frame_begin = 0;
+    _data_frame_end = 0;
   }
 
-  save();
-
-  // refresh_ui();
+  _row_count += statements.size() / 2;
 }
 
-void DbSqlEditorHistory::update_timestamp(std::tm timestamp) {
-  details_model()->datestamp(timestamp);
-  write_only_details_model()->datestamp(timestamp);
-}
 //--------------------------------------------------------------------------------------------------
@@ -29,6 +29,8 @@
 #include <time.h>
 #include "mforms/menu.h"
 
+class SqlHistoryStore;
+
 class MYSQLWBBACKEND_PUBLIC_FUNC DbSqlEditorHistory {
 public:
   typedef std::shared_ptr<DbSqlEditorHistory> Ref;
@@ -42,15 +44,22 @@ protected:
 
 public:
   void reset();
-  void add_entry(const std::list<std::string> &statements);
+  std::int64_t add_entry(const std::list<std::string> &statements);
+  void set_duration(std::int64_t entry, double duration);
+  void connection_name(const std::string &name) {
+    _connection_name = name;
+  }
   int current_entry() {
     return _current_entry_index;
   }
   void current_entry(int index);
+  void search(const std::string &text);
   std::string restore_sql_from_history(int entry_index, std::list<int> &detail_indexes);
 
 protected:
   int _current_entry_index;
+  std::string _connection_name;
+  std::shared_ptr<SqlHistoryStore> _store;
 
 public:
   void load();
@@ -60,16 +69,17 @@ public:
   class DetailsModel;
 
 public:
+  // Statements of one day (or of a search), read page wise from the history store.
   class DetailsModel : public VarGridModel {
   public:
     friend class DbSqlEditorHistory;
     typedef std::shared_ptr<DetailsModel> Ref;
-    static Ref create() {
-      return Ref(new DetailsModel());
+    static Ref create(std::shared_ptr<SqlHistoryStore> store) {
+      return Ref(new DetailsModel(store));
     }
 
   protected:
-    DetailsModel();
+    DetailsModel(std::shared_ptr<SqlHistoryStore> store);
 
   public:
     void add_entries(const std::list<std::string> &statements);
@@ -81,28 +91,18 @@ public:
     }
 
     virtual void reset();
+    virtual Cell cell(RowId row, ColumnId column);
 
-    void save();
-    void load(const std::string &storage_file_path);
-
-  protected:
-    int _last_loaded_row; // required to skip duplication of existing entries when dumping contents
-
-  public:
-    std::tm datestamp() const {
-      return _datestamp;
-    }
-    void datestamp(const std::tm &val) {
-      _datestamp = val;
-    }
+    void load(const std::string &day);
+    void load_search(const std::string &text);
 
   protected:
-    std::string storage_file_path() const;
-    std::tm _datestamp; // raw datestamp for locale independent storage file name
+    void load_frame(RowId row);
 
   private:
-    grt::StringRef _last_timestamp;
-    grt::StringRef _last_statement;
+    std::shared_ptr<SqlHistoryStore> _store;
+    std::string _day;
+    std::string _search_text;
     mforms::Menu _context_menu;
   };
 
@@ -124,10 +124,11 @@ public:
 
     DbSqlEditorHistory *_owner;
 
-    void add_statements(const std::list<std::string> &statements);
+    std::int64_t add_statements(const std::list<std::string> &statements);
 
   public:
     bool insert_entry(const std::tm &t);
+    bool insert_entry(const std::string &day);
     void delete_all_entries();
     void delete_entries(const std::vector<std::size_t> &rows);
     void set_ui_usage(bool value) {
@@ -137,8 +138,7 @@ public:
       return _ui_usage;
     }
 
-    std::string entry_path(std::size_t index);
-    std::tm entry_date(std::size_t index);
+    std::string entry_day(std::size_t index);
 
     virtual void reset();
     void load();
@@ -154,16 +154,10 @@ public:
   DetailsModel::Ref details_model() {
     return _details_model;
   }
-  DetailsModel::Ref write_only_details_model() {
-    return _write_only_details_model;
-  }
 
 protected:
   EntriesModel::Ref _entries_model;
   DetailsModel::Ref _details_model;
-  DetailsModel::Ref _write_only_details_model;
-
-  void update_timestamp(std::tm timestamp);
 };
 
 #endif /* _DB_SQL_EDITOR_HISTORY_BE_H_ */
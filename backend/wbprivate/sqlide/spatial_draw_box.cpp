@@ -22,6 +22,7 @@
  */
 
 #include <cairo/cairo.h>
+#include <thread>
 
 #include "spatial_draw_box.h"
 #include "mforms/box.h"
@@ -34,6 +35,9 @@
 
 DEFAULT_LOG_DOMAIN("spatial_draw_box");
 
+// Bands painted in parallel are not made smaller than this, in pixels.
+static const int MinBandHeight = 64;
+
 class ProgressPanel : public mforms::Box {
 public:
   ProgressPanel(const std::string &title) : mforms::Box(false), _timer(0) {
@@ -196,14 +200,7 @@ void SpatialDrawBox::render(bool reproject) {
   _current_layer = NULL;
   _current_layer_index = 0;
 
-  if (_zoom_level != 1) {
-    _ctx_cache->translate(base::Point(this->get_width() / 2.0, this->get_height() / 2.0));
-    _ctx_cache->scale(base::Point(_zoom_level, _zoom_level));
-    _ctx_cache->translate(base::Point(-this->get_width() / 2.0, -this->get_height() / 2.0));
-  }
-
-  _ctx_cache->translate(base::Point(_offset_x, _offset_y));
-
+  apply_view_transformation(*_ctx_cache);
   _ctx_cache->set_line_width(0);
 
   if (reproject && !_background_layer->hidden())
@@ -212,22 +209,59 @@ void SpatialDrawBox::render(bool reproject) {
   int i = 0;
 
   base::MutexLock lock(_layer_mutex);
-  for (std::deque<spatial::Layer *>::iterator it = _layers.begin(); it != _layers.end() && !_quitting; ++it, ++i) {
-    _current_work = base::strfmt("Rendering %i objects in layer %i...", (int)(*it)->size(), i + 1);
-
-    _current_layer_index = i;
-    _current_layer = *it;
-    if (!(*it)->hidden()) {
-      if (reproject)
+  // Each layer reprojects its features in parallel already, so the layers themselves are done one after the other.
+  if (reproject) {
+    for (std::deque<spatial::Layer *>::iterator it = _layers.begin(); it != _layers.end() && !_quitting; ++it, ++i) {
+      _current_work = base::strfmt("Rendering %i objects in layer %i...", (int)(*it)->size(), i + 1);
+
+      _current_layer_index = i;
+      _current_layer = *it;
+      if (!(*it)->hidden())
         (*it)->render(_spatial_reprojector);
-      (*it)->repaint(*_ctx_cache, _zoom_level, base::Rect());
     }
   }
 
+  if (!_quitting) {
+    _current_work = "Drawing layers...";
+    paint_layers(*surface);
+  }
+
   if (reproject)
     _needs_reprojection = false;
 }
 
+//--------------------------------------------------------------------------------------------------
+
+void SpatialDrawBox::apply_view_transformation(mdc::CairoCtx &cr) {
+  if (_zoom_level != 1) {
+    cr.translate(base::Point(this->get_width() / 2.0, this->get_height() / 2.0));
+    cr.scale(base::Point(_zoom_level, _zoom_level));
+    cr.translate(base::Point(-this->get_width() / 2.0, -this->get_height() / 2.0));
+  }
+
+  cr.translate(base::Point(_offset_x, _offset_y));
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Paints all visible layers into the given surface, split into horizontal bands which are painted in parallel.
+ */
+void SpatialDrawBox::paint_layers(mdc::ImageSurface &target) {
+  const int height = get_height();
+  if (get_width() <= 0 || height <= 0)
+    return;
+
+  // The bands are painted with the same transformation as the cache context.
+  cairo_matrix_t view_matrix;
+  cairo_get_matrix(_ctx_cache->get_cr(), &view_matrix);
+
+  int band_count = std::max(1, std::min((int)std::thread::hardware_concurrency(), height / MinBandHeight));
+  spatial::paint_layers(target, view_matrix, _layers, _zoom_level, band_count, _quitting);
+}
+
+//--------------------------------------------------------------------------------------------------
+
 bool SpatialDrawBox::get_progress(std::string &action, float &pct) {
   bool changed = false;
   _progress_mutex.lock();
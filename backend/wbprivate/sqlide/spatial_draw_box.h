@@ -108,6 +108,8 @@ class SpatialDrawBox : public mforms::DrawBox {
   void *render_done();
 
   void render(bool reproject = false);
+  void apply_view_transformation(mdc::CairoCtx &cr);
+  void paint_layers(mdc::ImageSurface &target);
   bool get_progress(std::string &action, float &pct);
 
   void restrict_displayed_area(int x1, int y1, int x2, int y2, bool no_invalidate = false);
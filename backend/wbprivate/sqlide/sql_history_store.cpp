@@ -0,0 +1,475 @@
+/*
+ * Copyright (c) 2020, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#include <cctype>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <set>
+#include <glib/gstdio.h>
+
+#include <sqlite/execute.hpp>
+#include <sqlite/query.hpp>
+#include <sqlite/database_exception.hpp>
+
+#include "base/log.h"
+#include "base/file_utilities.h"
+#include "base/boost_smart_ptr_helpers.h"
+#include "base/string_utilities.h"
+#include "base/xml_functions.h"
+#include "grt/grt_manager.h"
+#include "sqlide/sqlide_generics.h"
+
+#include "sql_history_store.h"
+
+DEFAULT_LOG_DOMAIN("sqlide-history")
+
+extern const char *SQL_HISTORY_DIR_NAME;
+
+static const char *HISTORY_DB_NAME = "history.sqlite";
+static const size_t MAX_BATCH_SIZE = 1000;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::shared_ptr<SqlHistoryStore> SqlHistoryStore::get() {
+  static std::mutex instanceMutex;
+  static std::weak_ptr<SqlHistoryStore> instance;
+
+  std::lock_guard<std::mutex> lock(instanceMutex);
+  std::shared_ptr<SqlHistoryStore> store = instance.lock();
+  if (!store) {
+    std::string directory = base::makePath(bec::GRTManager::get()->get_user_datadir(), SQL_HISTORY_DIR_NAME);
+    store = std::shared_ptr<SqlHistoryStore>(new SqlHistoryStore(directory));
+    instance = store;
+  }
+  return store;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+SqlHistoryStore::SqlHistoryStore(const std::string &directory)
+  : _directory(directory), _sqconn(nullptr), _haveFts(false), _writing(false), _stopping(false), _lastTicket(0) {
+  g_mkdir_with_parents(_directory.c_str(), 0700);
+
+  std::string path = base::makePath(_directory, HISTORY_DB_NAME);
+  _sqconn = new sqlite::connection(path);
+
+  // WAL allows reading while another Workbench instance writes, busy_timeout makes concurrent writers wait.
+  for (auto pragma : { "PRAGMA journal_mode=WAL", "PRAGMA busy_timeout=5000", "PRAGMA synchronous=NORMAL" }) {
+    try {
+      sqlite::query q(*_sqconn, pragma);
+      q.emit();
+    } catch (std::exception &exc) {
+      logWarning("Error executing %s on the query history: %s\n", pragma, exc.what());
+    }
+  }
+
+  initDb();
+  importXmlFiles();
+
+  _writer = std::thread(&SqlHistoryStore::writerLoop, this);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+SqlHistoryStore::~SqlHistoryStore() {
+  {
+    std::lock_guard<std::mutex> lock(_queueMutex);
+    _stopping = true;
+  }
+  _queueCondition.notify_all();
+  _writer.join(); // Writes what is still queued.
+
+  delete _sqconn;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void SqlHistoryStore::initDb() {
+  std::vector<std::string> code = {
+    "create table if not exists meta (name text primary key, value text)",
+    "create table if not exists entries (id integer primary key, day text not null, time text not null, "
+    "stamp integer not null, connection text not null, duration real, statement text not null)",
+    "create index if not exists entries_day on entries (day, id)",
+    "create index if not exists entries_stamp on entries (stamp)",
+    "create index if not exists entries_connection on entries (connection)",
+    "create index if not exists entries_duration on entries (duration)"
+  };
+
+  for (auto &statement : code) {
+    try {
+      sqlite::execute(*_sqconn, statement, true);
+    } catch (std::exception &exc) {
+      logError("Error creating query history table %s: %s\n", statement.c_str(), exc.what());
+    }
+  }
+
+  // The full text index is kept in sync by triggers. Not every SQLite build has FTS4, searching falls back to
+  // LIKE then.
+  std::vector<std::string> ftsCode = {
+    "create virtual table if not exists entries_fts using fts4(content='entries', statement)",
+    "create trigger if not exists entries_fts_insert after insert on entries begin "
+    "insert into entries_fts (docid, statement) values (new.id, new.statement); end",
+    "create trigger if not exists entries_fts_delete before delete on entries begin "
+    "delete from entries_fts where docid = old.id; end"
+  };
+
+  try {
+    sqlide::Sqlite_transaction_guarder guarder(_sqconn);
+    for (auto &statement : ftsCode)
+      sqlite::execute(*_sqconn, statement, true);
+    _haveFts = true;
+  } catch (std::exception &exc) {
+    logWarning("Full text search is not available for the query history: %s\n", exc.what());
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * One time import of the history files written by previous versions (one XML fragment file per day).
+ * The files are left in place.
+ */
+void SqlHistoryStore::importXmlFiles() {
+  {
+    sqlite::query q(*_sqconn, "select value from meta where name = 'xml_imported'");
+    if (q.emit())
+      return;
+  }
+
+  std::set<std::string> files;
+  GDir *dir = g_dir_open(_directory.c_str(), 0, nullptr);
+  if (dir != nullptr) {
+    while (const char *name = g_dir_read_name(dir)) {
+      // File name is expected in "YYYY-MM-DD" format.
+      if (strlen(name) == 10 && name[4] == '-' && name[7] == '-')
+        files.insert(name);
+    }
+    g_dir_close(dir);
+  }
+
+  try {
+    sqlide::Sqlite_transaction_guarder guarder(_sqconn);
+    sqlite::query insert(*_sqconn, "insert into entries (day, time, stamp, connection, statement) "
+                                   "values (?, ?, ?, '', ?)");
+
+    size_t count = 0;
+    for (auto &day : files) {
+      std::string path = base::makePath(_directory, day);
+      std::ifstream historyXml(path);
+      if (!historyXml.is_open())
+        continue;
+
+      // Skips the first line in the file as is the xml header. "~" means: same as in the previous entry.
+      std::string line, timestamp, statement;
+      std::getline(historyXml, line);
+      while (historyXml.good()) {
+        std::getline(historyXml, line);
+        if (line.empty())
+          continue;
+
+        xmlDocPtr xmlDoc = base::xml::xmlParseFragment(line);
+        if (xmlDoc == nullptr || xmlDoc->children == nullptr) {
+          logError("Can't parse %s, of file: %s\n", line.c_str(), path.c_str());
+          continue;
+        }
+
+        std::string value = base::xml::getProp(xmlDoc->children, "timestamp");
+        if (value != "~")
+          timestamp = value;
+        value = base::xml::getContent(xmlDoc->children);
+        if (value != "~")
+          statement = value;
+        xmlFreeDoc(xmlDoc);
+
+        insert.bind(1, day);
+        insert.bind(2, timestamp);
+        insert.bind(3, 0);
+        insert.bind(4, statement);
+        insert.emit();
+        insert.clear();
+        ++count;
+      }
+    }
+
+    sqlite::execute(*_sqconn, "insert into meta (name, value) values ('xml_imported', '1')", true);
+    logInfo("Imported %i query history entries from %i files\n", (int)count, (int)files.size());
+  } catch (std::exception &exc) {
+    logError("Error importing the query history: %s\n", exc.what());
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::int64_t SqlHistoryStore::add(const std::string &day, const std::string &time,
+                                  const std::list<std::string> &statements, const std::string &connection) {
+  std::int64_t stamp = (std::int64_t)::time(nullptr);
+
+  std::lock_guard<std::mutex> lock(_queueMutex);
+  for (auto &statement : statements)
+    _queue.push_back({ ++_lastTicket, false, 0, day, time, stamp, connection, statement });
+  _queueCondition.notify_all();
+
+  return _lastTicket;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void SqlHistoryStore::setDuration(std::int64_t ticket, double duration) {
+  std::lock_guard<std::mutex> lock(_queueMutex);
+  _queue.push_back({ ticket, true, duration, "", "", 0, "", "" });
+  _queueCondition.notify_all();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void SqlHistoryStore::writerLoop() {
+  while (true) {
+    std::vector<Operation> operations;
+    {
+      std::unique_lock<std::mutex> lock(_queueMutex);
+      _queueCondition.wait(lock, [this]() { return _stopping || !_queue.empty(); });
+      if (_queue.empty())
+        break; // Stopping and nothing left to write.
+
+      // Take everything that has been queued so far (up to a limit, to not block readers for too long).
+      size_t count = std::min(_queue.size(), MAX_BATCH_SIZE);
+      operations.assign(_queue.begin(), _queue.begin() + count);
+      _queue.erase(_queue.begin(), _queue.begin() + count);
+      _writing = true;
+    }
+
+    write(operations);
+
+    {
+      std::lock_guard<std::mutex> lock(_queueMutex);
+      _writing = false;
+    }
+    _queueCondition.notify_all();
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void SqlHistoryStore::write(const std::vector<Operation> &operations) {
+  std::lock_guard<std::mutex> lock(_dbMutex);
+  try {
+    sqlide::Sqlite_transaction_guarder guarder(_sqconn);
+    sqlite::query insert(*_sqconn, "insert into entries (day, time, stamp, connection, statement) "
+                                   "values (?, ?, ?, ?, ?)");
+    sqlite::query update(*_sqconn, "update entries set duration = ? where id = ?");
+    sqlite::query lastRow(*_sqconn, "select last_insert_rowid()");
+
+    for (auto &operation : operations) {
+      if (operation.isDuration) {
+        auto iterator = _ticketRows.find(operation.ticket);
+        if (iterator == _ticketRows.end())
+          continue;
+        update.bind(1, operation.duration);
+        update.bind(2, iterator->second);
+        update.emit();
+        update.clear();
+        _ticketRows.erase(iterator);
+      } else {
+        insert.bind(1, operation.day);
+        insert.bind(2, operation.time);
+        insert.bind(3, operation.stamp);
+        insert.bind(4, operation.connection);
+        insert.bind(5, operation.statement);
+        insert.emit();
+        insert.clear();
+
+        // Not every statement gets a duration, so only the most recent tickets are remembered.
+        if (_ticketRows.size() > MAX_BATCH_SIZE)
+          _ticketRows.erase(_ticketRows.begin());
+        if (lastRow.emit()) {
+          std::shared_ptr<sqlite::result> res(BoostHelper::convertPointer(lastRow.get_result()));
+          _ticketRows[operation.ticket] = res->get_int64(0);
+        }
+        lastRow.clear();
+      }
+    }
+  } catch (std::exception &exc) {
+    logError("Error writing to the query history: %s\n", exc.what());
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void SqlHistoryStore::flush() {
+  std::unique_lock<std::mutex> lock(_queueMutex);
+  _queueCondition.wait(lock, [this]() { return _queue.empty() && !_writing; });
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::vector<std::string> SqlHistoryStore::days() {
+  flush();
+
+  std::lock_guard<std::mutex> lock(_dbMutex);
+  std::vector<std::string> result;
+  try {
+    // Uses the day index, no need to touch the entries themselves.
+    sqlite::query q(*_sqconn, "select distinct day from entries order by day");
+    if (q.emit()) {
+      std::shared_ptr<sqlite::result> res(BoostHelper::convertPointer(q.get_result()));
+      do {
+        result.push_back(res->get_string(0));
+      } while (res->next_row());
+    }
+  } catch (std::exception &exc) {
+    logError("Error reading the query history: %s\n", exc.what());
+  }
+  return result;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void SqlHistoryStore::removeDays(const std::vector<std::string> &days) {
+  flush();
+
+  std::lock_guard<std::mutex> lock(_dbMutex);
+  try {
+    sqlide::Sqlite_transaction_guarder guarder(_sqconn);
+    sqlite::query q(*_sqconn, "delete from entries where day = ?");
+    for (auto &day : days) {
+      q.bind(1, day);
+      q.emit();
+      q.clear();
+
+      // Also remove the file from older versions, if there's still one.
+      base::tryRemove(base::makePath(_directory, day));
+    }
+  } catch (std::exception &exc) {
+    logError("Error deleting query history entries: %s\n", exc.what());
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+size_t SqlHistoryStore::dayCount(const std::string &day) {
+  return readCount("select count(*) from entries where day = ?", day);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::vector<SqlHistoryStore::Entry> SqlHistoryStore::dayEntries(const std::string &day, size_t offset,
+                                                                size_t limit) {
+  return readEntries("select day, time, statement from entries where day = ? order by id desc limit ? offset ?", day,
+                     offset, limit);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+size_t SqlHistoryStore::searchCount(const std::string &text) {
+  std::string query = ftsQuery(text);
+  if (!query.empty())
+    return readCount("select count(*) from entries_fts where entries_fts match ?", query);
+  return readCount("select count(*) from entries where statement like ?", "%" + text + "%");
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::vector<SqlHistoryStore::Entry> SqlHistoryStore::searchEntries(const std::string &text, size_t offset,
+                                                                   size_t limit) {
+  std::string query = ftsQuery(text);
+  if (!query.empty())
+    return readEntries("select e.day, e.time, e.statement from entries e where e.id in "
+                       "(select docid from entries_fts where entries_fts match ?) order by e.id desc limit ? offset ?",
+                       query, offset, limit);
+  return readEntries("select day, time, statement from entries where statement like ? order by id desc "
+                     "limit ? offset ?", "%" + text + "%", offset, limit);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Converts the search text into a FTS query, matching all words (as prefixes) in the text.
+ * Returns an empty string if there's no FTS index or the text contains no words. LIKE is used then.
+ */
+std::string SqlHistoryStore::ftsQuery(const std::string &text) const {
+  if (!_haveFts)
+    return "";
+
+  std::string result;
+  std::string word;
+  for (size_t i = 0; i <= text.size(); ++i) {
+    unsigned char c = i < text.size() ? (unsigned char)text[i] : ' ';
+    if (isalnum(c) || c == '_' || c >= 0x80)
+      word.push_back((char)c);
+    else if (!word.empty()) {
+      if (!result.empty())
+        result += " ";
+      result += "\"" + word + "*\"";
+      word.clear();
+    }
+  }
+  return result;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::vector<SqlHistoryStore::Entry> SqlHistoryStore::readEntries(const std::string &sql, const std::string &parameter,
+                                                                 size_t offset, size_t limit) {
+  flush();
+
+  std::lock_guard<std::mutex> lock(_dbMutex);
+  std::vector<Entry> result;
+  try {
+    sqlite::query q(*_sqconn, sql);
+    q.bind(1, parameter);
+    q.bind(2, (int)limit);
+    q.bind(3, (int)offset);
+    if (q.emit()) {
+      std::shared_ptr<sqlite::result> res(BoostHelper::convertPointer(q.get_result()));
+      result.reserve(limit);
+      do {
+        result.push_back({ res->get_string(0), res->get_string(1), res->get_string(2) });
+      } while (res->next_row());
+    }
+  } catch (std::exception &exc) {
+    logError("Error reading the query history: %s\n", exc.what());
+  }
+  return result;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+size_t SqlHistoryStore::readCount(const std::string &sql, const std::string &parameter) {
+  flush();
+
+  std::lock_guard<std::mutex> lock(_dbMutex);
+  try {
+    sqlite::query q(*_sqconn, sql);
+    q.bind(1, parameter);
+    if (q.emit()) {
+      std::shared_ptr<sqlite::result> res(BoostHelper::convertPointer(q.get_result()));
+      return (size_t)res->get_int(0);
+    }
+  } catch (std::exception &exc) {
+    logError("Error reading the query history: %s\n", exc.what());
+  }
+  return 0;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2020, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#pragma once
+
+#include <sqlite/connection.hpp>
+
+#include <condition_variable>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "workbench/wb_backend_public_interface.h"
+
+/**
+ * Local store for the SQL editor query history, shared by all editors.
+ * Statements are kept in a single SQLite file with an FTS index on the statement text (if the SQLite build
+ * supports it) and indexes on day, timestamp, connection and duration, so that reading a page of entries or
+ * searching through the entire history doesn't depend on the size of the history.
+ * Writes are queued and stored in batches by a background thread. Reads see all writes queued before them.
+ */
+class MYSQLWBBACKEND_PUBLIC_FUNC SqlHistoryStore {
+public:
+#if defined(ENABLE_TESTING)
+  friend class SqlHistoryStoreTester;
+#endif
+
+  struct Entry {
+    std::string day; // YYYY-MM-DD
+    std::string time;
+    std::string statement;
+  };
+
+  static std::shared_ptr<SqlHistoryStore> get();
+  ~SqlHistoryStore();
+
+  // Queues the statements for writing. The returned ticket identifies the last of them (for setDuration).
+  std::int64_t add(const std::string &day, const std::string &time, const std::list<std::string> &statements,
+                   const std::string &connection);
+  void setDuration(std::int64_t ticket, double duration);
+
+  std::vector<std::string> days();
+  void removeDays(const std::vector<std::string> &days);
+
+  // Entries are returned newest first.
+  size_t dayCount(const std::string &day);
+  std::vector<Entry> dayEntries(const std::string &day, size_t offset, size_t limit);
+  size_t searchCount(const std::string &text);
+  std::vector<Entry> searchEntries(const std::string &text, size_t offset, size_t limit);
+
+private:
+  struct Operation {
+    std::int64_t ticket;
+    bool isDuration;
+    double duration;
+    std::string day;
+    std::string time;
+    std::int64_t stamp;
+    std::string connection;
+    std::string statement;
+  };
+
+  std::string _directory;
+  sqlite::connection *_sqconn;
+  bool _haveFts;
+  std::mutex _dbMutex;
+
+  std::mutex _queueMutex;
+  std::condition_variable _queueCondition;
+  std::vector<Operation> _queue;
+  bool _writing;
+  bool _stopping;
+  std::int64_t _lastTicket;
+  std::map<std::int64_t, std::int64_t> _ticketRows;
+  std::thread _writer;
+
+  SqlHistoryStore(const std::string &directory);
+
+  void initDb();
+  void importXmlFiles();
+  void writerLoop();
+  void write(const std::vector<Operation> &operations);
+  void flush();
+  std::string ftsQuery(const std::string &text) const;
+  std::vector<Entry> readEntries(const std::string &sql, const std::string &parameter, size_t offset, size_t limit);
+  size_t readCount(const std::string &sql, const std::string &parameter);
+};
@@ -676,7 +676,7 @@ void WBContextSQLIDE::handle_notification(const std::string &name, void *sender,
 
 void WBContextSQLIDE::init() {
 
-  // Access the context help once to start its initial loading.
+  // Create the context help instance. Its help indexes are loaded on first use.
   help::DbSqlEditorContextHelp::get();
 
   DbSqlEditorSnippets::setup(this, base::makePath(bec::GRTManager::get()->get_user_datadir(), "snippets"));
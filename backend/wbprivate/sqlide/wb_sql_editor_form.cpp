@@ -39,6 +39,7 @@
 #include "sqlide/sql_script_run_wizard.h"
 
 #include "sqlide/column_width_cache.h"
+#include "sqlide/completion_cache.h"
 
 #include "objimpl/db.query/db_query_Resultset.h"
 #include "objimpl/wrapper/mforms_ObjectReference_impl.h"
@@ -78,6 +79,7 @@
 #include "wb_tunnel.h"
 
 #include <math.h>
+#include <atomic>
 #include <mutex>
 #include <thread>
 
@@ -187,6 +189,7 @@ private:
 
 struct SqlEditorForm::PrivateMutex {
   std::mutex _symbolsMutex;
+  std::atomic<bool> _completionRefreshCancelled { false };
 };
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -276,6 +279,7 @@ void SqlEditorForm::report_connection_failure(const grt::server_denied &info, co
 
 SqlEditorForm::SqlEditorForm(wb::WBContextSQLIDE *wbsql)
   : exec_sql_task(GrtThreadedTask::create()),
+    _completion_refresh_task(GrtThreadedTask::create()),
     _history(DbSqlEditorHistory::create()),
     _wbsql(wbsql),
     _version(grt::Initialized),
@@ -295,6 +299,9 @@ SqlEditorForm::SqlEditorForm(wb::WBContextSQLIDE *wbsql)
   exec_sql_task->msg_cb(std::bind(&SqlEditorForm::add_log_message, this, std::placeholders::_1, std::placeholders::_2,
                                   std::placeholders::_3, ""));
 
+  _completion_refresh_task->desc("Completion Cache Refresh Task");
+  _completion_refresh_task->send_task_res_msg(false);
+
   _last_log_message_timestamp = timestamp();
 
   long keep_alive_interval = bec::GRTManager::get()->get_app_option_int("DbSqlEditor:KeepAliveInterval", 600);
@@ -330,6 +337,7 @@ SqlEditorForm::~SqlEditorForm() {
                                               _connection->parameterValues().get_string("userName"));
 
   delete _column_width_cache;
+  delete _completion_cache;
 
   // debug: ensure that close() was called when the tab is closed
   if (_toolbar != nullptr)
@@ -383,8 +391,6 @@ void SqlEditorForm::check_server_problems() {
 void SqlEditorForm::finish_startup() {
   setup_side_palette();
 
-  _live_tree->finish_init();
-
   std::string cache_dir = bec::GRTManager::get()->get_user_datadir() + "/cache/";
   try {
     base::create_directory(cache_dir, 0700); // No-op if the folder already exists.
@@ -394,6 +400,15 @@ void SqlEditorForm::finish_startup() {
 
   _column_width_cache = new ColumnWidthCache(sanitize_file_name(get_session_name()), cache_dir);
 
+  // Must exist before the live tree loads the schema list, which fills the symbol tables from it.
+  try {
+    _completion_cache = new CompletionCache(sanitize_file_name(get_session_name()), cache_dir);
+  } catch (std::exception &e) {
+    logError("Could not open the completion cache: %s\n", e.what());
+  }
+
+  _live_tree->finish_init();
+
   if (_usr_dbc_conn && !_usr_dbc_conn->active_schema.empty())
     _live_tree->on_active_schema_change(_usr_dbc_conn->active_schema);
   readStaticServerSymbols();
@@ -584,6 +599,8 @@ grt::StringRef SqlEditorForm::do_disconnect() {
 //----------------------------------------------------------------------------------------------------------------------
 
 void SqlEditorForm::close() {
+  _pimplMutex->_completionRefreshCancelled = true;
+
   grt::ValueRef option(bec::GRTManager::get()->get_app_option("workbench:SaveSQLWorkspaceOnClose"));
 
   if (option.is_valid() && *grt::IntegerRef::cast_from(option)) {
@@ -1170,6 +1187,7 @@ void SqlEditorForm::set_connection(db_mgmt_ConnectionRef conn) {
     logWarning("Setting connection on an editor with a connection already set\n");
 
   _connection = conn;
+  _history->connection_name(conn->name());
 
   _dbc_auth = sql::Authentication::create(_connection, "");
 
@@ -2038,10 +2056,11 @@ grt::StringRef SqlEditorForm::do_exec_sql(Ptr self_ptr, std::shared_ptr<std::str
         std::string schema_name;
         std::string table_name;
 
+        std::int64_t history_entry = 0;
         if (logging_queries) {
           std::list<std::string> statements;
           statements.push_back(statement);
-          _history->add_entry(statements);
+          history_entry = _history->add_entry(statements);
         }
 
         Recordset_cdbc_storage::Ref data_storage;
@@ -2104,6 +2123,8 @@ grt::StringRef SqlEditorForm::do_exec_sql(Ptr self_ptr, std::shared_ptr<std::str
               statement_exec_timer.run();
               is_result_set_first = dbc_statement->execute(statement);
             }
+            if (history_entry != 0)
+              _history->set_duration(history_entry, statement_exec_timer.duration());
             logDebug3("Query executed successfully\n");
 
             updated_rows_count = dbc_statement->getUpdateCount();
@@ -2822,13 +2843,170 @@ std::string SqlEditorForm::active_schema() const {
 
 //----------------------------------------------------------------------------------------------------------------------
 
+/**
+ * Adds symbols for the given schema objects (and the columns of tables and views) to the schema symbol.
+ */
+static void addSchemaObjectSymbols(SymbolTable &symbols, SchemaSymbol *schemaSymbol,
+                                   const std::vector<CompletionCache::SchemaObject> &objects) {
+  for (auto &object : objects) {
+    switch (object.type) {
+      case CompletionCache::Table: {
+        TableSymbol *tableSymbol = symbols.addNewSymbol<TableSymbol>(schemaSymbol, object.name);
+        for (auto &column : object.columns)
+          symbols.addNewSymbol<ColumnSymbol>(tableSymbol, column, nullptr);
+        break;
+      }
+
+      case CompletionCache::View: {
+        ViewSymbol *viewSymbol = symbols.addNewSymbol<ViewSymbol>(schemaSymbol, object.name);
+        for (auto &column : object.columns)
+          symbols.addNewSymbol<ColumnSymbol>(viewSymbol, column, nullptr);
+        break;
+      }
+
+      case CompletionCache::Procedure:
+      case CompletionCache::Function:
+        symbols.addNewSymbol<StoredRoutineSymbol>(schemaSymbol, object.name, nullptr);
+        break;
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 void SqlEditorForm::schemaListRefreshed(std::vector<std::string> const &schemas) {
-  std::unique_lock<std::mutex> lock(_pimplMutex->_symbolsMutex);
-  _databaseSymbols.clear(); // Doesn't clear the dependencies.
+  {
+    std::unique_lock<std::mutex> lock(_pimplMutex->_symbolsMutex);
+    _databaseSymbols.clear(); // Doesn't clear the dependencies.
 
-  for (auto schema : schemas) {
-    _databaseSymbols.addNewSymbol<SchemaSymbol>(nullptr, schema);
+    for (auto schema : schemas) {
+      SchemaSymbol *schemaSymbol = _databaseSymbols.addNewSymbol<SchemaSymbol>(nullptr, schema);
+
+      // Make whatever we know from earlier sessions available to code completion right away.
+      if (_completion_cache != nullptr)
+        addSchemaObjectSymbols(_databaseSymbols, schemaSymbol, _completion_cache->schemaObjects(schema));
+    }
   }
+
+  if (_completion_cache != nullptr && !_completion_refresh_task->is_busy())
+    _completion_refresh_task->exec(
+      false, std::bind(&SqlEditorForm::refreshCompletionCache, this, weak_ptr_from(this), schemas));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Brings the completion cache up to date with the server. Only objects which are new or whose stamp changed get
+ * their columns fetched again. Tables and routines are stamped with their creation and update times, views (which
+ * have neither) with a hash of their definition. Objects without a stamp are always read again. Runs in the
+ * background; the symbol table of a schema is replaced only if something changed in it.
+ */
+grt::StringRef SqlEditorForm::refreshCompletionCache(SqlEditorForm::Ptr self_ptr, std::vector<std::string> schemas) {
+  RETVAL_IF_FAIL_TO_RETAIN_WEAK_PTR(SqlEditorForm, self_ptr, self, grt::StringRef(""))
+
+  for (auto &schema : _completion_cache->cachedSchemas()) {
+    if (std::find(schemas.begin(), schemas.end(), schema) == schemas.end())
+      _completion_cache->removeSchema(schema);
+  }
+
+  for (auto &schema : schemas) {
+    if (_pimplMutex->_completionRefreshCancelled)
+      break;
+
+    try {
+      std::vector<CompletionCache::SchemaObject> changed;
+      std::vector<CompletionCache::SchemaObject> removed;
+      {
+        sql::Dbc_connection_handler::Ref conn;
+        RecMutexLock aux_dbc_conn_mutex(ensure_valid_aux_connection(conn));
+        std::unique_ptr<sql::Statement> statement(conn->ref->createStatement());
+
+        std::vector<CompletionCache::SchemaObject> current;
+        auto collect = [&](sql::ResultSet *rs, CompletionCache::ObjectType type) {
+          current.push_back({ rs->getString(1), type, rs->getString(3), {} });
+        };
+
+        {
+          std::unique_ptr<sql::ResultSet> rs(statement->executeQuery(std::string(
+            base::sqlstring("SELECT t.TABLE_NAME, t.TABLE_TYPE, IF(t.TABLE_TYPE = 'VIEW', "
+                            "MD5(NULLIF(v.VIEW_DEFINITION, '')), CONCAT_WS(',', t.CREATE_TIME, t.UPDATE_TIME)) "
+                            "FROM information_schema.TABLES t LEFT JOIN information_schema.VIEWS v "
+                            "ON v.TABLE_SCHEMA = t.TABLE_SCHEMA AND v.TABLE_NAME = t.TABLE_NAME "
+                            "WHERE t.TABLE_SCHEMA = ?", 0) << schema)));
+          while (rs->next()) {
+            bool isView = std::string(rs->getString(2)) == "VIEW";
+            collect(rs.get(), isView ? CompletionCache::View : CompletionCache::Table);
+          }
+        }
+
+        {
+          std::unique_ptr<sql::ResultSet> rs(statement->executeQuery(std::string(
+            base::sqlstring("SELECT ROUTINE_NAME, ROUTINE_TYPE, CONCAT_WS(',', CREATED, LAST_ALTERED) "
+                            "FROM information_schema.ROUTINES WHERE ROUTINE_SCHEMA = ?", 0) << schema)));
+          while (rs->next()) {
+            bool isFunction = std::string(rs->getString(2)) == "FUNCTION";
+            collect(rs.get(), isFunction ? CompletionCache::Function : CompletionCache::Procedure);
+          }
+        }
+
+        _completion_cache->compareObjects(schema, current, changed, removed);
+
+        // One round trip for all columns of the schema, but keep only those of changed tables and views.
+        std::map<std::string, size_t> columnOwners;
+        for (size_t i = 0; i < changed.size(); ++i) {
+          if (changed[i].type == CompletionCache::Table || changed[i].type == CompletionCache::View)
+            columnOwners[changed[i].name] = i;
+        }
+
+        if (!columnOwners.empty()) {
+          std::unique_ptr<sql::ResultSet> rs(statement->executeQuery(std::string(
+            base::sqlstring("SELECT TABLE_NAME, COLUMN_NAME FROM information_schema.COLUMNS WHERE TABLE_SCHEMA = ? "
+                            "ORDER BY TABLE_NAME, ORDINAL_POSITION", 0) << schema)));
+          while (rs->next()) {
+            auto owner = columnOwners.find(rs->getString(1));
+            if (owner != columnOwners.end())
+              changed[owner->second].columns.push_back(rs->getString(2));
+          }
+        }
+      }
+
+      if (changed.empty() && removed.empty())
+        continue;
+
+      logDebug2("Completion cache for %s: %i changed, %i removed objects\n", schema.c_str(), (int)changed.size(),
+                (int)removed.size());
+      // Removal first, a dropped table can have been replaced by a view of the same name.
+      _completion_cache->removeObjects(schema, removed);
+      _completion_cache->storeObjects(schema, changed);
+
+      auto objects = _completion_cache->schemaObjects(schema);
+      std::unique_lock<std::mutex> lock(_pimplMutex->_symbolsMutex);
+      for (SchemaSymbol *schemaSymbol : _databaseSymbols.getSymbolsOfType<SchemaSymbol>()) {
+        if (schemaSymbol->name == schema) {
+          _databaseSymbols.lock();
+          schemaSymbol->clear();
+          addSchemaObjectSymbols(_databaseSymbols, schemaSymbol, objects);
+          _databaseSymbols.unlock();
+          break;
+        }
+      }
+    } catch (const sql::SQLException &e) {
+      logWarning("Could not refresh the completion cache for schema %s: %s\n", schema.c_str(), e.what());
+    }
+  }
+
+  return grt::StringRef("");
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Drops everything the completion cache knows, so that the next schema fetches read all columns from the server.
+ * Used when the user explicitly asks for a refresh.
+ */
+void SqlEditorForm::discardCompletionCache() {
+  if (_completion_cache != nullptr)
+    _completion_cache->clear();
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -2897,6 +3075,34 @@ void SqlEditorForm::schema_meta_data_refreshed(const std::string &schema_name, b
     return symbol->name == "performance_schema";
   }) != schemaSymbols.end();
 
+  // Columns already known from the completion cache don't need a server round trip.
+  std::map<std::string, std::vector<std::string>> cachedColumns;
+  if (_completion_cache != nullptr) {
+    for (auto &object : _completion_cache->schemaObjects(schema_name)) {
+      if (object.type == CompletionCache::Table || object.type == CompletionCache::View)
+        cachedColumns[object.name] = object.columns;
+    }
+  }
+  std::vector<CompletionCache::SchemaObject> fetchedObjects;
+
+  auto addColumns = [&](ScopedSymbol *parent, const std::string &name, CompletionCache::ObjectType type) {
+    auto entry = cachedColumns.find(name);
+    if (entry != cachedColumns.end() && !entry->second.empty()) {
+      for (auto &column : entry->second)
+        _databaseSymbols.addNewSymbol<ColumnSymbol>(parent, column, nullptr);
+    } else if (statement != nullptr) {
+      std::unique_ptr<sql::ResultSet> rs(statement->executeQuery(
+        std::string(base::sqlstring("SHOW FULL COLUMNS FROM !.!", 0) << schema_name << name)));
+
+      CompletionCache::SchemaObject object{ name, type, "", {} };
+      while (rs->next()) {
+        object.columns.push_back(rs->getString(1));
+        _databaseSymbols.addNewSymbol<ColumnSymbol>(parent, object.columns.back(), nullptr);
+      }
+      fetchedObjects.push_back(object);
+    }
+  };
+
   for (SchemaSymbol *schemaSymbol : schemaSymbols) {
     if (schemaSymbol->name == schema_name) {
       schemaSymbol->clear();
@@ -2904,30 +3110,20 @@ void SqlEditorForm::schema_meta_data_refreshed(const std::string &schema_name, b
         TableSymbol *tableSymbol = _databaseSymbols.addNewSymbol<TableSymbol>(schemaSymbol, table);
 
         // Fetch column info for each table.
-        if (statement != nullptr) {
-          std::unique_ptr<sql::ResultSet> rs(statement->executeQuery(
-            std::string(base::sqlstring("SHOW FULL COLUMNS FROM !.!", 0) << schema_name << table)));
-
-          while (rs->next()) {
-            _databaseSymbols.addNewSymbol<ColumnSymbol>(tableSymbol, rs->getString(1), nullptr);
-          }
-        }
+        addColumns(tableSymbol, table, CompletionCache::Table);
       }
 
       for (auto view : *views) {
         ViewSymbol *viewSymbol = _databaseSymbols.addNewSymbol<ViewSymbol>(schemaSymbol, view);
 
         // Same for each view.
-        if (statement != nullptr) {
-          std::unique_ptr<sql::ResultSet> rs(statement->executeQuery(
-            std::string(base::sqlstring("SHOW FULL COLUMNS FROM !.!", 0) << schema_name << view)));
-
-          while (rs->next()) {
-            _databaseSymbols.addNewSymbol<ColumnSymbol>(viewSymbol, rs->getString(1), nullptr);
-          }
-        }
+        addColumns(viewSymbol, view, CompletionCache::View);
       }
 
+      // An empty stamp makes the next background refresh read these objects once more.
+      if (_completion_cache != nullptr && !fetchedObjects.empty())
+        _completion_cache->storeObjects(schema_name, fetchedObjects);
+
       for (auto procedure : *procedures) {
         _databaseSymbols.addNewSymbol<StoredRoutineSymbol>(schemaSymbol, procedure, nullptr);
       }
@@ -64,6 +64,7 @@ namespace bec {
 class QuerySidePalette;
 class SqlEditorTreeController;
 class ColumnWidthCache;
+class CompletionCache;
 class SqlEditorPanel;
 class SqlEditorResult;
 
@@ -434,12 +435,14 @@ public:
   std::string active_schema() const;
 
   void schemaListRefreshed(std::vector<std::string> const &schemas);
+  void discardCompletionCache();
 
   void schema_meta_data_refreshed(const std::string &schema_name, base::StringListPtr tables, base::StringListPtr views,
                                   base::StringListPtr procedures, base::StringListPtr functions);
 
 private:
   void cache_active_schema_name();
+  grt::StringRef refreshCompletionCache(SqlEditorForm::Ptr self_ptr, std::vector<std::string> schemas);
 
 public:
   void request_refresh_schema_tree();
@@ -564,6 +567,8 @@ private:
   ServerState _last_server_running_state = UnknownState;
 
   ColumnWidthCache *_column_width_cache = nullptr;
+  CompletionCache *_completion_cache = nullptr; // Persisted object names for the symbol tables below.
+  GrtThreadedTask::Ref _completion_refresh_task;
 
   parsers::SymbolTable _staticServerSymbols; // Charsets, collations, engines.
   parsers::SymbolTable _databaseSymbols; // All available db objects reachable via the current connection.
@@ -22,9 +22,8 @@
  */
 
 #include <pcrecpp.h>
-#include <thread>
-#include <rapidjson/istreamwrapper.h>
 #include <fstream>
+#include <iterator>
 
 #include "base/log.h"
 #include "base/string_utilities.h"
@@ -290,61 +289,57 @@ DbSqlEditorContextHelp::DbSqlEditorContextHelp() {
     { "like", "string-comparison-functions" },
     { "auto_increment", "example-auto-increment" },
   };
-
-  loaderThread = std::thread([this]() {
-    std::string dataDir = base::makePath(mforms::App::get()->baseDir(), "modules/data/sqlide");
-    for (long version : { 800, 507, 506, 505 }) {
-      std::string fileName = "help-" + std::to_string(version / 100) + "." + std::to_string(version % 10) + ".json";
-      std::string path = base::makePath(dataDir, fileName);
-      if (!base::file_exists(path)) {
-        logError("Help file not found (%s)\n", path.c_str());
-        continue;
-      }
-
-      try {
-        rapidjson::Value document;
-        std::ifstream ifs(path);
-        IStreamWrapper isw(ifs);
-        Document d;
-        d.ParseStream(isw);
-        if (d.HasParseError()) {
-          logError("Could not read help text file (%s)\nError code: %d\n", fileName.c_str(), d.GetParseError());
-          continue;
-        }
-
-        std::set<std::string> topics;
-        Value topicRoot;
-        topicRoot.CopyFrom(d, d.GetAllocator());
-
-        if (topicRoot.HasMember("topics")) {
-          auto const &topicList = topicRoot["topics"].GetArray();
-          for (auto &topic : topicList) {
-            std::string id = base::toupper(topic["id"].GetString());
-            topics.insert(id);
-            helpContent[version][id] = createHelpTextFromJson(version, topic);
-          }
-        }
-        helpTopics[version] = topics;
-      } catch (std::bad_cast &e) {
-        logError("Unexpected file format (%s)\nError message: %s\n", fileName.c_str(), e.what());
-      }
-      
-    }
-  });
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 
 DbSqlEditorContextHelp::~DbSqlEditorContextHelp() {
-  waitForLoading();
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 
-void DbSqlEditorContextHelp::waitForLoading() {
-  if (loaderThread.joinable())
-    loaderThread.join();
-};
+/**
+ * Returns the help index for the given (short) server version, loading it on first use. The index is normally
+ * pre-built and memory mapped. If it is missing (e.g. in builds without the index generator), the index is built
+ * from the help JSON file instead. Must be called with indexLock held.
+ */
+HelpIndex *DbSqlEditorContextHelp::indexForVersion(long version) {
+  auto iterator = helpIndexes.find(version);
+  if (iterator != helpIndexes.end())
+    return iterator->second.get();
+
+  static const std::set<long> availableVersions = { 800, 507, 506, 505 };
+  std::unique_ptr<HelpIndex> &index = helpIndexes[version];
+  if (availableVersions.count(version) == 0)
+    return nullptr;
+
+  std::string dataDir = base::makePath(mforms::App::get()->baseDir(), "modules/data/sqlide");
+  std::string baseName = "help-" + std::to_string(version / 100) + "." + std::to_string(version % 10);
+
+  std::string path = base::makePath(dataDir, baseName + ".idx");
+  if (base::file_exists(path)) {
+    index = HelpIndex::open(path);
+    if (index)
+      return index.get();
+    logError("Invalid help index file (%s), falling back to the JSON file\n", path.c_str());
+  }
+
+  path = base::makePath(dataDir, baseName + ".json");
+  if (!base::file_exists(path)) {
+    logError("Help file not found (%s)\n", path.c_str());
+    return nullptr;
+  }
+
+  try {
+    std::ifstream stream(path, std::ios::binary);
+    std::string json((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+    index = HelpIndex::fromData(HelpIndex::build(json));
+  } catch (std::exception &e) {
+    logError("Could not read help text file (%s)\nError message: %s\n", path.c_str(), e.what());
+  }
+
+  return index.get();
+}
 
 //----------------------------------------------------------------------------------------------------------------------
 
@@ -352,12 +347,10 @@ void DbSqlEditorContextHelp::waitForLoading() {
  * A quick lookup if the help topic exists actually, without retrieving help text.
  */
 bool DbSqlEditorContextHelp::topicExists(long serverVersion, const std::string &topic) {
-  waitForLoading();
+  std::lock_guard<std::mutex> lock(indexLock);
 
-  auto iterator = helpTopics.find(serverVersion / 100);
-  if (iterator == helpTopics.end())
-    return false;
-  return iterator->second.count(topic) > 0;
+  HelpIndex *index = indexForVersion(serverVersion / 100);
+  return index != nullptr && index->contains(topic);
 };
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -365,14 +358,32 @@ bool DbSqlEditorContextHelp::topicExists(long serverVersion, const std::string &
 bool DbSqlEditorContextHelp::helpTextForTopic(HelpContext *context, const std::string &topic, std::string &text) {
   logDebug2("Looking up help topic: %s\n", topic.c_str());
 
-  // If help text is requested so quickly that loading the help content hasn't finished yet, wait here.
-  // Usually however, the content is loaded way before offline help is queried the first time.
-  waitForLoading();
-
   if (!topic.empty()) {
-    auto iterator = helpContent.find(context->serverVersion() / 100);
-    if (iterator == helpContent.end())
-      return false;
+    long version = context->serverVersion() / 100;
+    std::string content;
+    {
+      std::lock_guard<std::mutex> lock(indexLock);
+      HelpIndex *index = indexForVersion(version);
+      if (index == nullptr)
+        return false;
+
+      // Only topics actually shown are decoded and formatted. Keep them, as the same topics are usually shown
+      // over and over again while the caret moves.
+      auto &versionContent = helpContent[version];
+      auto iterator = versionContent.find(topic);
+      if (iterator != versionContent.end())
+        content = iterator->second;
+      else {
+        std::string json;
+        if (index->topicJson(topic, json)) {
+          Document document;
+          document.Parse(json.c_str(), json.size());
+          if (!document.HasParseError() && document.IsObject())
+            content = createHelpTextFromJson(version, document);
+        }
+        versionContent[topic] = content;
+      }
+    }
 
     // Prepare style sheet depending on the OS theme.
     std::string styleSheet;
@@ -402,7 +413,7 @@ bool DbSqlEditorContextHelp::helpTextForTopic(HelpContext *context, const std::s
     base::replaceStringInplace(styleSheet, "»userInput«", color.to_html());
 #endif
 
-    text = "<html><head>" + styleSheet + "</head>" + iterator->second[topic] + "</html>";
+    text = "<html><head>" + styleSheet + "</head>" + content + "</html>";
     return true;
   }
   return false;
@@ -23,9 +23,12 @@
 
 #pragma once
 
-#include <thread>
+#include <memory>
+#include <mutex>
 #include "rapidjson/document.h"
 
+#include "wb_sql_editor_help_index.h"
+
 // Helper class to find context sensitive help based on a statement and a position in it.
 
 namespace JsonParser {
@@ -53,20 +56,19 @@ namespace help {
   public:
     static DbSqlEditorContextHelp *get();
 
-    void waitForLoading();
-
     bool helpTextForTopic(HelpContext *helpContext, const std::string &topic, std::string &text);
     std::string helpTopicFromPosition(HelpContext *helpContext, const std::string &query, size_t caretPosition);
 
   protected:
-    std::thread loaderThread;
     std::map<std::string, std::string> pageMap;
-    std::map<long, std::set<std::string>> helpTopics;               // Quick lookup for help topics per server version.
-    std::map<long, std::map<std::string, std::string>> helpContent; // Help text from a topic (also per version).
+    std::mutex indexLock;
+    std::map<long, std::unique_ptr<HelpIndex>> helpIndexes;        // Loaded on first use, per server version.
+    std::map<long, std::map<std::string, std::string>> helpContent; // Formatted help text of topics looked up so far.
 
     DbSqlEditorContextHelp();
     ~DbSqlEditorContextHelp();
 
+    HelpIndex *indexForVersion(long version);
     std::string createHelpTextFromJson(long version, rapidjson::Value const &json);
     bool topicExists(long serverVersion, const std::string &topic);
   };
@@ -0,0 +1,261 @@
+/*
+ * Copyright (c) 2020, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#include <cstring>
+#include <map>
+#include <stdexcept>
+#include <vector>
+
+#include <glib.h>
+
+#include "rapidjson/document.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+
+#include "base/string_utilities.h"
+
+#include "wb_sql_editor_help_index.h"
+
+using namespace help;
+
+static const char indexMagic[4] = { 'W', 'B', 'H', 'I' };
+static const size_t headerSize = 16;
+static const size_t topicEntrySize = 16;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// FNV-1a, which is good enough for the few thousand topics we have per file.
+static unsigned hashTopic(const char *text, size_t length) {
+  unsigned hash = 2166136261u;
+  for (size_t i = 0; i < length; ++i) {
+    hash ^= static_cast<unsigned char>(text[i]);
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static void append(std::string &target, unsigned value) {
+  target += static_cast<char>(value & 0xFF);
+  target += static_cast<char>((value >> 8) & 0xFF);
+  target += static_cast<char>((value >> 16) & 0xFF);
+  target += static_cast<char>((value >> 24) & 0xFF);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::string HelpIndex::build(const std::string &json) {
+  rapidjson::Document document;
+  document.Parse(json.c_str(), json.size());
+  if (document.HasParseError())
+    throw std::runtime_error("help JSON parse error at offset " + std::to_string(document.GetErrorOffset()));
+
+  // Later duplicates replace earlier ones, as the original help loader did.
+  std::map<std::string, std::string> topics;
+  if (document.IsObject() && document.HasMember("topics") && document["topics"].IsArray()) {
+    for (auto const &topic : document["topics"].GetArray()) {
+      if (!topic.IsObject() || !topic.HasMember("id") || !topic["id"].IsString())
+        throw std::runtime_error("help topic without id");
+
+      rapidjson::StringBuffer buffer;
+      rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+      topic.Accept(writer);
+      topics[base::toupper(topic["id"].GetString())] = std::string(buffer.GetString(), buffer.GetSize());
+    }
+  }
+
+  unsigned bucketCount = 16;
+  while (bucketCount < 2 * topics.size())
+    bucketCount *= 2;
+
+  std::vector<unsigned> buckets(bucketCount, 0);
+  std::string entries;
+  std::string blob;
+  unsigned index = 0;
+  for (auto const &topic : topics) {
+    unsigned bucket = hashTopic(topic.first.c_str(), topic.first.size()) & (bucketCount - 1);
+    while (buckets[bucket] != 0)
+      bucket = (bucket + 1) & (bucketCount - 1);
+    buckets[bucket] = ++index;
+
+    append(entries, static_cast<unsigned>(blob.size()));
+    append(entries, static_cast<unsigned>(topic.first.size()));
+    blob += topic.first;
+
+    append(entries, static_cast<unsigned>(blob.size()));
+    append(entries, static_cast<unsigned>(topic.second.size()));
+    blob += topic.second;
+  }
+
+  std::string result(indexMagic, sizeof(indexMagic));
+  append(result, formatVersion);
+  append(result, static_cast<unsigned>(topics.size()));
+  append(result, bucketCount);
+  for (unsigned bucket : buckets)
+    append(result, bucket);
+
+  return result + entries + blob;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Memory maps the given index file. Returns nullptr if the file cannot be mapped or is not a valid index.
+ */
+std::unique_ptr<HelpIndex> HelpIndex::open(const std::string &path) {
+  GMappedFile *file = g_mapped_file_new(path.c_str(), FALSE, nullptr);
+  if (file == nullptr)
+    return nullptr;
+
+  std::unique_ptr<HelpIndex> index(new HelpIndex());
+  index->_file = file;
+  index->_data = g_mapped_file_get_contents(file);
+  index->_size = g_mapped_file_get_length(file);
+
+  if (!index->validate())
+    return nullptr;
+  return index;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Creates an index from an in-memory copy, e.g. one built on the fly from a JSON file.
+ */
+std::unique_ptr<HelpIndex> HelpIndex::fromData(std::string data) {
+  std::unique_ptr<HelpIndex> index(new HelpIndex());
+  index->_ownedData = std::move(data);
+  index->_data = index->_ownedData.data();
+  index->_size = index->_ownedData.size();
+
+  if (!index->validate())
+    return nullptr;
+  return index;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+HelpIndex::~HelpIndex() {
+  if (_file != nullptr)
+    g_mapped_file_unref(_file);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+size_t HelpIndex::topicCount() const {
+  return _topicCount;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool HelpIndex::contains(const std::string &topic) const {
+  return findTopic(topic) >= 0;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool HelpIndex::topicJson(const std::string &topic, std::string &json) const {
+  long index = findTopic(topic);
+  if (index < 0)
+    return false;
+
+  size_t blobStart = headerSize + 4 * static_cast<size_t>(_bucketCount) + topicEntrySize * _topicCount;
+  size_t entry = headerSize + 4 * static_cast<size_t>(_bucketCount) + topicEntrySize * static_cast<size_t>(index);
+  json.assign(_data + blobStart + read(entry + 8), read(entry + 12));
+  return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Checks the header and makes sure all offsets stay within the data, so lookups need no further range checks.
+ */
+bool HelpIndex::validate() {
+  if (_data == nullptr || _size < headerSize || memcmp(_data, indexMagic, sizeof(indexMagic)) != 0)
+    return false;
+  if (read(4) != formatVersion)
+    return false;
+
+  _topicCount = read(8);
+  _bucketCount = read(12);
+  if (_bucketCount == 0 || (_bucketCount & (_bucketCount - 1)) != 0 || _topicCount >= _bucketCount)
+    return false;
+
+  size_t blobStart = headerSize + 4 * static_cast<size_t>(_bucketCount) + topicEntrySize * _topicCount;
+  if (blobStart > _size)
+    return false;
+
+  size_t blobSize = _size - blobStart;
+  for (unsigned i = 0; i < _bucketCount; ++i) {
+    if (read(headerSize + 4 * i) > _topicCount)
+      return false;
+  }
+
+  size_t entry = headerSize + 4 * static_cast<size_t>(_bucketCount);
+  for (unsigned i = 0; i < _topicCount; ++i, entry += topicEntrySize) {
+    if (static_cast<size_t>(read(entry)) + read(entry + 4) > blobSize)
+      return false;
+    if (static_cast<size_t>(read(entry + 8)) + read(entry + 12) > blobSize)
+      return false;
+  }
+
+  return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Returns the index of the given (upper case) topic or -1 if it doesn't exist.
+ */
+long HelpIndex::findTopic(const std::string &topic) const {
+  if (_topicCount == 0)
+    return -1;
+
+  size_t entries = headerSize + 4 * static_cast<size_t>(_bucketCount);
+  size_t blobStart = entries + topicEntrySize * _topicCount;
+
+  unsigned bucket = hashTopic(topic.c_str(), topic.size()) & (_bucketCount - 1);
+  for (unsigned probe = 0; probe < _bucketCount; ++probe) {
+    unsigned slot = read(headerSize + 4 * static_cast<size_t>(bucket));
+    if (slot == 0)
+      return -1;
+
+    size_t entry = entries + topicEntrySize * (slot - 1);
+    if (read(entry + 4) == topic.size() && memcmp(_data + blobStart + read(entry), topic.c_str(), topic.size()) == 0)
+      return static_cast<long>(slot - 1);
+
+    bucket = (bucket + 1) & (_bucketCount - 1);
+  }
+
+  return -1;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+unsigned HelpIndex::read(size_t offset) const {
+  const unsigned char *p = reinterpret_cast<const unsigned char *>(_data + offset);
+  return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<unsigned>(p[3]) << 24);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
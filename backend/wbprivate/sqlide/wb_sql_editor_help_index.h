@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2020, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#pragma once
+
+#include "workbench/wb_backend_public_interface.h"
+
+#include <memory>
+#include <string>
+
+typedef struct _GMappedFile GMappedFile;
+
+namespace help {
+
+  /**
+   * Compact, read-only lookup structure for the offline help of one server version. It is generated at build time
+   * from the help JSON files (see tools/genhelpindex) and memory mapped on first use, so only the topics actually
+   * looked up are ever decoded.
+   *
+   * Binary layout (all numbers are little endian uint32):
+   *   header:  magic "WBHI", format version, topic count, bucket count (a power of 2)
+   *   buckets: bucket count entries, 0 for an empty bucket or 1 + topic index (open addressing, linear probing)
+   *   topics:  topic count entries of (id offset, id length, data offset, data length), relative to the blob start
+   *   blob:    the upper cased topic ids and the compact JSON text of each topic
+   */
+  class MYSQLWBBACKEND_PUBLIC_FUNC HelpIndex {
+  public:
+    static const unsigned formatVersion = 1;
+
+    ~HelpIndex();
+
+    // Converts the content of a help JSON file into the binary index. Throws std::runtime_error on invalid input.
+    static std::string build(const std::string &json);
+
+    static std::unique_ptr<HelpIndex> open(const std::string &path);
+    static std::unique_ptr<HelpIndex> fromData(std::string data);
+
+    size_t topicCount() const;
+    bool contains(const std::string &topic) const;
+    bool topicJson(const std::string &topic, std::string &json) const;
+
+  private:
+    GMappedFile *_file = nullptr;
+    std::string _ownedData;
+    const char *_data = nullptr;
+    size_t _size = 0;
+
+    unsigned _topicCount = 0;
+    unsigned _bucketCount = 0;
+
+    HelpIndex() = default;
+
+    bool validate();
+    long findTopic(const std::string &topic) const;
+    unsigned read(size_t offset) const;
+  };
+
+} // namespace help
@@ -278,7 +278,7 @@ void SqlEditorTreeController::finish_init() {
   // update the info box
   schema_row_selected();
 
-  tree_refresh();
+  refresh_schema_tree();
 
   // make sure to restore the splitter pos after layout is ready
   bec::GRTManager::get()->run_once_when_idle(
@@ -1181,7 +1181,17 @@ wb::LiveSchemaTree::ObjectType SqlEditorTreeController::fetch_object_type(const
 
 //----------------------------------------------------------------------------------------------------------------------
 
+/**
+ * Explicit refresh requested by the user. Cached completion data cannot be trusted then, so it is read again.
+ */
 void SqlEditorTreeController::tree_refresh() {
+  _owner->discardCompletionCache();
+  refresh_schema_tree();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void SqlEditorTreeController::refresh_schema_tree() {
   if (_owner->connected()) {
     live_schemata_refresh_task->exec(false, std::bind((grt::StringRef(SqlEditorTreeController::*)(SqlEditorForm::Ptr)) &
                                                         SqlEditorTreeController::do_refresh_schema_tree_safe,
@@ -2460,7 +2470,7 @@ void SqlEditorTreeController::handle_grt_notification(const std::string &name, g
   } else if (name == "GRNSQLEditorReconnected") {
     if (sender == _owner->wbsql()->get_grt_editor_object(_owner)) {
       _session_info->set_markup_text(_owner->get_connection_info());
-      tree_refresh();
+      refresh_schema_tree();
     }
   } else if (name == "GNColorsChanged") {
     updateColors();
@@ -166,6 +166,7 @@ public:
   void open_alter_object_editor(db_DatabaseObjectRef object, db_CatalogRef server_state_catalog);
 
 private:
+  void refresh_schema_tree();
   grt::StringRef do_refresh_schema_tree_safe(std::weak_ptr<SqlEditorForm> self_ptr);
 
   int insert_text_to_active_editor(const std::string &str);
@@ -0,0 +1,767 @@
+/*
+ * Copyright (c) 2020, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <libxml/parser.h>
+#include <libxml/tree.h>
+
+#include "wb_autosave_journal.h"
+
+#include "base/file_functions.h"
+#include "base/log.h"
+#include "base/string_utilities.h"
+#include "base/xml_functions.h"
+
+DEFAULT_LOG_DOMAIN("model")
+
+using namespace wb;
+
+// Journals smaller than this are not worth compacting.
+static const size_t MinCompactionSize = 1024 * 1024;
+
+// If the journal is still bigger than this after compaction, the next autosave writes a full snapshot.
+static const size_t MaxCompactedSize = 16 * 1024 * 1024;
+
+typedef std::map<std::string, grt::ObjectRef> ObjectMap;
+
+//----------------- Record storage -----------------------------------------------------------------------------------
+
+/**
+ * Records are stored as "<size>\n<xml>\n". A record cut short (e.g. by a crash while writing it) ends the journal.
+ */
+static std::string frame_record(const std::string &record) {
+  return std::to_string(record.size()) + "\n" + record + "\n";
+}
+
+//--------------------------------------------------------------------------------------------------------------------
+
+static std::vector<std::string> read_records(const std::string &path, size_t limit = std::string::npos) {
+  std::vector<std::string> records;
+
+  gchar *data;
+  gsize length;
+  if (!g_file_get_contents(path.c_str(), &data, &length, NULL))
+    return records;
+
+  std::string content(data, std::min((size_t)length, limit));
+  g_free(data);
+
+  size_t position = 0;
+  while (position < content.size()) {
+    size_t eol = content.find('\n', position);
+    if (eol == std::string::npos)
+      break;
+
+    char *end = NULL;
+    size_t size = (size_t)std::strtoull(content.c_str() + position, &end, 10);
+    if (end != content.c_str() + eol || eol + 1 + size >= content.size() || content[eol + 1 + size] != '\n') {
+      logWarning("Autosave journal %s ends with an incomplete record\n", path.c_str());
+      break;
+    }
+
+    records.push_back(content.substr(eol + 1, size));
+    position = eol + size + 2;
+  }
+
+  return records;
+}
+
+//--------------------------------------------------------------------------------------------------------------------
+
+static bool append_to_file(const std::string &path, const std::string &data, const char *mode = "ab") {
+  FILE *file = base_fopen(path.c_str(), mode);
+  if (file == NULL)
+    return false;
+
+  bool success = fwrite(data.data(), 1, data.size(), file) == data.size() && fflush(file) == 0;
+  return fclose(file) == 0 && success;
+}
+
+//--------------------------------------------------------------------------------------------------------------------
+
+static bool is_record_for(xmlDocPtr record, const std::string &snapshot_id) {
+  return base::xml::getProp(xmlDocGetRootElement(record), "snapshot") == snapshot_id;
+}
+
+//--------------------------------------------------------------------------------------------------------------------
+
+static std::string dump_record(xmlDocPtr doc) {
+  xmlChar *buffer = NULL;
+  int size = 0;
+  xmlDocDumpMemory(doc, &buffer, &size);
+
+  std::string result((const char *)buffer, size);
+  xmlFree(buffer);
+
+  return result;
+}
+
+//--------------------------------------------------------------------------------------------------------------------
+
+static xmlNodePtr add_change(xmlNodePtr record, const char *kind, const grt::ObjectRef &object,
+                             const std::string &member, const std::string &content) {
+  xmlNodePtr node = xmlNewTextChild(record, NULL, (xmlChar *)kind, (xmlChar *)content.c_str());
+  xmlNewProp(node, (xmlChar *)"object", (xmlChar *)object->id().c_str());
+  xmlNewProp(node, (xmlChar *)"member", (xmlChar *)member.c_str());
+
+  return node;
+}
+
+//--------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Returns the name of the member of owner which holds the given list or dict.
+ */
+static std::string member_holding(const grt::ObjectRef &owner, const grt::ValueRef &container) {
+  std::string name;
+  owner->get_metaclass()->foreach_member([&](const grt::MetaClass::Member *member) {
+    if (member->type.base.type == container.type() && !member->calculated &&
+        owner->get_member(member->name).valueptr() == container.valueptr()) {
+      name = member->name;
+      return false;
+    }
+    return true;
+  });
+
+  return name;
+}
+
+//----------------- AutosaveJournal ----------------------------------------------------------------------------------
+
+AutosaveJournal::AutosaveJournal(const std::string &path, const std::string &snapshot_id)
+  : _path(path),
+    _snapshot_id(snapshot_id),
+    _size(0),
+    _compact_size(MinCompactionSize),
+    _compacted_size(0),
+    _compacting(false),
+    _failed(false) {
+  // Finish a compaction interrupted between removing the old journal and renaming the new one.
+  std::string tmp_path = _path + ".tmp";
+  if (!g_file_test(_path.c_str(), G_FILE_TEST_EXISTS) && g_file_test(tmp_path.c_str(), G_FILE_TEST_EXISTS))
+    base_rename(tmp_path.c_str(), _path.c_str());
+
+  _size = (size_t)std::max(0L, base_get_file_size(_path.c_str()));
+  _compact_size = std::max(MinCompactionSize, 2 * _size);
+}
+
+//--------------------------------------------------------------------------------------------------------------------
+
+AutosaveJournal::~AutosaveJournal() {
+  _undo_connection.disconnect();
+  wait_for_compaction();
+}
+
+//--------------------------------------------------------------------------------------------------------------------
+
+void AutosaveJournal::track_changes(grt::UndoManager *undo_manager) {
+  _undo_connection = undo_manager->signal_action_added()->connect(
+    std::bind(&AutosaveJournal::action_added, this, std::placeholders::_1));
+}
+
+//--------------------------------------------------------------------------------------------------------------------
+
+bool AutosaveJournal::has_changes() const {
+  return !_changed_members.empty() || !_changed_lists.empty() || !_changed_dicts.empty();
+}
+
+//--------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Called for each action recorded by the undo manager, before the change is applied. Only remembers what changed,
+ * the values are taken when the next record is written.
+ */
+void AutosaveJournal::action_added(grt::UndoAction *action) {
+  if (grt::UndoObjectChangeAction *change = dynamic_cast<grt::UndoObjectChangeAction *>(action)) {
+    auto &entry = _changed_members[change->get_object().valueptr()];
+    entry.first = change->get_object();
+    entry.second.insert(change->get_member());
+  } else if (grt::UndoListInsertAction *insert = dynamic_cast<grt::UndoListInsertAction *>(action))
+    list_changed(insert->get_list());
+  else if (grt::UndoListRemoveAction *remove = dynamic_cast<grt::UndoListRemoveAction *>(action))
+    list_changed(remove->get_list());
+  else if (grt::UndoListSetAction *set = dynamic_cast<grt::UndoListSetAction *>(action))
+    list_changed(set->get_list());
+  else if (grt::UndoListReorderAction *reorder = dynamic_cast<grt::UndoListReorderAction *>(action))
+    list_changed(reorder->get_list());
+  else if (grt::UndoDictSetAction *dict_set = dynamic_cast<grt::UndoDictSetAction *>(action))
+    _changed_dicts[dict_set->get_dict().valueptr()] = dict_set->get_dict();
+  else if (grt::UndoDictRemoveAction *dict_remove = dynamic_cast<grt::UndoDictRemoveAction *>(action))
+    _changed_dicts[dict_remove->get_dict().valueptr()] = dict_remove->get_dict();
+}
+
+//--------------------------------------------------------------------------------------------------------------------
+
+void AutosaveJournal::list_changed(const grt::BaseListRef &list) {
+  auto iter = _changed_lists.find(list.valueptr());
+  if (iter != _changed_lists.end())
+    return;
+
+  // The list is still unchanged, so we can remember which objects it had before. Objects which appear
+  // later in owned lists are new and will be stored completely.
+  ChangedList &entry = _changed_lists[list.valueptr()];
+  entry.list = list;
+  if (list.content_type() == grt::ObjectType) {
+    for (const grt::ValueRef &item : list) {
+      if (item.is_valid())
+        entry.initial_ids.insert(grt::ObjectRef::cast_from(item)->id());
+    }
+  }
+}
+
+//--------------------------------------------------------------------------------------------------------------------
+
+std::string AutosaveJournal::create_record() {
+  xmlDocPtr doc = xmlNewDoc((xmlChar *)"1.0");
+  xmlNodePtr record = xmlNewDocNode(doc, NULL, (xmlChar *)"record", NULL);
+  xmlDocSetRootElement(doc, record);
+  xmlNewProp(record, (xmlChar *)"snapshot", (xmlChar *)_snapshot_id.c_str());
+
+  grt::BaseListRef new_objects(grt::ObjectType);
+  std::set<std::string> new_ids;
+  auto add_new_object = [&](const grt::ValueRef &value) {
+    if (value.is_valid() && new_ids.insert(grt::ObjectRef::cast_from(value)->id()).second)
+      new_objects.ginsert_unchecked(value);
+  };
+
+  auto add_list = [&](const grt::ObjectRef &owner, const std::string &member, const grt::BaseListRef &list,
+                      const std::set<std::string> *initial_ids) {
+    if (list.content_type() != grt::ObjectType) {
+      xmlNodePtr node = add_change(record, "set", owner, member, grt::GRT::get()->serialize_xml_data(list));
+      xmlNewProp(node, (xmlChar *)"type", (xmlChar *)"value");
+      return;
+    }
+
+    const grt::MetaClass::Member *info = owner->get_metaclass()->get_member_info(member);
+    bool owned = info != NULL && info->owned_object;
+
+    std::string ids;
+    for (const grt::ValueRef &item : list) {
+      if (!item.is_valid())
+        continue;
+      const std::string &id = grt::ObjectRef::cast_from(item)->id();
+      if (owned && (initial_ids == NULL || initial_ids->find(id) == initial_ids->end()))
+        add_new_object(item);
+      if (!ids.empty())
+        ids.push_back(' ');
+      ids.append(id);
+    }
+    add_change(record, "list", owner, member, ids);
+  };
+
+  for (auto &iter : _changed_members) {
+    const grt::ObjectRef &object = iter.second.first;
+    for (const std::string &member : iter.second.second) {
+      const grt::MetaClass::Member *info = object->get_metaclass()->get_member_info(member);
+      if (info == NULL || info->calculated)
+        continue;
+
+      grt::ValueRef value = object->get_member(member);
+      std::string type;
+      std::string content;
+      switch (value.type()) {
+        case grt::IntegerType:
+          type = "int";
+          content = std::to_string(*grt::IntegerRef::cast_from(value));
+          break;
+        case grt::DoubleType:
+          type = "real";
+          content = base::to_string(*grt::DoubleRef::cast_from(value));
+          break;
+        case grt::StringType:
+          type = "string";
+          content = *grt::StringRef::cast_from(value);
+          break;
+        case grt::ObjectType:
+          type = "object";
+          content = grt::ObjectRef::cast_from(value)->id();
+          if (info->owned_object)
+            add_new_object(value);
+          break;
+        case grt::ListType:
+          add_list(object, member, grt::BaseListRef::cast_from(value), NULL);
+          continue;
+        case grt::DictType:
+          type = "value";
+          content = grt::GRT::get()->serialize_xml_data(value);
+          break;
+        default:
+          type = "null";
+          break;
+      }
+      xmlNewProp(add_change(record, "set", object, member, content), (xmlChar *)"type", (xmlChar *)type.c_str());
+    }
+  }
+
+  for (auto &iter : _changed_lists) {
+    grt::internal::OwnedList *list = dynamic_cast<grt::internal::OwnedList *>(iter.second.list.valueptr());
+    if (list == NULL || list->owner_of_owned_list() == NULL) {
+      logDebug2("Skipping change of a list not stored in an object\n");
+      continue;
+    }
+
+    grt::ObjectRef owner(list->owner_of_owned_list());
+    std::string member = member_holding(owner, iter.second.list);
+    if (!member.empty())
+      add_list(owner, member, iter.second.list, &iter.second.initial_ids);
+  }
+
+  for (auto &iter : _changed_dicts) {
+    grt::internal::OwnedDict *dict = dynamic_cast<grt::internal::OwnedDict *>(iter.second.valueptr());
+    if (dict == NULL || dict->owner_of_owned_dict() == NULL) {
+      logDebug2("Skipping change of a dict not stored in an object\n");
+      continue;
+    }
+
+    grt::ObjectRef owner(dict->owner_of_owned_dict());
+    std::string member = member_holding(owner, iter.second);
+    if (!member.empty()) {
+      xmlNodePtr node = add_change(record, "set", owner, member, grt::GRT::get()->serialize_xml_data(iter.second));
+      xmlNewProp(node, (xmlChar *)"type", (xmlChar *)"value");
+    }
+  }
+
+  // New objects must be created before anything can refer to them.
+  if (new_objects.count() > 0) {
+    xmlNodePtr node = xmlNewDocRawNode(doc, NULL, (xmlChar *)"objects", NULL);
+    xmlNodeAddContent(node, (xmlChar *)grt::GRT::get()->serialize_xml_data(new_objects).c_str());
+    if (record->children != NULL)
+      xmlAddPrevSibling(record->children, node);
+    else
+      xmlAddChild(record, node);
+  }
+
+  _changed_members.clear();
+  _changed_lists.clear();
+  _changed_dicts.clear();
+
+  std::string result = dump_record(doc);
+  xmlFreeDoc(doc);
+
+  return result;
+}
+
+//--------------------------------------------------------------------------------------------------------------------
+
+bool AutosaveJournal::append() {
+  if (!has_changes())
+    return true;
+
+  std::string record;
+  try {
+    record = frame_record(create_record());
+  } catch (std::exception &exc) {
+    logError("Could not create autosave journal record: %s\n", exc.what());
+    _failed = true;
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(_file_mutex);
+  if (!append_to_file(_path, record)) {
+    logError("Could not write to autosave journal %s: %s\n", _path.c_str(), g_strerror(errno));
+    _failed = true;
+    return false;
+  }
+
+  _size += record.size();
+  if (_size >= _compact_size && !_compacting) {
+    if (_compactor.joinable())
+      _compactor.join();
+
+    _compacting = true;
+    _compactor = std::thread(&AutosaveJournal::compact, this, _size);
+  }
+
+  return true;
+}
+
+//--------------------------------------------------------------------------------------------------------------------
+
+bool AutosaveJournal::needs_snapshot() const {
+  std::lock_guard<std::mutex> lock(_file_mutex);
+  return _failed || _compacted_size > MaxCompactedSize;
+}
+
+//--------------------------------------------------------------------------------------------------------------------
+
+void AutosaveJournal::reset(const std::string &snapshot_id) {
+  wait_for_compaction();
+
+  _snapshot_id = snapshot_id;
+  _changed_members.clear();
+  _changed_lists.clear();
+  _changed_dicts.clear();
+
+  std::lock_guard<std::mutex> lock(_file_mutex);
+  base_remove(_path);
+  base_remove(_path + ".tmp");
+  _size = 0;
+  _compact_size = MinCompactionSize;
+  _compacted_size = 0;
+  _failed = false;
+}
+
+//--------------------------------------------------------------------------------------------------------------------
+
+void AutosaveJournal::wait_for_compaction() {
+  if (_compactor.joinable())
+    _compactor.join();
+}
+
+//--------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Runs in a background thread and merges the first size bytes of the journal into a single record, which keeps all
+ * stored objects but only the last state written for each member. Records appended in the meantime are copied
+ * over unchanged.
+ */
+void AutosaveJournal::compact(size_t size) {
+  std::vector<std::string> records = read_records(_path, size);
+
+  xmlDocPtr merged = xmlNewDoc((xmlChar *)"1.0");
+  xmlNodePtr root = xmlNewDocNode(merged, NULL, (xmlChar *)"record", NULL);
+  xmlDocSetRootElement(merged, root);
+  xmlNewProp(root, (xmlChar *)"snapshot", (xmlChar *)_snapshot_id.c_str());
+
+  // Member changes by (object id, member), in the order they were last written.
+  std::map<std::pair<std::string, std::string>, std::pair<size_t, xmlNodePtr>> changes;
+  size_t sequence = 0;
+
+  for (const std::string &data : records) {
+    xmlDocPtr doc = xmlReadMemory(data.data(), (int)data.size(), NULL, NULL, XML_PARSE_HUGE);
+    if (doc == NULL)
+      break;
+    if (xmlDocGetRootElement(doc) == NULL) {
+      xmlFreeDoc(doc);
+      break;
+    }
+    if (!is_record_for(doc, _snapshot_id)) {
+      // Left over from an older snapshot, drop it.
+      xmlFreeDoc(doc);
+      continue;
+    }
+
+    for (xmlNodePtr node = xmlDocGetRootElement(doc)->children; node != NULL; node = node->next) {
+      if (node->type != XML_ELEMENT_NODE)
+        continue;
+
+      xmlNodePtr copy = xmlDocCopyNode(node, merged, 1);
+      if (base::xml::nameIs(node, "objects")) {
+        xmlAddChild(root, copy);
+        continue;
+      }
+
+      auto &entry = changes[std::make_pair(base::xml::getProp(node, "object"), base::xml::getProp(node, "member"))];
+      if (entry.second != NULL)
+        xmlFreeNode(entry.second);
+      entry = std::make_pair(sequence++, copy);
+    }
+    xmlFreeDoc(doc);
+  }
+
+  std::vector<std::pair<size_t, xmlNodePtr>> ordered;
+  for (auto &iter : changes)
+    ordered.push_back(iter.second);
+  std::sort(ordered.begin(), ordered.end());
+  for (auto &iter : ordered)
+    xmlAddChild(root, iter.second);
+
+  std::string record = frame_record(dump_record(merged));
+  xmlFreeDoc(merged);
+
+  std::string tmp_path = _path + ".tmp";
+  bool success = append_to_file(tmp_path, record, "wb");
+
+  std::lock_guard<std::mutex> lock(_file_mutex);
+  if (success && _size > size) {
+    // Copy what was appended while we were busy.
+    std::string tail;
+    FILE *file = base_fopen(_path.c_str(), "rb");
+    if (file != NULL) {
+      tail.resize(_size - size);
+      success = fseek(file, (long)size, SEEK_SET) == 0 && fread(&tail[0], 1, tail.size(), file) == tail.size();
+      fclose(file);
+    } else
+      success = false;
+    success = success && append_to_file(tmp_path, tail);
+  }
+
+  // The old journal is only removed once the new one is complete. If we crash in between, replay() picks up the
+  // temporary file.
+  if (success && base_remove(_path) == 0 && base_rename(tmp_path.c_str(), _path.c_str()) == 0) {
+    logDebug("Compacted autosave journal from %zu to %zu bytes\n", _size, record.size() + (_size - size));
+    _size = record.size() + (_size - size);
+    _compacted_size = record.size();
+  } else {
+    logWarning("Could not compact autosave journal %s\n", _path.c_str());
+    base_remove(tmp_path);
+  }
+
+  _compact_size = std::max(MinCompactionSize, 2 * _size);
+  _compacting = false;
+}
+
+//----------------- Replay -------------------------------------------------------------------------------------------
+
+/**
+ * Adds the object and everything it owns to the map, unless it's already there (in which case the existing object
+ * is used, which makes replaying a record more than once harmless).
+ */
+static void register_objects(const grt::ObjectRef &object, ObjectMap &objects) {
+  if (!objects.insert(std::make_pair(object->id(), object)).second)
+    return;
+
+  object->get_metaclass()->foreach_member([&](const grt::MetaClass::Member *member) {
+    if (!member->owned_object || member->calculated || member->name == "owner")
+      return true;
+
+    grt::ValueRef value = object->get_member(member->name);
+    switch (value.type()) {
+      case grt::ObjectType:
+        register_objects(grt::ObjectRef::cast_from(value), objects);
+        break;
+      case grt::ListType:
+        for (const grt::ValueRef &item : grt::BaseListRef::cast_from(value)) {
+          if (item.type() == grt::ObjectType)
+            register_objects(grt::ObjectRef::cast_from(item), objects);
+        }
+        break;
+      case grt::DictType:
+        for (const auto &item : grt::DictRef::cast_from(value)) {
+          if (item.second.type() == grt::ObjectType)
+            register_objects(grt::ObjectRef::cast_from(item.second), objects);
+        }
+        break;
+      default:
+        break;
+    }
+    return true;
+  });
+}
+
+//--------------------------------------------------------------------------------------------------------------------
+
+static grt::ObjectRef resolve_object(const ObjectMap &objects, const std::string &id) {
+  ObjectMap::const_iterator iter = objects.find(id);
+  if (iter != objects.end())
+    return iter->second;
+
+  // Objects not in the document, like the simple datatypes of the rdbms.
+  return grt::GRT::get()->find_object_by_id(id, "/");
+}
+
+//--------------------------------------------------------------------------------------------------------------------
+
+static void apply_list(const grt::ObjectRef &object, const std::string &member, const std::string &content,
+                       const ObjectMap &objects) {
+  grt::ValueRef value = object->get_member(member);
+  if (value.type() != grt::ListType)
+    return;
+  grt::BaseListRef list(grt::BaseListRef::cast_from(value));
+  const grt::MetaClass::Member *info = object->get_metaclass()->get_member_info(member);
+  bool owned = info != NULL && info->owned_object;
+
+  std::vector<grt::ObjectRef> target;
+  std::set<grt::internal::Value *> wanted;
+  for (const std::string &id : base::split(content, " ")) {
+    if (id.empty())
+      continue;
+    grt::ObjectRef item = resolve_object(objects, id);
+    if (item.is_valid()) {
+      target.push_back(item);
+      wanted.insert(item.valueptr());
+    } else
+      logWarning("Autosave journal refers to unknown object %s in %s.%s\n", id.c_str(), object->id().c_str(),
+                 member.c_str());
+  }
+
+  // Change only what differs, to not disturb owned lists unnecessarily.
+  for (size_t i = list.count(); i-- > 0;) {
+    if (wanted.find(list[i].valueptr()) == wanted.end())
+      list.remove(i);
+  }
+  for (size_t i = 0; i < target.size(); ++i) {
+    if (i < list.count() && list[i].valueptr() == target[i].valueptr())
+      continue;
+
+    size_t index = list.get_index(target[i]);
+    if (index != grt::BaseListRef::npos)
+      list.reorder(index, i);
+    else {
+      list.ginsert(target[i], i);
+
+      // The owner of a new object can only be resolved in the GRT tree, which may not have the owner yet.
+      if (owned && GrtObjectRef::can_wrap(target[i]))
+        GrtObjectRef::cast_from(target[i])->owner(GrtObjectRef::cast_from(object));
+    }
+  }
+}
+
+//--------------------------------------------------------------------------------------------------------------------
+
+static void apply_set(const grt::ObjectRef &object, const std::string &member, xmlNodePtr node,
+                      const ObjectMap &objects) {
+  std::string type = base::xml::getProp(node, "type");
+  std::string content = base::xml::getContent(node);
+
+  grt::ValueRef value;
+  if (type == "int")
+    value = grt::IntegerRef((grt::internal::Integer::storage_type)std::strtoll(content.c_str(), NULL, 10));
+  else if (type == "real")
+    value = grt::DoubleRef(base::atof<double>(content, 0.0));
+  else if (type == "string")
+    value = grt::StringRef(content);
+  else if (type == "object") {
+    value = resolve_object(objects, content);
+    if (!value.is_valid()) {
+      logWarning("Autosave journal refers to unknown object %s in %s.%s\n", content.c_str(), object->id().c_str(),
+                 member.c_str());
+      return;
+    }
+  } else if (type == "value") {
+    value = grt::GRT::get()->unserialize_xml_data(content);
+
+    // Lists and dicts of an object are usually fixed, so their content is replaced instead.
+    grt::ValueRef current = object->get_member(member);
+    if (current.type() == grt::ListType && value.type() == grt::ListType) {
+      grt::BaseListRef list(grt::BaseListRef::cast_from(current));
+      list.remove_all();
+      for (const grt::ValueRef &item : grt::BaseListRef::cast_from(value))
+        list.ginsert(item);
+      return;
+    }
+    if (current.type() == grt::DictType && value.type() == grt::DictType) {
+      grt::DictRef dict(grt::DictRef::cast_from(current));
+      dict.reset_entries();
+      for (const auto &item : grt::DictRef::cast_from(value))
+        dict.set(item.first, item.second);
+      return;
+    }
+  }
+
+  object->get_metaclass()->set_member_internal((grt::internal::Object *)object.valueptr(), member, value, true);
+}
+
+//--------------------------------------------------------------------------------------------------------------------
+
+bool AutosaveJournal::exists(const std::string &path) {
+  return g_file_test(path.c_str(), G_FILE_TEST_EXISTS) || g_file_test((path + ".tmp").c_str(), G_FILE_TEST_EXISTS);
+}
+
+//--------------------------------------------------------------------------------------------------------------------
+
+std::string AutosaveJournal::snapshot_id(const std::string &snapshot_path) {
+  gchar *data;
+  gsize length;
+  if (!g_file_get_contents(snapshot_path.c_str(), &data, &length, NULL))
+    return "";
+
+  gchar *checksum = g_compute_checksum_for_data(G_CHECKSUM_SHA1, (const guchar *)data, length);
+  std::string result(checksum);
+  g_free(checksum);
+  g_free(data);
+
+  return result;
+}
+
+//--------------------------------------------------------------------------------------------------------------------
+
+size_t AutosaveJournal::replay(const std::string &path, const workbench_DocumentRef &doc,
+                               const std::string &snapshot_id) {
+  std::string journal = path;
+  if (!g_file_test(journal.c_str(), G_FILE_TEST_EXISTS))
+    journal += ".tmp"; // A compaction was interrupted after the old journal was removed.
+
+  std::vector<std::string> records = read_records(journal);
+  if (records.empty())
+    return 0;
+
+  ObjectMap objects;
+  register_objects(doc, objects);
+
+  grt::UndoManager *undo_manager = grt::GRT::get()->get_undo_manager();
+  undo_manager->disable();
+
+  size_t applied = 0;
+  size_t stale = 0;
+  for (const std::string &data : records) {
+    xmlDocPtr record = xmlReadMemory(data.data(), (int)data.size(), NULL, NULL, XML_PARSE_HUGE);
+    if (record == NULL || xmlDocGetRootElement(record) == NULL) {
+      if (record != NULL)
+        xmlFreeDoc(record);
+      logError("Invalid record in autosave journal %s, ignoring the rest\n", journal.c_str());
+      break;
+    }
+
+    // Records written before the current snapshot are already part of it (or of something newer).
+    if (!is_record_for(record, snapshot_id)) {
+      xmlFreeDoc(record);
+      ++stale;
+      continue;
+    }
+
+    try {
+      for (xmlNodePtr node = xmlDocGetRootElement(record)->children; node != NULL; node = node->next) {
+        if (node->type != XML_ELEMENT_NODE)
+          continue;
+
+        if (base::xml::nameIs(node, "objects")) {
+          grt::ValueRef value = grt::GRT::get()->unserialize_xml_data(base::xml::getContent(node));
+          if (value.type() == grt::ListType) {
+            for (const grt::ValueRef &item : grt::BaseListRef::cast_from(value)) {
+              if (item.type() == grt::ObjectType)
+                register_objects(grt::ObjectRef::cast_from(item), objects);
+            }
+          }
+          continue;
+        }
+
+        std::string member = base::xml::getProp(node, "member");
+        ObjectMap::const_iterator object = objects.find(base::xml::getProp(node, "object"));
+        if (object == objects.end() || !object->second->has_member(member))
+          continue; // Not part of the document (e.g. an option).
+
+        if (base::xml::nameIs(node, "list"))
+          apply_list(object->second, member, base::xml::getContent(node), objects);
+        else
+          apply_set(object->second, member, node, objects);
+      }
+      ++applied;
+    } catch (std::exception &exc) {
+      logError("Error replaying autosave journal record: %s\n", exc.what());
+    }
+    xmlFreeDoc(record);
+  }
+
+  undo_manager->enable();
+  if (stale > 0)
+    logWarning("Ignored %zu records of an older snapshot in autosave journal %s\n", stale, journal.c_str());
+  logInfo("Replayed %zu records from autosave journal %s\n", applied, journal.c_str());
+
+  return applied;
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2020, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#pragma once
+
+#include "wb_backend_public_interface.h"
+
+#include "grt.h"
+#include "grtpp_undo_manager.h"
+#include "grts/structs.workbench.h"
+
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+
+namespace wb {
+
+  /**
+   * Append-only journal of the changes made to a model document since its last full snapshot (the saved
+   * document or the autosave document in the expanded document folder).
+   *
+   * Objects, lists and dicts are collected from the actions recorded by the undo manager. On each autosave
+   * only their current state is written, so the cost depends on the edit and not on the size of the model.
+   * Objects added to owned lists are stored completely, everything else is stored by object id.
+   * Records describe state and not operations, so replaying a record twice gives the same result. The journal
+   * is compacted in a background thread when it gets too big, by dropping records overwritten by later ones.
+   *
+   * Each record carries the id of the snapshot it applies to (see snapshot_id()). Records of another snapshot are
+   * ignored, so a crash between writing a new snapshot and resetting the journal doesn't replay stale records.
+   */
+  class MYSQLWBBACKEND_PUBLIC_FUNC AutosaveJournal {
+  public:
+    AutosaveJournal(const std::string &path, const std::string &snapshot_id);
+    ~AutosaveJournal();
+
+    void track_changes(grt::UndoManager *undo_manager);
+    bool has_changes() const;
+
+    // Writes the state of everything changed since the last call. Returns false if that failed.
+    bool append();
+
+    // True if recovering from the journal would take longer than loading a full snapshot.
+    bool needs_snapshot() const;
+
+    // Discards the journal file and all collected changes (after a full snapshot has been written). New records
+    // apply to the snapshot with the given id.
+    void reset(const std::string &snapshot_id);
+
+    static bool exists(const std::string &path);
+
+    // Identifies the content of a snapshot file (a checksum). Empty if there is no such file.
+    static std::string snapshot_id(const std::string &snapshot_path);
+
+    // Applies all records of the journal made for the given snapshot to the document, which must already be part of
+    // the GRT tree (links to objects outside of it are resolved there). Returns the number of records applied.
+    static size_t replay(const std::string &path, const workbench_DocumentRef &doc, const std::string &snapshot_id);
+
+  private:
+    struct ChangedList {
+      grt::BaseListRef list;
+      std::set<std::string> initial_ids; // ids of the objects in the list before it was first changed
+    };
+
+    std::string _path;
+    std::string _snapshot_id;
+    boost::signals2::scoped_connection _undo_connection;
+
+    std::map<grt::internal::Value *, std::pair<grt::ObjectRef, std::set<std::string>>> _changed_members;
+    std::map<grt::internal::Value *, ChangedList> _changed_lists;
+    std::map<grt::internal::Value *, grt::DictRef> _changed_dicts;
+
+    mutable std::mutex _file_mutex; // guards the journal file and the sizes against the compaction thread
+    std::thread _compactor;
+    size_t _size;
+    size_t _compact_size; // size at which the next compaction starts
+    size_t _compacted_size;
+    bool _compacting;
+    bool _failed;
+
+    void action_added(grt::UndoAction *action);
+    void list_changed(const grt::BaseListRef &list);
+
+    std::string create_record();
+    void compact(size_t size);
+    void wait_for_compaction();
+  };
+
+} // namespace wb
@@ -64,6 +64,7 @@
 
 #include "base/threaded_timer.h"
 #include "base/log.h"
+#include "base/profiling.h"
 #include "base/drawing.h"
 
 #include "mforms/mforms.h"
@@ -99,6 +100,9 @@ DEFAULT_LOG_DOMAIN(DOMAIN_WB_CONTEXT)
 
 #define DEFAULT_UNDO_STACK_SIZE 10
 
+// approximate memory (in MB) the model undo history may use before old entries are dropped, 0 disables the limit
+#define DEFAULT_UNDO_MEMORY_LIMIT 256
+
 // auto-save every 1 minute (default)
 #define AUTO_SAVE_MODEL_INTERVAL (60)
 
@@ -335,6 +339,17 @@ WBOptions::WBOptions(const std::string &appBinaryName)
                                                   },
                                                   "<level>"));
 
+  programOptions->addEntry(dataTypes::OptionEntry(dataTypes::OptionArgumentType::OptionArgumentText, "trace-file",
+                                                  "Record a Chrome trace (chrome://tracing, Perfetto) into the given file",
+                                                  [](const dataTypes::OptionEntry &entry, int *retval) {
+                                                    if (!entry.value.textValue.empty()) {
+                                                      base::Tracer::start(entry.value.textValue);
+                                                      base::Tracer::set_thread_name("main");
+                                                    }
+                                                    return true;
+                                                  },
+                                                  "<file>"));
+
   programOptions->addEntry(dataTypes::OptionEntry(dataTypes::OptionArgumentType::OptionArgumentLogical, 'v', "verbose",
                                                   "Enable diagnostics output",
                                                   [this](const dataTypes::OptionEntry &entry, int *retval) {
@@ -410,6 +425,14 @@ void WBOptions::analyzeCommandLineArguments() {
     base::Logger::setLogLevelSpecifiedByUser();
   }
 
+  if (!base::Tracer::is_enabled()) {
+    const char *trace_file = getenv("WB_TRACE_FILE");
+    if (trace_file != nullptr && *trace_file != '\0') {
+      base::Tracer::start(trace_file);
+      base::Tracer::set_thread_name("main");
+    }
+  }
+
   // Get last path and use it
   if (!programOptions->pathArgs.empty())
     open_at_startup = programOptions->pathArgs.back();
@@ -426,7 +449,7 @@ WBContext::WBContext(bool verbose) : _frontendCallbacks(nullptr) {
   _model_context = nullptr;
   _sqlide_context = new WBContextSQLIDE();
   _file = nullptr;
-  _save_point = nullptr;
+  _save_point = 0;
   _tunnel_manager = nullptr;
   _model_import_file = nullptr;
 
@@ -597,6 +620,9 @@ void WBContext::finalize() {
   bec::GRTManager::get()->set_status_slot(std::function<void(std::string)>{});
   _plugin_manager->set_gui_plugin_callbacks(PluginManagerImpl::OpenGUIPluginSlot{},
     PluginManagerImpl::ShowGUIPluginSlot{}, PluginManagerImpl::CloseGUIPluginSlot{});
+
+  // Writes the recorded trace, if --trace-file or WB_TRACE_FILE was given.
+  base::Tracer::stop();
 }
 
 void WBContext::block_user_interaction(bool flag) {
@@ -1387,7 +1413,9 @@ void WBContext::set_default_options(grt::DictRef options) {
   set_default(options, "workbench:ForceSWRendering", 0);
   set_default(options, "workbench:OSSHideMissing", 0);
   set_default(options, "workbench:UndoEntries", DEFAULT_UNDO_STACK_SIZE);
+  set_default(options, "workbench:UndoMemoryLimit", DEFAULT_UNDO_MEMORY_LIMIT);
   set_default(options, "workbench:AutoSaveModelInterval", AUTO_SAVE_MODEL_INTERVAL);
+  set_default(options, "workbench:ContinuousModelValidation", 0);
   set_default(options, "workbench:AutoSaveSQLEditorInterval", AUTO_SAVE_SQLEDITOR_INTERVAL);
   set_default(options, "workbench.AutoReopenLastModel", 0);
   set_default(options, "workbench:SaveSQLWorkspaceOnClose", 1);
@@ -1945,6 +1973,10 @@ void WBContext::option_dict_changed(grt::internal::OwnedDict *options, bool, con
       undo_size = 1;
 
     grt::GRT::get()->get_undo_manager()->set_undo_limit(undo_size);
+
+    ssize_t undo_memory = get_wb_options().get_int("workbench:UndoMemoryLimit", DEFAULT_UNDO_MEMORY_LIMIT);
+    grt::GRT::get()->get_undo_manager()->set_undo_memory_limit(undo_memory > 0 ? (size_t)undo_memory * 1024 * 1024
+                                                                                : 0);
   }
 }
 
@@ -2110,6 +2142,7 @@ void WBContext::new_document() {
                    std::bind(&WBContext::request_refresh, this, RefreshDocument, "", static_cast<NativeHandle>(0)));
 
     _file->create();
+    _file->open_autosave_journal(doc);
     bec::GRTManager::get()->set_db_file_path(_file->get_db_file_path());
 
     _filename = "";
@@ -2120,7 +2153,7 @@ void WBContext::new_document() {
 
     reset_document();
 
-    _save_point = grt::GRT::get()->get_undo_manager()->get_latest_undo_action();
+    _save_point = grt::GRT::get()->get_undo_manager()->get_latest_undo_serial();
     request_refresh(RefreshDocument, "");
 
     bec::GRTManager::get()->run_once_when_idle(std::bind(_frontendCallbacks->perform_command, "reset_layout"));
@@ -2393,6 +2426,9 @@ bool WBContext::open_document(const std::string &file) {
   // mark the document as a global object, so that child objects have changes tracked for undo
   doc->mark_global();
 
+  // apply the changes auto-saved in a previous session, if the document is being recovered
+  _file->open_autosave_journal(doc);
+
   // check if paperType is properly set (if its null it could be a custom type
   // not available locally)
   if (!doc->pageSettings()->paperType().is_valid()) {
@@ -2407,7 +2443,7 @@ bool WBContext::open_document(const std::string &file) {
   _model_context->model_loaded(_file, doc);
 
   _filename = file;
-  _save_point = grt::GRT::get()->get_undo_manager()->get_latest_undo_action();
+  _save_point = grt::GRT::get()->get_undo_manager()->get_latest_undo_serial();
 
   wb->docPath(_filename);
 
@@ -2502,7 +2538,7 @@ void WBContext::do_close_document(bool destroying) {
   // reset undo manager before destroying views to make sure that old refs to
   // figures will be released and bridges will be deleted 1st
   grt::GRT::get()->get_undo_manager()->reset();
-  _save_point = grt::GRT::get()->get_undo_manager()->get_latest_undo_action();
+  _save_point = grt::GRT::get()->get_undo_manager()->get_latest_undo_serial();
 
   FOREACH_COMPONENT(_components, iter)
   (*iter)->close_document();
@@ -2537,7 +2573,7 @@ void WBContext::close_document_finish() {
 
   // reset once again just to be sure
   grt::GRT::get()->get_undo_manager()->reset();
-  _save_point = grt::GRT::get()->get_undo_manager()->get_latest_undo_action();
+  _save_point = grt::GRT::get()->get_undo_manager()->get_latest_undo_serial();
 }
 
 //--------------------------------------------------------------------------------
@@ -2593,7 +2629,7 @@ grt::ValueRef WBContext::save_grt() {
   bec::GRTManager::get()->has_unsaved_changes(false);
   _attachments_changed = false;
 
-  _save_point = grt::GRT::get()->get_undo_manager()->get_latest_undo_action();
+  _save_point = grt::GRT::get()->get_undo_manager()->get_latest_undo_serial();
   request_refresh(RefreshDocument, "");
 
   return grt::IntegerRef(1);
@@ -2662,7 +2698,7 @@ bool WBContext::has_unsaved_changes() {
   if (bec::GRTManager::get()->has_unsaved_changes())
     return true;
 
-  if (grt::GRT::get()->get_undo_manager()->get_latest_closed_undo_action() != _save_point)
+  if (grt::GRT::get()->get_undo_manager()->get_latest_closed_undo_serial() != _save_point)
     return true;
 
   if (_file && _file->has_unsaved_changes())
@@ -401,8 +401,8 @@ namespace wb {
 
     ModelFile *_file;
     std::string _filename;
-    // only used for comparing pointers
-    grt::UndoAction *_save_point;
+    // serial of the latest undo action when the document was last saved
+    size_t _save_point;
 
     TunnelManager *_tunnel_manager;
 
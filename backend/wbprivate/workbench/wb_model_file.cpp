@@ -26,11 +26,17 @@
 
 #include <zip.h>
 #include "wb_model_file.h"
+#include "wb_autosave_journal.h"
 
 #include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
 #include <set>
 #include <stdexcept>
+#include <thread>
 #include <errno.h>
+#include <zlib.h>
 
 #include "grt.h"
 
@@ -73,11 +79,15 @@
 
 /* Auto-saving
  *
- * Auto-saving works by saving the model document file (the XML) to the expanded document folder
- * from time to time, named as document-autosave.mwb.xml. The expanded document folder is
- * automatically deleted when it is closed normally.
+ * Auto-saving works by appending the changes made since the last auto-save to a journal in the
+ * expanded document folder (document-autosave.journal). The changes are applied on top of the
+ * document XML saved last, which is either the document itself or a full snapshot of it, named
+ * document-autosave.mwb.xml. A snapshot is only written if there is no document XML yet or if the
+ * journal got too big. Journal records carry a checksum of the document XML they apply to, so records
+ * left over from before the last snapshot (e.g. after a crash right after writing it) are ignored.
+ * The expanded document folder is automatically deleted when it is closed normally.
  * When a document is opened, it will check if there already is a document folder for that file
- * and if so, the recovery function will kick in, using the autosave XML file.
+ * and if so, the recovery function will kick in, using the autosave XML file and the journal.
  */
 
 DEFAULT_LOG_DOMAIN("model")
@@ -174,7 +184,7 @@ std::string ModelFile::create_document_dir(const std::string &dir, const std::st
   return path;
 }
 
-ModelFile::ModelFile(const std::string &tmpdir) : _temp_dir_lock(0), _dirty(false) {
+ModelFile::ModelFile(const std::string &tmpdir) : _temp_dir_lock(0), _journal(0), _dirty(false) {
   _temp_dir = tmpdir;
 }
 
@@ -270,8 +280,9 @@ void ModelFile::open(const std::string &path) {
 
     time_t file_ts;
     base::file_mtime(path, file_ts);
-    time_t autosave_ts;
-    base::file_mtime(base::makePath(auto_save_dir, MAIN_DOCUMENT_NAME), autosave_ts);
+    time_t autosave_ts = 0;
+    if (!base::file_mtime(base::makePath(auto_save_dir, MAIN_DOCUMENT_AUTOSAVE_JOURNAL_NAME), autosave_ts))
+      base::file_mtime(base::makePath(auto_save_dir, MAIN_DOCUMENT_NAME), autosave_ts);
     if (autosave_ts == 0)
       base::file_mtime(auto_save_dir, autosave_ts);
 
@@ -429,22 +440,113 @@ bool ModelFile::semantic_check(workbench_DocumentRef doc) {
 
 //--------------------------------------------------------------------------------------------------
 
-std::list<std::string> ModelFile::unpack_zip(const std::string &zipfile, const std::string &destdir) {
-  std::list<std::string> unpacked_files;
+// Archives with fewer members than this are packed and unpacked on the calling thread, as starting
+// workers costs more than it saves.
+static const size_t MIN_PARALLEL_ZIP_MEMBERS = 4;
 
-  if (g_mkdir_with_parents(destdir.c_str(), 0700) < 0)
-    throw grt::os_error(strfmt(_("Cannot create temporary directory for open document: %s"), destdir.c_str()), errno);
+// Members larger than this are left to libzip to compress while writing the archive, so we don't keep
+// the compressed copy of a big data.db in memory.
+static const long long MAX_PRECOMPRESSED_MEMBER_SIZE = 64 * 1024 * 1024;
 
-  int err;
+// libzip publishes its version in zipconf.h since 1.3. Only these versions are reliably able to store
+// data we compressed ourselves, as they take over the stat info of a source verbatim.
+#ifdef LIBZIP_VERSION_MAJOR
+#define HAVE_PRECOMPRESSED_ZIP_SOURCES 1
+#endif
+
+//--------------------------------------------------------------------------------------------------
+
+#ifdef HAVE_PRECOMPRESSED_ZIP_SOURCES
+
+/**
+ * Runs the given task for each index in [0, count), spread over as many threads as there are cores.
+ * The task must not throw.
+ */
+static void run_parallel(size_t count, const std::function<void(size_t)> &task) {
+  size_t threadCount = std::min<size_t>(std::max(1U, std::thread::hardware_concurrency()), count);
+  if (count < MIN_PARALLEL_ZIP_MEMBERS || threadCount < 2) {
+    for (size_t i = 0; i < count; ++i)
+      task(i);
+    return;
+  }
+
+  std::atomic<size_t> next(0);
+  std::vector<std::thread> workers;
+  for (size_t i = 0; i < threadCount; ++i) {
+    workers.emplace_back([&]() {
+      size_t index;
+      while ((index = next++) < count)
+        task(index);
+    });
+  }
+
+  for (auto &worker : workers)
+    worker.join();
+}
+
+#endif
+
+//--------------------------------------------------------------------------------------------------
+
+static zip *open_zip_for_reading(const std::string &zipfile, int &err) {
 #ifdef ZIP_DISABLE_DEPRECATED
   // Would be good if we could test for zip_fdopen, but there's no way in the preprocessor.
-  // And there's no version macro either for libzip.
+  // And only newer versions of libzip have a version macro.
   // Define ZIP_DISABLE_DEPRECATED to use the newer APIs.
   int fd = base_open(zipfile, O_RDONLY, S_IREAD); // Error checking is done already before.
-  zip *z = zip_fdopen(fd, 0, &err);
+  return zip_fdopen(fd, 0, &err);
 #else
-  zip *z = zip_open(zipfile.c_str(), 0, &err); // Older versions of libzip.
+  return zip_open(zipfile.c_str(), 0, &err); // Older versions of libzip.
 #endif
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Extracts a single member of the document archive to the given path. Returns an error message
+ * or an empty string on success.
+ */
+static std::string extract_zip_member(zip *z, zip_uint64_t index, const std::string &outpath) {
+  zip_file *file = zip_fopen_index(z, index, 0);
+  if (!file)
+    return strfmt(_("Error opening document file: %s"), zip_strerror(z));
+
+  FILE *outfile = base_fopen(outpath.c_str(), "w+");
+  if (!outfile) {
+    int err = errno;
+    zip_fclose(file);
+    return strfmt("%s: %s", _("Error creating temporary file while opending document."), g_strerror(err));
+  }
+
+  std::string error;
+  char buffer[4098];
+  ssize_t c;
+  while ((c = (size_t)zip_fread(file, buffer, sizeof(buffer))) > 0) {
+    if ((ssize_t)fwrite(buffer, 1, c, outfile) < c) {
+      error = strfmt("%s: %s", _("Error writing temporary file while opending document."), g_strerror(ferror(outfile)));
+      break;
+    }
+  }
+
+  if (error.empty() && c < 0)
+    error = strfmt(_("Error opening document file: %s"), zip_file_strerror(file) ? zip_file_strerror(file) : "");
+
+  zip_fclose(file);
+  fclose(outfile);
+
+  return error;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+std::list<std::string> ModelFile::unpack_zip(const std::string &zipfile, const std::string &destdir) {
+  std::list<std::string> unpacked_files;
+
+  if (g_mkdir_with_parents(destdir.c_str(), 0700) < 0)
+    throw grt::os_error(strfmt(_("Cannot create temporary directory for open document: %s"), destdir.c_str()), errno);
+
+  int err;
+  zip *z = open_zip_for_reading(zipfile, err);
   if (z == NULL) {
     if (err == ZIP_ER_NOZIP)
       throw std::runtime_error("The file is not a Workbench document.");
@@ -477,27 +579,26 @@ std::list<std::string> ModelFile::unpack_zip(const std::string &zipfile, const s
 #else
   int count = zip_get_num_files(z);
 #endif
+
+  // First collect the members to extract and create their folders, then extract the content.
+  std::vector<std::pair<zip_uint64_t, std::string>> members;
   for (int i = 0; i < count; i++) {
-    zip_file *file = zip_fopen_index(z, i, 0);
-    if (!file) {
-      const char *err = zip_strerror(z);
+    const char *zname = zip_get_name(z, i, 0);
+    if (!zname) {
+      std::string error = zip_strerror(z);
       zip_close(z);
-      throw std::runtime_error(strfmt(_("Error opening document file: %s"), err));
+      throw std::runtime_error(strfmt(_("Error opening document file: %s"), error.c_str()));
     }
 
-    const char *zname = zip_get_name(z, i, 0);
-    if (strcmp(zname, "/") == 0 || strcmp(zname, "\\") == 0) {
-      zip_fclose(file);
+    if (strcmp(zname, "/") == 0 || strcmp(zname, "\\") == 0)
       continue;
-    }
+
     std::string dirname = base::dirname(zname);
     std::string basename = base::basename(zname);
 
     // skip lock file as it is already locked and inaccessible
-    if (basename == lock_filename) {
-      zip_fclose(file);
+    if (basename == lock_filename)
       continue;
-    }
 
     std::string outpath = destdir;
 
@@ -505,7 +606,6 @@ std::list<std::string> ModelFile::unpack_zip(const std::string &zipfile, const s
       outpath.append("/");
       outpath.append(dirname);
       if (g_mkdir_with_parents(outpath.c_str(), 0700) < 0) {
-        zip_fclose(file);
         zip_close(z);
         throw grt::os_error(_("Error creating temporary directory while opending document."), errno);
       }
@@ -513,48 +613,59 @@ std::list<std::string> ModelFile::unpack_zip(const std::string &zipfile, const s
     outpath.append("/");
     outpath.append(basename);
 
-    FILE *outfile = base_fopen(outpath.c_str(), "w+");
-    if (!outfile) {
-      zip_fclose(file);
-      zip_close(z);
-      throw grt::os_error(_("Error creating temporary file while opending document."), errno);
-    }
-
+    members.push_back({ (zip_uint64_t)i, outpath });
     unpacked_files.push_back(outpath);
+  }
 
-    char buffer[4098];
-    ssize_t c;
-    while ((c = (size_t)zip_fread(file, buffer, sizeof(buffer))) > 0) {
-      if ((ssize_t)fwrite(buffer, 1, c, outfile) < c) {
-        int err = ferror(outfile);
-        fclose(outfile);
-        zip_fclose(file);
-        zip_close(z);
-        throw grt::os_error(_("Error writing temporary file while opending document."), err);
-      }
-    }
-
-    if (c < 0) {
-      std::string err = zip_file_strerror(file) ? zip_file_strerror(file) : "";
-      zip_fclose(file);
-      zip_close(z);
-      throw std::runtime_error(strfmt(_("Error opening document file: %s"), err.c_str()));
+  // A zip handle must not be shared between threads, so each worker reads its share of the members through
+  // a handle of its own. Inflating is then spread over all cores, which pays off for documents with many
+  // or large attachments and a big data.db.
+  std::vector<std::string> errors(members.size());
+  size_t workerCount = std::min<size_t>(std::max(1U, std::thread::hardware_concurrency()), members.size());
+  if (members.size() < MIN_PARALLEL_ZIP_MEMBERS || workerCount < 2) {
+    for (size_t i = 0; i < members.size(); ++i)
+      errors[i] = extract_zip_member(z, members[i].first, members[i].second);
+  } else {
+    std::vector<std::thread> workers;
+    for (size_t worker = 0; worker < workerCount; ++worker) {
+      workers.emplace_back([&, worker]() {
+        int err;
+        zip *handle = open_zip_for_reading(zipfile, err);
+        for (size_t i = worker; i < members.size(); i += workerCount) {
+          if (handle == NULL)
+            errors[i] = _("Error opening document file.");
+          else
+            errors[i] = extract_zip_member(handle, members[i].first, members[i].second);
+        }
+        if (handle != NULL)
+          zip_close(handle);
+      });
     }
 
-    zip_fclose(file);
-    fclose(outfile);
+    for (auto &worker : workers)
+      worker.join();
   }
 
   zip_close(z);
 
+  for (auto &error : errors) {
+    if (!error.empty())
+      throw std::runtime_error(error);
+  }
+
   return unpacked_files;
 }
 
-static void zip_dir_contents(zip *z, const std::string &destdir, const std::string &partial) {
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Collects the (relative) paths of all files in the given folder and its subfolders. The files of a folder
+ * come before those of its subfolders.
+ */
+static void list_dir_contents(const std::string &destdir, std::vector<std::string> &files) {
   GError *error = 0;
   GDir *dir = g_dir_open(destdir.empty() ? "." : destdir.c_str(), 0, &error);
   if (!dir) {
-    zip_close(z);
     std::string err = error ? error->message : "Cannot open document directory.";
     g_error_free(error);
     throw grt::os_error(err);
@@ -574,36 +685,163 @@ static void zip_dir_contents(zip *z, const std::string &destdir, const std::stri
       if (g_file_test(tmp.c_str(), G_FILE_TEST_IS_DIR)) {
         if (add_directories) {
           try {
-            zip_dir_contents(z, destdir.empty() ? entry : destdir + G_DIR_SEPARATOR + entry, tmp);
+            list_dir_contents(tmp, files);
           } catch (...) {
             g_dir_close(dir);
             throw;
           }
         }
-      } else {
-        if (!add_directories) {
-          zip_source *src = zip_source_file(z, tmp.c_str(), 0, 0);
-#ifdef _MSC_VER
-          if (!src || zip_file_add(z, tmp.c_str(), src, ZIP_FL_OVERWRITE | ZIP_FL_ENC_UTF_8) < 0) {
-            zip_source_free(src);
-            g_dir_close(dir);
-            throw std::runtime_error(zip_strerror(z));
-          }
-#else
-          if (!src || zip_add(z, tmp.c_str(), src) < 0) {
-            zip_source_free(src);
-            g_dir_close(dir);
-            throw std::runtime_error(zip_strerror(z));
-          }
-#endif
-        }
-      }
+      } else if (!add_directories)
+        files.push_back(tmp);
     }
     g_dir_rewind(dir);
   }
   g_dir_close(dir);
 }
 
+//--------------------------------------------------------------------------------------------------
+
+#ifdef HAVE_PRECOMPRESSED_ZIP_SOURCES
+
+/**
+ * An archive member deflated in memory ahead of writing the archive. libzip copies such data as is
+ * instead of compressing it once more in zip_close, which it does for one member after the other.
+ */
+struct PrecompressedMember {
+  std::string data; // Raw deflate stream, as stored in the archive.
+  zip_uint64_t size = 0;
+  zip_uint32_t crc = 0;
+  time_t mtime = 0;
+  zip_uint64_t offset = 0;
+  zip_error_t error;
+  bool valid = false;
+
+  PrecompressedMember() {
+    zip_error_init(&error);
+  }
+
+  PrecompressedMember(const PrecompressedMember &) = delete;
+  PrecompressedMember &operator=(const PrecompressedMember &) = delete;
+
+  ~PrecompressedMember() {
+    zip_error_fini(&error);
+  }
+
+  // Returns false if the file cannot be read, so it is added the normal way.
+  bool compress(const std::string &path) {
+    GStatBuf info;
+    if (g_stat(path.c_str(), &info) != 0 || info.st_size > MAX_PRECOMPRESSED_MEMBER_SIZE)
+      return false;
+
+    FILE *file = base_fopen(path.c_str(), "rb");
+    if (file == nullptr)
+      return false;
+
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+      fclose(file);
+      return false;
+    }
+
+    bool success = true;
+    uLong checksum = crc32(0, Z_NULL, 0);
+    unsigned char input[0x10000];
+    unsigned char output[0x10000];
+    int flush = Z_NO_FLUSH;
+    while (flush != Z_FINISH) {
+      size_t read = fread(input, 1, sizeof(input), file);
+      if (ferror(file)) {
+        success = false;
+        break;
+      }
+      flush = feof(file) ? Z_FINISH : Z_NO_FLUSH;
+      size += read;
+      checksum = crc32(checksum, input, (uInt)read);
+
+      stream.next_in = input;
+      stream.avail_in = (uInt)read;
+      do {
+        stream.next_out = output;
+        stream.avail_out = sizeof(output);
+        deflate(&stream, flush);
+        data.append((char *)output, sizeof(output) - stream.avail_out);
+      } while (stream.avail_out == 0);
+    }
+
+    deflateEnd(&stream);
+    fclose(file);
+
+    crc = (zip_uint32_t)checksum;
+    mtime = info.st_mtime;
+    valid = success;
+    return success;
+  }
+
+  static zip_int64_t callback(void *userdata, void *buffer, zip_uint64_t length, zip_source_cmd_t command) {
+    PrecompressedMember *member = static_cast<PrecompressedMember *>(userdata);
+    switch (command) {
+      case ZIP_SOURCE_OPEN:
+        member->offset = 0;
+        return 0;
+
+      case ZIP_SOURCE_READ: {
+        zip_uint64_t count = std::min<zip_uint64_t>(length, member->data.size() - member->offset);
+        memcpy(buffer, member->data.data() + member->offset, (size_t)count);
+        member->offset += count;
+        return (zip_int64_t)count;
+      }
+
+      case ZIP_SOURCE_CLOSE:
+      case ZIP_SOURCE_FREE:
+        return 0;
+
+      case ZIP_SOURCE_STAT: {
+        zip_stat_t *stat = static_cast<zip_stat_t *>(buffer);
+        zip_stat_init(stat);
+        stat->size = member->size;
+        stat->comp_size = member->data.size();
+        stat->comp_method = ZIP_CM_DEFLATE;
+        stat->crc = member->crc;
+        stat->mtime = member->mtime;
+        stat->valid = ZIP_STAT_SIZE | ZIP_STAT_COMP_SIZE | ZIP_STAT_COMP_METHOD | ZIP_STAT_CRC | ZIP_STAT_MTIME;
+        return sizeof(*stat);
+      }
+
+      case ZIP_SOURCE_ERROR:
+        return zip_error_to_data(&member->error, buffer, length);
+
+      case ZIP_SOURCE_SUPPORTS:
+        return zip_source_make_command_bitmap(ZIP_SOURCE_OPEN, ZIP_SOURCE_READ, ZIP_SOURCE_CLOSE, ZIP_SOURCE_STAT,
+                                              ZIP_SOURCE_ERROR, ZIP_SOURCE_FREE, -1);
+
+      default:
+        zip_error_set(&member->error, ZIP_ER_OPNOTSUPP, 0);
+        return -1;
+    }
+  }
+};
+
+#endif
+
+//--------------------------------------------------------------------------------------------------
+
+static void add_zip_member(zip *z, const std::string &path, zip_source *src) {
+#ifdef _MSC_VER
+  if (!src || zip_file_add(z, path.c_str(), src, ZIP_FL_OVERWRITE | ZIP_FL_ENC_UTF_8) < 0) {
+    zip_source_free(src);
+    throw std::runtime_error(zip_strerror(z));
+  }
+#else
+  if (!src || zip_add(z, path.c_str(), src) < 0) {
+    zip_source_free(src);
+    throw std::runtime_error(zip_strerror(z));
+  }
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------
+
 void ModelFile::pack_zip(const std::string &zipfile, const std::string &destdir, const std::string &comment) {
   std::string curdir;
 
@@ -653,8 +891,29 @@ void ModelFile::pack_zip(const std::string &zipfile, const std::string &destdir,
   zip_set_archive_comment(z, zip_comment.c_str(), (int)zip_comment.size());
 #endif
 
+  std::vector<std::string> files;
+#ifdef HAVE_PRECOMPRESSED_ZIP_SOURCES
+  // libzip reads the sources only in zip_close, so the compressed data must outlive the zip handle.
+  std::unique_ptr<PrecompressedMember[]> members;
+#endif
+
   try {
-    zip_dir_contents(z, "", "");
+    list_dir_contents("", files);
+
+#ifdef HAVE_PRECOMPRESSED_ZIP_SOURCES
+    members.reset(new PrecompressedMember[files.size()]);
+    run_parallel(files.size(), [&](size_t i) { members[i].compress(files[i]); });
+#endif
+
+    for (size_t i = 0; i < files.size(); ++i) {
+#ifdef HAVE_PRECOMPRESSED_ZIP_SOURCES
+      if (members[i].valid) {
+        add_zip_member(z, files[i], zip_source_function(z, PrecompressedMember::callback, &members[i]));
+        continue;
+      }
+#endif
+      add_zip_member(z, files[i], zip_source_file(z, files[i].c_str(), 0, 0));
+    }
 
     if (zip_close(z) < 0) {
       std::string err = zip_strerror(z) ? zip_strerror(z) : "";
@@ -783,6 +1042,8 @@ bool ModelFile::save_to(const std::string &path, const std::string &comment) {
 
   // saving the file for real can delete the autosave
   g_remove(get_path_for("document-autosave.mwb.xml").c_str());
+  if (_journal)
+    _journal->reset(AutosaveJournal::snapshot_id(get_path_for(MAIN_DOCUMENT_NAME)));
   g_remove(get_path_for("real_path").c_str());
 
   if (g_path_is_absolute(path.c_str()))
@@ -802,6 +1063,9 @@ bool ModelFile::save_to(const std::string &path, const std::string &comment) {
 void ModelFile::cleanup() {
   RecMutexLock lock(_mutex);
 
+  delete _journal;
+  _journal = 0;
+
   delete _temp_dir_lock;
   _temp_dir_lock = 0;
 
@@ -928,7 +1192,34 @@ void ModelFile::store_document(const workbench_DocumentRef &doc) {
 }
 
 void ModelFile::store_document_autosave(const workbench_DocumentRef &doc) {
-  grt::GRT::get()->serialize(doc, get_path_for("document-autosave.mwb.xml"), DOCUMENT_FORMAT, DOCUMENT_VERSION);
+  // Only the changes are written, as long as there is a full document to apply them to.
+  if (_journal && !_journal->needs_snapshot() &&
+      (has_file(MAIN_DOCUMENT_NAME) || has_file(MAIN_DOCUMENT_AUTOSAVE_NAME))) {
+    if (_journal->append())
+      return;
+  }
+
+  grt::GRT::get()->serialize(doc, get_path_for(MAIN_DOCUMENT_AUTOSAVE_NAME), DOCUMENT_FORMAT, DOCUMENT_VERSION);
+  if (_journal)
+    _journal->reset(AutosaveJournal::snapshot_id(get_path_for(MAIN_DOCUMENT_AUTOSAVE_NAME)));
+}
+
+/**
+ * Applies the changes from the autosave journal of a recovered document and starts recording new changes.
+ * The document must already be in the GRT tree. New changes are appended to the existing journal, as it applies
+ * to the same document XML.
+ */
+void ModelFile::open_autosave_journal(const workbench_DocumentRef &doc) {
+  std::string snapshot_id = AutosaveJournal::snapshot_id(
+    get_path_for(has_file(MAIN_DOCUMENT_AUTOSAVE_NAME) ? MAIN_DOCUMENT_AUTOSAVE_NAME : MAIN_DOCUMENT_NAME));
+
+  std::string path = get_path_for(MAIN_DOCUMENT_AUTOSAVE_JOURNAL_NAME);
+  if (AutosaveJournal::exists(path))
+    AutosaveJournal::replay(path, doc, snapshot_id);
+
+  delete _journal;
+  _journal = new AutosaveJournal(path, snapshot_id);
+  _journal->track_changes(grt::GRT::get()->get_undo_manager());
 }
 
 void ModelFile::delete_file(const std::string &path) {
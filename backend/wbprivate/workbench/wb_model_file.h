@@ -37,12 +37,15 @@
 
 #define MAIN_DOCUMENT_NAME "document.mwb.xml"
 #define MAIN_DOCUMENT_AUTOSAVE_NAME "document-autosave.mwb.xml"
+#define MAIN_DOCUMENT_AUTOSAVE_JOURNAL_NAME "document-autosave.journal"
 
 namespace bec {
   class GRTManager;
 }
 
 namespace wb {
+  class AutosaveJournal;
+
   class MYSQLWBBACKEND_PUBLIC_FUNC ModelFile : public base::trackable {
   public:
     ModelFile(const std::string &tmpdir);
@@ -69,6 +72,7 @@ namespace wb {
 
     void store_document(const workbench_DocumentRef &doc);
     void store_document_autosave(const workbench_DocumentRef &doc);
+    void open_autosave_journal(const workbench_DocumentRef &doc);
 
     std::list<std::string> get_file_list(const std::string &prefixdir = "");
     bool has_file(const std::string &name);
@@ -112,6 +116,7 @@ namespace wb {
 
   private:
     base::LockFile *_temp_dir_lock;
+    AutosaveJournal *_journal;
     base::RecMutex _mutex;
     std::string _temp_dir;                //< temporary files directory
     std::string _content_dir;             //< path for directory where document contents are stored in disk
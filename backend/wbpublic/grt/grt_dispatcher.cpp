@@ -23,6 +23,7 @@
 
 #include "base/threading.h"
 #include "base/log.h"
+#include "base/profiling.h"
 
 #include "grt_dispatcher.h"
 #include "grt_manager.h"
@@ -438,7 +439,8 @@ gpointer GRTDispatcher::worker_thread(gpointer data) {
   GAsyncQueue *task_queue = self->_task_queue;
   GAsyncQueue *callback_queue = self->_callback_queue;
 
-  mforms::Utilities::set_thread_name("GRTDispatcher");
+  // Worker dispatchers (SQL editor, threaded tasks) get their own name so they can be told apart in traces.
+  mforms::Utilities::set_thread_name(self->_is_main_dispatcher ? "GRTDispatcher" : "GRTDispatcher worker");
 
   logDebug("worker thread running\n");
 
@@ -683,6 +685,8 @@ void GRTDispatcher::restore_callbacks(const GRTTaskBase::Ref task) {
 //--------------------------------------------------------------------------------------------------
 
 void GRTDispatcher::execute_task(const GRTTaskBase::Ref gtask) {
+  TRACE_ZONE(base::Tracer::is_enabled() ? base::Tracer::intern(gtask->name()) : nullptr);
+
   try {
     gtask->started();
     grt::ValueRef result = gtask->execute();
@@ -23,6 +23,7 @@
 
 #include "base/threading.h"
 #include "base/log.h"
+#include "base/profiling.h"
 #include "base/file_utilities.h"
 
 #include "grtpp_module_python.h"
@@ -342,6 +343,8 @@ static void nothing() {
 }
 
 void GRTManager::perform_idle_tasks() {
+  TRACE_ZONE("GRTManager::perform_idle_tasks");
+
   // flush the dispatcher callback queue
   {
     DispatcherMap copy;
@@ -23,8 +23,12 @@
 
 #include "spatial_handler.h"
 #include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <iostream>
+#include <memory>
 #include <stdexcept>
+#include <thread>
 #include "base/log.h"
 
 DEFAULT_LOG_DOMAIN("spatial");
@@ -191,6 +195,140 @@ double spatial::ShapeContainer::distance_line(const std::vector<base::Point> &po
   return -1;
 }
 
+void spatial::simplify_points(const std::vector<base::Point> &points, double tolerance,
+                              std::vector<base::Point> &result) {
+  result.clear();
+  if (points.size() < 3) {
+    result = points;
+    return;
+  }
+
+  std::vector<bool> keep(points.size(), false);
+  keep.front() = true;
+  keep.back() = true;
+
+  std::vector<std::pair<size_t, size_t> > ranges;
+  ranges.push_back(std::make_pair(0, points.size() - 1));
+  while (!ranges.empty()) {
+    std::pair<size_t, size_t> range = ranges.back();
+    ranges.pop_back();
+
+    double max_distance = 0;
+    size_t farthest = range.first;
+    for (size_t i = range.first + 1; i < range.second; ++i) {
+      double distance = distance_to_segment(points[range.first], points[range.second], points[i]);
+      if (distance > max_distance) {
+        max_distance = distance;
+        farthest = i;
+      }
+    }
+
+    if (max_distance > tolerance) {
+      keep[farthest] = true;
+      ranges.push_back(std::make_pair(range.first, farthest));
+      ranges.push_back(std::make_pair(farthest, range.second));
+    }
+  }
+
+  for (size_t i = 0; i < points.size(); ++i) {
+    if (keep[i])
+      result.push_back(points[i]);
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+static const size_t IndexNodeCapacity = 16;
+
+static spatial::FeatureIndex::Box union_box(const spatial::FeatureIndex::Box &a, const spatial::FeatureIndex::Box &b) {
+  spatial::FeatureIndex::Box box = {std::min(a.min_x, b.min_x), std::min(a.min_y, b.min_y),
+                                    std::max(a.max_x, b.max_x), std::max(a.max_y, b.max_y)};
+  return box;
+}
+
+// Sorts the entries so that each run of IndexNodeCapacity entries covers a compact tile of the plane:
+// vertical slices by the box centers along x, each of them ordered by the centers along y.
+template <class T, class BoxOf>
+static void str_order(std::vector<T> &entries, BoxOf box_of) {
+  const size_t node_count = (entries.size() + IndexNodeCapacity - 1) / IndexNodeCapacity;
+  const size_t slice_size = (size_t)std::ceil(std::sqrt((double)node_count)) * IndexNodeCapacity;
+
+  std::sort(entries.begin(), entries.end(), [&box_of](const T &a, const T &b) {
+    return box_of(a).min_x + box_of(a).max_x < box_of(b).min_x + box_of(b).max_x;
+  });
+  for (size_t start = 0; start < entries.size(); start += slice_size) {
+    std::sort(entries.begin() + start, entries.begin() + std::min(entries.size(), start + slice_size),
+              [&box_of](const T &a, const T &b) {
+                return box_of(a).min_y + box_of(a).max_y < box_of(b).min_y + box_of(b).max_y;
+              });
+  }
+}
+
+void spatial::FeatureIndex::build(const std::vector<std::pair<Box, size_t> > &items) {
+  clear();
+  if (items.empty())
+    return;
+
+  _items = items;
+  str_order(_items, [](const std::pair<Box, size_t> &item) -> const Box & { return item.first; });
+
+  std::vector<Node> nodes;
+  for (size_t first = 0; first < _items.size(); first += IndexNodeCapacity) {
+    Node node = {_items[first].first, first, std::min(IndexNodeCapacity, _items.size() - first)};
+    for (size_t i = first + 1; i < first + node.count; ++i)
+      node.bounds = union_box(node.bounds, _items[i].first);
+    nodes.push_back(node);
+  }
+
+  while (nodes.size() > 1) {
+    str_order(nodes, [](const Node &node) -> const Box & { return node.bounds; });
+
+    std::vector<Node> parents;
+    for (size_t first = 0; first < nodes.size(); first += IndexNodeCapacity) {
+      Node parent = {nodes[first].bounds, first, std::min(IndexNodeCapacity, nodes.size() - first)};
+      for (size_t i = first + 1; i < first + parent.count; ++i)
+        parent.bounds = union_box(parent.bounds, nodes[i].bounds);
+      parents.push_back(parent);
+    }
+    _levels.push_back(nodes);
+    nodes.swap(parents);
+  }
+  _levels.push_back(nodes);
+}
+
+void spatial::FeatureIndex::clear() {
+  _items.clear();
+  _levels.clear();
+}
+
+void spatial::FeatureIndex::query(const Box &area, std::vector<size_t> &result) const {
+  result.clear();
+  if (_levels.empty())
+    return;
+
+  query_node(_levels.size() - 1, _levels.back().front(), area, result);
+  std::sort(result.begin(), result.end());
+}
+
+void spatial::FeatureIndex::query_node(size_t level, const Node &node, const Box &area,
+                                       std::vector<size_t> &result) const {
+  if (!node.bounds.intersects(area))
+    return;
+
+  if (level == 0) {
+    for (size_t i = node.first; i < node.first + node.count; ++i) {
+      if (_items[i].first.intersects(area))
+        result.push_back(_items[i].second);
+    }
+  } else {
+    const std::vector<Node> &children = _levels[level - 1];
+    for (size_t i = node.first; i < node.first + node.count; ++i)
+      query_node(level - 1, children[i], area, result);
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
 double spatial::ShapeContainer::distance_polygon(const base::Point &p) const {
   if (points.empty())
     return -1;
@@ -626,6 +764,16 @@ std::string spatial::Converter::dec_to_dms(double angle, AxisType axis, int prec
 
 spatial::Converter::~Converter() {
   base::RecMutexLock mtx(_projection_protector);
+  if (_geo_to_proj != NULL)
+    OCTDestroyCoordinateTransformation(_geo_to_proj);
+  if (_proj_to_geo != NULL)
+    OCTDestroyCoordinateTransformation(_proj_to_geo);
+}
+
+// The coordinate transformations must not be shared between threads, so each rendering thread uses its own copy.
+spatial::Converter *spatial::Converter::clone() {
+  base::RecMutexLock mtx(_projection_protector);
+  return new Converter(_view, _source_srs, _target_srs);
 }
 
 void spatial::Converter::change_projection(OGRSpatialReference *src_srs, OGRSpatialReference *dst_srs) {
@@ -728,6 +876,18 @@ bool spatial::Converter::from_proj_to_latlon(double &lat, double &lon) {
 }
 
 void spatial::Converter::transform_points(std::deque<ShapeContainer> &shapes_container) {
+  project_points(shapes_container);
+  projected_to_view(shapes_container);
+}
+
+void spatial::Converter::transform_envelope(spatial::Envelope &env) {
+  if (project_envelope(env))
+    projected_to_view(env);
+}
+
+// Reprojects the points, dropping the ones that can't be converted. The bounding box is marked as converted
+// only if it could be reprojected too.
+void spatial::Converter::project_points(std::deque<ShapeContainer> &shapes_container) {
   std::deque<ShapeContainer>::iterator it;
   for (it = shapes_container.begin(); it != shapes_container.end() && !_interrupt; it++) {
     std::deque<size_t> for_removal;
@@ -737,16 +897,8 @@ void spatial::Converter::transform_points(std::deque<ShapeContainer> &shapes_con
     }
 
     if (_geo_to_proj->Transform(1, &(*it).bounding_box.bottom_right.x, &(*it).bounding_box.bottom_right.y) &&
-        _geo_to_proj->Transform(1, &(*it).bounding_box.top_left.x, &(*it).bounding_box.top_left.y)) {
-      int x, y;
-      from_projected((*it).bounding_box.bottom_right.x, (*it).bounding_box.bottom_right.y, x, y);
-      (*it).bounding_box.bottom_right.x = x;
-      (*it).bounding_box.bottom_right.y = y;
-      from_projected((*it).bounding_box.top_left.x, (*it).bounding_box.top_left.y, x, y);
-      (*it).bounding_box.top_left.x = x;
-      (*it).bounding_box.top_left.y = y;
+        _geo_to_proj->Transform(1, &(*it).bounding_box.top_left.x, &(*it).bounding_box.top_left.y))
       (*it).bounding_box.converted = true;
-    }
 
     if (!for_removal.empty())
       logDebug("%i points that could not be converted were skipped\n", (int)for_removal.size());
@@ -754,9 +906,23 @@ void spatial::Converter::transform_points(std::deque<ShapeContainer> &shapes_con
     std::deque<size_t>::reverse_iterator rit;
     for (rit = for_removal.rbegin(); rit != for_removal.rend() && !_interrupt; rit++)
       (*it).points.erase((*it).points.begin() + *rit);
+  }
+}
+
+void spatial::Converter::projected_to_view(std::deque<ShapeContainer> &shapes_container) {
+  std::deque<ShapeContainer>::iterator it;
+  for (it = shapes_container.begin(); it != shapes_container.end() && !_interrupt; it++) {
+    int x, y;
+    if ((*it).bounding_box.converted) {
+      from_projected((*it).bounding_box.bottom_right.x, (*it).bounding_box.bottom_right.y, x, y);
+      (*it).bounding_box.bottom_right.x = x;
+      (*it).bounding_box.bottom_right.y = y;
+      from_projected((*it).bounding_box.top_left.x, (*it).bounding_box.top_left.y, x, y);
+      (*it).bounding_box.top_left.x = x;
+      (*it).bounding_box.top_left.y = y;
+    }
 
     for (size_t i = 0; i < (*it).points.size() && !_interrupt; i++) {
-      int x, y;
       from_projected((*it).points[i].x, (*it).points[i].y, x, y);
       (*it).points[i].x = x;
       (*it).points[i].y = y;
@@ -764,26 +930,31 @@ void spatial::Converter::transform_points(std::deque<ShapeContainer> &shapes_con
   }
 }
 
-void spatial::Converter::transform_envelope(spatial::Envelope &env) {
+bool spatial::Converter::project_envelope(spatial::Envelope &env) {
   if (!env.is_init()) {
     logError("Can't transform empty envelope.\n");
-    return;
+    return false;
   }
 
   if (_geo_to_proj->Transform(1, &env.top_left.x, &env.top_left.y) &&
       _geo_to_proj->Transform(1, &env.bottom_right.x, &env.bottom_right.y)) {
-    int x, y;
-    from_projected(env.bottom_right.x, env.bottom_right.y, x, y);
-    env.bottom_right.x = x;
-    env.bottom_right.y = y;
-    from_projected(env.top_left.x, env.top_left.y, x, y);
-    env.top_left.x = x;
-    env.top_left.y = y;
     env.converted = true;
-  } else {
-    logError("Unable to transform envelope: %f, %f, %f, %f.\n", env.top_left.x, env.top_left.y, env.bottom_right.x,
-             env.bottom_right.y);
+    return true;
   }
+
+  logError("Unable to transform envelope: %f, %f, %f, %f.\n", env.top_left.x, env.top_left.y, env.bottom_right.x,
+           env.bottom_right.y);
+  return false;
+}
+
+void spatial::Converter::projected_to_view(spatial::Envelope &env) {
+  int x, y;
+  from_projected(env.bottom_right.x, env.bottom_right.y, x, y);
+  env.bottom_right.x = x;
+  env.bottom_right.y = y;
+  from_projected(env.top_left.x, env.top_left.y, x, y);
+  env.top_left.x = x;
+  env.top_left.y = y;
 }
 
 void spatial::Converter::interrupt() {
@@ -792,7 +963,16 @@ void spatial::Converter::interrupt() {
 
 using namespace spatial;
 
-Feature::Feature(Layer *layer, int row_id, const std::string &data, bool wkt = false) : _owner(layer), _row_id(row_id) {
+// Simplification tolerances of the detail levels in pixels of the unzoomed view, coarsest first. A level is used while
+// its error stays below half a pixel at the current zoom.
+static const double LodTolerances[] = {0.5, 0.25, 0.125};
+static const size_t LodLevelCount = sizeof(LodTolerances) / sizeof(LodTolerances[0]);
+
+// Below this number of features per thread reprojecting in parallel doesn't pay off.
+static const size_t MinFeaturesPerThread = 256;
+
+Feature::Feature(Layer *layer, int row_id, const std::string &data, bool wkt = false)
+  : _owner(layer), _row_id(row_id), _projected_srs(NULL) {
   if (wkt)
     _geometry.import_from_wkt(data);
   else
@@ -812,15 +992,87 @@ void Feature::get_envelope(spatial::Envelope &env, const bool &screen_coords) {
 }
 
 void Feature::render(Converter *converter) {
-  std::deque<ShapeContainer> tmp_shapes;
-  _geometry.get_points(tmp_shapes);
-  converter->transform_points(tmp_shapes);
-  spatial::Envelope env;
-  _geometry.get_envelope(env);
-  converter->transform_envelope(env);
+  if (_projected_srs != converter->target_srs()) {
+    std::deque<ShapeContainer> tmp_shapes;
+    _geometry.get_points(tmp_shapes);
+    converter->project_points(tmp_shapes);
+    spatial::Envelope env;
+    _geometry.get_envelope(env);
+    converter->project_envelope(env);
+
+    if (_owner->_interrupt)
+      return;
+    _projected.swap(tmp_shapes);
+    _projected_env = env;
+    _projected_srs = converter->target_srs();
+  }
+
+  std::deque<ShapeContainer> tmp_shapes(_projected);
+  converter->projected_to_view(tmp_shapes);
+  spatial::Envelope env = _projected_env;
+  if (env.converted)
+    converter->projected_to_view(env);
   _env_screen = env;
 
-  _shapes = tmp_shapes;
+  _shapes.swap(tmp_shapes);
+  simplify();
+}
+
+void Feature::simplify() {
+  _simplified.clear();
+  _simplified.resize(LodLevelCount);
+
+  size_t point_count = 0;
+  for (std::deque<ShapeContainer>::const_iterator it = _shapes.begin(); it != _shapes.end(); ++it)
+    point_count += it->points.size();
+
+  for (size_t level = 0; level < LodLevelCount && !_owner->_interrupt; ++level) {
+    std::deque<ShapeContainer> &shapes = _simplified[level];
+    size_t simplified_count = 0;
+    for (std::deque<ShapeContainer>::const_iterator it = _shapes.begin(); it != _shapes.end(); ++it) {
+      shapes.push_back(ShapeContainer());
+      shapes.back().type = it->type;
+      shapes.back().bounding_box = it->bounding_box;
+      if (it->type == ShapePoint)
+        shapes.back().points = it->points;
+      else
+        simplify_points(it->points, LodTolerances[level], shapes.back().points);
+      simplified_count += shapes.back().points.size();
+    }
+
+    // Not worth keeping, and the finer levels would save even less.
+    if (simplified_count > point_count * 3 / 4) {
+      shapes.clear();
+      break;
+    }
+  }
+}
+
+const std::deque<ShapeContainer> &Feature::shapes_for_scale(float scale) const {
+  for (size_t level = 0; level < _simplified.size(); ++level) {
+    if (LodTolerances[level] * scale <= 0.5 && !_simplified[level].empty())
+      return _simplified[level];
+  }
+  return _shapes;
+}
+
+bool Feature::screen_bounds(FeatureIndex::Box &box) const {
+  bool found = false;
+  for (std::deque<ShapeContainer>::const_iterator it = _shapes.begin(); it != _shapes.end(); ++it) {
+    for (std::vector<base::Point>::const_iterator p = it->points.begin(); p != it->points.end(); ++p) {
+      if (!found) {
+        box.min_x = box.max_x = p->x;
+        box.min_y = box.max_y = p->y;
+        found = true;
+      } else {
+        box.min_x = std::min(box.min_x, p->x);
+        box.min_y = std::min(box.min_y, p->y);
+        box.max_x = std::max(box.max_x, p->x);
+        box.max_y = std::max(box.max_y, p->y);
+      }
+    }
+  }
+  return found;
 }
 
 double Feature::distance(const base::Point &p, const double &allowed_distance) {
@@ -851,7 +1103,9 @@ void Feature::interrupt() {
 }
 
 void Feature::repaint(mdc::CairoCtx &cr, float scale, const base::Rect &clip_area, base::Color fill_color) {
-  for (std::deque<ShapeContainer>::iterator it = _shapes.begin(); it != _shapes.end() && !_owner->_interrupt; it++) {
+  const std::deque<ShapeContainer> &shapes = shapes_for_scale(scale);
+  for (std::deque<ShapeContainer>::const_iterator it = shapes.begin(); it != shapes.end() && !_owner->_interrupt;
+       it++) {
     if ((*it).points.empty()) {
       logError("%s is empty", shape_description(it->type).c_str());
       continue;
@@ -948,6 +1202,8 @@ void Layer::set_show(bool flag) {
 }
 
 void Layer::add_feature(int row_id, const std::string &geom_data, bool wkt) {
+  _index.clear();
+
   spatial::Envelope env;
   Feature *feature = new Feature(this, row_id, geom_data, wkt);
   feature->get_envelope(env);
@@ -965,8 +1221,19 @@ void Layer::repaint(mdc::CairoCtx &cr, float scale, const base::Rect &clip_area)
   color.green *= 0.6;
   color.blue *= 0.6;
   cr.set_color(color);
-  for (std::deque<Feature *>::iterator it = _features.begin(); it != _features.end() && !_interrupt; ++it)
-    (*it)->repaint(cr, scale, clip_area, _fill_polygons ? _color : base::Color::invalid());
+  if (clip_area.empty() || _index.empty()) {
+    for (std::deque<Feature *>::iterator it = _features.begin(); it != _features.end() && !_interrupt; ++it)
+      (*it)->repaint(cr, scale, clip_area, _fill_polygons ? _color : base::Color::invalid());
+  } else {
+    // point markers are drawn with a fixed size around their position, so they may reach into the area from outside
+    const double margin = 6.0 / scale;
+    FeatureIndex::Box area = {clip_area.left() - margin, clip_area.top() - margin, clip_area.right() + margin,
+                              clip_area.bottom() + margin};
+    std::vector<size_t> visible;
+    _index.query(area, visible);
+    for (std::vector<size_t>::const_iterator it = visible.begin(); it != visible.end() && !_interrupt; ++it)
+      _features[*it]->repaint(cr, scale, clip_area, _fill_polygons ? _color : base::Color::invalid());
+  }
 
   cr.restore();
 }
@@ -981,18 +1248,71 @@ spatial::Envelope spatial::Layer::get_envelope() {
 
 void Layer::render(Converter *converter) {
   _render_progress = 0.0;
-  float step = 1.0f / _features.size();
+  _index.clear();
+
+  const size_t count = _features.size();
+  std::atomic<size_t> next(0);
+  std::atomic<size_t> done(0);
+  auto render_features = [this, count, &next, &done](Converter *converter, bool report_progress) {
+    for (size_t i = next++; i < count && !_interrupt; i = next++) {
+      _features[i]->render(converter);
+      ++done;
+      if (report_progress)
+        _render_progress = (float)done / count;
+    }
+  };
+
+  // Every thread needs its own converter, the calling thread takes part with the one passed in.
+  size_t thread_count =
+    std::min<size_t>(std::thread::hardware_concurrency(), (count + MinFeaturesPerThread - 1) / MinFeaturesPerThread);
+  std::vector<std::unique_ptr<Converter> > converters;
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < thread_count; ++i) {
+    try {
+      converters.emplace_back(converter->clone());
+    } catch (std::exception &exc) {
+      logError("Unable to create a coordinate converter for a rendering thread: %s\n", exc.what());
+      break;
+    }
+    threads.emplace_back(render_features, converters.back().get(), false);
+  }
+  render_features(converter, true);
+  for (std::thread &thread : threads)
+    thread.join();
 
-  for (std::deque<spatial::Feature *>::iterator iter = _features.begin(); iter != _features.end() && !_interrupt;
-       ++iter) {
-    (*iter)->render(converter);
-    _render_progress += step;
+  if (!_interrupt)
+    build_index();
+}
+
+void Layer::build_index() {
+  std::vector<std::pair<FeatureIndex::Box, size_t> > items;
+  items.reserve(_features.size());
+  for (size_t i = 0; i < _features.size(); ++i) {
+    FeatureIndex::Box box;
+    if (_features[i]->screen_bounds(box))
+      items.push_back(std::make_pair(box, i));
   }
+  _index.build(items);
 }
 
 spatial::Feature *Layer::feature_closest(const base::Point &p, const double &allowed_distance) {
   double rval = -1;
   spatial::Feature *f = NULL;
+  if (!_index.empty()) {
+    FeatureIndex::Box area = {p.x - allowed_distance, p.y - allowed_distance, p.x + allowed_distance,
+                              p.y + allowed_distance};
+    std::vector<size_t> candidates;
+    _index.query(area, candidates);
+    for (std::vector<size_t>::const_iterator it = candidates.begin(); it != candidates.end() && !_interrupt; ++it) {
+      double dist = _features[*it]->distance(p, allowed_distance);
+      if (dist < allowed_distance && dist != -1 && (dist < rval || rval == -1)) {
+        rval = dist;
+        f = _features[*it];
+      }
+    }
+    return f;
+  }
+
   for (std::deque<spatial::Feature *>::iterator iter = _features.begin(); iter != _features.end() && !_interrupt;
        ++iter) {
     double dist = (*iter)->distance(p, allowed_distance);
@@ -1009,3 +1329,51 @@ spatial::LayerId spatial::new_layer_id() {
   static LayerId id = 0;
   return ++id;
 }
+
+void spatial::paint_layers(mdc::ImageSurface &target, const cairo_matrix_t &view, const std::deque<Layer *> &layers,
+                           float scale, int band_count, const bool &quitting) {
+  const int width = cairo_image_surface_get_width(target.get_surface());
+  const int height = cairo_image_surface_get_height(target.get_surface());
+  if (width <= 0 || height <= 0)
+    return;
+
+  band_count = std::max(1, std::min(band_count, height));
+  const int band_height = (height + band_count - 1) / band_count;
+
+  std::vector<std::shared_ptr<mdc::ImageSurface> > bands;
+  std::vector<std::thread> threads;
+  for (int top = 0; top < height; top += band_height) {
+    bands.push_back(
+      std::make_shared<mdc::ImageSurface>(width, std::min(band_height, height - top), CAIRO_FORMAT_ARGB32));
+    threads.emplace_back([&layers, &quitting, top, width, band_height, view, scale](mdc::ImageSurface *band) {
+      try {
+        mdc::CairoCtx cr(*band);
+        cr.translate(0, -top);
+        cairo_transform(cr.get_cr(), &view);
+        cr.set_line_width(0);
+
+        // The band's own device space starts at 0, the translation above already moves it to its position.
+        double left = 0, right = width, upper = 0, lower = band_height;
+        cr.device_to_user(&left, &upper);
+        cr.device_to_user(&right, &lower);
+        base::Rect visible(base::Point(left, upper), base::Point(right, lower));
+
+        for (std::deque<Layer *>::const_iterator it = layers.begin(); it != layers.end() && !quitting; ++it) {
+          if (!(*it)->hidden())
+            (*it)->repaint(cr, scale, visible);
+        }
+      } catch (std::exception &exc) {
+        logError("spatial::paint_layers: %s\n", exc.what());
+      }
+    }, bands.back().get());
+  }
+
+  for (std::thread &thread : threads)
+    thread.join();
+
+  mdc::CairoCtx cr(target);
+  for (size_t i = 0; i < bands.size(); ++i) {
+    cr.set_source_surface(bands[i]->get_surface(), 0, (double)i * band_height);
+    cr.paint();
+  }
+}
@@ -31,6 +31,7 @@
 #include <gdal/gdal_alg.h>
 #include <gdal/gdal.h>
 #include <deque>
+#include <vector>
 #include "base/geometry.h"
 #include "wbpublic_public_interface.h"
 
@@ -93,6 +94,40 @@ namespace spatial {
 
   enum AxisType { AxisLat = 1, AxisLon = 2 };
 
+  // Douglas-Peucker simplification, drops the points that are closer than tolerance to the simplified line.
+  WBPUBLICBACKEND_PUBLIC_FUNC void simplify_points(const std::vector<base::Point> &points, double tolerance,
+                                                   std::vector<base::Point> &result);
+
+  // A static R-tree over bounding boxes, bulk loaded with the Sort-Tile-Recursive algorithm.
+  class WBPUBLICBACKEND_PUBLIC_FUNC FeatureIndex {
+  public:
+    struct Box {
+      double min_x, min_y, max_x, max_y;
+      bool intersects(const Box &other) const {
+        return min_x <= other.max_x && other.min_x <= max_x && min_y <= other.max_y && other.min_y <= max_y;
+      }
+    };
+
+    void build(const std::vector<std::pair<Box, size_t> > &items);
+    void clear();
+    bool empty() const {
+      return _levels.empty();
+    }
+    // Returns the ids of all items whose box intersects area, in ascending order.
+    void query(const Box &area, std::vector<size_t> &result) const;
+
+  private:
+    struct Node {
+      Box bounds;
+      size_t first;
+      size_t count;
+    };
+    std::vector<std::pair<Box, size_t> > _items; // in packing order, the children of the leaf nodes
+    std::vector<std::vector<Node> > _levels;     // leaf nodes first, the last level holds only the root
+
+    void query_node(size_t level, const Node &node, const Box &area, std::vector<size_t> &result) const;
+  };
+
   class WBPUBLICBACKEND_PUBLIC_FUNC ShapeContainer {
   protected:
     double distance_linearring(const base::Point &p) const;
@@ -170,6 +205,10 @@ namespace spatial {
     void change_projection(OGRSpatialReference *src_srs = NULL, OGRSpatialReference *dst_srs = NULL);
     void change_projection(ProjectionView view, OGRSpatialReference *src_srs = NULL,
                            OGRSpatialReference *dst_srs = NULL);
+    Converter *clone();
+    OGRSpatialReference *target_srs() const {
+      return _target_srs;
+    }
     void from_projected(double lat, double lon, int &x, int &y);
     void to_projected(int x, int y, double &lat, double &lon);
 
@@ -181,6 +220,12 @@ namespace spatial {
     static std::string dec_to_dms(double angle, AxisType axis, int precision);
     void transform_points(std::deque<ShapeContainer> &shapes_container);
     void transform_envelope(spatial::Envelope &env);
+    // The two steps of transform_points()/transform_envelope(): the expensive reprojection, which only depends on the
+    // target projection, and the mapping of the projected coordinates to the current view.
+    void project_points(std::deque<ShapeContainer> &shapes_container);
+    void projected_to_view(std::deque<ShapeContainer> &shapes_container);
+    bool project_envelope(spatial::Envelope &env);
+    void projected_to_view(spatial::Envelope &env);
     void interrupt();
   };
 
@@ -193,6 +238,17 @@ namespace spatial {
     std::deque<ShapeContainer> _shapes;
     spatial::Envelope _env_screen;
 
+    // The shapes reprojected to _projected_srs, so that a change of the view alone doesn't need to reproject again.
+    std::deque<ShapeContainer> _projected;
+    spatial::Envelope _projected_env;
+    OGRSpatialReference *_projected_srs;
+
+    // _shapes simplified for each of the detail levels, empty where simplifying didn't save enough points.
+    std::vector<std::deque<ShapeContainer> > _simplified;
+
+    void simplify();
+    const std::deque<ShapeContainer> &shapes_for_scale(float scale) const;
+
   public:
     Feature(Layer *layer, int row_id, const std::string &data, bool wkt);
     ~Feature();
@@ -207,6 +263,7 @@ namespace spatial {
       return _row_id;
     }
     double distance(const base::Point &p, const double &allowed_distance = 4.0);
+    bool screen_bounds(FeatureIndex::Box &box) const;
   };
 
   typedef int LayerId;
@@ -225,6 +282,9 @@ namespace spatial {
     bool _interrupt;
     spatial::Envelope _spatial_envelope;
     bool _fill_polygons;
+    FeatureIndex _index; // the screen bounds of the features, rebuilt by render()
+
+    void build_index();
 
   public:
     Layer(LayerId layer_id, base::Color color);
@@ -260,5 +320,14 @@ namespace spatial {
     float query_render_progress();
     spatial::Envelope get_envelope();
   };
+
+  /**
+   * Paints the visible layers into target, which is split into band_count horizontal bands painted in parallel,
+   * each into its own image and only with the features that reach into it. view maps the layers' screen coordinates
+   * to the target. Painting stops early when quitting becomes true.
+   */
+  WBPUBLICBACKEND_PUBLIC_FUNC void paint_layers(mdc::ImageSurface &target, const cairo_matrix_t &view,
+                                                const std::deque<Layer *> &layers, float scale, int band_count,
+                                                const bool &quitting);
 };
 #endif /* SPATIAL_HANDLER_H_ */
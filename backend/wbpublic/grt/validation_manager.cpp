@@ -23,13 +23,29 @@
 
 #include "base/log.h"
 
+#include "base/string_utilities.h"
+
 #include "validation_manager.h"
 #include "grt/grt_manager.h"
+#include "grtpp_undo_manager.h"
 
 #include <algorithm>
+#include <chrono>
 
 DEFAULT_LOG_DOMAIN("validation")
 
+// Set while an IncrementalValidator runs the validators. Collects the messages instead of sending them to the
+// listeners, so that only the messages which changed are sent.
+static std::function<void(const grt::Validator::Tag &, const grt::ObjectRef &, const std::string &, const int)>
+  *collect_message = nullptr;
+
+// How long an IncrementalValidator may keep the main thread busy at a time.
+static const std::chrono::milliseconds VALIDATION_SLICE(20);
+
+// Every SWEEP_INTERVAL seconds an IncrementalValidator checks SWEEP_SIZE of the validated objects again.
+static const double SWEEP_INTERVAL = 5.0;
+static const size_t SWEEP_SIZE = 20;
+
 //--------------------------------------------------------------------------------------------------
 
 bec::ValidationMessagesBE::ValidationMessagesBE() {
@@ -174,6 +190,20 @@ void bec::ValidationManager::register_validator(const std::string& type, grt::Va
 
 //--------------------------------------------------------------------------------------------------
 
+/**
+ * Returns true if a validator is registered for any class, i.e. if validating objects can produce messages at all.
+ */
+bool bec::ValidationManager::has_validators() {
+  const std::list<grt::MetaClass*>& metaclasses(grt::GRT::get()->get_metaclasses());
+  for (std::list<grt::MetaClass*>::const_iterator iter = metaclasses.begin(); iter != metaclasses.end(); ++iter) {
+    if ((*iter)->has_validators())
+      return true;
+  }
+  return false;
+}
+
+//--------------------------------------------------------------------------------------------------
+
 void bec::ValidationManager::scan() {
   const std::vector<app_PluginRef> plugins = bec::GRTManager::get()->get_plugin_manager()->get_plugins_for_group("");
 
@@ -195,11 +225,17 @@ void bec::ValidationManager::scan() {
 //--------------------------------------------------------------------------------------------------
 
 bool bec::ValidationManager::validate_instance(const grt::ObjectRef& obj, const grt::Validator::Tag& tag) {
-  bool ret = true;
-
   // Clear messages with corresponding tag from the object.
   (*signal_notify())(tag, obj, tag, grt::NoErrorMsg);
 
+  return run_validators(obj, tag);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool bec::ValidationManager::run_validators(const grt::ObjectRef& obj, const grt::Validator::Tag& tag) {
+  bool ret = true;
+
   static const grt::MetaClass* mc_to_break_checks = grt::GRT::get()->get_metaclass("db.DatabaseObject");
   grt::MetaClass* mc = obj->get_metaclass();
 
@@ -215,6 +251,11 @@ bool bec::ValidationManager::validate_instance(const grt::ObjectRef& obj, const
 
 void bec::ValidationManager::message(const grt::Validator::Tag& tag, const grt::ObjectRef& o, const std::string& m,
                                      const int level) {
+  if (collect_message != nullptr) {
+    (*collect_message)(tag, o, m, level);
+    return;
+  }
+
   // Add message to the Object
   (*signal_notify())(tag, o, m, level);
 }
@@ -227,3 +268,461 @@ void bec::ValidationManager::clear() {
 }
 
 //--------------------------------------------------------------------------------------------------
+
+static bool is_identifier_char(char c) {
+  return isalnum((unsigned char)c) || c == '_' || c == '$' || (c & 0x80) != 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Checks whether the (lower case) text contains the given (lower case) name as a whole word. Quoted and qualified
+ * names are found too, false positives only cause an additional validation.
+ */
+static bool mentions(const std::string& text, const std::string& name) {
+  if (name.empty())
+    return false;
+
+  for (size_t pos = text.find(name); pos != std::string::npos; pos = text.find(name, pos + 1)) {
+    size_t end = pos + name.size();
+    if ((pos == 0 || !is_identifier_char(text[pos - 1])) && (end == text.size() || !is_identifier_char(text[end])))
+      return true;
+  }
+  return false;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+template <class T>
+static void append_objects(const grt::ListRef<T>& list, std::vector<grt::ObjectRef>& objects) {
+  for (typename grt::ListRef<T>::const_iterator iter = list.begin(); iter != list.end(); ++iter)
+    objects.push_back(*iter);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bec::IncrementalValidator::IncrementalValidator(const std::vector<grt::Validator::Tag>& tags)
+  : _tags(tags), _sweep_timer(NULL), _structure_changed(false), _validated_count(0) {
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bec::IncrementalValidator::~IncrementalValidator() {
+  detach();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Starts validating the given catalog and tracking its changes. Everything in the catalog is validated once,
+ * when the main thread gets idle.
+ */
+void bec::IncrementalValidator::attach(const db_CatalogRef& catalog, grt::UndoManager* undo_manager) {
+  detach();
+
+  _catalog = catalog;
+  _structure_changed = true;
+  _undo_connection = undo_manager->signal_action_added()->connect(
+    std::bind(&IncrementalValidator::action_added, this, std::placeholders::_1));
+  _sweep_timer = bec::GRTManager::get()->run_every(std::bind(&IncrementalValidator::sweep, this), SWEEP_INTERVAL);
+  schedule_validation();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Stops tracking the catalog and forgets all results. Messages already sent are not cleared, use
+ * ValidationManager::clear() for that.
+ */
+void bec::IncrementalValidator::detach() {
+  _undo_connection.disconnect();
+  _validate_connection.disconnect();
+  if (_sweep_timer != NULL) {
+    bec::GRTManager::get()->cancel_timer(_sweep_timer);
+    _sweep_timer = NULL;
+  }
+
+  _queue.clear();
+  _dirty.clear();
+  _cache.clear();
+  _changed_names.clear();
+  _sweep_position.clear();
+  _catalog.clear();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Returns the object validated for a change of the given one: the table owning a column, index etc. or the schema,
+ * table, view or routine itself. Returns an invalid ref for objects not validated (e.g. diagram figures).
+ */
+GrtNamedObjectRef bec::IncrementalValidator::validation_unit(grt::ObjectRef object) {
+  while (object.is_valid()) {
+    if (db_TableRef::can_wrap(object) || db_ViewRef::can_wrap(object) || db_RoutineRef::can_wrap(object) ||
+        db_SchemaRef::can_wrap(object))
+      return GrtNamedObjectRef::cast_from(object);
+
+    if (!GrtObjectRef::can_wrap(object))
+      break;
+    object = GrtObjectRef::cast_from(object)->owner();
+  }
+  return GrtNamedObjectRef();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void bec::IncrementalValidator::mark_dirty(const grt::ObjectRef& object) {
+  GrtNamedObjectRef unit(validation_unit(object));
+  if (unit.is_valid())
+    _dirty[unit.id()] = unit;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Called by the undo manager for each change, right after it was applied.
+ */
+void bec::IncrementalValidator::action_added(grt::UndoAction* action) {
+  grt::ObjectRef owner;
+  grt::BaseListRef list;
+  if (grt::UndoObjectChangeAction* change = dynamic_cast<grt::UndoObjectChangeAction*>(action))
+    owner = change->get_object();
+  else if (grt::UndoListInsertAction* insert = dynamic_cast<grt::UndoListInsertAction*>(action))
+    list = insert->get_list();
+  else if (grt::UndoListRemoveAction* remove = dynamic_cast<grt::UndoListRemoveAction*>(action))
+    list = remove->get_list();
+  else if (grt::UndoListSetAction* set = dynamic_cast<grt::UndoListSetAction*>(action))
+    list = set->get_list();
+  else if (grt::UndoListReorderAction* reorder = dynamic_cast<grt::UndoListReorderAction*>(action))
+    list = reorder->get_list();
+  else if (grt::UndoDictSetAction* dict_set = dynamic_cast<grt::UndoDictSetAction*>(action)) {
+    grt::internal::OwnedDict* dict = dynamic_cast<grt::internal::OwnedDict*>(dict_set->get_dict().valueptr());
+    if (dict != NULL && dict->owner_of_owned_dict() != NULL)
+      owner = grt::ObjectRef(dict->owner_of_owned_dict());
+  } else if (grt::UndoDictRemoveAction* dict_remove = dynamic_cast<grt::UndoDictRemoveAction*>(action)) {
+    grt::internal::OwnedDict* dict = dynamic_cast<grt::internal::OwnedDict*>(dict_remove->get_dict().valueptr());
+    if (dict != NULL && dict->owner_of_owned_dict() != NULL)
+      owner = grt::ObjectRef(dict->owner_of_owned_dict());
+  }
+
+  bool structure_changed = false;
+  if (list.is_valid()) {
+    grt::internal::OwnedList* owned_list = dynamic_cast<grt::internal::OwnedList*>(list.valueptr());
+    if (owned_list != NULL && owned_list->owner_of_owned_list() != NULL)
+      owner = grt::ObjectRef(owned_list->owner_of_owned_list());
+
+    // Objects might have been added to or removed from the catalog.
+    structure_changed = dynamic_cast<grt::UndoListReorderAction*>(action) == NULL;
+  }
+
+  GrtNamedObjectRef unit(validation_unit(owner));
+  if (!unit.is_valid() && !(owner.is_valid() && owner == _catalog))
+    return;
+
+  if (unit.is_valid()) {
+    _dirty[unit.id()] = unit;
+
+    // Views and routines still using the old name of a renamed table or view must be validated again too. The
+    // new name is taken from the object when the next round starts.
+    grt::UndoObjectChangeAction* change = dynamic_cast<grt::UndoObjectChangeAction*>(action);
+    if (change != NULL && change->get_object() == unit && change->get_member() == "name" &&
+        grt::StringRef::can_wrap(change->get_value()))
+      _changed_names.insert(base::tolower(*grt::StringRef::cast_from(change->get_value())));
+  }
+  if (structure_changed)
+    _structure_changed = true;
+  schedule_validation();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void bec::IncrementalValidator::schedule_validation() {
+  if (!_validate_connection.connected())
+    _validate_connection =
+      bec::GRTManager::get()->run_once_when_idle(std::bind(&IncrementalValidator::validate_pending, this));
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Validates all pending objects right away, instead of in slices whenever the main thread is idle.
+ */
+void bec::IncrementalValidator::validate_all() {
+  _validate_connection.disconnect();
+
+  while (prepare_round()) {
+    GrtNamedObjectRef unit(_queue.front());
+    _queue.pop_front();
+    validate_unit(unit);
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Timer callback. Marks the next few validated objects dirty, so that changes not seen by the undo manager are
+ * found eventually. After each pass over all objects the catalog is checked for added and removed objects too.
+ */
+bool bec::IncrementalValidator::sweep() {
+  if (!_queue.empty() || !_dirty.empty() || _cache.empty())
+    return true;
+
+  auto iter = _cache.upper_bound(_sweep_position);
+  for (size_t i = 0; i < SWEEP_SIZE; ++i, ++iter) {
+    if (iter == _cache.end()) {
+      _sweep_position.clear();
+      _structure_changed = true;
+      break;
+    }
+    _dirty[iter->first] = iter->second.first;
+    _sweep_position = iter->first;
+  }
+  schedule_validation();
+  return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+size_t bec::IncrementalValidator::pending_count() const {
+  return _dirty.size() + _queue.size();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+size_t bec::IncrementalValidator::validated_count() const {
+  return _validated_count;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Updates the dirty set after objects were added to or removed from the catalog. New objects become dirty and the
+ * messages of removed objects are cleared.
+ */
+void bec::IncrementalValidator::update_units() {
+  std::map<std::string, GrtNamedObjectRef> live;
+  grt::ListRef<db_Schema> schemata(_catalog->schemata());
+  for (grt::ListRef<db_Schema>::const_iterator schema = schemata.begin(); schema != schemata.end(); ++schema) {
+    live[(*schema).id()] = *schema;
+
+    grt::ListRef<db_Table> tables((*schema)->tables());
+    for (grt::ListRef<db_Table>::const_iterator table = tables.begin(); table != tables.end(); ++table)
+      live[(*table).id()] = *table;
+
+    grt::ListRef<db_View> views((*schema)->views());
+    for (grt::ListRef<db_View>::const_iterator view = views.begin(); view != views.end(); ++view)
+      live[(*view).id()] = *view;
+
+    grt::ListRef<db_Routine> routines((*schema)->routines());
+    for (grt::ListRef<db_Routine>::const_iterator routine = routines.begin(); routine != routines.end(); ++routine)
+      live[(*routine).id()] = *routine;
+  }
+
+  for (auto iter = _cache.begin(); iter != _cache.end();) {
+    if (live.find(iter->first) == live.end()) {
+      publish(iter->second.second, MessageList());
+      iter = _cache.erase(iter);
+    } else
+      ++iter;
+  }
+
+  for (auto iter = _dirty.begin(); iter != _dirty.end();) {
+    if (live.find(iter->first) == live.end())
+      iter = _dirty.erase(iter);
+    else
+      ++iter;
+  }
+
+  _queue.erase(std::remove_if(_queue.begin(), _queue.end(),
+                              [&live](const GrtNamedObjectRef& unit) { return live.find(unit.id()) == live.end(); }),
+               _queue.end());
+
+  for (auto& entry : live) {
+    if (_cache.find(entry.first) == _cache.end())
+      _dirty.insert(entry);
+  }
+
+  _structure_changed = false;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Adds the objects whose validation might depend on a dirty object: the tables referenced by or referencing
+ * a dirty table and the views and routines mentioning the name of a dirty table or view.
+ */
+void bec::IncrementalValidator::add_dependents() {
+  std::map<std::string, GrtNamedObjectRef> dependents;
+  std::set<std::string> dirty_tables;
+  std::set<std::string> names;
+  names.swap(_changed_names);
+
+  for (auto& entry : _dirty) {
+    if (db_TableRef::can_wrap(entry.second)) {
+      db_TableRef table(db_TableRef::cast_from(entry.second));
+      dirty_tables.insert(entry.first);
+      names.insert(base::tolower(*table->name()));
+
+      grt::ListRef<db_ForeignKey> fks(table->foreignKeys());
+      for (grt::ListRef<db_ForeignKey>::const_iterator fk = fks.begin(); fk != fks.end(); ++fk) {
+        db_TableRef referenced((*fk)->referencedTable());
+        if (referenced.is_valid())
+          dependents[referenced.id()] = referenced;
+      }
+    } else if (db_ViewRef::can_wrap(entry.second))
+      names.insert(base::tolower(*entry.second->name()));
+  }
+
+  if (names.empty())
+    return;
+
+  auto mentions_any = [&names](const std::string& definition) {
+    std::string text(base::tolower(definition));
+    for (const std::string& name : names) {
+      if (mentions(text, name))
+        return true;
+    }
+    return false;
+  };
+
+  grt::ListRef<db_Schema> schemata(_catalog->schemata());
+  for (grt::ListRef<db_Schema>::const_iterator schema = schemata.begin(); schema != schemata.end(); ++schema) {
+    grt::ListRef<db_Table> tables((*schema)->tables());
+    for (grt::ListRef<db_Table>::const_iterator table = tables.begin(); table != tables.end(); ++table) {
+      if (dirty_tables.empty())
+        break;
+      if (_dirty.find((*table).id()) != _dirty.end())
+        continue;
+
+      grt::ListRef<db_ForeignKey> fks((*table)->foreignKeys());
+      for (grt::ListRef<db_ForeignKey>::const_iterator fk = fks.begin(); fk != fks.end(); ++fk) {
+        db_TableRef referenced((*fk)->referencedTable());
+        if (referenced.is_valid() && dirty_tables.find(referenced.id()) != dirty_tables.end()) {
+          dependents[(*table).id()] = *table;
+          break;
+        }
+      }
+    }
+
+    grt::ListRef<db_View> views((*schema)->views());
+    for (grt::ListRef<db_View>::const_iterator view = views.begin(); view != views.end(); ++view) {
+      if (_dirty.find((*view).id()) == _dirty.end() && mentions_any((*view)->sqlDefinition()))
+        dependents[(*view).id()] = *view;
+    }
+
+    grt::ListRef<db_Routine> routines((*schema)->routines());
+    for (grt::ListRef<db_Routine>::const_iterator routine = routines.begin(); routine != routines.end(); ++routine) {
+      if (_dirty.find((*routine).id()) == _dirty.end() && mentions_any((*routine)->sqlDefinition()))
+        dependents[(*routine).id()] = *routine;
+    }
+  }
+
+  _dirty.insert(dependents.begin(), dependents.end());
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Validates pending objects until the time slice is used up. The rest is validated the next time the main thread
+ * is idle, so that edits are not held up by a large round.
+ */
+void bec::IncrementalValidator::validate_pending() {
+  // Still connected while called from the idle handler, which would keep schedule_validation() from working.
+  _validate_connection.disconnect();
+
+  std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now() + VALIDATION_SLICE;
+
+  while (prepare_round()) {
+    if (std::chrono::steady_clock::now() >= end) {
+      schedule_validation();
+      break;
+    }
+
+    GrtNamedObjectRef unit(_queue.front());
+    _queue.pop_front();
+    validate_unit(unit);
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Makes sure the current round has objects left, starting a new round with the dirty objects and their dependents
+ * if needed. Returns false if there is nothing to validate.
+ */
+bool bec::IncrementalValidator::prepare_round() {
+  if (!_catalog.is_valid())
+    return false;
+
+  if (_structure_changed)
+    update_units();
+
+  if (_queue.empty() && !_dirty.empty()) {
+    add_dependents();
+    for (auto& entry : _dirty)
+      _queue.push_back(entry.second);
+    _dirty.clear();
+  }
+  return !_queue.empty();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Runs the validators for the given object and its columns, indices etc. and sends the messages which changed
+ * since its last validation.
+ */
+void bec::IncrementalValidator::validate_unit(const GrtNamedObjectRef& unit) {
+  std::vector<grt::ObjectRef> objects(1, unit);
+  if (db_TableRef::can_wrap(unit)) {
+    db_TableRef table(db_TableRef::cast_from(unit));
+    append_objects(table->columns(), objects);
+    append_objects(table->indices(), objects);
+    append_objects(table->foreignKeys(), objects);
+    append_objects(table->triggers(), objects);
+  }
+
+  MessageList messages;
+  std::function<void(const grt::Validator::Tag&, const grt::ObjectRef&, const std::string&, const int)> collector =
+    [&messages](const grt::Validator::Tag& tag, const grt::ObjectRef& object, const std::string& text,
+                const int level) { messages.push_back({ object, tag, text, level }); };
+  collect_message = &collector;
+
+  for (const grt::ObjectRef& object : objects) {
+    for (const grt::Validator::Tag& tag : _tags) {
+      try {
+        ValidationManager::run_validators(object, tag);
+      } catch (std::exception& exc) {
+        logError("Validating %s (%s) failed: %s\n", object.id().c_str(), tag.c_str(), exc.what());
+      }
+    }
+  }
+  collect_message = nullptr;
+  ++_validated_count;
+
+  std::pair<GrtNamedObjectRef, MessageList>& entry = _cache[unit.id()];
+  if (!(entry.second == messages))
+    publish(entry.second, messages);
+  entry.first = unit;
+  entry.second.swap(messages);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void bec::IncrementalValidator::publish(const MessageList& old_messages, const MessageList& new_messages) {
+  std::set<std::pair<std::string, grt::Validator::Tag> > cleared;
+  auto clear = [&cleared](const Message& message) {
+    if (cleared.insert(std::make_pair(message.object.id(), message.tag)).second)
+      (*ValidationManager::signal_notify())(message.tag, message.object, message.tag, grt::NoErrorMsg);
+  };
+
+  for (const Message& message : old_messages)
+    clear(message);
+  for (const Message& message : new_messages)
+    clear(message);
+
+  for (const Message& message : new_messages)
+    (*ValidationManager::signal_notify())(message.tag, message.object, message.text, message.level);
+}
+
+//--------------------------------------------------------------------------------------------------
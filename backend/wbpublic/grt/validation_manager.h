@@ -26,9 +26,13 @@
 #include "wbpublic_public_interface.h"
 #include "grt.h"
 #include "grts/structs.app.h"
+#include "grts/structs.db.h"
+#include "grt/grt_manager.h"
 #include "tree_model.h"
 #include "refresh_ui.h"
 #include <deque>
+#include <map>
+#include <set>
 
 // Common tag names
 #define CHECK_NAME "name"
@@ -36,6 +40,10 @@
 #define CHECK_EFFICIENCY "efficiency"
 #define CHECK_LOGIC "logic"
 
+namespace grt {
+  class UndoAction;
+}
+
 namespace bec {
 
   class GRTManager;
@@ -91,6 +99,7 @@ namespace bec {
 
     static void scan();
     static void register_validator(const std::string& type, grt::Validator* v);
+    static bool has_validators();
     static bool validate_instance(const grt::ObjectRef& obj, const grt::Validator::Tag& tag);
 
     static MessageSignal* signal_notify();
@@ -99,11 +108,83 @@ namespace bec {
     static void clear();
 
   private:
+    friend class IncrementalValidator;
+
     static bool is_validation_plugin(const app_PluginRef& plugin);
+    static bool run_validators(const grt::ObjectRef& obj, const grt::Validator::Tag& tag);
 
     static MessageSignal* _signal_notify;
   };
 
+  //------------------------------------------------------------------------------
+
+  /**
+   * Keeps the validation messages of a catalog up to date without checking the whole catalog after each change.
+   *
+   * Changes are taken from the undo manager, which reports them right after they were applied (also while undo
+   * recording is disabled). The schemata, tables, views and routines they touch are marked dirty and validated
+   * again when the main thread is idle, together with the objects depending on them (tables referencing or
+   * referenced by a dirty table, views and routines mentioning the name of a dirty table or view). Validation runs
+   * in short slices, so large rounds don't block the UI. The messages of each object are cached and only those which
+   * changed are sent through ValidationManager::signal_notify().
+   *
+   * Changes made while the GRT doesn't track changes reach no undo manager. To pick them up eventually, a few of the
+   * validated objects are checked again every few seconds, in turns.
+   */
+  class WBPUBLICBACKEND_PUBLIC_FUNC IncrementalValidator {
+  public:
+    IncrementalValidator(const std::vector<grt::Validator::Tag>& tags);
+    ~IncrementalValidator();
+
+    void attach(const db_CatalogRef& catalog, grt::UndoManager* undo_manager);
+    void detach();
+
+    void mark_dirty(const grt::ObjectRef& object);
+    void validate_pending();
+    void validate_all();
+
+    size_t pending_count() const;
+    size_t validated_count() const;
+
+  private:
+    struct Message {
+      grt::ObjectRef object;
+      grt::Validator::Tag tag;
+      std::string text;
+      int level;
+
+      bool operator==(const Message& other) const {
+        return object == other.object && tag == other.tag && text == other.text && level == other.level;
+      }
+    };
+    typedef std::vector<Message> MessageList;
+
+    void action_added(grt::UndoAction* action);
+    void schedule_validation();
+    bool sweep();
+    bool prepare_round();
+    void validate_unit(const GrtNamedObjectRef& unit);
+    void publish(const MessageList& old_messages, const MessageList& new_messages);
+
+    void update_units();
+    void add_dependents();
+    static GrtNamedObjectRef validation_unit(grt::ObjectRef object);
+
+    std::vector<grt::Validator::Tag> _tags;
+    db_CatalogRef _catalog;
+    boost::signals2::scoped_connection _undo_connection;
+    boost::signals2::connection _validate_connection;
+    GRTManager::Timer* _sweep_timer;
+    std::string _sweep_position; // Id of the last object checked again by sweep().
+
+    std::map<std::string, GrtNamedObjectRef> _dirty;
+    std::deque<GrtNamedObjectRef> _queue; // The current round.
+    std::map<std::string, std::pair<GrtNamedObjectRef, MessageList> > _cache;
+    std::set<std::string> _changed_names; // Names of changed tables and views, as they were before the change.
+    bool _structure_changed;
+    size_t _validated_count;
+  };
+
   //------------------------------------------------------------------------------
   inline bec::ValidationManager::MessageSignal* bec::ValidationManager::signal_notify() {
     if (!_signal_notify)
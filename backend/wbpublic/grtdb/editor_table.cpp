@@ -2901,8 +2901,9 @@ NodeId TableEditorBE::add_fk_with_columns(const std::vector<NodeId> &columns) {
   return id;
 }
 
-void TableEditorBE::undo_called(grt::UndoAction *action, grt::UndoAction *expected) {
-  if (action == expected)
+// Actions are compared by serial, the expected one may have been dropped from the history and its address reused.
+void TableEditorBE::undo_called(grt::UndoAction *action, size_t expected_serial) {
+  if (action != nullptr && action->serial() == expected_serial)
     do_ui_refresh();
 }
 
@@ -2987,9 +2988,9 @@ bool TableEditorBE::parse_column_type(const std::string &str, db_ColumnRef &colu
     // call _refresh_ui when this parse column type action is undone
     // XXX: everytime we parse a column type 2 new connections are added without removing the old ones!
     scoped_connect(um->signal_undo(),
-                   std::bind(&TableEditorBE::undo_called, this, std::placeholders::_1, um->get_latest_undo_action()));
+                   std::bind(&TableEditorBE::undo_called, this, std::placeholders::_1, um->get_latest_undo_serial()));
     scoped_connect(um->signal_redo(),
-                   std::bind(&TableEditorBE::undo_called, this, std::placeholders::_1, um->get_latest_undo_action()));
+                   std::bind(&TableEditorBE::undo_called, this, std::placeholders::_1, um->get_latest_undo_serial()));
   }
   return flag;
 }
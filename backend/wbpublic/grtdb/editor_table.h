@@ -364,7 +364,7 @@ namespace bec {
   protected:
     FKConstraintListBE _fk_list;
 
-    void undo_called(grt::UndoAction *action, grt::UndoAction *expected);
+    void undo_called(grt::UndoAction *action, size_t expected_serial);
 
   private:
     mforms::Box *_inserts_panel;
@@ -74,6 +74,19 @@ static grt::StringRef getGeoRepresentation(grt::StringRef data, bool outputAsJso
   return grt::StringRef();
 }
 
+// Flags the columns listed in the given list, ignoring indexes out of range.
+static std::vector<bool> columnFlags(const grt::IntegerListRef &columns, size_t columnCount) {
+  std::vector<bool> flags(columnCount, false);
+  if (columns.is_valid()) {
+    for (size_t i = 0; i < columns.count(); ++i) {
+      ssize_t column = *columns[i];
+      if (column >= 0 && (size_t)column < columnCount)
+        flags[column] = true;
+    }
+  }
+  return flags;
+}
+
 WBRecordsetResultset::WBRecordsetResultset(db_query_ResultsetRef aself, std::shared_ptr<Recordset> rset)
   : db_query_Resultset::ImplData(aself), cursor(0), recordset(rset) {
   const size_t last_column = recordset->get_column_count();
@@ -109,6 +122,7 @@ WBRecordsetResultset::WBRecordsetResultset(db_query_ResultsetRef aself, std::sha
     column->columnType(type);
 
     self->columns().insert(column);
+    column_types.push_back(recordset->get_column_type(i));
   }
 }
 
@@ -201,6 +215,57 @@ grt::IntegerRef WBRecordsetResultset::previousRow() {
   return grt::IntegerRef(0);
 }
 
+grt::BaseListRef WBRecordsetResultset::fetchRows(ssize_t count) {
+  grt::BaseListRef rows(true);
+  const size_t row_count = recordset->count();
+  for (; count > 0 && cursor < row_count; --count, ++cursor) {
+    bec::NodeId node(cursor);
+    grt::BaseListRef row(true);
+    for (size_t i = 0; i < column_types.size(); ++i) {
+      if (recordset->is_field_null(node, i)) {
+        row.ginsert(grt::ValueRef());
+        continue;
+      }
+
+      switch (column_types[i]) {
+        case bec::GridModel::NumericType: {
+          ssize_t value = 0;
+          recordset->get_field(node, i, value);
+          row.ginsert(grt::IntegerRef(value));
+          break;
+        }
+        case bec::GridModel::FloatType: {
+          double value = 0.0;
+          recordset->get_field(node, i, value);
+          row.ginsert(grt::DoubleRef(value));
+          break;
+        }
+        default: {
+          std::string value;
+          recordset->get_field_repr_no_truncate(node, i, value);
+          row.ginsert(grt::StringRef(value));
+          break;
+        }
+      }
+    }
+    rows.ginsert(row);
+  }
+  return rows;
+}
+
+grt::BaseListRef WBRecordsetResultset::fetchStringRows(ssize_t count, const grt::IntegerListRef &wktColumns) {
+  std::vector<bool> wkt(columnFlags(wktColumns, column_types.size()));
+  grt::BaseListRef rows(true);
+  const size_t row_count = recordset->count();
+  for (; count > 0 && cursor < row_count; --count, ++cursor) {
+    grt::BaseListRef row(true);
+    for (size_t i = 0; i < wkt.size(); ++i)
+      row.ginsert(wkt[i] ? geoStringFieldValue(i) : stringFieldValue(i));
+    rows.ginsert(row);
+  }
+  return rows;
+}
+
 void WBRecordsetResultset::refresh() {
   recordset->refresh();
 }
@@ -252,7 +317,30 @@ grt::IntegerRef WBRecordsetResultset::saveFieldValueToFile(ssize_t column, const
 //================================================================================
 
 class WBPUBLICBACKEND_PUBLIC_FUNC CPPResultsetResultset : public db_query_Resultset::ImplData {
+  enum FieldKind { IntegerField, DoubleField, GeometryField, StringField };
+
   std::shared_ptr<sql::ResultSet> recordset;
+  std::vector<FieldKind> field_kinds; // How fetchRows() reads each column, resolved once from the metadata.
+
+  static FieldKind field_kind(int type) {
+    switch (type) {
+      case sql::DataType::BIT:
+      case sql::DataType::TINYINT:
+      case sql::DataType::SMALLINT:
+      case sql::DataType::MEDIUMINT:
+      case sql::DataType::INTEGER:
+      case sql::DataType::BIGINT:
+      case sql::DataType::YEAR:
+        return IntegerField;
+      case sql::DataType::REAL:
+      case sql::DataType::DOUBLE:
+        return DoubleField;
+      case sql::DataType::GEOMETRY:
+        return GeometryField;
+      default:
+        return StringField;
+    }
+  }
 
 public:
   CPPResultsetResultset(db_query_ResultsetRef aself, std::shared_ptr<sql::ResultSet> rset)
@@ -333,6 +421,7 @@ public:
       column->columnType(type);
 
       self->columns().insert(column);
+      field_kinds.push_back(field_kind(meta->getColumnType(i)));
     }
   }
 
@@ -407,6 +496,77 @@ public:
     return grt::IntegerRef(recordset->previous());
   }
 
+  virtual grt::BaseListRef fetchRows(ssize_t count) {
+    grt::BaseListRef rows(true);
+    if (recordset->rowsCount() == 0 || (recordset->isBeforeFirst() && !recordset->next()))
+      return rows;
+
+    for (; count > 0 && !recordset->isAfterLast(); --count) {
+      grt::BaseListRef row(true);
+      for (uint32_t i = 1; i <= (uint32_t)field_kinds.size(); ++i) {
+        if (recordset->isNull(i)) {
+          row.ginsert(grt::ValueRef());
+          continue;
+        }
+
+        switch (field_kinds[i - 1]) {
+          case IntegerField:
+#ifdef ENVIRONMENT_64
+            row.ginsert(grt::IntegerRef((size_t)recordset->getInt64(i)));
+#else
+            row.ginsert(grt::IntegerRef(recordset->getInt(i)));
+#endif
+            break;
+          case DoubleField:
+            row.ginsert(grt::DoubleRef(recordset->getDouble(i)));
+            break;
+          case GeometryField:
+            try {
+              row.ginsert(getGeoRepresentation(grt::StringRef(recordset->getString(i)), false));
+            } catch (std::exception &) {
+              throw std::invalid_argument(
+                base::strfmt("unable to convert geometry data to WKT for column %li", (long)i - 1).c_str());
+            }
+            break;
+          case StringField:
+            row.ginsert(grt::StringRef(recordset->getString(i)));
+            break;
+        }
+      }
+      rows.ginsert(row);
+      recordset->next();
+    }
+    return rows;
+  }
+
+  virtual grt::BaseListRef fetchStringRows(ssize_t count, const grt::IntegerListRef &wktColumns) {
+    std::vector<bool> wkt(columnFlags(wktColumns, field_kinds.size()));
+    grt::BaseListRef rows(true);
+    if (recordset->rowsCount() == 0 || (recordset->isBeforeFirst() && !recordset->next()))
+      return rows;
+
+    for (; count > 0 && !recordset->isAfterLast(); --count) {
+      grt::BaseListRef row(true);
+      for (uint32_t i = 1; i <= (uint32_t)wkt.size(); ++i) {
+        grt::StringRef data(recordset->getString(i));
+        if (!wkt[i - 1]) {
+          row.ginsert(data);
+          continue;
+        }
+
+        try {
+          row.ginsert(getGeoRepresentation(data, false));
+        } catch (std::exception &) {
+          throw std::invalid_argument(
+            base::strfmt("unable to convert geometry data to WKT for column %li", (long)i - 1).c_str());
+        }
+      }
+      rows.ginsert(row);
+      recordset->next();
+    }
+    return rows;
+  }
+
   virtual void refresh() {
   }
 
@@ -573,6 +733,14 @@ grt::IntegerRef db_query_Resultset::previousRow() {
   return _data ? _data->previousRow() : grt::IntegerRef(0);
 }
 
+grt::BaseListRef db_query_Resultset::fetchRows(ssize_t count) {
+  return _data ? _data->fetchRows(count) : grt::BaseListRef(true);
+}
+
+grt::BaseListRef db_query_Resultset::fetchStringRows(ssize_t count, const grt::IntegerListRef &wktColumns) {
+  return _data ? _data->fetchStringRows(count, wktColumns) : grt::BaseListRef(true);
+}
+
 grt::IntegerRef db_query_Resultset::refresh() {
   if (_data)
     _data->refresh();
@@ -56,6 +56,8 @@ public:
   virtual grt::IntegerRef intFieldValueByName(const std::string &column) = 0;
   virtual grt::IntegerRef nextRow() = 0;
   virtual grt::IntegerRef previousRow() = 0;
+  virtual grt::BaseListRef fetchRows(ssize_t count) = 0;
+  virtual grt::BaseListRef fetchStringRows(ssize_t count, const grt::IntegerListRef &wktColumns) = 0;
   virtual grt::IntegerRef saveFieldValueToFile(ssize_t column, const std::string &file) = 0;
   virtual grt::StringRef stringFieldValue(ssize_t column) = 0;
   virtual grt::StringRef stringFieldValueByName(const std::string &column) = 0;
@@ -69,6 +71,7 @@ class WBPUBLICBACKEND_PUBLIC_FUNC WBRecordsetResultset : public db_query_Results
 public:
   size_t cursor;
   std::shared_ptr<Recordset> recordset;
+  std::vector<bec::GridModel::ColumnType> column_types;
 
   WBRecordsetResultset(db_query_ResultsetRef aself, std::shared_ptr<Recordset> rset);
   virtual grt::StringRef sql() const;
@@ -83,6 +86,8 @@ public:
   virtual grt::IntegerRef intFieldValueByName(const std::string &column);
   virtual grt::IntegerRef nextRow();
   virtual grt::IntegerRef previousRow();
+  virtual grt::BaseListRef fetchRows(ssize_t count);
+  virtual grt::BaseListRef fetchStringRows(ssize_t count, const grt::IntegerListRef &wktColumns);
 
   virtual void refresh();
   virtual grt::StringRef stringFieldValue(ssize_t column);
@@ -0,0 +1,284 @@
+/*
+ * Copyright (c) 2020, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#include <sqlite/execute.hpp>
+#include <sqlite/query.hpp>
+#include <sqlite/database_exception.hpp>
+
+#include "base/log.h"
+#include "base/file_utilities.h"
+#include "base/boost_smart_ptr_helpers.h"
+#include "grt/common.h"
+#include "sqlide_generics.h"
+
+#include "completion_cache.h"
+
+DEFAULT_LOG_DOMAIN("completion_cache");
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CompletionCache::CompletionCache(const std::string &connection_id, const std::string &cache_dir)
+  : _connection_id(connection_id) {
+  std::string path = base::makePath(cache_dir, connection_id) + ".completion_cache";
+  _sqconn = new sqlite::connection(path);
+  sqlite::execute(*_sqconn, "PRAGMA temp_store=MEMORY", true);
+  sqlite::execute(*_sqconn, "PRAGMA synchronous=NORMAL", true);
+
+  logDebug2("Using completion cache file %s\n", path.c_str());
+
+  // Check if the DB is already initialized.
+  sqlite::query q(*_sqconn, "select name from sqlite_master where type='table'");
+  int found = 0;
+  if (q.emit()) {
+    std::shared_ptr<sqlite::result> res(BoostHelper::convertPointer(q.get_result()));
+    do {
+      std::string name = res->get_string(0);
+      if (name == "objects" || name == "columns")
+        found++;
+    } while (res->next_row());
+  }
+  if (found < 2) {
+    logDebug3("Initializing cache\n");
+    init_db();
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CompletionCache::~CompletionCache() {
+  delete _sqconn;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void CompletionCache::init_db() {
+  std::vector<std::string> code = {
+    "drop table if exists objects",
+    "drop table if exists columns",
+    "create table objects (schema_name varchar(64) not null, object_name varchar(64) not null, "
+    "object_type int not null, stamp varchar(64), primary key (schema_name, object_name, object_type))",
+    "create table columns (schema_name varchar(64) not null, object_name varchar(64) not null, "
+    "position int not null, column_name varchar(64) not null, primary key (schema_name, object_name, position))"
+  };
+
+  logInfo("Initializing completion cache for %s\n", _connection_id.c_str());
+  for (auto &statement : code) {
+    try {
+      sqlite::execute(*_sqconn, statement, true);
+    } catch (std::exception &exc) {
+      logError("Error creating cache %s: %s\n", statement.c_str(), exc.what());
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::vector<std::string> CompletionCache::cachedSchemas() {
+  std::lock_guard<std::mutex> lock(_mutex);
+  std::vector<std::string> result;
+  try {
+    sqlite::query q(*_sqconn, "select distinct schema_name from objects");
+    if (q.emit()) {
+      std::shared_ptr<sqlite::result> res(BoostHelper::convertPointer(q.get_result()));
+      do {
+        result.push_back(res->get_string(0));
+      } while (res->next_row());
+    }
+  } catch (std::exception &exc) {
+    logError("Error reading schema list from completion cache: %s\n", exc.what());
+  }
+  return result;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::vector<CompletionCache::SchemaObject> CompletionCache::schemaObjects(const std::string &schema) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  std::vector<SchemaObject> result;
+  try {
+    std::map<std::string, size_t> columnOwners;
+    {
+      sqlite::query q(*_sqconn, "select object_name, object_type, stamp from objects where schema_name = ?");
+      q.bind(1, schema);
+      if (q.emit()) {
+        std::shared_ptr<sqlite::result> res(BoostHelper::convertPointer(q.get_result()));
+        do {
+          SchemaObject object;
+          object.name = res->get_string(0);
+          object.type = static_cast<ObjectType>(res->get_int(1));
+          object.stamp = res->get_string(2);
+          if (object.type == Table || object.type == View)
+            columnOwners[object.name] = result.size();
+          result.push_back(object);
+        } while (res->next_row());
+      }
+    }
+
+    sqlite::query q(*_sqconn, "select object_name, column_name from columns where schema_name = ? "
+                              "order by object_name, position");
+    q.bind(1, schema);
+    if (q.emit()) {
+      std::shared_ptr<sqlite::result> res(BoostHelper::convertPointer(q.get_result()));
+      do {
+        auto owner = columnOwners.find(res->get_string(0));
+        if (owner != columnOwners.end())
+          result[owner->second].columns.push_back(res->get_string(1));
+      } while (res->next_row());
+    }
+  } catch (std::exception &exc) {
+    logError("Error reading schema %s from completion cache: %s\n", schema.c_str(), exc.what());
+  }
+  return result;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Compares the objects currently on the server with the cached ones. Objects which are new, whose stamp changed or
+ * which have no stamp at all go to changed (without columns). Cached objects which are not in the current list go to
+ * removed.
+ */
+void CompletionCache::compareObjects(const std::string &schema, const std::vector<SchemaObject> &current,
+                                     std::vector<SchemaObject> &changed, std::vector<SchemaObject> &removed) {
+  std::map<std::pair<int, std::string>, std::string> cachedStamps;
+  for (auto &object : schemaObjects(schema))
+    cachedStamps[{ object.type, object.name }] = object.stamp;
+
+  for (auto &object : current) {
+    auto entry = cachedStamps.find({ object.type, object.name });
+    if (entry == cachedStamps.end() || object.stamp.empty() || entry->second != object.stamp)
+      changed.push_back({ object.name, object.type, object.stamp, {} });
+    if (entry != cachedStamps.end())
+      cachedStamps.erase(entry);
+  }
+
+  for (auto &entry : cachedStamps)
+    removed.push_back({ entry.first.second, static_cast<ObjectType>(entry.first.first), "", {} });
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Adds or replaces the given objects. For tables and views the column list is replaced as well.
+ */
+void CompletionCache::storeObjects(const std::string &schema, const std::vector<SchemaObject> &objects) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  try {
+    sqlide::Sqlite_transaction_guarder transaction(_sqconn);
+    sqlite::query insertObject(*_sqconn, "insert or replace into objects values (?, ?, ?, ?)");
+    sqlite::query deleteColumns(*_sqconn, "delete from columns where schema_name = ? and object_name = ?");
+    sqlite::query insertColumn(*_sqconn, "insert or replace into columns values (?, ?, ?, ?)");
+    for (auto &object : objects) {
+      insertObject.bind(1, schema);
+      insertObject.bind(2, object.name);
+      insertObject.bind(3, (int)object.type);
+      insertObject.bind(4, object.stamp);
+      insertObject.emit();
+      insertObject.clear();
+
+      if (object.type != Table && object.type != View)
+        continue;
+
+      deleteColumns.bind(1, schema);
+      deleteColumns.bind(2, object.name);
+      deleteColumns.emit();
+      deleteColumns.clear();
+
+      for (size_t i = 0; i < object.columns.size(); ++i) {
+        insertColumn.bind(1, schema);
+        insertColumn.bind(2, object.name);
+        insertColumn.bind(3, (int)i);
+        insertColumn.bind(4, object.columns[i]);
+        insertColumn.emit();
+        insertColumn.clear();
+      }
+    }
+  } catch (std::exception &exc) {
+    logError("Error storing objects of schema %s in completion cache: %s\n", schema.c_str(), exc.what());
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void CompletionCache::removeObjects(const std::string &schema, const std::vector<SchemaObject> &objects) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  try {
+    sqlide::Sqlite_transaction_guarder transaction(_sqconn);
+    sqlite::query deleteObject(*_sqconn,
+                               "delete from objects where schema_name = ? and object_name = ? and object_type = ?");
+    sqlite::query deleteColumns(*_sqconn, "delete from columns where schema_name = ? and object_name = ?");
+    for (auto &object : objects) {
+      deleteObject.bind(1, schema);
+      deleteObject.bind(2, object.name);
+      deleteObject.bind(3, (int)object.type);
+      deleteObject.emit();
+      deleteObject.clear();
+
+      if (object.type != Table && object.type != View)
+        continue;
+
+      deleteColumns.bind(1, schema);
+      deleteColumns.bind(2, object.name);
+      deleteColumns.emit();
+      deleteColumns.clear();
+    }
+  } catch (std::exception &exc) {
+    logError("Error removing objects of schema %s from completion cache: %s\n", schema.c_str(), exc.what());
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void CompletionCache::removeSchema(const std::string &schema) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  try {
+    sqlide::Sqlite_transaction_guarder transaction(_sqconn);
+    sqlite::query deleteObjects(*_sqconn, "delete from objects where schema_name = ?");
+    deleteObjects.bind(1, schema);
+    deleteObjects.emit();
+
+    sqlite::query deleteColumns(*_sqconn, "delete from columns where schema_name = ?");
+    deleteColumns.bind(1, schema);
+    deleteColumns.emit();
+  } catch (std::exception &exc) {
+    logError("Error removing schema %s from completion cache: %s\n", schema.c_str(), exc.what());
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Removes all schemas, e.g. when the cached data can't be trusted anymore.
+ */
+void CompletionCache::clear() {
+  std::lock_guard<std::mutex> lock(_mutex);
+  try {
+    sqlide::Sqlite_transaction_guarder transaction(_sqconn);
+    sqlite::execute(*_sqconn, "delete from objects", true);
+    sqlite::execute(*_sqconn, "delete from columns", true);
+  } catch (std::exception &exc) {
+    logError("Error clearing completion cache: %s\n", exc.what());
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
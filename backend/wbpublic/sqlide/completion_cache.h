@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2020, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#pragma once
+
+#include <sqlite/connection.hpp>
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * Persistent store for the schema object names used by code completion, one file per connection.
+ * It allows to fill the completion symbol table right after connecting, without waiting for the server.
+ * Each object carries a stamp (built from its creation and modification times, or its definition for views),
+ * which is used to find out which objects must be refreshed from the server.
+ */
+class WBPUBLICBACKEND_PUBLIC_FUNC CompletionCache {
+public:
+  enum ObjectType { Table, View, Procedure, Function };
+
+  struct SchemaObject {
+    std::string name;
+    ObjectType type;
+    std::string stamp;
+    std::vector<std::string> columns; // Only for tables and views.
+  };
+
+  CompletionCache(const std::string &connection_id, const std::string &cache_dir);
+  virtual ~CompletionCache();
+
+  std::vector<std::string> cachedSchemas();
+  std::vector<SchemaObject> schemaObjects(const std::string &schema);
+
+  void compareObjects(const std::string &schema, const std::vector<SchemaObject> &current,
+                      std::vector<SchemaObject> &changed, std::vector<SchemaObject> &removed);
+
+  void storeObjects(const std::string &schema, const std::vector<SchemaObject> &objects);
+  void removeObjects(const std::string &schema, const std::vector<SchemaObject> &objects);
+  void removeSchema(const std::string &schema);
+  void clear();
+
+private:
+  std::string _connection_id;
+  sqlite::connection *_sqconn;
+  std::mutex _mutex;
+
+  void init_db();
+};
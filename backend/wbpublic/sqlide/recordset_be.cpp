@@ -132,6 +132,7 @@ bool Recordset::reset(Recordset_data_storage::Ptr data_storage_ptr, bool rethrow
   _sort_columns.clear();
   _column_filter_expr_map.clear();
   _data_search_string.clear();
+  drop_index_data();
 
   RETAIN_WEAK_PTR(Recordset_data_storage, data_storage_ptr, data_storage)
   if (data_storage) {
@@ -309,6 +310,7 @@ void Recordset::recalc_row_count(sqlite::connection *data_swap_db) {
 Recordset::Cell Recordset::cell(RowId row, ColumnId column) {
   if (_row_count == row) {
     RowId rowid = _next_new_rowid++; // rowid of the new record
+    drop_index_data();
     {
       std::shared_ptr<sqlite::connection> data_swap_db = this->data_swap_db();
       sqlide::Sqlite_transaction_guarder transaction_guarder(data_swap_db.get());
@@ -370,6 +372,8 @@ void Recordset::mark_dirty(RowId row, ColumnId column, const sqlite::variant_t &
   RowId rowid(row);
   NodeId node(row);
   if (get_field_(node, _rowid_column, (ssize_t &)rowid)) {
+    drop_index_data();
+
     std::shared_ptr<sqlite::connection> data_swap_db = this->data_swap_db();
     sqlide::Sqlite_transaction_guarder transaction_guarder(data_swap_db.get());
 
@@ -425,6 +429,7 @@ bool Recordset::delete_nodes(std::vector<bec::NodeId> &nodes) {
         return false;
     }
 
+    drop_index_data();
     for (auto &node : nodes) {
       node[0] -= processed_node_count;
       RowId row = node[0];
@@ -816,105 +821,126 @@ void Recordset::reset_data_search_string() {
   rebuild_data_index(data_swap_db.get(), true, true);
 }
 
+void Recordset::drop_index_data() {
+  base::RecMutexLock data_mutex(_data_mutex);
+  _index_row_ids.reset();
+  _index_columns.clear();
+}
+
+const sqlide::IndexColumn &Recordset::index_column(sqlite::connection *data_swap_db, ColumnId column,
+                                                   sqlide::IndexColumn::Collation collation) {
+  std::shared_ptr<sqlide::IndexColumn> &values = _index_columns[std::make_pair(column, (int)collation)];
+  if (values)
+    return *values;
+
+  values.reset(new sqlide::IndexColumn(collation));
+  values->reserve(_index_row_ids->size());
+
+  // Same row order as for the row ids, so that row numbers can be used across columns.
+  bool numeric = collation == sqlide::IndexColumn::Numeric;
+  std::string partition_suffix = data_swap_db_partition_suffix(data_swap_db_column_partition(column));
+  sqlite::query q(*data_swap_db, strfmt("select `_%u` is null, cast(`_%u` as %s) from `data%s` order by rowid",
+                                        (unsigned int)column, (unsigned int)column, numeric ? "numeric" : "text",
+                                        partition_suffix.c_str()));
+  if (q.emit()) {
+    std::shared_ptr<sqlite::result> rs = BoostHelper::convertPointer(q.get_result());
+    sqlide::VarToLongDouble to_number;
+    do {
+      if (rs->get_int(0) != 0)
+        values->addNull();
+      else if (numeric) {
+        sqlite::variant_t number = rs->get_variant(1);
+        values->addNumber(boost::apply_visitor(to_number, number));
+      } else {
+        std::string text = rs->get_string(1);
+        values->addText(text.data(), text.size());
+      }
+    } while (rs->next_row());
+  }
+
+  return *values;
+}
+
 void Recordset::rebuild_data_index(sqlite::connection *data_swap_db, bool do_cache_data_frame, bool do_refresh_ui) {
   {
     base::RecMutexLock data_mutex(_data_mutex);
 
-    std::string where_clause;
-    {
-      sqlide::QuoteVar qv;
-      {
-        qv.escape_string = std::bind(sqlide::QuoteVar::escape_ansi_sql_string, std::placeholders::_1);
-        qv.store_unknown_as_string = true;
-        qv.allow_func_escaping = false;
+    // Filtering and sorting happen in memory, on column values loaded once from the swap db (and kept until the
+    // data changes). Only the resulting row order goes back into the swap db, for the data frame cache.
+    std::vector<size_t> rows;
+    bool use_all_rows = _column_filter_expr_map.empty() && _data_search_string.empty() && _sort_columns.empty();
+    if (!use_all_rows) {
+      if (!_index_row_ids) {
+        _index_row_ids.reset(new std::vector<int>());
+        sqlite::query q(*data_swap_db, "select `id` from `data` order by rowid");
+        if (q.emit()) {
+          std::shared_ptr<sqlite::result> rs = BoostHelper::convertPointer(q.get_result());
+          do {
+            _index_row_ids->push_back(rs->get_int(0));
+          } while (rs->next_row());
+        }
       }
-      sqlite::variant_t var_string_type = std::string();
-      sqlite::variant_t var_string;
-      std::string sql_string;
 
-      // column filters subclause
-      std::string where_subclause1;
-      {
-        for (auto &column_filter_expr : _column_filter_expr_map) {
-          var_string = column_filter_expr.second;
-          sql_string = boost::apply_visitor(qv, var_string_type, var_string);
-          where_subclause1 += strfmt("_%u like %s and ", (unsigned int)column_filter_expr.first, sql_string.c_str());
-        }
-        if (!where_subclause1.empty()) {
-          where_subclause1.resize(where_subclause1.size() - std::string(" and ").size());
-          where_subclause1.insert(0, "(");
-          where_subclause1.append(")");
+      size_t row_count = _index_row_ids->size();
+      std::vector<char> keep(row_count, 1);
+
+      for (auto &column_filter_expr : _column_filter_expr_map) {
+        const sqlide::IndexColumn &values =
+          index_column(data_swap_db, column_filter_expr.first, sqlide::IndexColumn::Binary);
+        for (size_t row = 0; row < row_count; ++row) {
+          if (keep[row] && !values.matchesPattern(row, column_filter_expr.second))
+            keep[row] = 0;
         }
       }
 
-      // data search subclause
-      std::string where_subclause2;
       if (!_data_search_string.empty()) {
-        var_string = "%" + _data_search_string + "%";
-        sql_string = boost::apply_visitor(qv, var_string_type, var_string);
+        // Like the former "like '%...%'" search wildcards in the search string are honored, which needs the
+        // slower pattern matcher. Otherwise a plain (case insensitive) substring scan is enough.
+        bool has_wildcards = _data_search_string.find_first_of("%_") != std::string::npos;
+        std::string pattern = "%" + _data_search_string + "%";
+
+        std::vector<char> found(row_count, 0);
         for (ColumnId column = 0, column_count = get_column_count(); column < column_count; ++column) {
-          where_subclause2 += strfmt("_%u like %s or ", (unsigned int)column, sql_string.c_str());
-        }
-        if (!where_subclause2.empty()) {
-          where_subclause2.resize(where_subclause2.size() - std::string(" or ").size());
-          where_subclause2.insert(0, "(");
-          where_subclause2.append(")");
+          const sqlide::IndexColumn &values = index_column(data_swap_db, column, sqlide::IndexColumn::Binary);
+          if (has_wildcards) {
+            for (size_t row = 0; row < row_count; ++row) {
+              if (!found[row] && values.matchesPattern(row, pattern))
+                found[row] = 1;
+            }
+          } else
+            values.markRowsContaining(_data_search_string, found);
         }
+
+        for (size_t row = 0; row < row_count; ++row)
+          keep[row] = keep[row] && found[row];
       }
 
-      if (!where_subclause1.empty() || !where_subclause2.empty()) {
-        std::string subclauses_mediator = (!where_subclause1.empty() && !where_subclause2.empty()) ? " and " : "";
-        where_clause =
-          strfmt("where %s%s%s", where_subclause1.c_str(), subclauses_mediator.c_str(), where_subclause2.c_str());
+      rows.reserve(row_count);
+      for (size_t row = 0; row < row_count; ++row) {
+        if (keep[row])
+          rows.push_back(row);
       }
-    }
 
-    std::string orderby_clause;
-    {
+      std::vector<std::pair<const sqlide::IndexColumn *, int> > sort_keys;
       for (auto &sort_column : _sort_columns) {
-        std::string column_expr;
+        sqlide::IndexColumn::Collation collation;
         switch (get_real_column_type(sort_column.first)) {
           case NumericType:
           case FloatType:
-          case DatetimeType:
-            column_expr = strfmt("cast(_%u as numeric)", (unsigned int)sort_column.first);
+            collation = sqlide::IndexColumn::Numeric;
             break;
           case StringType:
-            column_expr = strfmt("_%u COLLATE NOCASE", (unsigned int)sort_column.first);
+            collation = sqlide::IndexColumn::NoCase;
             break;
 
-          default:
-            column_expr = strfmt("_%u", (unsigned int)sort_column.first);
-            break;
-        }
-        const char *dir;
-        switch (sort_column.second) {
-          case 1:
-            dir = "ASC";
-            break;
-          case -1:
-            dir = "DESC";
-            break;
-          default:
-            dir = "";
+          default: // Includes date/time values, whose text form sorts chronologically.
+            collation = sqlide::IndexColumn::Binary;
             break;
         }
-        orderby_clause += strfmt("%s %s, ", column_expr.c_str(), dir);
-      }
-      if (!orderby_clause.empty()) {
-        orderby_clause.resize(orderby_clause.size() - std::string(", ").size());
-        orderby_clause.insert(0, "order by ");
-      }
-    }
-
-    std::string tables_join = "`data`";
-    {
-      for (size_t partition = 1, partition_count = data_swap_db_partition_count(); partition < partition_count;
-           ++partition) {
-        std::string partition_suffix = data_swap_db_partition_suffix(partition);
-        tables_join +=
-          strfmt(" inner join `data%s` on (`data`.id=`data%s`.id)", partition_suffix.c_str(), partition_suffix.c_str());
+        sort_keys.push_back(
+          std::make_pair(&index_column(data_swap_db, sort_column.first, collation), sort_column.second < 0 ? -1 : 1));
       }
+      sqlide::sortRows(rows, sort_keys);
     }
 
     {
@@ -924,9 +950,16 @@ void Recordset::rebuild_data_index(sqlite::connection *data_swap_db, bool do_cac
 
       sqlite::execute(*data_swap_db, strfmt("create table if not exists %s (`id` integer)", temp_table_name.c_str()),
                       true);
-      sqlite::execute(*data_swap_db, strfmt("insert into %s select `data`.`id` from %s %s %s", temp_table_name.c_str(),
-                                            tables_join.c_str(), where_clause.c_str(), orderby_clause.c_str()),
-                      true);
+      if (use_all_rows)
+        sqlite::execute(*data_swap_db, strfmt("insert into %s select `id` from `data`", temp_table_name.c_str()), true);
+      else {
+        sqlite::query insert_statement(*data_swap_db, strfmt("insert into %s values (?)", temp_table_name.c_str()));
+        for (size_t row : rows) {
+          insert_statement.bind(1, (*_index_row_ids)[row]);
+          insert_statement.emit();
+          insert_statement.clear();
+        }
+      }
       sqlite::execute(*data_swap_db, "drop table if exists `data_index`", true);
       sqlite::execute(*data_swap_db, strfmt("alter table %s rename to `data_index`", temp_table_name.c_str()), true);
 
@@ -1290,7 +1323,9 @@ void Recordset::copy_rows_to_clipboard(const std::vector<int> &indeces, std::str
 
   sqlide::QuoteVar qv;
   {
-    qv.escape_string = std::bind(base::escape_sql_string, std::placeholders::_1, false);
+    qv.append_escaped_string = [](std::string &buffer, const std::string &s) {
+      base::append_escaped_sql_string(buffer, s, false);
+    };
     qv.store_unknown_as_string = true;
     qv.allow_func_escaping = true;
   }
@@ -26,6 +26,7 @@
 #include "wbpublic_public_interface.h"
 #include "sqlide/sqlide_generics.h"
 #include "sqlide/var_grid_model_be.h"
+#include "sqlide/recordset_index.h"
 #include "grt/action_list.h"
 #include <map>
 #include <set>
@@ -267,6 +268,14 @@ private:
 private:
   void rebuild_data_index(sqlite::connection *data_swap_db, bool do_cache_data_frame, bool do_refresh_ui);
 
+  // In-memory copies of the swap db content used to filter and sort. Loaded on demand, dropped on data changes.
+  std::shared_ptr<std::vector<int> > _index_row_ids;
+  std::map<std::pair<ColumnId, int>, std::shared_ptr<sqlide::IndexColumn> > _index_columns;
+
+  void drop_index_data();
+  const sqlide::IndexColumn &index_column(sqlite::connection *data_swap_db, ColumnId column,
+                                          sqlide::IndexColumn::Collation collation);
+
 public:
   void caption(const std::string &val) {
     _caption = val;
@@ -62,6 +62,7 @@ void Recordset_data_storage::serialize(Recordset::Ptr recordset_ptr) {
 void Recordset_data_storage::unserialize(Recordset::Ptr recordset_ptr) {
   RETURN_IF_FAIL_TO_RETAIN_WEAK_PTR(Recordset, recordset_ptr, recordset)
   std::shared_ptr<sqlite::connection> data_swap_db = recordset->data_swap_db();
+  recordset->drop_index_data();
   do_unserialize(recordset, data_swap_db.get());
   recordset->rebuild_data_index(data_swap_db.get(), false, false);
 }
@@ -81,6 +82,7 @@ void Recordset_data_storage::fetch_blob_value(Recordset *recordset, sqlite::conn
 
   // cache fetched blob in data swap db, blob shouldn't stay in memory for long
   if (!sqlide::is_var_null(blob_value)) {
+    recordset->drop_index_data();
     sqlide::Sqlite_transaction_guarder transaction_guarder(data_swap_db);
     update_data_swap_record(data_swap_db, rowid, column, blob_value);
     transaction_guarder.commit();
@@ -0,0 +1,367 @@
+/*
+ * Copyright (c) 2020, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  #include <emmintrin.h>
+  #define INDEX_USE_SSE2
+#endif
+
+#ifdef _MSC_VER
+  #include <intrin.h>
+#endif
+
+#include "recordset_index.h"
+
+using namespace sqlide;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static inline unsigned char foldCase(unsigned char c) {
+  return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static inline const unsigned char *nextCharacter(const unsigned char *run, const unsigned char *end) {
+  // Skip a complete UTF-8 sequence, not just a single byte.
+  ++run;
+  while (run < end && (*run & 0xC0) == 0x80)
+    ++run;
+  return run;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static inline unsigned int firstSetBit(unsigned int mask) {
+#ifdef _MSC_VER
+  unsigned long index;
+  _BitScanForward(&index, mask);
+  return (unsigned int)index;
+#else
+  return (unsigned int)__builtin_ctz(mask);
+#endif
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Returns the first position in [head, end) holding one of the two given bytes, or end if there is none.
+ */
+static const unsigned char *findEither(const unsigned char *head, const unsigned char *end, unsigned char c1,
+                                       unsigned char c2) {
+#ifdef INDEX_USE_SSE2
+  __m128i v1 = _mm_set1_epi8((char)c1);
+  __m128i v2 = _mm_set1_epi8((char)c2);
+  while (end - head >= 16) {
+    __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(head));
+    __m128i hits = _mm_or_si128(_mm_cmpeq_epi8(block, v1), _mm_cmpeq_epi8(block, v2));
+    unsigned int mask = (unsigned int)_mm_movemask_epi8(hits);
+    if (mask != 0)
+      return head + firstSetBit(mask);
+    head += 16;
+  }
+#endif
+
+  while (head < end && *head != c1 && *head != c2)
+    ++head;
+  return head;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool sqlide::likeMatch(const char *text, size_t length, const std::string &pattern) {
+  const unsigned char *run = reinterpret_cast<const unsigned char *>(text);
+  const unsigned char *end = run + length;
+  const unsigned char *patternRun = reinterpret_cast<const unsigned char *>(pattern.c_str());
+  const unsigned char *patternEnd = patternRun + pattern.size();
+
+  // Position after the last % and the text position it was tried at, for backtracking.
+  const unsigned char *wildcard = nullptr;
+  const unsigned char *wildcardText = nullptr;
+
+  while (run < end) {
+    if (patternRun < patternEnd) {
+      if (*patternRun == '%') {
+        wildcard = ++patternRun;
+        wildcardText = run;
+        continue;
+      }
+
+      if (*patternRun == '_') {
+        ++patternRun;
+        run = nextCharacter(run, end);
+        continue;
+      }
+
+      if (foldCase(*patternRun) == foldCase(*run)) {
+        ++patternRun;
+        ++run;
+        continue;
+      }
+    }
+
+    if (wildcard == nullptr)
+      return false;
+
+    // Let the last % swallow one more character and try again from there.
+    patternRun = wildcard;
+    wildcardText = nextCharacter(wildcardText, end);
+    run = wildcardText;
+  }
+
+  while (patternRun < patternEnd && *patternRun == '%')
+    ++patternRun;
+  return patternRun == patternEnd;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+IndexColumn::IndexColumn(Collation collation) : _collation(collation) {
+  if (_collation != Numeric)
+    _offsets.push_back(0);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void IndexColumn::reserve(size_t rowCount) {
+  _nulls.reserve(rowCount);
+  if (_collation == Numeric)
+    _numbers.reserve(rowCount);
+  else
+    _offsets.reserve(rowCount + 1);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void IndexColumn::addNull() {
+  _nulls.push_back(1);
+  if (_collation == Numeric)
+    _numbers.push_back(0);
+  else {
+    _text.push_back('\0');
+    _offsets.push_back(_text.size());
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void IndexColumn::addNumber(long double value) {
+  _nulls.push_back(0);
+  _numbers.push_back(value);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void IndexColumn::addText(const char *text, size_t length) {
+  _nulls.push_back(0);
+  _text.append(text, length);
+  _text.push_back('\0');
+  _offsets.push_back(_text.size());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Compares two cells of this column. NULL is less than any other value, as in SQLite.
+ */
+int IndexColumn::compare(size_t row1, size_t row2) const {
+  if (_nulls[row1] || _nulls[row2])
+    return (int)_nulls[row2] - (int)_nulls[row1];
+
+  if (_collation == Numeric) {
+    long double value1 = _numbers[row1];
+    long double value2 = _numbers[row2];
+    return value1 < value2 ? -1 : (value1 > value2 ? 1 : 0);
+  }
+
+  const unsigned char *text1 = reinterpret_cast<const unsigned char *>(_text.data()) + _offsets[row1];
+  const unsigned char *text2 = reinterpret_cast<const unsigned char *>(_text.data()) + _offsets[row2];
+  size_t length1 = _offsets[row1 + 1] - _offsets[row1] - 1;
+  size_t length2 = _offsets[row2 + 1] - _offsets[row2] - 1;
+  size_t length = std::min(length1, length2);
+
+  if (_collation == Binary) {
+    int result = memcmp(text1, text2, length);
+    if (result != 0)
+      return result;
+  } else {
+    for (size_t i = 0; i < length; ++i) {
+      int result = (int)foldCase(text1[i]) - (int)foldCase(text2[i]);
+      if (result != 0)
+        return result;
+    }
+  }
+
+  return length1 < length2 ? -1 : (length1 > length2 ? 1 : 0);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool IndexColumn::matchesPattern(size_t row, const std::string &pattern) const {
+  if (_collation == Numeric || _nulls[row])
+    return false;
+
+  return likeMatch(_text.data() + _offsets[row], _offsets[row + 1] - _offsets[row] - 1, pattern);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Sets the entries in found for all rows whose text contains the needle (ASCII case insensitive).
+ * Instead of looking at each cell separately the whole text buffer is scanned for the first needle character.
+ * Candidates are then verified, and a match skips the rest of its row.
+ */
+void IndexColumn::markRowsContaining(const std::string &needle, std::vector<char> &found) const {
+  if (_collation == Numeric || needle.empty())
+    return;
+
+  const unsigned char *start = reinterpret_cast<const unsigned char *>(_text.data());
+  const unsigned char *end = start + _text.size();
+  const unsigned char *needleStart = reinterpret_cast<const unsigned char *>(needle.data());
+  size_t needleLength = needle.size();
+
+  unsigned char lower = foldCase(needleStart[0]);
+  unsigned char upper = (lower >= 'a' && lower <= 'z') ? lower - ('a' - 'A') : lower;
+
+  const unsigned char *run = start;
+  while (true) {
+    run = findEither(run, end, lower, upper);
+    if ((size_t)(end - run) < needleLength)
+      break;
+
+    // Cells are zero terminated and the needle contains no zero, so a match cannot cross a cell boundary.
+    size_t i = 1;
+    while (i < needleLength && foldCase(run[i]) == foldCase(needleStart[i]))
+      ++i;
+
+    if (i < needleLength) {
+      ++run;
+      continue;
+    }
+
+    size_t row = std::upper_bound(_offsets.begin(), _offsets.end(), (size_t)(run - start)) - _offsets.begin() - 1;
+    found[row] = 1;
+    run = start + _offsets[row + 1];
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Returns a 64 bit value whose order agrees with compare() for the given row: if one cell is less than another
+ * its prefix is less or equal. Sorting by the prefix first avoids most of the (cache unfriendly) full comparisons.
+ */
+std::uint64_t IndexColumn::sortPrefix(size_t row) const {
+  if (_nulls[row])
+    return 0;
+
+  if (_collation == Numeric) {
+    double value = (double)_numbers[row];
+    std::uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return (bits & 0x8000000000000000ULL) ? ~bits : (bits | 0x8000000000000000ULL);
+  }
+
+  const unsigned char *text = reinterpret_cast<const unsigned char *>(_text.data()) + _offsets[row];
+  size_t length = std::min<size_t>(8, _offsets[row + 1] - _offsets[row] - 1);
+  std::uint64_t prefix = 0;
+  for (size_t i = 0; i < 8; ++i) {
+    unsigned char c = i < length ? text[i] : 0;
+    prefix = (prefix << 8) | (_collation == NoCase ? foldCase(c) : c);
+  }
+  return prefix;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void sqlide::sortRows(std::vector<size_t> &rows, const std::vector<std::pair<const IndexColumn *, int>> &keys) {
+  if (keys.empty() || rows.size() < 2)
+    return;
+
+  struct SortItem {
+    std::uint64_t prefix;
+    size_t row;
+  };
+
+  const IndexColumn *primary = keys[0].first;
+  bool descending = keys[0].second < 0;
+  std::vector<SortItem> items(rows.size());
+  for (size_t i = 0; i < rows.size(); ++i) {
+    std::uint64_t prefix = primary->sortPrefix(rows[i]);
+    items[i] = { descending ? ~prefix : prefix, rows[i] };
+  }
+
+  auto less = [&keys](const SortItem &item1, const SortItem &item2) {
+    if (item1.prefix != item2.prefix)
+      return item1.prefix < item2.prefix;
+
+    for (auto &key : keys) {
+      int result = key.first->compare(item1.row, item2.row);
+      if (result != 0)
+        return key.second < 0 ? result > 0 : result < 0;
+    }
+    return false;
+  };
+
+  // Sort chunks in parallel and merge them afterwards. Both steps keep equal rows in their original order.
+  static const size_t minimumChunkSize = 50000;
+  size_t chunkCount =
+    std::min<size_t>(std::max(1U, std::thread::hardware_concurrency()), items.size() / minimumChunkSize);
+  if (chunkCount < 2)
+    std::stable_sort(items.begin(), items.end(), less);
+  else {
+    std::vector<size_t> bounds;
+    for (size_t i = 0; i <= chunkCount; ++i)
+      bounds.push_back(items.size() * i / chunkCount);
+
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < chunkCount; ++i) {
+      auto first = items.begin() + bounds[i];
+      auto last = items.begin() + bounds[i + 1];
+      workers.emplace_back([first, last, &less]() { std::stable_sort(first, last, less); });
+    }
+    for (auto &worker : workers)
+      worker.join();
+
+    for (size_t width = 1; width < chunkCount; width *= 2) {
+      workers.clear();
+      for (size_t i = 0; i + width < chunkCount; i += 2 * width) {
+        auto first = items.begin() + bounds[i];
+        auto middle = items.begin() + bounds[i + width];
+        auto last = items.begin() + bounds[std::min(i + 2 * width, chunkCount)];
+        workers.emplace_back([first, middle, last, &less]() { std::inplace_merge(first, middle, last, less); });
+      }
+      for (auto &worker : workers)
+        worker.join();
+    }
+  }
+
+  for (size_t i = 0; i < items.size(); ++i)
+    rows[i] = items[i].row;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
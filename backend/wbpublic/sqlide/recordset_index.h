@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2020, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#pragma once
+
+#include "wbpublic_public_interface.h"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace sqlide {
+
+  /**
+   * The values of a single recordset column in data swap db row order, kept in memory to search and sort
+   * a recordset without going through SQLite. Depending on the collation, cells are stored either as numbers or
+   * as text (all text in one buffer, which allows to scan a column in one go).
+   */
+  class WBPUBLICBACKEND_PUBLIC_FUNC IndexColumn {
+  public:
+    enum Collation {
+      Numeric, // Compared by value, what cast(... as numeric) gives in SQLite.
+      NoCase,  // Text, compared with ASCII case folding like COLLATE NOCASE.
+      Binary   // Text, compared byte wise.
+    };
+
+    IndexColumn(Collation collation);
+
+    void reserve(size_t rowCount);
+    void addNull();
+    void addNumber(long double value);
+    void addText(const char *text, size_t length);
+
+    Collation collation() const {
+      return _collation;
+    }
+    size_t size() const {
+      return _nulls.size();
+    }
+    bool isNull(size_t row) const {
+      return _nulls[row] != 0;
+    }
+
+    int compare(size_t row1, size_t row2) const;
+    std::uint64_t sortPrefix(size_t row) const;
+    bool matchesPattern(size_t row, const std::string &pattern) const;
+    void markRowsContaining(const std::string &needle, std::vector<char> &found) const;
+
+  private:
+    Collation _collation;
+    std::vector<char> _nulls;
+    std::vector<long double> _numbers;
+
+    // Text of all cells, each one followed by a terminating zero. _offsets has one more entry than there are rows.
+    std::string _text;
+    std::vector<size_t> _offsets;
+  };
+
+  // SQL LIKE matching (% and _ wildcards, ASCII case insensitive, no escape char) as done by SQLite.
+  WBPUBLICBACKEND_PUBLIC_FUNC bool likeMatch(const char *text, size_t length, const std::string &pattern);
+
+  // Sorts the given row numbers by the keys (column, direction: 1 = ascending, -1 = descending).
+  // The sort is stable and uses several threads for large row counts.
+  WBPUBLICBACKEND_PUBLIC_FUNC void sortRows(std::vector<size_t> &rows,
+                                            const std::vector<std::pair<const IndexColumn *, int>> &keys);
+}
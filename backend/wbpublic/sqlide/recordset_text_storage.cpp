@@ -139,12 +139,12 @@ void Recordset_text_storage::do_apply_changes(const Recordset *recordset, sqlite
   throw std::runtime_error("Recordset_text_storage::apply_changes is not implemented");
 }
 
-static std::string escape_sql_string_(const std::string &s) {
-  return base::escape_sql_string(s, false);
+static void append_escaped_sql_string_(std::string &buffer, const std::string &s) {
+  base::append_escaped_sql_string(buffer, s, false);
 }
 
-static std::string escape_json_string_(const std::string &s) {
-  return base::escape_json_string(s);
+static void append_escaped_json_string_(std::string &buffer, const std::string &s) {
+  base::append_escaped_json_string(buffer, s);
 }
 
 void Recordset_text_storage::do_serialize(const Recordset *recordset, sqlite::connection *data_swap_db) {
@@ -200,9 +200,9 @@ void Recordset_text_storage::do_serialize(const Recordset *recordset, sqlite::co
     if (info.quote != "")
       qv.quote = info.quote;
     if (_data_format == "JSON")
-      qv.escape_string = escape_json_string_;
+      qv.append_escaped_string = append_escaped_json_string_;
     else
-      qv.escape_string = escape_sql_string_;
+      qv.append_escaped_string = append_escaped_sql_string_;
     // swap db (sqlite) stores unknown values as quoted strings
     qv.store_unknown_as_string = true;
     qv.allow_func_escaping = false;
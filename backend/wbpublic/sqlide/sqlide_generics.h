@@ -242,6 +242,9 @@ namespace sqlide {
     }
     typedef std::function<std::string(const std::string &)> Escape_sql_string;
     Escape_sql_string escape_string;
+    // Optional. If set it's used instead of escape_string and writes directly into the result string.
+    typedef std::function<void(std::string &, const std::string &)> Append_escaped_sql_string;
+    Append_escaped_sql_string append_escaped_string;
     std::string quote;
     typedef std::function<std::string(const unsigned char *, size_t)> Blob_to_string;
     Blob_to_string blob_to_string;
@@ -290,6 +293,23 @@ namespace sqlide {
       return out;
     }
 
+    std::string quote_string(const std::string &v) const {
+      std::string result;
+      result.reserve(v.size() + 2 * quote.size() + 1);
+      if (needQuote) {
+        if (bitMode)
+          result.push_back('b');
+        result.append(quote);
+      }
+      if (append_escaped_string)
+        append_escaped_string(result, v);
+      else
+        result.append(escape_string(v));
+      if (needQuote)
+        result.append(quote);
+      return result;
+    }
+
     result_type operator()(const unknown_t &, const std::string &v) const {
       static std::string t;
       return store_unknown_as_string ? operator()(t, v) : v;
@@ -314,10 +334,10 @@ namespace sqlide {
           if ((v.size() > func_call_seq.size()) && (v.compare(0, func_call_seq.size(), func_call_seq) == 0))
             return v.substr(func_call_seq.size());
           else if ((v.size() > func_call_exc.size()) && (v.compare(0, func_call_exc.size(), func_call_exc) == 0))
-            return (needQuote ? ((bitMode ? "b" : "" ) + quote) : "") + escape_string(v.substr(1)) + (needQuote ? quote : "");
+            return quote_string(v.substr(1));
         }
       }
-      return (needQuote ? ((bitMode ? "b" : "" ) + quote) : "") + escape_string(v) + (needQuote ? quote : "");
+      return quote_string(v);
     }
     template <typename T>
     result_type operator()(const T &, const blob_ref_t &v) const {
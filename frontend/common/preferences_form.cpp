@@ -1321,6 +1321,16 @@ mforms::View *PreferencesForm::create_model_page() {
                           "and slow down operation."));
     }
 
+    {
+      mforms::TextEntry *entry = new_numeric_entry_option("workbench:UndoMemoryLimit", 0, 65536);
+      entry->set_max_length(5);
+      entry->set_size(100, -1);
+
+      table->add_option(entry, _("Model undo history memory limit (MB):"), "Undo History Memory Limit",
+                        _("Approximate amount of memory the undo history may use. The oldest entries are discarded "
+                          "when it is exceeded. Use 0 for no limit."));
+    }
+
     {
       static const char *auto_save_intervals =
         "disable:0,10 seconds:10,15 seconds:15,30 seconds:30,1 minute:60,5 minutes:300,10 minutes:600,20 minutes:1200";
@@ -1330,6 +1340,11 @@ mforms::View *PreferencesForm::create_model_page() {
                         _("Interval to perform auto-saving of the open model. The model will be restored from the last "
                           "auto-saved version if Workbench unexpectedly quits."));
     }
+
+    table->add_checkbox_option("workbench:ContinuousModelValidation", _("Validate the model while editing it"),
+                               "Continuous Model Validation",
+                               _("Validates changed objects and the objects depending on them whenever Workbench "
+                                 "is idle and keeps the validation messages up to date."));
   }
   return top_box;
 }
@@ -296,6 +296,19 @@ public:
 private: // The next attribute is read-only.
 public:
 
+  /**
+   * Method. returns up to count rows starting at the current row and moves the current row past them. Each row is a list of the column values (int, double, string or None), with the value types resolved from the column types only once for the whole resultset
+   * \param count 
+   * \return list of rows, empty when there are no more rows
+   */
+  virtual grt::BaseListRef fetchRows(ssize_t count);
+  /**
+   * Method. like fetchRows, but each value is returned as by stringFieldValue, i.e. in the string form sent by the server. The values of the columns listed in wktColumns are returned as by geoStringFieldValue instead
+   * \param count 
+   * \param wktColumns 
+   * \return list of rows, empty when there are no more rows
+   */
+  virtual grt::BaseListRef fetchStringRows(ssize_t count, const grt::IntegerListRef &wktColumns);
   /**
    * Method. returns the float contents of the field at the given column index and current row
    * \param column 
@@ -412,6 +425,10 @@ private: // Wrapper methods for use by the grt.
     return grt::ObjectRef(new db_query_Resultset());
   }
 
+  static grt::ValueRef call_fetchRows(grt::internal::Object *self, const grt::BaseListRef &args){ return dynamic_cast<db_query_Resultset*>(self)->fetchRows(grt::IntegerRef::cast_from(args[0])); }
+
+  static grt::ValueRef call_fetchStringRows(grt::internal::Object *self, const grt::BaseListRef &args){ return dynamic_cast<db_query_Resultset*>(self)->fetchStringRows(grt::IntegerRef::cast_from(args[0]), grt::IntegerListRef::cast_from(args[1])); }
+
   static grt::ValueRef call_floatFieldValue(grt::internal::Object *self, const grt::BaseListRef &args){ return dynamic_cast<db_query_Resultset*>(self)->floatFieldValue(grt::IntegerRef::cast_from(args[0])); }
 
   static grt::ValueRef call_floatFieldValueByName(grt::internal::Object *self, const grt::BaseListRef &args){ return dynamic_cast<db_query_Resultset*>(self)->floatFieldValueByName(grt::StringRef::cast_from(args[0])); }
@@ -460,6 +477,8 @@ public:
     meta->bind_member("currentRow", new grt::MetaClass::Property<db_query_Resultset,grt::IntegerRef>(&db_query_Resultset::currentRow));
     meta->bind_member("rowCount", new grt::MetaClass::Property<db_query_Resultset,grt::IntegerRef>(&db_query_Resultset::rowCount));
     meta->bind_member("sql", new grt::MetaClass::Property<db_query_Resultset,grt::StringRef>(&db_query_Resultset::sql));
+    meta->bind_method("fetchRows", &db_query_Resultset::call_fetchRows);
+    meta->bind_method("fetchStringRows", &db_query_Resultset::call_fetchStringRows);
     meta->bind_method("floatFieldValue", &db_query_Resultset::call_floatFieldValue);
     meta->bind_method("floatFieldValueByName", &db_query_Resultset::call_floatFieldValueByName);
     meta->bind_method("geoJsonFieldValue", &db_query_Resultset::call_geoJsonFieldValue);
@@ -26,55 +26,70 @@
 
 #include "common.h"
 
+#include <atomic>
+#include <cstdint>
 #include <string>
-#include <map>
 #include <time.h>
 
 namespace base {
-  // This class has been created to provide a way to accumulate the
-  // processing time spent on a specific section of the code.
-  // Usage: add(id) to register a new accumulator
-  //        on(id) to start accumulating time on the <id> accumulator
-  //        off(if) to stop accumulating time on the <id> accumulator
-  //
-  // This class can be instantiated to monitor the processing time inside
-  // a method or class or the static version GlobalTA below could be used
-  // to monitor processing time among classes or libraries
-  class BASELIBRARY_PUBLIC_FUNC TimeAccumulator {
-  private:
-    std::map<std::string, double> _accumulators;
-    std::map<std::string, clock_t> _starts;
-
+  /**
+   * Low-overhead tracing of what the threads of the application are doing, written in Chrome's trace event format
+   * (load the file in chrome://tracing or https://ui.perfetto.dev).
+   *
+   * Each thread records its events into an own ring buffer, without locking. Only the latest events are kept when a
+   * buffer is full. Event names are not copied, so they must be string literals or come from intern().
+   * When tracing is not enabled, recording an event costs a single (relaxed) atomic load.
+   *
+   * Usage: Tracer::start(file) to enable tracing, stop() to disable it again and write the trace to that file
+   *        TRACE_ZONE("name") to record the time spent in the current scope
+   *        instant("name") for things happening at a single point in time
+   *        counter("name", value) to track a value over time
+   *        set_thread_name(name) to give the current thread a meaningful name in the trace
+   */
+  class BASELIBRARY_PUBLIC_FUNC Tracer {
   public:
-    void add(const std::string& id);
-    void on(const std::string& id);
-    void off(const std::string& id);
-    void dump(const std::string& message);
-    void clear();
-  };
+    static void start(const std::string& output_file = "");
+    static void stop();
+    static bool is_enabled() {
+      return _enabled.load(std::memory_order_relaxed);
+    }
+
+    static void begin_zone(const char* name);
+    static void end_zone(const char* name);
+    static void instant(const char* name);
+    static void counter(const char* name, int64_t value);
+
+    static const char* intern(const std::string& name);
+    static void set_thread_name(const std::string& name);
+
+    static std::string chrome_trace();
+    static bool write_chrome_trace(const std::string& path);
+    static void clear();
 
-  class BASELIBRARY_PUBLIC_FUNC GlobalTA {
   private:
-    static TimeAccumulator _tacc;
+    static std::atomic<bool> _enabled;
+  };
 
+  // Records the time spent in a scope, if tracing is enabled. Use it via TRACE_ZONE.
+  class BASELIBRARY_PUBLIC_FUNC TraceZone {
   public:
-    static void add(const std::string& id) {
-      _tacc.add(id);
-    };
-    static void on(const std::string& id) {
-      _tacc.on(id);
-    };
-    static void off(const std::string& id) {
-      _tacc.off(id);
-    };
-    static void dump(const std::string& message) {
-      _tacc.dump(message);
-    };
-    static void clear() {
-      _tacc.clear();
-    };
+    TraceZone(const char* name) : _name(name != nullptr && Tracer::is_enabled() ? name : nullptr) {
+      if (_name != nullptr)
+        Tracer::begin_zone(_name);
+    }
+    ~TraceZone() {
+      if (_name != nullptr)
+        Tracer::end_zone(_name);
+    }
+
+  private:
+    const char* _name;
   };
 
+#define TRACE_ZONE_JOIN2(a, b) a##b
+#define TRACE_ZONE_JOIN(a, b) TRACE_ZONE_JOIN2(a, b)
+#define TRACE_ZONE(name) base::TraceZone TRACE_ZONE_JOIN(_trace_zone_, __LINE__)(name)
+
   // This class has been created to provide a way to time mark
   // a process on it's different phases
   // Usage: start(message) to record the time measuring
@@ -28,6 +28,7 @@
 #include "common.h"
 
 #include <set>
+#include <string_view>
 
 namespace base {
 
@@ -39,13 +40,26 @@ enum class MySQLVersion {
   MySQL80,
 };
 
+// Details about a keyword, as returned by MySQLSymbolInfo::keywordInfo().
+struct KeywordInfo {
+  static const size_t NotAKeyword = ~static_cast<size_t>(0);
+
+  size_t id = NotAKeyword; // Unique for all server versions (0 .. keywordCount() - 1), e.g. for lookup tables.
+  bool keyword = false;    // Is a keyword in the requested server version.
+  bool reserved = false;   // Is a reserved keyword in the requested server version.
+  MySQLVersion since = MySQLVersion::Unknown; // The first server version with this keyword.
+};
+
 class BASELIBRARY_PUBLIC_FUNC MySQLSymbolInfo {
 public:
   static std::set<std::string> const& systemFunctionsForVersion(MySQLVersion version);
   static std::set<std::string> const& keywordsForVersion(MySQLVersion version);
 
-  static bool isReservedKeyword(std::string const& identifier, MySQLVersion version);
-  static bool isKeyword(std::string const& identifier, MySQLVersion version);
+  static KeywordInfo keywordInfo(std::string_view word, MySQLVersion version);
+  static size_t keywordCount();
+
+  static bool isReservedKeyword(std::string_view identifier, MySQLVersion version);
+  static bool isKeyword(std::string_view identifier, MySQLVersion version);
 
   static MySQLVersion numberToVersion(long version);
 };
@@ -24,22 +24,24 @@
 #include "base/profiling.h"
 #include "base/log.h"
 #include "base/string_utilities.h"
+#include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
 
 DEFAULT_LOG_DOMAIN("Profiling")
 
 namespace base {
-  TimeAccumulator create_global_ta() {
-    TimeAccumulator _ta;
-    return _ta;
-  }
-
   StopWatch create_global_sw() {
     StopWatch _sw;
     return _sw;
   }
 
-  TimeAccumulator GlobalTA::_tacc = create_global_ta();
   StopWatch GlobalSW::_sw = create_global_sw();
 
   //----------------- Time Check --------------------------------------------------------
@@ -84,39 +86,277 @@ namespace base {
     }
   }
 
-  //----------------- Time Profiler -----------------------------------------------------
-  void TimeAccumulator::add(const std::string& id) {
-    _accumulators[id] = 0;
-    _starts[id] = 0;
+  //----------------- Tracer ------------------------------------------------------------
+
+  // Number of events kept per thread. Older events are overwritten.
+  static const uint64_t TRACE_BUFFER_SIZE = 1 << 16;
+
+  namespace {
+    // All members are atomic, as a buffer can be read while its thread overwrites old events.
+    struct TraceEvent {
+      std::atomic<const char*> name;
+      std::atomic<int64_t> timestamp; // In nanoseconds since the tracer was loaded.
+      std::atomic<int64_t> value;
+      std::atomic<char> phase;        // As used in the trace format: B(egin), E(nd), i(nstant) or C(ounter).
+    };
+
+    struct ThreadTraceBuffer {
+      int thread_id;
+      std::string thread_name; // Protected by the registry mutex.
+      std::atomic<uint64_t> head;
+      std::atomic<uint64_t> first; // Events before this one were cleared.
+      std::unique_ptr<TraceEvent[]> events;
+
+      ThreadTraceBuffer(int id) : thread_id(id), head(0), first(0), events(new TraceEvent[TRACE_BUFFER_SIZE]) {
+      }
+    };
+
+    struct TraceRegistry {
+      std::mutex mutex;
+      std::vector<std::shared_ptr<ThreadTraceBuffer> > buffers;
+      std::unordered_set<std::string> names;
+      std::string output_file;
+      int next_thread_id = 1;
+    };
+
+    // Never freed, threads may still record events while the application shuts down.
+    TraceRegistry& trace_registry() {
+      static TraceRegistry* registry = new TraceRegistry();
+      return *registry;
+    }
+
+    const std::chrono::steady_clock::time_point trace_epoch = std::chrono::steady_clock::now();
+
+    thread_local std::shared_ptr<ThreadTraceBuffer> thread_trace_buffer;
+
+    // Kept apart from the buffer, so that naming a thread doesn't allocate a buffer while tracing is off.
+    thread_local std::string thread_trace_name;
+
+    ThreadTraceBuffer* current_trace_buffer() {
+      if (!thread_trace_buffer) {
+        TraceRegistry& registry = trace_registry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        thread_trace_buffer = std::make_shared<ThreadTraceBuffer>(registry.next_thread_id++);
+        thread_trace_buffer->thread_name = thread_trace_name;
+        registry.buffers.push_back(thread_trace_buffer);
+      }
+      return thread_trace_buffer.get();
+    }
+
+    void record_trace_event(const char* name, char phase, int64_t value) {
+      ThreadTraceBuffer* buffer = current_trace_buffer();
+      uint64_t head = buffer->head.load(std::memory_order_relaxed);
+
+      TraceEvent& event = buffer->events[head % TRACE_BUFFER_SIZE];
+      event.name.store(name, std::memory_order_relaxed);
+      event.timestamp.store(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - trace_epoch).count(),
+        std::memory_order_relaxed);
+      event.value.store(value, std::memory_order_relaxed);
+      event.phase.store(phase, std::memory_order_relaxed);
+
+      buffer->head.store(head + 1, std::memory_order_release);
+    }
+  }
+
+  std::atomic<bool> Tracer::_enabled(false);
+
+  //-------------------------------------------------------------------------------------
+
+  /**
+   * Enables tracing. If an output file is given, the trace is written to it by stop().
+   */
+  void Tracer::start(const std::string& output_file) {
+    {
+      TraceRegistry& registry = trace_registry();
+      std::lock_guard<std::mutex> lock(registry.mutex);
+      registry.output_file = output_file;
+    }
+    _enabled = true;
+  }
+
+  //-------------------------------------------------------------------------------------
+
+  void Tracer::stop() {
+    _enabled = false;
+
+    std::string output_file;
+    {
+      TraceRegistry& registry = trace_registry();
+      std::lock_guard<std::mutex> lock(registry.mutex);
+      output_file.swap(registry.output_file);
+    }
+
+    if (!output_file.empty()) {
+      if (write_chrome_trace(output_file))
+        logInfo("Trace written to %s\n", output_file.c_str());
+    }
+  }
+
+  //-------------------------------------------------------------------------------------
+
+  void Tracer::begin_zone(const char* name) {
+    if (is_enabled())
+      record_trace_event(name, 'B', 0);
+  }
+
+  //-------------------------------------------------------------------------------------
+
+  void Tracer::end_zone(const char* name) {
+    // Also recorded when tracing was disabled meanwhile, to close the zone.
+    record_trace_event(name, 'E', 0);
+  }
+
+  //-------------------------------------------------------------------------------------
+
+  void Tracer::instant(const char* name) {
+    if (is_enabled())
+      record_trace_event(name, 'i', 0);
+  }
+
+  //-------------------------------------------------------------------------------------
+
+  void Tracer::counter(const char* name, int64_t value) {
+    if (is_enabled())
+      record_trace_event(name, 'C', value);
   }
+
   //-------------------------------------------------------------------------------------
-  void TimeAccumulator::on(const std::string& id) {
-    clock_t current = clock();
-    _starts[id] = current;
+
+  /**
+   * Returns a copy of the name which stays valid for the lifetime of the application, for event names which are
+   * not string literals (e.g. task names or names coming from Python). Use it sparingly, as it needs a lock.
+   */
+  const char* Tracer::intern(const std::string& name) {
+    TraceRegistry& registry = trace_registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    return registry.names.insert(name).first->c_str();
   }
+
   //-------------------------------------------------------------------------------------
-  void TimeAccumulator::off(const std::string& id) {
-    clock_t current = clock();
 
-    double diff = current - _starts[id];
-    double acc = _accumulators[id];
-    acc += diff;
-    _accumulators[id] = acc;
+  /**
+   * Names the current thread in the trace. The name is remembered until the thread records its first event.
+   */
+  void Tracer::set_thread_name(const std::string& name) {
+    thread_trace_name = name;
+    if (!thread_trace_buffer)
+      return;
+
+    TraceRegistry& registry = trace_registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    thread_trace_buffer->thread_name = name;
   }
+
   //-------------------------------------------------------------------------------------
-  void TimeAccumulator::dump(const std::string& message) {
-    std::map<std::string, double>::const_iterator index, end = _accumulators.end();
 
-    logDebug("Dumping data for : %s\n", message.data());
+  /**
+   * Returns the events recorded so far as Chrome trace JSON. Can be called at any time, from any thread.
+   */
+  std::string Tracer::chrome_trace() {
+    std::vector<std::shared_ptr<ThreadTraceBuffer> > buffers;
+    std::vector<std::string> thread_names;
+    {
+      TraceRegistry& registry = trace_registry();
+      std::lock_guard<std::mutex> lock(registry.mutex);
+      buffers = registry.buffers;
+      for (auto& buffer : buffers)
+        thread_names.push_back(buffer->thread_name);
+    }
+
+    struct Event {
+      const char* name;
+      int64_t timestamp;
+      int64_t value;
+      char phase;
+    };
+
+    std::string result = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first_entry = true;
+    auto add_entry_start = [&](const char* name, char phase, int thread_id) {
+      result += first_entry ? "\n{\"name\":\"" : ",\n{\"name\":\"";
+      first_entry = false;
+      append_escaped_json_string(result, name, strlen(name));
+      result += "\",\"ph\":\"";
+      result += phase;
+      result += "\",\"pid\":1,\"tid\":" + std::to_string(thread_id);
+    };
+
+    std::vector<Event> events;
+    for (size_t i = 0; i < buffers.size(); ++i) {
+      ThreadTraceBuffer& buffer = *buffers[i];
+
+      if (!thread_names[i].empty()) {
+        add_entry_start("thread_name", 'M', buffer.thread_id);
+        result += ",\"args\":{\"name\":\"";
+        append_escaped_json_string(result, thread_names[i]);
+        result += "\"}}";
+      }
+
+      uint64_t head = buffer.head.load(std::memory_order_acquire);
+      uint64_t start = std::max(buffer.first.load(std::memory_order_relaxed),
+                                head > TRACE_BUFFER_SIZE ? head - TRACE_BUFFER_SIZE : 0);
+      events.clear();
+      for (uint64_t index = start; index < head; ++index) {
+        TraceEvent& event = buffer.events[index % TRACE_BUFFER_SIZE];
+        events.push_back({ event.name.load(std::memory_order_relaxed), event.timestamp.load(std::memory_order_relaxed),
+                           event.value.load(std::memory_order_relaxed), event.phase.load(std::memory_order_relaxed) });
+      }
+
+      // The thread might have overwritten the oldest of the events while they were copied. Skip those.
+      std::atomic_thread_fence(std::memory_order_acquire);
+      uint64_t new_head = buffer.head.load(std::memory_order_relaxed);
+      size_t skip = 0;
+      if (new_head > TRACE_BUFFER_SIZE && new_head - TRACE_BUFFER_SIZE > start)
+        skip = (size_t)std::min<uint64_t>(new_head - TRACE_BUFFER_SIZE - start, events.size());
+
+      for (size_t j = skip; j < events.size(); ++j) {
+        const Event& event = events[j];
+        add_entry_start(event.name, event.phase, buffer.thread_id);
+        result += strfmt(",\"ts\":%.3f", event.timestamp / 1000.0);
+        if (event.phase == 'i')
+          result += ",\"s\":\"t\"";
+        else if (event.phase == 'C')
+          result += ",\"args\":{\"value\":" + std::to_string(event.value) + "}";
+        result += "}";
+      }
+    }
+    result += "\n]}\n";
+
+    return result;
+  }
+
+  //-------------------------------------------------------------------------------------
 
-    for (index = _accumulators.begin(); index != end; index++) {
-      logDebug("--->Time on accumulator %s : %lf\n", index->first.data(), index->second / CLOCKS_PER_SEC);
+  bool Tracer::write_chrome_trace(const std::string& path) {
+    std::ofstream stream(path.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!stream.is_open()) {
+      logError("Could not open trace file %s\n", path.c_str());
+      return false;
     }
+
+    stream << chrome_trace();
+    return stream.good();
   }
+
   //-------------------------------------------------------------------------------------
-  void TimeAccumulator::clear() {
-    _accumulators.clear();
-    _starts.clear();
+
+  /**
+   * Discards all events recorded so far and the buffers of threads which ended.
+   */
+  void Tracer::clear() {
+    TraceRegistry& registry = trace_registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    std::vector<std::shared_ptr<ThreadTraceBuffer> > buffers;
+    for (auto& buffer : registry.buffers) {
+      if (buffer.use_count() > 1) {
+        buffer->first.store(buffer->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+        buffers.push_back(buffer);
+      }
+    }
+    registry.buffers.swap(buffers);
   }
+
   //-------------------------------------------------------------------------------------
-} // namespace base
\ No newline at end of file
+} // namespace base
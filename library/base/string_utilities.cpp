@@ -35,6 +35,18 @@
 #include <fstream>
 #include <boost/locale/encoding_utf.hpp>
 
+#if defined(__AVX2__)
+  #include <immintrin.h>
+  #define ESCAPING_USE_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  #include <emmintrin.h>
+  #define ESCAPING_USE_SSE2
+#endif
+
+#ifdef _MSC_VER
+  #include <intrin.h>
+#endif
+
 DEFAULT_LOG_DOMAIN(DOMAIN_BASE);
 
 namespace base {
@@ -928,6 +940,168 @@ namespace base {
 
   //--------------------------------------------------------------------------------------------------
 
+  /**
+   * Escaping support. A string is scanned for bytes which might need an escape (all control chars plus the
+   * mode specific special chars), with 16 or 32 bytes per step where SIMD is available. Runs of clean bytes are
+   * copied in one go, the candidates are then looked up in a table which gives the char to write after
+   * the backslash (or 0 if the byte is taken over unchanged).
+   */
+  namespace {
+
+    enum EscapeMode { EscapeSql, EscapeSqlWildcards, EscapeJson };
+
+    struct EscapeTable {
+      char escapes[256];
+
+      EscapeTable(EscapeMode mode) {
+        memset(escapes, 0, sizeof(escapes));
+        escapes[(unsigned char)'\\'] = '\\';
+        escapes[(unsigned char)'"'] = '"';
+        escapes[(unsigned char)'\n'] = 'n';
+        escapes[(unsigned char)'\r'] = 'r';
+
+        if (mode == EscapeJson) {
+          escapes[(unsigned char)'\b'] = 'b';
+          escapes[(unsigned char)'\f'] = 'f';
+          escapes[(unsigned char)'\t'] = 't';
+        } else {
+          escapes[0] = '0'; // Must be escaped for 'mysql'.
+          escapes[(unsigned char)'\''] = '\'';
+          escapes[(unsigned char)'\032'] = 'Z'; // This gives problems on Win32.
+          if (mode == EscapeSqlWildcards) {
+            escapes[(unsigned char)'_'] = '_';
+            escapes[(unsigned char)'%'] = '%';
+          }
+        }
+      }
+    };
+
+    //----------------------------------------------------------------------------------------------------------------
+
+    inline unsigned int firstSetBit(unsigned int mask) {
+#ifdef _MSC_VER
+      unsigned long index;
+      _BitScanForward(&index, mask);
+      return index;
+#else
+      return __builtin_ctz(mask);
+#endif
+    }
+
+    //----------------------------------------------------------------------------------------------------------------
+
+    /**
+     * Returns the first position in [head, end) which holds a byte that might need escaping in the given mode,
+     * or end if there is none.
+     */
+    template <EscapeMode mode>
+    const char *findEscapeCandidate(const char *head, const char *end) {
+#if defined(ESCAPING_USE_AVX2)
+      const __m256i controlLimit = _mm256_set1_epi8(0x1F);
+      const __m256i backslash = _mm256_set1_epi8('\\');
+      const __m256i doubleQuote = _mm256_set1_epi8('"');
+      const __m256i singleQuote = _mm256_set1_epi8('\'');
+      const __m256i underscore = _mm256_set1_epi8('_');
+      const __m256i percent = _mm256_set1_epi8('%');
+
+      while (end - head >= 32) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(head));
+
+        // Unsigned compare <= 0x1F, so that UTF-8 lead and continuation bytes are not taken as candidates.
+        __m256i hits = _mm256_cmpeq_epi8(_mm256_min_epu8(block, controlLimit), block);
+        hits = _mm256_or_si256(hits, _mm256_cmpeq_epi8(block, backslash));
+        hits = _mm256_or_si256(hits, _mm256_cmpeq_epi8(block, doubleQuote));
+        if (mode != EscapeJson)
+          hits = _mm256_or_si256(hits, _mm256_cmpeq_epi8(block, singleQuote));
+        if (mode == EscapeSqlWildcards) {
+          hits = _mm256_or_si256(hits, _mm256_cmpeq_epi8(block, underscore));
+          hits = _mm256_or_si256(hits, _mm256_cmpeq_epi8(block, percent));
+        }
+
+        unsigned int mask = (unsigned int)_mm256_movemask_epi8(hits);
+        if (mask != 0)
+          return head + firstSetBit(mask);
+        head += 32;
+      }
+#elif defined(ESCAPING_USE_SSE2)
+      const __m128i controlLimit = _mm_set1_epi8(0x1F);
+      const __m128i backslash = _mm_set1_epi8('\\');
+      const __m128i doubleQuote = _mm_set1_epi8('"');
+      const __m128i singleQuote = _mm_set1_epi8('\'');
+      const __m128i underscore = _mm_set1_epi8('_');
+      const __m128i percent = _mm_set1_epi8('%');
+
+      while (end - head >= 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(head));
+
+        __m128i hits = _mm_cmpeq_epi8(_mm_min_epu8(block, controlLimit), block);
+        hits = _mm_or_si128(hits, _mm_cmpeq_epi8(block, backslash));
+        hits = _mm_or_si128(hits, _mm_cmpeq_epi8(block, doubleQuote));
+        if (mode != EscapeJson)
+          hits = _mm_or_si128(hits, _mm_cmpeq_epi8(block, singleQuote));
+        if (mode == EscapeSqlWildcards) {
+          hits = _mm_or_si128(hits, _mm_cmpeq_epi8(block, underscore));
+          hits = _mm_or_si128(hits, _mm_cmpeq_epi8(block, percent));
+        }
+
+        unsigned int mask = (unsigned int)_mm_movemask_epi8(hits);
+        if (mask != 0)
+          return head + firstSetBit(mask);
+        head += 16;
+      }
+#endif
+
+      // Tail (or everything, if there's no SIMD support).
+      while (head < end) {
+        unsigned char c = (unsigned char)*head;
+        if (c <= 0x1F || c == '\\' || c == '"')
+          return head;
+        if (mode != EscapeJson && c == '\'')
+          return head;
+        if (mode == EscapeSqlWildcards && (c == '_' || c == '%'))
+          return head;
+        ++head;
+      }
+      return end;
+    }
+
+    //----------------------------------------------------------------------------------------------------------------
+
+    template <EscapeMode mode>
+    void appendEscaped(std::string &buffer, const char *data, size_t length) {
+      static const EscapeTable table(mode);
+
+      // Grow geometrically, an exact reserve would reallocate on every append to the same buffer.
+      size_t needed = buffer.size() + length;
+      if (needed > buffer.capacity())
+        buffer.reserve(std::max(2 * buffer.capacity(), needed));
+
+      const char *end = data + length;
+      const char *run = data;
+      while (run < end) {
+        const char *candidate = findEscapeCandidate<mode>(run, end);
+        if (candidate == end) {
+          buffer.append(run, end - run);
+          break;
+        }
+
+        char escape = table.escapes[(unsigned char)*candidate];
+        if (escape == 0) {
+          // Not all control chars must be escaped. Keep it as part of the next run.
+          buffer.append(run, candidate - run + 1);
+        } else {
+          buffer.append(run, candidate - run);
+          buffer.push_back('\\');
+          buffer.push_back(escape);
+        }
+        run = candidate + 1;
+      }
+    }
+
+  }
+
+  //--------------------------------------------------------------------------------------------------
+
   /**
    * Escape a string to be used in a SQL query
    * Same code as used by mysql. Handles null bytes in the middle of the string.
@@ -935,93 +1109,54 @@ namespace base {
    */
   std::string escape_sql_string(const std::string &s, bool wildcards) {
     std::string result;
-    result.reserve(s.size());
+    append_escaped_sql_string(result, s, wildcards);
+    return result;
+  }
 
-    for (std::string::const_iterator ch = s.begin(); ch != s.end(); ++ch) {
-      char escape = 0;
+  //--------------------------------------------------------------------------------------------------
 
-      switch (*ch) {
-        case 0: /* Must be escaped for 'mysql' */
-          escape = '0';
-          break;
-        case '\n': /* Must be escaped for logs */
-          escape = 'n';
-          break;
-        case '\r':
-          escape = 'r';
-          break;
-        case '\\':
-          escape = '\\';
-          break;
-        case '\'':
-          escape = '\'';
-          break;
-        case '"': /* Better safe than sorry */
-          escape = '"';
-          break;
-        case '\032': /* This gives problems on Win32 */
-          escape = 'Z';
-          break;
-        case '_':
-          if (wildcards)
-            escape = '_';
-          break;
-        case '%':
-          if (wildcards)
-            escape = '%';
-          break;
-      }
-      if (escape) {
-        result.push_back('\\');
-        result.push_back(escape);
-      } else
-        result.push_back(*ch);
-    }
-    return result;
+  /**
+   * Same as escape_sql_string, but appends the escaped text to the given buffer, which avoids a new string
+   * for each value when many values are escaped into one text (like in INSERT statements).
+   */
+  void append_escaped_sql_string(std::string &buffer, const std::string &s, bool wildcards) {
+    append_escaped_sql_string(buffer, s.data(), s.size(), wildcards);
   }
 
+  //--------------------------------------------------------------------------------------------------
+
+  void append_escaped_sql_string(std::string &buffer, const char *data, size_t length, bool wildcards) {
+    if (wildcards)
+      appendEscaped<EscapeSqlWildcards>(buffer, data, length);
+    else
+      appendEscaped<EscapeSql>(buffer, data, length);
+  }
+
+  //--------------------------------------------------------------------------------------------------
+
   /**
    * Escape a string to be used in a JSON
    */
   std::string escape_json_string(const std::string &s) {
     std::string result;
-    result.reserve(s.size());
-    for (auto ch : s) {
-      char escape = 0;
-      switch (ch) {
-        case '"':
-          escape = '"';
-          break;
-        case '\\':
-          escape = '\\';
-          break;
-        case '\b':
-          escape = 'b';
-          break;
-        case '\f':
-          escape = 'f';
-          break;
-        case '\n':
-          escape = 'n';
-          break;
-        case '\r':
-          escape = 'r';
-          break;
-        case '\t':
-          escape = 't';
-          break;
-        default:
-          break;
-      }
-      if (escape) {
-        result.push_back('\\');
-        result.push_back(escape);
-      } else
-        result.push_back(ch);
-    }
+    append_escaped_json_string(result, s);
     return result;
   }
 
+  //--------------------------------------------------------------------------------------------------
+
+  void append_escaped_json_string(std::string &buffer, const std::string &s) {
+    append_escaped_json_string(buffer, s.data(), s.size());
+  }
+
+  //--------------------------------------------------------------------------------------------------
+
+  void append_escaped_json_string(std::string &buffer, const char *data, size_t length) {
+    appendEscaped<EscapeJson>(buffer, data, length);
+  }
+
+  //--------------------------------------------------------------------------------------------------
+
   /**
    * Removes repeated quote chars and supported escape sequences from the given string.
    * Invalid escape sequences are handled like in the server, by dropping the backslash and
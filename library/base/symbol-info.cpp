@@ -30,7 +30,12 @@ using namespace base;
 #include "server/keyword_list56.h"
 #include "server/keyword_list57.h"
 #include "server/keyword_list80.h"
+
+#include <algorithm>
+#include <cstdint>
 #include <map>
+#include <mutex>
+#include <vector>
 
 //----------------------------------------------------------------------------------------------------------------------
 
@@ -52,60 +57,224 @@ std::set<std::string> const& MySQLSymbolInfo::systemFunctionsForVersion(MySQLVer
 
 //----------------------------------------------------------------------------------------------------------------------
 
-static std::map<MySQLVersion, std::set<std::string>> keywords;
-static std::map<MySQLVersion, std::set<std::string>> reservedKeywords;
+namespace {
+
+  /**
+   * All keywords of all supported server versions in a minimal perfect hash table (hash and displace), built once
+   * on first use from the server keyword lists. A lookup hashes the word twice and does a single, case-insensitive
+   * comparison, without allocating anything.
+   */
+  class KeywordTable {
+  public:
+    static KeywordTable const& get() {
+      static KeywordTable table;
+      return table;
+    }
+
+    KeywordInfo lookup(std::string_view word, MySQLVersion version) const {
+      KeywordInfo info;
+      if (word.empty() || word.size() > _maxLength)
+        return info;
+
+      uint32_t seed = _seeds[hash(word, 0) & (_seeds.size() - 1)];
+      int index = _slots[hash(word, seed) & (_slots.size() - 1)];
+      if (index < 0)
+        return info;
+
+      Entry const& entry = _entries[index];
+      if (entry.length != word.size())
+        return info;
+      for (size_t i = 0; i < word.size(); ++i) {
+        if (toUpper(word[i]) != entry.word[i])
+          return info;
+      }
+
+      info.id = index;
+      info.keyword = (entry.versions & versionBit(version)) != 0;
+      info.reserved = (entry.reserved & versionBit(version)) != 0;
+      info.since = entry.since;
+      return info;
+    }
+
+    size_t size() const {
+      return _entries.size();
+    }
+
+  private:
+    struct Entry {
+      const char *word; // Upper case, as in the server lists.
+      size_t length;
+      uint8_t versions;
+      uint8_t reserved;
+      MySQLVersion since;
+    };
+
+    std::vector<Entry> _entries;
+    std::vector<uint32_t> _seeds; // One per bucket.
+    std::vector<int> _slots;      // Index into _entries or -1.
+    size_t _maxLength = 0;
+
+    static uint8_t versionBit(MySQLVersion version) {
+      switch (version) {
+        case MySQLVersion::MySQL56:
+          return 1;
+        case MySQLVersion::MySQL57:
+          return 2;
+        case MySQLVersion::MySQL80:
+          return 4;
+        default:
+          return 0;
+      }
+    }
+
+    static char toUpper(char c) {
+      return (c >= 'a' && c <= 'z') ? c - ('a' - 'A') : c;
+    }
+
+    // FNV-1a over the upper cased word, with a seed to get different hash functions.
+    static uint32_t hash(std::string_view word, uint32_t seed) {
+      uint32_t result = 2166136261U ^ (seed * 16777619U);
+      for (char c : word) {
+        result ^= static_cast<unsigned char>(toUpper(c));
+        result *= 16777619U;
+      }
+      return result;
+    }
+
+    template <size_t N>
+    void addList(keyword_t const (&list)[N], MySQLVersion version, std::map<std::string_view, size_t> &known) {
+      for (size_t i = 0; i < N; ++i) {
+        std::string_view word = list[i].word;
+        auto iterator = known.find(word);
+        if (iterator == known.end()) {
+          iterator = known.emplace(word, _entries.size()).first;
+          _entries.push_back({ list[i].word, word.size(), 0, 0, version });
+          _maxLength = std::max(_maxLength, word.size());
+        }
+
+        Entry &entry = _entries[iterator->second];
+        entry.versions |= versionBit(version);
+        if (list[i].reserved != 0)
+          entry.reserved |= versionBit(version);
+      }
+    }
+
+    static size_t powerOfTwo(size_t value) {
+      size_t result = 1;
+      while (result < value)
+        result <<= 1;
+      return result;
+    }
+
+    KeywordTable() {
+      std::map<std::string_view, size_t> known;
+      addList(keyword_list56, MySQLVersion::MySQL56, known);
+      addList(keyword_list57, MySQLVersion::MySQL57, known);
+      addList(keyword_list80, MySQLVersion::MySQL80, known);
+
+      // Distribute the words into buckets (~4 words per bucket) and then, largest bucket first, search a seed
+      // for each bucket which maps all its words to free slots.
+      std::vector<std::vector<size_t>> buckets(powerOfTwo(_entries.size() / 4 + 1));
+      for (size_t i = 0; i < _entries.size(); ++i) {
+        std::string_view word(_entries[i].word, _entries[i].length);
+        buckets[hash(word, 0) & (buckets.size() - 1)].push_back(i);
+      }
+
+      std::vector<size_t> order(buckets.size());
+      for (size_t i = 0; i < order.size(); ++i)
+        order[i] = i;
+      std::stable_sort(order.begin(), order.end(),
+                       [&](size_t a, size_t b) { return buckets[a].size() > buckets[b].size(); });
+
+      _seeds.resize(buckets.size(), 0);
+      _slots.resize(powerOfTwo(_entries.size() * 2), -1);
+
+      std::vector<size_t> candidates;
+      for (size_t bucketIndex : order) {
+        auto &bucket = buckets[bucketIndex];
+        if (bucket.empty())
+          break;
+
+        for (uint32_t seed = 1;; ++seed) {
+          candidates.clear();
+          for (size_t entry : bucket) {
+            size_t slot = hash(std::string_view(_entries[entry].word, _entries[entry].length), seed) &
+                          (_slots.size() - 1);
+            if (_slots[slot] >= 0 || std::find(candidates.begin(), candidates.end(), slot) != candidates.end())
+              break;
+            candidates.push_back(slot);
+          }
+
+          if (candidates.size() == bucket.size()) {
+            _seeds[bucketIndex] = seed;
+            for (size_t i = 0; i < bucket.size(); ++i)
+              _slots[candidates[i]] = static_cast<int>(bucket[i]);
+            break;
+          }
+        }
+      }
+    }
+  };
+
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 std::set<std::string> const& MySQLSymbolInfo::keywordsForVersion(MySQLVersion version) {
-  if (keywords.count(version) == 0) {
+  static std::map<MySQLVersion, std::set<std::string>> keywords;
+  static std::mutex keywordsMutex;
+
+  std::lock_guard<std::mutex> lock(keywordsMutex);
+  auto iterator = keywords.find(version);
+  if (iterator == keywords.end()) {
     std::set<std::string> list;
-    std::set<std::string> reservedList;
     switch (version) {
-      case MySQLVersion::MySQL56: {
-        size_t listSize = sizeof(keyword_list56) / sizeof(keyword_list56[0]);
-        for (size_t i = 0; i < listSize; ++i) {
-          std::string word = keyword_list56[i].word;
-          list.insert(word);
-          if (keyword_list56[i].reserved != 0)
-            reservedList.insert(word);
-        }
+      case MySQLVersion::MySQL56:
+        for (auto &keyword : keyword_list56)
+          list.insert(keyword.word);
         break;
-      }
 
-      case MySQLVersion::MySQL57: {
-        size_t listSize = sizeof(keyword_list57) / sizeof(keyword_list57[0]);
-        for (size_t i = 0; i < listSize; ++i) {
-          std::string word = keyword_list57[i].word;
-          list.insert(word);
-          if (keyword_list57[i].reserved != 0)
-            reservedList.insert(word);
-        }
+      case MySQLVersion::MySQL57:
+        for (auto &keyword : keyword_list57)
+          list.insert(keyword.word);
         break;
-      }
 
-      case MySQLVersion::MySQL80: {
-        size_t listSize = sizeof(keyword_list80) / sizeof(keyword_list80[0]);
-        for (size_t i = 0; i < listSize; ++i) {
-          std::string word = keyword_list80[i].word;
-          list.insert(word);
-          if (keyword_list80[i].reserved != 0)
-            reservedList.insert(word);
-        }
+      case MySQLVersion::MySQL80:
+        for (auto &keyword : keyword_list80)
+          list.insert(keyword.word);
         break;
-      }
 
       default:
         break;
     }
-    keywords[version] = list;
+    iterator = keywords.emplace(version, std::move(list)).first;
   }
 
-  return keywords[version];
+  return iterator->second;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Case-insensitive lookup of the given word in the keywords of all server versions.
+ */
+KeywordInfo MySQLSymbolInfo::keywordInfo(std::string_view word, MySQLVersion version) {
+  return KeywordTable::get().lookup(word, version);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * The number of keywords over all server versions. Keyword ids are below this value.
+ */
+size_t MySQLSymbolInfo::keywordCount() {
+  return KeywordTable::get().size();
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 
-bool MySQLSymbolInfo::isReservedKeyword(std::string const& identifier, MySQLVersion version) {
-  std::ignore = keywordsForVersion(version);
-  return reservedKeywords[version].count(identifier) > 0;
+bool MySQLSymbolInfo::isReservedKeyword(std::string_view identifier, MySQLVersion version) {
+  return KeywordTable::get().lookup(identifier, version).reserved;
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -113,9 +282,8 @@ bool MySQLSymbolInfo::isReservedKeyword(std::string const& identifier, MySQLVers
 /**
  * For both, reserved and non-reserved keywords.
  */
-bool MySQLSymbolInfo::isKeyword(std::string const& identifier, MySQLVersion version) {
-  auto keywords = keywordsForVersion(version);
-  return keywords.count(identifier) > 0;
+bool MySQLSymbolInfo::isKeyword(std::string_view identifier, MySQLVersion version) {
+  return KeywordTable::get().lookup(identifier, version).keyword;
 }
 
 //----------------------------------------------------------------------------------------------------------------------
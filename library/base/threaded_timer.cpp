@@ -26,6 +26,7 @@
 
 #include "base/threaded_timer.h"
 #include "base/log.h"
+#include "base/profiling.h"
 #include "base/threading.h"
 
 // 30 fps should ensure smooth animations. Higher values are better, but put higher load on a system.
@@ -180,6 +181,14 @@ void ThreadedTimer::pool_function(gpointer data, gpointer user_data) {
   ThreadedTimer *timer = static_cast<ThreadedTimer *>(user_data);
   TimerTask *task = static_cast<TimerTask *>(data);
 
+  // Pool threads are reused, naming them once is enough.
+  static thread_local bool named = false;
+  if (!named && base::Tracer::is_enabled()) {
+    base::Tracer::set_thread_name("ThreadedTimer");
+    named = true;
+  }
+  TRACE_ZONE("ThreadedTimer task");
+
   try {
     bool do_stop = task->callback(task->task_id);
     base::MutexLock lock(timer->_timer_lock);
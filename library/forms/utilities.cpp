@@ -28,6 +28,7 @@
 #include "base/string_utilities.h"
 #include "base/file_functions.h"
 #include "base/log.h"
+#include "base/profiling.h"
 #include "base/threading.h"
 
 #include "mforms/mforms.h"
@@ -904,6 +905,7 @@ bool Utilities::in_main_thread() {
 }
 
 void Utilities::set_thread_name(const std::string &name) {
+  base::Tracer::set_thread_name(name);
   if (ControlFactory::get_instance()->_utilities_impl.set_thread_name)
     ControlFactory::get_instance()->_utilities_impl.set_thread_name(name);
 }
@@ -2072,6 +2072,10 @@ namespace grt {
      */
     bool foreach_validator(const ObjectRef &obj, const Validator::Tag &tag);
 
+    bool has_validators() const {
+      return !_validators.empty();
+    }
+
     inline const MemberList &get_members_partial() {
       return _members;
     }
@@ -102,6 +102,8 @@ static std::string format_type_cpp(const TypeSpec &type, bool unknown_as_void =
           return "grt::DictListRef";
         case ObjectType:
           return "grt::ListRef<" + cppize_class_name(type.content.object_class) + ">";
+        case UnknownType:
+          return "grt::BaseListRef";
         default:
           return "??? invalid ???";
       }
@@ -688,7 +688,9 @@ void MetaClass::add_validator(Validator *v) {
 }
 
 void MetaClass::remove_validator(Validator *v) {
-  throw std::logic_error("void MetaClass::del_validator(Validator* v) not implemented!");
+  ValidatorList::iterator iter = std::find(_validators.begin(), _validators.end(), v);
+  if (iter != _validators.end())
+    _validators.erase(iter);
 }
 
 void MetaClass::set_member_value(internal::Object *object, const std::string &name, const ValueRef &value) {
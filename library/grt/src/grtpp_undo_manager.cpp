@@ -26,7 +26,10 @@
 #include "grtpp_undo_manager.h"
 #include "base/string_utilities.h"
 
+#include <atomic>
 #include <iostream>
+#include <set>
+#include <string.h>
 #include <time.h>
 
 #ifdef _MSC_VER
@@ -106,10 +109,130 @@ static std::string member_for_object_dict(const ObjectRef &object, const DictRef
 
 //---------------------------------------------------------------------------------------------------
 
+// How many plain member changes at the end of a group are checked for a previous change of the same member.
+#define UNDO_MERGE_SCAN_LIMIT 32
+
+static size_t value_footprint(const ValueRef &value, std::set<internal::Value *> &seen, bool follow_objects);
+
+static bool add_member_footprint(const MetaClass::Member *member, const ObjectRef &object,
+                                 std::set<internal::Value *> &seen, size_t *size) {
+  if (member->calculated)
+    return true;
+
+  ValueRef value(object.get_member(member->name));
+  if (value.is_valid() && value.type() == ObjectType && !member->owned_object)
+    *size += sizeof(void *); // only a reference, the target is accounted for by its owner
+  else
+    *size += value_footprint(value, seen, member->owned_object);
+
+  return true;
+}
+
+/** Estimates the memory kept alive by a value referenced from the undo history.
+ *
+ * Objects that are still part of the global tree belong to the live model and are not counted, detached objects
+ * (e.g. a removed table) are counted including everything they own.
+ */
+static size_t value_footprint(const ValueRef &value, std::set<internal::Value *> &seen, bool follow_objects) {
+  if (!value.is_valid() || !seen.insert(value.valueptr()).second)
+    return 0;
+
+  switch (value.type()) {
+    case IntegerType:
+      return sizeof(internal::Integer);
+
+    case DoubleType:
+      return sizeof(internal::Double);
+
+    case StringType:
+      return sizeof(internal::String) + strlen(StringRef::cast_from(value).c_str());
+
+    case ListType: {
+      BaseListRef list(BaseListRef::cast_from(value));
+      size_t size = sizeof(internal::List);
+      for (size_t c = list.count(), i = 0; i < c; i++) {
+        if (list[i].is_valid() && list[i].type() == ObjectType && !follow_objects)
+          size += sizeof(void *);
+        else
+          size += sizeof(void *) + value_footprint(list[i], seen, follow_objects);
+      }
+      return size;
+    }
+
+    case DictType: {
+      DictRef dict(DictRef::cast_from(value));
+      size_t size = sizeof(internal::Dict);
+      for (DictRef::const_iterator iter = dict.begin(); iter != dict.end(); ++iter) {
+        size += sizeof(std::string) + iter->first.size() + sizeof(void *);
+        if (!iter->second.is_valid() || iter->second.type() != ObjectType || follow_objects)
+          size += value_footprint(iter->second, seen, follow_objects);
+      }
+      return size;
+    }
+
+    case ObjectType: {
+      ObjectRef object(ObjectRef::cast_from(value));
+      if (object->is_global())
+        return 0;
+
+      size_t size = sizeof(internal::Object) + object->id().size();
+      object.get_metaclass()->foreach_member(
+        std::bind(&add_member_footprint, std::placeholders::_1, object, std::ref(seen), &size));
+      return size;
+    }
+
+    default:
+      return 0;
+  }
+}
+
+static size_t value_footprint(const ValueRef &value) {
+  std::set<internal::Value *> seen;
+  return value_footprint(value, seen, true);
+}
+
+/** Checks whether a member change is redundant in the given (open) group, which is the case if the same
+ * object member was already changed earlier in the same group. Undoing the group restores the value recorded by the
+ * earlier action, so the intermediate value held by the new one is never observable.
+ *
+ * Only the trailing run of plain member changes is checked, any other kind of action (a list change, a sub group or
+ * a custom action) may depend on the intermediate value and stops the search.
+ */
+static bool is_redundant_change(UndoGroup *group, UndoAction *action) {
+  UndoObjectChangeAction *change = dynamic_cast<UndoObjectChangeAction *>(action);
+  if (!change || !group)
+    return false;
+
+  std::list<UndoAction *> &actions(group->get_actions());
+  int scanned = 0;
+  for (std::list<UndoAction *>::reverse_iterator iter = actions.rbegin();
+       iter != actions.rend() && scanned < UNDO_MERGE_SCAN_LIMIT; ++iter, ++scanned) {
+    UndoObjectChangeAction *previous = dynamic_cast<UndoObjectChangeAction *>(*iter);
+    if (!previous)
+      break;
+
+    if (previous->get_object().valueptr() == change->get_object().valueptr() &&
+        previous->get_member() == change->get_member())
+      return true;
+  }
+  return false;
+}
+
+//---------------------------------------------------------------------------------------------------
+
+static std::atomic<size_t> last_undo_serial(0);
+
+UndoAction::UndoAction() : _serial(++last_undo_serial) {
+}
+
 void UndoAction::set_description(const std::string &description) {
   _description = description;
 }
 
+size_t UndoAction::memory_footprint() const {
+  return sizeof(*this) + _description.size();
+}
+
 //---------------------------------------------------------------------------------------------------
 
 void SimpleUndoAction::dump(std::ostream &out, int indent) const {
@@ -139,6 +262,10 @@ void UndoObjectChangeAction::undo(UndoManager *owner) {
   grt::GRT::get()->stop_tracking_changes();
 }
 
+size_t UndoObjectChangeAction::memory_footprint() const {
+  return sizeof(*this) + _member.size() + description().size() + value_footprint(_value);
+}
+
 void UndoObjectChangeAction::dump(std::ostream &out, int indent) const {
   std::string new_value;
 
@@ -243,6 +370,10 @@ void UndoListSetAction::undo(UndoManager *owner) {
   grt::GRT::get()->stop_tracking_changes();
 }
 
+size_t UndoListSetAction::memory_footprint() const {
+  return sizeof(*this) + description().size() + value_footprint(_value);
+}
+
 void UndoListSetAction::dump(std::ostream &out, int indent) const {
   ObjectRef owner = owner_of_list(_list);
 
@@ -286,6 +417,10 @@ void UndoListRemoveAction::undo(UndoManager *owner) {
   grt::GRT::get()->stop_tracking_changes();
 }
 
+size_t UndoListRemoveAction::memory_footprint() const {
+  return sizeof(*this) + description().size() + value_footprint(_value);
+}
+
 void UndoListRemoveAction::dump(std::ostream &out, int indent) const {
   ObjectRef owner = owner_of_list(_list);
 
@@ -325,6 +460,10 @@ void UndoDictSetAction::undo(UndoManager *owner) {
   }
 }
 
+size_t UndoDictSetAction::memory_footprint() const {
+  return sizeof(*this) + _key.size() + description().size() + value_footprint(_value);
+}
+
 void UndoDictSetAction::dump(std::ostream &out, int indent) const {
   ObjectRef owner = owner_of_dict(_dict);
 
@@ -362,6 +501,10 @@ void UndoDictRemoveAction::undo(UndoManager *owner) {
   }
 }
 
+size_t UndoDictRemoveAction::memory_footprint() const {
+  return sizeof(*this) + _key.size() + description().size() + value_footprint(_value);
+}
+
 void UndoDictRemoveAction::dump(std::ostream &out, int indent) const {
   ObjectRef owner = owner_of_dict(_dict);
 
@@ -380,6 +523,7 @@ void UndoDictRemoveAction::dump(std::ostream &out, int indent) const {
 
 UndoGroup::UndoGroup() {
   _is_open = true;
+  _footprint = 0;
 }
 
 UndoGroup::~UndoGroup() {
@@ -449,9 +593,13 @@ void UndoGroup::add(UndoAction *op) {
   // add the action to the topmost open undo group
   UndoGroup *subgroup = get_deepest_open_subgroup();
 
-  if (subgroup)
-    subgroup->_actions.push_back(op);
-  else
+  if (subgroup) {
+    // repeated changes of the same member (e.g. while dragging a figure) only need the first old value
+    if (is_redundant_change(subgroup, op))
+      delete op;
+    else
+      subgroup->_actions.push_back(op);
+  } else
     throw std::logic_error("trying to add an action to a closed undo group");
 }
 
@@ -486,6 +634,20 @@ std::string UndoGroup::description() const {
   return UndoAction::description();
 }
 
+size_t UndoGroup::memory_footprint() const {
+  if (_footprint > 0)
+    return _footprint;
+
+  size_t size = UndoAction::memory_footprint();
+  for (std::list<UndoAction *>::const_iterator iter = _actions.begin(); iter != _actions.end(); ++iter)
+    size += sizeof(void *) * 2 + (*iter)->memory_footprint();
+
+  // closed groups don't change anymore
+  if (!_is_open)
+    _footprint = size;
+  return size;
+}
+
 void UndoGroup::dump(std::ostream &out, int indent) const {
   out << strfmt("%*s group%s { ", indent, "", _is_open ? "(open)" : "") << std::endl;
   for (std::list<UndoAction *>::const_iterator iter = _actions.begin(); iter != _actions.end(); ++iter) {
@@ -501,6 +663,7 @@ UndoManager::UndoManager() {
   _is_undoing = false;
   _is_redoing = false;
   _undo_limit = 0;
+  _undo_memory_limit = 0;
   _blocks = 0;
 }
 
@@ -548,10 +711,50 @@ void UndoManager::set_undo_limit(size_t limit) {
   trim_undo_stack();
 }
 
+void UndoManager::set_undo_memory_limit(size_t bytes) {
+  _undo_memory_limit = bytes;
+
+  trim_undo_stack();
+}
+
+size_t UndoManager::get_undo_memory_usage() const {
+  size_t size = 0;
+  lock();
+  for (std::deque<UndoAction *>::const_iterator iter = _undo_stack.begin(); iter != _undo_stack.end(); ++iter)
+    size += (*iter)->memory_footprint();
+  for (std::deque<UndoAction *>::const_iterator iter = _redo_stack.begin(); iter != _redo_stack.end(); ++iter)
+    size += (*iter)->memory_footprint();
+  unlock();
+  return size;
+}
+
+/** Drops the oldest undo entries until both the entry count and the memory limit are satisfied.
+ * The newest entry is never dropped.
+ */
 void UndoManager::trim_undo_stack() {
   lock();
-  if (_undo_limit > 0)
-    _undo_stack.erase(_undo_stack.begin(), _undo_stack.begin() + std::max(0, (int)(_undo_stack.size() - _undo_limit)));
+  size_t drop = 0;
+  if (_undo_limit > 0 && _undo_stack.size() > _undo_limit)
+    drop = _undo_stack.size() - _undo_limit;
+
+  if (_undo_memory_limit > 0 && _undo_stack.size() > 1) {
+    size_t used = 0, keep = 0;
+    for (std::deque<UndoAction *>::reverse_iterator iter = _undo_stack.rbegin(); iter != _undo_stack.rend(); ++iter) {
+      used += (*iter)->memory_footprint();
+      if (keep > 0 && used > _undo_memory_limit)
+        break;
+      ++keep;
+    }
+    drop = std::max(drop, _undo_stack.size() - keep);
+  }
+
+  if (drop > 0)
+    logDebug2("Dropping %i old undo entries\n", (int)drop);
+
+  for (; drop > 0; --drop) {
+    delete _undo_stack.front();
+    _undo_stack.pop_front();
+  }
   unlock();
 }
 
@@ -624,6 +827,22 @@ UndoAction *UndoManager::get_latest_undo_action() const {
   return action;
 }
 
+size_t UndoManager::get_latest_undo_serial() const {
+  lock();
+  UndoAction *action = get_latest_undo_action();
+  size_t serial = action != nullptr ? action->serial() : 0;
+  unlock();
+  return serial;
+}
+
+size_t UndoManager::get_latest_closed_undo_serial() const {
+  lock();
+  UndoAction *action = get_latest_closed_undo_action();
+  size_t serial = action != nullptr ? action->serial() : 0;
+  unlock();
+  return serial;
+}
+
 void UndoManager::reset() {
   lock();
   for (std::deque<UndoAction *>::iterator iter = _undo_stack.begin(); iter != _undo_stack.end(); ++iter)
@@ -701,6 +920,10 @@ bool UndoManager::end_undo_group(const std::string &description, bool trim) {
     if (!group->is_open() && _undo_log && _undo_log->good())
       group->dump(*_undo_log);
 
+    // a finished bulk operation may have pushed the history over its memory limit
+    if (!group->is_open() && stack == &_undo_stack && _undo_memory_limit > 0)
+      trim_undo_stack();
+
     if (description != "cancelled")
       _changed_signal();
     /* have to 1st merge or check for signal_apply from the deleted groups
@@ -858,6 +1081,8 @@ void UndoManager::redo() {
 }
 
 void UndoManager::add_undo(UndoAction *cmd) {
+  _action_added_signal(cmd);
+
   if (_blocks > 0) {
     delete cmd;
     return;
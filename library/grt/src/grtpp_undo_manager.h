@@ -35,10 +35,18 @@ namespace grt {
 
   class MYSQLGRT_PUBLIC UndoAction {
     std::string _description;
+    size_t _serial;
 
   public:
+    UndoAction();
     virtual ~UndoAction(){};
 
+    // Unique and increasing for each action created. Unlike the action's address it can be kept to identify a
+    // state of the undo history (e.g. a save point), even after the action was dropped from the history.
+    size_t serial() const {
+      return _serial;
+    }
+
     virtual void set_description(const std::string &description);
 
     virtual void undo(UndoManager *owner) = 0;
@@ -47,6 +55,9 @@ namespace grt {
     }
 
     virtual void dump(std::ostream &out, int indent = 0) const = 0;
+
+    // Approximate number of bytes kept alive by this action (including values that are no longer part of the model).
+    virtual size_t memory_footprint() const;
   };
 
   class MYSQLGRT_PUBLIC SimpleUndoAction : public UndoAction {
@@ -75,6 +86,7 @@ namespace grt {
     UndoObjectChangeAction(const ObjectRef &object, const std::string &member, const ValueRef &value);
 
     virtual void undo(UndoManager *owner);
+    virtual size_t memory_footprint() const;
 
     const ObjectRef &get_object() const {
       return _object;
@@ -82,6 +94,9 @@ namespace grt {
     const std::string &get_member() const {
       return _member;
     }
+    const ValueRef &get_value() const {
+      return _value;
+    }
 
     virtual void dump(std::ostream &out, int indent = 0) const;
   };
@@ -95,6 +110,10 @@ namespace grt {
 
     virtual void undo(UndoManager *owner);
 
+    const BaseListRef &get_list() const {
+      return _list;
+    }
+
     virtual void dump(std::ostream &out, int indent = 0) const;
   };
 
@@ -107,6 +126,11 @@ namespace grt {
     UndoListSetAction(const BaseListRef &list, size_t index);
 
     virtual void undo(UndoManager *owner);
+    virtual size_t memory_footprint() const;
+
+    const BaseListRef &get_list() const {
+      return _list;
+    }
 
     virtual void dump(std::ostream &out, int indent = 0) const;
   };
@@ -120,6 +144,10 @@ namespace grt {
     UndoListReorderAction(const BaseListRef &list, size_t oindex, size_t nindex);
 
     virtual void undo(UndoManager *owner);
+
+    const BaseListRef &get_list() const {
+      return _list;
+    }
     virtual void dump(std::ostream &out, int indent = 0) const;
   };
 
@@ -133,6 +161,11 @@ namespace grt {
     UndoListRemoveAction(const BaseListRef &list, size_t index);
 
     virtual void undo(UndoManager *owner);
+    virtual size_t memory_footprint() const;
+
+    const BaseListRef &get_list() const {
+      return _list;
+    }
     virtual void dump(std::ostream &out, int indent = 0) const;
   };
 
@@ -146,6 +179,11 @@ namespace grt {
     UndoDictSetAction(const DictRef &dict, const std::string &key);
 
     virtual void undo(UndoManager *owner);
+    virtual size_t memory_footprint() const;
+
+    const DictRef &get_dict() const {
+      return _dict;
+    }
     virtual void dump(std::ostream &out, int indent = 0) const;
   };
 
@@ -159,12 +197,18 @@ namespace grt {
     UndoDictRemoveAction(const DictRef &dict, const std::string &key);
 
     virtual void undo(UndoManager *owner);
+    virtual size_t memory_footprint() const;
+
+    const DictRef &get_dict() const {
+      return _dict;
+    }
     virtual void dump(std::ostream &out, int indent = 0) const;
   };
 
   class MYSQLGRT_PUBLIC UndoGroup : public UndoAction {
     std::list<UndoAction *> _actions;
     bool _is_open;
+    mutable size_t _footprint; // cached once the group is closed, 0 if not yet computed
 
   public:
     UndoGroup();
@@ -182,6 +226,7 @@ namespace grt {
     virtual void undo(UndoManager *owner);
 
     virtual void dump(std::ostream &out, int indent = 0) const;
+    virtual size_t memory_footprint() const;
 
     void add(UndoAction *op);
     bool empty() const;
@@ -219,6 +264,14 @@ namespace grt {
       return _undo_limit;
     }
 
+    // Upper bound (in bytes) for the approximate memory held by the undo history, 0 means no limit.
+    // The most recent undo entry is always kept, even if it alone exceeds the limit.
+    void set_undo_memory_limit(size_t bytes);
+    size_t get_undo_memory_limit() const {
+      return _undo_memory_limit;
+    }
+    size_t get_undo_memory_usage() const;
+
     void disable();
     void enable();
     bool is_enabled() const {
@@ -251,6 +304,10 @@ namespace grt {
     UndoAction *get_latest_undo_action() const;
     UndoAction *get_latest_closed_undo_action() const;
 
+    // Serials of the actions above, 0 if there is none.
+    size_t get_latest_undo_serial() const;
+    size_t get_latest_closed_undo_serial() const;
+
     std::string get_running_action_description() const;
 
     UndoSignal *signal_undo() {
@@ -264,6 +321,12 @@ namespace grt {
       return &_changed_signal;
     }
 
+    // Emitted for every action passed to add_undo() (also while undoing/redoing or when undo is disabled),
+    // before the change it describes is applied.
+    UndoSignal *signal_action_added() {
+      return &_action_added_signal;
+    }
+
     void dump_undo_stack();
     void dump_redo_stack();
 
@@ -285,6 +348,7 @@ namespace grt {
     std::deque<UndoAction *> _redo_stack;
 
     size_t _undo_limit;
+    size_t _undo_memory_limit;
 
     int _blocks;
     bool _is_undoing;
@@ -292,6 +356,7 @@ namespace grt {
 
     UndoSignal _undo_signal;
     RedoSignal _redo_signal;
+    UndoSignal _action_added_signal;
     boost::signals2::signal<void()> _changed_signal;
 
     void trim_undo_stack();
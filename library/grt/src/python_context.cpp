@@ -42,6 +42,7 @@
 #include "python_grtdict.h"
 
 #include "base/log.h"
+#include "base/profiling.h"
 
 #ifdef _MSC_VER
 #include "base/event_log.h"
@@ -57,6 +58,10 @@ static const char *GRTTypeSignature = "GRTCONTEXT";
 // used to identify a GRT value as a PyCObject
 static const char *GRTValueSignature = "GRTVALUE";
 
+// The Python wrappers of the GRT objects currently handed out to Python, so that an object passed over several times
+// gets the same wrapper instead of a new one each time. Entries are removed when their wrapper is deallocated.
+static std::unordered_map<internal::Value *, PyObject *> object_wrappers;
+
 static std::string flatten_class_name(std::string name) {
   std::string::size_type p;
   while ((p = name.find('.')) != std::string::npos)
@@ -403,6 +408,50 @@ static PyObject *grt_log_debug3(PyObject *self, PyObject *args) {
   return pylog(base::Logger::LogLevel::Debug3, args);
 }
 
+static PyObject *grt_trace_enabled(PyObject *self, PyObject *args) {
+  if (base::Tracer::is_enabled())
+    Py_RETURN_TRUE;
+  Py_RETURN_FALSE;
+}
+
+static PyObject *pytrace(void (*record)(const char *), PyObject *args) {
+  char *name;
+  if (!PyArg_ParseTuple(args, "s", &name))
+    return NULL;
+
+  // Python strings don't live long enough to be used as event names.
+  if (base::Tracer::is_enabled())
+    record(base::Tracer::intern(name));
+
+  Py_INCREF(Py_None);
+  return Py_None;
+}
+
+static PyObject *grt_trace_begin(PyObject *self, PyObject *args) {
+  return pytrace(&base::Tracer::begin_zone, args);
+}
+
+static PyObject *grt_trace_end(PyObject *self, PyObject *args) {
+  return pytrace(&base::Tracer::end_zone, args);
+}
+
+static PyObject *grt_trace_instant(PyObject *self, PyObject *args) {
+  return pytrace(&base::Tracer::instant, args);
+}
+
+static PyObject *grt_trace_counter(PyObject *self, PyObject *args) {
+  char *name;
+  PY_LONG_LONG value;
+  if (!PyArg_ParseTuple(args, "sL", &name, &value))
+    return NULL;
+
+  if (base::Tracer::is_enabled())
+    base::Tracer::counter(base::Tracer::intern(name), value);
+
+  Py_INCREF(Py_None);
+  return Py_None;
+}
+
 static PyObject *grt_send_output(PyObject *self, PyObject *args) {
   PythonContext *ctx;
   std::string text;
@@ -882,6 +931,8 @@ static PyObject *grt_serialize(PyObject *self, PyObject *args) {
   }
 
   try {
+    WillLeavePython lock;
+
     grt::GRT::get()->serialize(value, path);
   } catch (const std::exception &exc) {
     PythonContext::set_python_error(exc, "serializing object");
@@ -906,7 +957,12 @@ static PyObject *grt_unserialize(PyObject *self, PyObject *args) {
   }
 
   try {
-    grt::ValueRef value = grt::GRT::get()->unserialize(path);
+    grt::ValueRef value;
+    {
+      WillLeavePython lock;
+
+      value = grt::GRT::get()->unserialize(path);
+    }
     return ctx->from_grt(value);
   } catch (const std::exception &exc) {
     PythonContext::set_python_error(exc, base::strfmt("unserializing file %s", path));
@@ -1038,6 +1094,17 @@ static PyMethodDef GrtModuleMethods[] = {
   {"log_info", grt_log_info, METH_VARARGS,
    "Logs an informational message to the log file, in the specified context ex: log_info('myplugin', 'file opened')"},
 
+  {"trace_enabled", grt_trace_enabled, METH_NOARGS,
+   "Returns True if tracing is enabled (see --trace-file), so that collecting expensive trace data can be skipped."},
+  {"trace_begin", grt_trace_begin, METH_VARARGS,
+   "Starts a trace zone on the current thread, to be ended with trace_end() with the same name ex: "
+   "trace_begin('copy schema')"},
+  {"trace_end", grt_trace_end, METH_VARARGS, "Ends a trace zone started with trace_begin()."},
+  {"trace_instant", grt_trace_instant, METH_VARARGS,
+   "Records something happening at a single point in time in the trace ex: trace_instant('connection lost')"},
+  {"trace_counter", grt_trace_counter, METH_VARARGS,
+   "Records the current value of a counter in the trace ex: trace_counter('rows copied', 1500)"},
+
   {"push_message_handler", grt_push_message_handler, METH_VARARGS,
    "Pushes a callback of the form function((type, text, detail)) to be called when a plugin outputs text. Return value "
    "must be True if the message was handled, False if it should be handled by a previously installed handler."},
@@ -1234,6 +1301,14 @@ ValueRef PythonContext::value_from_internal_cobject(PyObject *value) {
   throw std::runtime_error("attempt to extract GRT value from invalid Python object");
 }
 
+/** Called by the object wrapper when it's deallocated, to drop it from the wrapper cache.
+ */
+void PythonContext::forget_object_wrapper(PyObject *wrapper, const ObjectRef &object) {
+  std::unordered_map<internal::Value *, PyObject *>::iterator entry = object_wrappers.find(object.valueptr());
+  if (entry != object_wrappers.end() && entry->second == wrapper)
+    object_wrappers.erase(entry);
+}
+
 /** Convert a GRT value to a Python object/value.
  *
  * For objects, it will also wrap in the appropriate object subclass from grt.classes
@@ -1279,6 +1354,13 @@ PyObject *PythonContext::from_grt(const ValueRef &value) {
         return r;
       }
       case ObjectType: {
+        std::unordered_map<internal::Value *, PyObject *>::const_iterator cached =
+          object_wrappers.find(value.valueptr());
+        if (cached != object_wrappers.end()) {
+          Py_INCREF(cached->second);
+          return cached->second;
+        }
+
         std::string class_name = grt::ObjectRef::cast_from(value).class_name();
         PyObject *content = PythonContext::internal_cobject_from_value(value);
         PyObject *theclass = _grt_class_wrappers[class_name];
@@ -1287,6 +1369,8 @@ PyObject *PythonContext::from_grt(const ValueRef &value) {
         Py_XDECREF(args);
         Py_XDECREF(content);
 
+        if (r)
+          object_wrappers[value.valueptr()] = r;
         return r;
       }
       default:
@@ -1671,6 +1755,8 @@ int PythonContext::refresh() {
   WillEnterPython lock;
 
   _grt_class_wrappers.clear();
+  // wrappers created so far are instances of the old classes
+  object_wrappers.clear();
 
   PyModule_AddObject(get_grt_module(), "root", from_grt(grt::GRT::get()->root()));
 
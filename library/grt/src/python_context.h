@@ -113,6 +113,7 @@ namespace grt {
 
     static PyObject *internal_cobject_from_value(const ValueRef &value);
     static ValueRef value_from_internal_cobject(PyObject *value);
+    static void forget_object_wrapper(PyObject *wrapper, const ObjectRef &object);
 
     static void set_wrap_pyobject_func(PyObject *(*func)(PyObject *, PyObject *));
     static void set_unwrap_pyobject_func(PyObject *(*func)(PyObject *, PyObject *));
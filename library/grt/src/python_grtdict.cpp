@@ -345,6 +345,28 @@ static PyObject *dict_setdefault(PyGRTDictObject *self, PyObject *arg) {
   Py_RETURN_NONE;
 }
 
+// Iterates over a snapshot of the keys, so the dict may be changed while iterating.
+static PyObject *dict_iter(PyGRTDictObject *self) {
+  PyObject *keys = dict_keys(self, NULL);
+  if (!keys)
+    return NULL;
+
+  PyObject *iter = PyObject_GetIter(keys);
+  Py_DECREF(keys);
+  return iter;
+}
+
+static int dict_contains(PyGRTDictObject *self, PyObject *key) {
+  AutoPyObject tmp;
+  if (PyUnicode_Check(key))
+    key = tmp = PyUnicode_AsUTF8String(key);
+
+  if (!PyString_Check(key))
+    return 0;
+
+  return self->dict->has_key(PyString_AsString(key)) ? 1 : 0;
+}
+
 static PyObject *dict_printable(PyGRTDictObject *self) {
   return PyString_FromString(self->dict->toString().c_str());
 }
@@ -383,6 +405,20 @@ static PyMappingMethods PyGRTDictObject_as_mapping = {
   (objobjargproc)dict_ass_subscript // objobjargproc mp_ass_subscript;
 };
 
+static PySequenceMethods PyGRTDictObject_as_sequence = {
+  0,                         // lenfunc sq_length;
+  0,                         // binaryfunc sq_concat;
+  0,                         // ssizeargfunc sq_repeat;
+  0,                         // ssizeargfunc sq_item;
+  0,                         // ssizessizeargfunc sq_slice;
+  0,                         // ssizeobjargproc sq_ass_item;
+  0,                         // ssizessizeobjargproc sq_ass_slice;
+  (objobjproc)dict_contains, // objobjproc sq_contains;
+  /* Added in release 2.0 */
+  0, // binaryfunc sq_inplace_concat;
+  0  // ssizeargfunc sq_inplace_repeat;
+};
+
 static PyTypeObject PyGRTDictObjectType = {
   PyObject_HEAD_INIT(&PyType_Type) // PyObject_VAR_HEAD
   0,
@@ -400,9 +436,9 @@ static PyTypeObject PyGRTDictObjectType = {
 
   /* Method suites for standard classes */
 
-  0,                           //  PyNumberMethods *tp_as_number;
-  0,                           //  PySequenceMethods *tp_as_sequence;
-  &PyGRTDictObject_as_mapping, //  PyMappingMethods *tp_as_mapping;
+  0,                            //  PyNumberMethods *tp_as_number;
+  &PyGRTDictObject_as_sequence, //  PySequenceMethods *tp_as_sequence;
+  &PyGRTDictObject_as_mapping,  //  PyMappingMethods *tp_as_mapping;
 
   /* More standard operations (here for binary compatibility) */
 
@@ -436,8 +472,8 @@ static PyTypeObject PyGRTDictObjectType = {
 
   /* Added in release 2.2 */
   /* Iterators */
-  0, //  getiterfunc tp_iter;
-  0, //  iternextfunc tp_iternext;
+  (getiterfunc)dict_iter, //  getiterfunc tp_iter;
+  0,                      //  iternextfunc tp_iternext;
 
   /* Attribute descriptor and subclassing stuff */
   PyGRTDictMethods,    //  struct PyMethodDef *tp_methods;
@@ -117,6 +117,46 @@ static PyObject *list_item(PyGRTListObject *self, Py_ssize_t index) {
   }
 }
 
+// Converts the items from ilow to ihigh into a Python list, in one go and with the context looked up once.
+static PyObject *list_items_to_pylist(PythonContext *ctx, const grt::BaseListRef &list, Py_ssize_t ilow,
+                                      Py_ssize_t ihigh) {
+  const Py_ssize_t count = (Py_ssize_t)list.count();
+  if (ilow < 0)
+    ilow = 0;
+  if (ihigh > count)
+    ihigh = count;
+  if (ihigh < ilow)
+    ihigh = ilow;
+
+  PyObject *result = PyList_New(ihigh - ilow);
+  if (!result)
+    return NULL;
+
+  for (Py_ssize_t i = ilow; i < ihigh; ++i) {
+    PyObject *item = ctx->from_grt(list[i]);
+    if (!item) {
+      Py_DECREF(result);
+      return NULL;
+    }
+    PyList_SET_ITEM(result, i - ilow, item);
+  }
+  return result;
+}
+
+static PyObject *list_slice(PyGRTListObject *self, Py_ssize_t ilow, Py_ssize_t ihigh) {
+  PythonContext *ctx;
+
+  if (!(ctx = PythonContext::get_and_check()))
+    return NULL;
+
+  try {
+    return list_items_to_pylist(ctx, *self->list, ilow, ihigh);
+  } catch (std::exception &exc) {
+    PythonContext::set_python_error(exc);
+    return NULL;
+  }
+}
+
 static int list_assign(PyGRTListObject *self, Py_ssize_t index, PyObject *value) {
   PythonContext *ctx = PythonContext::get_and_check();
   if (!ctx)
@@ -290,6 +330,58 @@ static PyObject *list_reorder(PyGRTListObject *self, PyObject *args) {
   return NULL;
 }
 
+// Converts the whole list to a tuple of plain Python values in one go, nested lists become tuples too.
+// This spares the caller creating a wrapper object for every nested list and every item access.
+static PyObject *list_to_tuple(PythonContext *ctx, const grt::BaseListRef &list) {
+  const size_t count = list.count();
+  PyObject *tuple = PyTuple_New(count);
+  if (!tuple)
+    return NULL;
+
+  for (size_t i = 0; i < count; ++i) {
+    grt::ValueRef value(list[i]);
+    PyObject *item;
+    if (value.is_valid() && value.type() == grt::ListType)
+      item = list_to_tuple(ctx, grt::BaseListRef::cast_from(value));
+    else
+      item = ctx->from_grt(value);
+    if (!item) {
+      Py_DECREF(tuple);
+      return NULL;
+    }
+    PyTuple_SET_ITEM(tuple, i, item);
+  }
+  return tuple;
+}
+
+static PyObject *list_astuple(PyGRTListObject *self) {
+  PythonContext *ctx = PythonContext::get_and_check();
+  if (!ctx)
+    return NULL;
+
+  try {
+    return list_to_tuple(ctx, *self->list);
+  } catch (std::exception &exc) {
+    PythonContext::set_python_error(exc);
+    return NULL;
+  }
+  return NULL;
+}
+
+static PyObject *list_tolist(PyGRTListObject *self) {
+  PythonContext *ctx = PythonContext::get_and_check();
+  if (!ctx)
+    return NULL;
+
+  try {
+    return list_items_to_pylist(ctx, *self->list, 0, (Py_ssize_t)self->list->count());
+  } catch (std::exception &exc) {
+    PythonContext::set_python_error(exc);
+    return NULL;
+  }
+  return NULL;
+}
+
 static PyObject *list_get_contenttype(PyGRTListObject *self, void *closure) {
   return Py_BuildValue("(ss)", type_to_str(self->list->content_type()).c_str(),
                        self->list->content_class_name().c_str());
@@ -309,6 +401,8 @@ PyDoc_STRVAR(reorder_doc, "L.reorder(oindex, nindex) -- reorder object at index"
 PyDoc_STRVAR(remove_doc, "L.remove(value) -- remove first occurrence of object");
 PyDoc_STRVAR(remove_all_doc, "L.remove_all() -- remove all elements from the list");
 PyDoc_STRVAR(extend_doc, "L.extend(list) -- add all elements from the list");
+PyDoc_STRVAR(astuple_doc, "L.astuple() -- return the contents as a tuple of plain values, nested lists become tuples");
+PyDoc_STRVAR(tolist_doc, "L.tolist() -- return the contents as a Python list");
 
 #if !defined(_MSC_VER) && !defined(__APPLE__)
 
@@ -326,6 +420,8 @@ static PyMethodDef PyGRTListMethods[] = {
   {"reorder", (PyCFunction)list_reorder, METH_VARARGS, reorder_doc},
   {"remove", (PyCFunction)list_remove, METH_O, remove_doc},
   {"remove_all", (PyCFunction)list_remove_all, METH_NOARGS, remove_all_doc},
+  {"astuple", (PyCFunction)list_astuple, METH_NOARGS, astuple_doc},
+  {"tolist", (PyCFunction)list_tolist, METH_NOARGS, tolist_doc},
   {NULL, NULL, 0, NULL}};
 #if !defined(_MSC_VER) && !defined(__APPLE__)
 #pragma GCC diagnostic pop
@@ -338,19 +434,145 @@ static PyGetSetDef PyGRTListGetSetters[] = {
 };
 
 static PySequenceMethods PyGRTListObject_as_sequence = {
-  (lenfunc)list_length,         // lenfunc sq_length;
-  0,                            // binaryfunc sq_concat;
-  0,                            // ssizeargfunc sq_repeat;
-  (ssizeargfunc)list_item,      // ssizeargfunc sq_item;
-  0,                            //(ssizessizeargfunc)list_slice, // ssizessizeargfunc sq_slice;
-  (ssizeobjargproc)list_assign, // ssizeobjargproc sq_ass_item;
-  0,                            ///(ssizessizeobjargproc)list_assign_slice,// ssizessizeobjargproc sq_ass_slice;
-  (objobjproc)list_contains,    // objobjproc sq_contains;
+  (lenfunc)list_length,          // lenfunc sq_length;
+  0,                             // binaryfunc sq_concat;
+  0,                             // ssizeargfunc sq_repeat;
+  (ssizeargfunc)list_item,       // ssizeargfunc sq_item;
+  (ssizessizeargfunc)list_slice, // ssizessizeargfunc sq_slice;
+  (ssizeobjargproc)list_assign,  // ssizeobjargproc sq_ass_item;
+  0,                             ///(ssizessizeobjargproc)list_assign_slice,// ssizessizeobjargproc sq_ass_slice;
+  (objobjproc)list_contains,     // objobjproc sq_contains;
   /* Added in release 2.0 */
   (binaryfunc)list_inplace_concat, // binaryfunc sq_inplace_concat;
   0                                // ssizeargfunc sq_inplace_repeat;
 };
 
+//----------------------------------------------------------------------------------------------
+
+static void listiter_dealloc(PyGRTListIteratorObject *self) {
+  Py_XDECREF(self->owner);
+
+  self->ob_type->tp_free(self);
+}
+
+// Like the iterators of Python lists this one reflects changes of the list while iterating.
+static PyObject *listiter_next(PyGRTListIteratorObject *self) {
+  if (!self->owner)
+    return NULL;
+
+  if (self->index < (Py_ssize_t)self->owner->list->count()) {
+    try {
+      return self->context->from_grt(self->owner->list->get(self->index++));
+    } catch (std::exception &exc) {
+      PythonContext::set_python_error(exc);
+      return NULL;
+    }
+  }
+
+  // exhausted, returning NULL without an exception set ends the iteration
+  Py_CLEAR(self->owner);
+  return NULL;
+}
+
+static PyTypeObject PyGRTListIteratorObjectType = {
+  PyObject_HEAD_INIT(&PyType_Type) // PyObject_VAR_HEAD
+  0,
+  "grt.ListIterator",                 // char *tp_name; /* For printing, in format "<module>.<name>" */
+  sizeof(PyGRTListIteratorObject), 0, // int tp_basicsize, tp_itemsize; /* For allocation */
+
+  /* Methods to implement standard operations */
+
+  (destructor)listiter_dealloc, //  destructor tp_dealloc;
+  0,                            //  printfunc tp_print;
+  0,                            //  getattrfunc tp_getattr;
+  0,                            //  setattrfunc tp_setattr;
+  0,                            //  cmpfunc tp_compare;
+  0,                            //  reprfunc tp_repr;
+
+  /* Method suites for standard classes */
+
+  0, //  PyNumberMethods *tp_as_number;
+  0, //  PySequenceMethods *tp_as_sequence;
+  0, //  PyMappingMethods *tp_as_mapping;
+
+  /* More standard operations (here for binary compatibility) */
+
+  0,                       //  hashfunc tp_hash;
+  0,                       //  ternaryfunc tp_call;
+  0,                       //  reprfunc tp_str;
+  PyObject_GenericGetAttr, //  getattrofunc tp_getattro;
+  0,                       //  setattrofunc tp_setattro;
+
+  /* Functions to access object as input/output buffer */
+  0, //  PyBufferProcs *tp_as_buffer;
+
+  /* Flags to define presence of optional/expanded features */
+  Py_TPFLAGS_DEFAULT, //  long tp_flags;
+
+  0, //  char *tp_doc; /* Documentation string */
+
+  /* Assigned meaning in release 2.0 */
+  /* call function for all accessible objects */
+  0, //  traverseproc tp_traverse;
+
+  /* delete references to contained objects */
+  0, //  inquiry tp_clear;
+
+  /* Assigned meaning in release 2.1 */
+  /* rich comparisons */
+  0, //  richcmpfunc tp_richcompare;
+
+  /* weak reference enabler */
+  0, //  long tp_weaklistoffset;
+
+  /* Added in release 2.2 */
+  /* Iterators */
+  PyObject_SelfIter,           //  getiterfunc tp_iter;
+  (iternextfunc)listiter_next, //  iternextfunc tp_iternext;
+
+  /* Attribute descriptor and subclassing stuff */
+  0,                   //  struct PyMethodDef *tp_methods;
+  0,                   //  struct PyMemberDef *tp_members;
+  0,                   //  struct PyGetSetDef *tp_getset;
+  0,                   //  struct _typeobject *tp_base;
+  0,                   //  PyObject *tp_dict;
+  0,                   //  descrgetfunc tp_descr_get;
+  0,                   //  descrsetfunc tp_descr_set;
+  0,                   //  long tp_dictoffset;
+  0,                   //  initproc tp_init;
+  PyType_GenericAlloc, //  allocfunc tp_alloc;
+  0,                   //  newfunc tp_new;
+  0,                   //  freefunc tp_free; /* Low-level free-memory routine */
+  0,                   //  inquiry tp_is_gc; /* For PyObject_IS_GC */
+  0,                   //  PyObject *tp_bases;
+  0,                   //  PyObject *tp_mro; /* method resolution order */
+  0,                   //  PyObject *tp_cache;
+  0,                   //  PyObject *tp_subclasses;
+  0,                   //  PyObject *tp_weaklist;
+  0,                   // tp_del
+#if (PY_MAJOR_VERSION == 2) && (PY_MINOR_VERSION > 5)
+  0 // tp_version_tag
+#endif
+};
+
+static PyObject *list_iter(PyGRTListObject *self) {
+  PythonContext *ctx = PythonContext::get_and_check();
+  if (!ctx)
+    return NULL;
+
+  PyGRTListIteratorObject *iter = (PyGRTListIteratorObject *)PyType_GenericAlloc(&PyGRTListIteratorObjectType, 0);
+  if (!iter)
+    return NULL;
+
+  Py_INCREF(self);
+  iter->owner = self;
+  iter->context = ctx;
+  iter->index = 0;
+  return (PyObject *)iter;
+}
+
+//----------------------------------------------------------------------------------------------
+
 static PyTypeObject PyGRTListObjectType = {
   PyObject_HEAD_INIT(&PyType_Type) // PyObject_VAR_HEAD
   0,
@@ -404,8 +626,8 @@ static PyTypeObject PyGRTListObjectType = {
 
   /* Added in release 2.2 */
   /* Iterators */
-  0, //  getiterfunc tp_iter;
-  0, //  iternextfunc tp_iternext;
+  (getiterfunc)list_iter, //  getiterfunc tp_iter;
+  0,                      //  iternextfunc tp_iternext;
 
   /* Attribute descriptor and subclassing stuff */
   PyGRTListMethods,    //  struct PyMethodDef *tp_methods;
@@ -437,6 +659,9 @@ void grt::PythonContext::init_grt_list_type() {
   if (PyType_Ready(&PyGRTListObjectType) < 0) {
     throw std::runtime_error("Could not initialize GRT List type in python");
   }
+  if (PyType_Ready(&PyGRTListIteratorObjectType) < 0) {
+    throw std::runtime_error("Could not initialize GRT List iterator type in python");
+  }
 
   Py_INCREF(&PyGRTListObjectType);
   PyModule_AddObject(get_grt_module(), "List", (PyObject *)&PyGRTListObjectType);
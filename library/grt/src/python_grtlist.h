@@ -28,6 +28,10 @@
 
 #include "grt.h"
 
+namespace grt {
+  class PythonContext;
+}
+
 /** Wraps a GRT list object as a Python sequence object
  */
 struct PyGRTListObject {
@@ -35,3 +39,13 @@ struct PyGRTListObject {
 
     grt::BaseListRef *list;
 };
+
+/** Iterates over a GRT list, converting the items as they are requested
+ */
+struct PyGRTListIteratorObject {
+  PyObject_HEAD
+
+    PyGRTListObject *owner;
+  grt::PythonContext *context;
+  Py_ssize_t index;
+};
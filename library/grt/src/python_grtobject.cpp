@@ -189,6 +189,8 @@ static int object_init(PyGRTObjectObject *self, PyObject *args, PyObject *kwds)
     if (!PyArg_ParseTupleAndKeywords(args, kwds, "z|O", (char **)kwlist, &class_name, &valueptr))
       return -1;
 
+    if (self->object)
+      PythonContext::forget_object_wrapper((PyObject *)self, *self->object);
     delete self->object;
 
     if (valueptr && valueptr != Py_None) {
@@ -219,6 +221,8 @@ static int object_init(PyGRTObjectObject *self, PyObject *args, PyObject *kwds)
 }
 
 static void object_dealloc(PyGRTObjectObject *self) {
+  if (self->object)
+    PythonContext::forget_object_wrapper((PyObject *)self, *self->object);
   delete self->object;
 
   self->ob_type->tp_free(self);
@@ -256,39 +260,90 @@ static long object_hash(PyGRTObjectObject *self) {
   return hash;
 }
 
+// What an attribute name refers to in a GRT class, either a member, a method or nothing.
+struct ObjectAttribute {
+  const grt::MetaClass::Member *member;
+  const grt::MetaClass::Method *method;
+};
+
+static std::unordered_map<const grt::MetaClass *, std::unordered_map<std::string, ObjectAttribute> > attribute_cache;
+
+// Looks up an attribute name in the metaclass and its parents, the result is cached per metaclass.
+static const ObjectAttribute &resolve_attribute(grt::MetaClass *meta, const std::string &name) {
+  std::unordered_map<std::string, ObjectAttribute> &attributes = attribute_cache[meta];
+  std::unordered_map<std::string, ObjectAttribute>::const_iterator cached = attributes.find(name);
+  if (cached != attributes.end())
+    return cached->second;
+
+  ObjectAttribute attribute = {NULL, NULL};
+  // same search as MetaClass::get_member_value(), overriding members have the property of the overridden one
+  for (grt::MetaClass *mc = meta; mc; mc = mc->parent()) {
+    const grt::MetaClass::MemberList &members = mc->get_members_partial();
+    grt::MetaClass::MemberList::const_iterator member = members.find(name);
+    if (member != members.end() && (!member->second.overrides || !mc->parent())) {
+      if (member->second.property)
+        attribute.member = &member->second;
+      break;
+    }
+  }
+  if (!attribute.member)
+    attribute.method = meta->get_method_info(name);
+
+  return attributes[name] = attribute;
+}
+
+// Whether the name is found as a regular Python attribute, defined in the wrapper class or set in the instance.
+static bool is_python_attribute(PyObject *self, PyObject *attr_name) {
+  if (_PyType_Lookup(Py_TYPE(self), attr_name))
+    return true;
+
+  PyObject **dict = _PyObject_GetDictPtr(self);
+  return dict && *dict && PyDict_GetItem(*dict, attr_name);
+}
+
 static PyObject *object_getattro(PyGRTObjectObject *self, PyObject *attr_name) {
   if (PyString_Check(attr_name)) {
     const char *attrname = PyString_AsString(attr_name);
 
-    PyObject *object;
-    if ((object = PyObject_GenericGetAttr((PyObject *)self, attr_name)))
-      return object;
-    PyErr_Clear();
-
-    if (strcmp(attrname, "__grtclassname__") == 0)
-      return Py_BuildValue("s", self->object->class_name().c_str());
-    else if (strcmp(attrname, "__id__") == 0)
-      return Py_BuildValue("s", self->object->id().c_str());
-    else {
-      if (self->object->has_member(attrname)) {
+    // Members and methods are resolved before the generic lookup, which would have to raise and clear
+    // an AttributeError for each of them.
+    if (!is_python_attribute((PyObject *)self, attr_name)) {
+      const ObjectAttribute &attribute = resolve_attribute(self->object->get_metaclass(), attrname);
+      if (attribute.member) {
         PythonContext *ctx = PythonContext::get_and_check();
         if (!ctx)
           return NULL;
 
-        return ctx->from_grt(self->object->get_member(attrname));
-      } else if (self->object->has_method(attrname)) {
+        try {
+          return ctx->from_grt(attribute.member->property->get(&self->object->content()));
+        } catch (std::exception &exc) {
+          PythonContext::set_python_error(exc);
+          return NULL;
+        }
+      } else if (attribute.method) {
         // create a method call object and return it
         PyGRTMethodObject *method = (PyGRTMethodObject *)PyType_GenericNew(&PyGRTMethodObjectType, NULL, NULL);
         if (!method)
           return NULL;
 
         method->object = new grt::ObjectRef(*self->object);
-        method->method = self->object->get_metaclass()->get_method_info(attrname);
+        method->method = attribute.method;
 
         return (PyObject *)method;
-      } else
-        PyErr_SetString(PyExc_AttributeError, strfmt("unknown attribute '%s'", attrname).c_str());
+      }
     }
+
+    PyObject *object;
+    if ((object = PyObject_GenericGetAttr((PyObject *)self, attr_name)))
+      return object;
+    PyErr_Clear();
+
+    if (strcmp(attrname, "__grtclassname__") == 0)
+      return Py_BuildValue("s", self->object->class_name().c_str());
+    else if (strcmp(attrname, "__id__") == 0)
+      return Py_BuildValue("s", self->object->id().c_str());
+    else
+      PyErr_SetString(PyExc_AttributeError, strfmt("unknown attribute '%s'", attrname).c_str());
   }
   return NULL;
 }
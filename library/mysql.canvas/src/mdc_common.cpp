@@ -31,6 +31,7 @@
 #endif
 
 #include <errno.h>
+#include <unordered_map>
 
 #include <cairo/cairo-ps.h>
 #include <cairo/cairo-pdf.h>
@@ -89,10 +90,20 @@ struct ScaledFont {
   }
 };
 
+// Number of measured strings kept per context. Diagrams show the same captions over and over again (on every relayout
+// and zoom change), so this saves most of the text measuring.
+#define TEXT_RUN_CACHE_SIZE 4096
+
 class mdc::FontManager {
+  typedef std::list<std::pair<std::string, std::shared_ptr<const TextRun> > > RunList;
+
   std::map<std::string, std::list<ScaledFont> > _cache;
   CairoCtx *_cairo;
 
+  // Least recently used measured strings first, keyed by font and text.
+  RunList _runs;
+  std::unordered_map<std::string, RunList::iterator> _run_index;
+
   cairo_scaled_font_t *lookup(const FontSpec &spec) {
     if (_cache.find(spec.family) != _cache.end()) {
       std::list<ScaledFont> &flist(_cache[spec.family]);
@@ -188,8 +199,105 @@ public:
 
     return font;
   }
+
+  std::shared_ptr<const TextRun> get_text_run(const FontSpec &spec, const std::string &text) {
+    std::string key = base::strfmt("%s\n%i %i %f\n", spec.family.c_str(), spec.slant, spec.weight, spec.size);
+    key.append(text);
+
+    std::unordered_map<std::string, RunList::iterator>::iterator entry = _run_index.find(key);
+    if (entry != _run_index.end()) {
+      _runs.splice(_runs.end(), _runs, entry->second);
+      return entry->second->second;
+    }
+
+    std::shared_ptr<const TextRun> run = std::make_shared<TextRun>(get_font(spec), text);
+    if (_runs.size() >= TEXT_RUN_CACHE_SIZE) {
+      _run_index.erase(_runs.front().first);
+      _runs.pop_front();
+    }
+    _runs.push_back(std::make_pair(key, run));
+    _run_index[key] = std::prev(_runs.end());
+
+    return run;
+  }
 };
 
+//--------------------------------------------------------------------------------------------------
+
+TextRun::TextRun(cairo_scaled_font_t *font, const std::string &text) : _font(cairo_scaled_font_reference(font)) {
+  cairo_glyph_t *glyphs = nullptr;
+  int num_glyphs = 0;
+  cairo_text_cluster_t *clusters = nullptr;
+  int num_clusters = 0;
+  cairo_text_cluster_flags_t flags;
+
+  if (cairo_scaled_font_text_to_glyphs(font, 0, 0, text.c_str(), (int)text.size(), &glyphs, &num_glyphs, &clusters,
+                                       &num_clusters, &flags) == CAIRO_STATUS_SUCCESS) {
+    _glyphs.assign(glyphs, glyphs + num_glyphs);
+
+    cairo_text_extents_t extents;
+    cairo_scaled_font_glyph_extents(font, glyphs, num_glyphs, &extents);
+
+    // Clusters are in logical order and glyphs are positioned one after the other, so the x position of the first
+    // glyph of a cluster is the width of the text before it. Backward (RTL) clusters are not produced by the
+    // fonts we create, they are handled as a single unbreakable character.
+    size_t byte = 0, glyph = 0;
+    if (flags & CAIRO_TEXT_CLUSTER_FLAG_BACKWARD)
+      num_clusters = 0;
+    for (int i = 0; i < num_clusters; ++i) {
+      _offsets.push_back(byte);
+      _first_glyph.push_back(glyph);
+      _advances.push_back(glyph < _glyphs.size() ? std::max(_glyphs[glyph].x, _advances.empty() ? 0 : _advances.back())
+                                                 : extents.x_advance);
+      byte += clusters[i].num_bytes;
+      glyph += clusters[i].num_glyphs;
+    }
+    if (byte < text.size() || glyph < _glyphs.size()) {
+      // whatever wasn't covered by clusters is one more character
+      _offsets.push_back(byte);
+      _first_glyph.push_back(glyph);
+      _advances.push_back(glyph < _glyphs.size() ? _glyphs[glyph].x : extents.x_advance);
+    }
+    _offsets.push_back(text.size());
+    _first_glyph.push_back(_glyphs.size());
+    _advances.push_back(std::max(extents.x_advance, _advances.empty() ? 0 : _advances.back()));
+
+    cairo_glyph_free(glyphs);
+    cairo_text_cluster_free(clusters);
+  } else {
+    // the text cannot be measured, treat it as a single character without width
+    if (!text.empty()) {
+      _offsets.push_back(0);
+      _first_glyph.push_back(0);
+      _advances.push_back(0);
+    }
+    _offsets.push_back(text.size());
+    _first_glyph.push_back(0);
+    _advances.push_back(0);
+  }
+}
+
+TextRun::~TextRun() {
+  cairo_scaled_font_destroy(_font);
+}
+
+size_t TextRun::index_at(size_t byte_offset) const {
+  std::vector<size_t>::const_iterator iter = std::upper_bound(_offsets.begin(), _offsets.end(), byte_offset);
+  if (iter == _offsets.begin())
+    return 0;
+  return std::min((size_t)(iter - _offsets.begin()) - 1, length());
+}
+
+void TextRun::get_extents(size_t from, size_t to, cairo_text_extents_t &extents) const {
+  size_t first = _first_glyph[from];
+  size_t last = _first_glyph[to];
+
+  if (last > first)
+    cairo_scaled_font_glyph_extents(_font, &_glyphs[first], (int)(last - first), &extents);
+  else
+    memset(&extents, 0, sizeof(extents));
+}
+
 Surface::Surface(const Surface &other) : surface(cairo_surface_reference(other.surface)) {
 }
 
@@ -312,11 +420,19 @@ void CairoCtx::set_font(const FontSpec &font) const {
 }
 
 void CairoCtx::get_text_extents(const FontSpec &font, const std::string &text, cairo_text_extents_t &extents) {
-  cairo_scaled_font_text_extents(fm->get_font(font), text.c_str(), &extents);
+  std::shared_ptr<const TextRun> run = fm->get_text_run(font, text);
+  run->get_extents(0, run->length(), extents);
 }
 
 void CairoCtx::get_text_extents(const FontSpec &font, const char *text, cairo_text_extents_t &extents) {
-  cairo_scaled_font_text_extents(fm->get_font(font), text, &extents);
+  get_text_extents(font, std::string(text ? text : ""), extents);
+}
+
+/**
+ * Returns the measured glyphs of the text, from a cache of recently used strings.
+ */
+std::shared_ptr<const TextRun> CairoCtx::get_text_run(const FontSpec &font, const std::string &text) {
+  return fm->get_text_run(font, text);
 }
 
 bool CairoCtx::get_font_extents(const FontSpec &font, cairo_font_extents_t &extents) {
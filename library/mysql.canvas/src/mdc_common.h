@@ -30,6 +30,7 @@
 #include <vector>
 #include <string>
 #include <map>
+#include <memory>
 #include <set>
 #include <stdexcept>
 #include <assert.h>
@@ -195,6 +196,50 @@ namespace mdc {
   };
 #endif
 
+  /**
+   * A piece of text measured once with a given font. It keeps the glyphs of the whole string, so the width and extents
+   * of any part of it can be computed without measuring again. Positions are character indexes (0..length()), where
+   * character means a cluster of glyphs that cannot be split.
+   */
+  class MYSQLCANVAS_PUBLIC_FUNC TextRun {
+  public:
+    TextRun(cairo_scaled_font_t *font, const std::string &text);
+    ~TextRun();
+
+    size_t length() const {
+      return _offsets.size() - 1;
+    }
+
+    // Byte offset in the text of the character at the given index (the text length for length()).
+    size_t byte_offset(size_t index) const {
+      return _offsets[index];
+    }
+
+    // Index of the character that contains the given byte offset.
+    size_t index_at(size_t byte_offset) const;
+
+    // Width of the text up to the character at the given index.
+    double advance(size_t index) const {
+      return _advances[index];
+    }
+
+    double width(size_t from, size_t to) const {
+      return _advances[to] - _advances[from];
+    }
+
+    void get_extents(size_t from, size_t to, cairo_text_extents_t &extents) const;
+
+  private:
+    cairo_scaled_font_t *_font;
+    std::vector<cairo_glyph_t> _glyphs;
+    std::vector<size_t> _offsets;     // byte offset of each character plus the text length
+    std::vector<size_t> _first_glyph; // first glyph of each character plus the glyph count
+    std::vector<double> _advances;    // prefix sums of the character advances
+
+    TextRun(const TextRun &) = delete;
+    TextRun &operator=(const TextRun &) = delete;
+  };
+
   class FontManager;
 
   struct MYSQLCANVAS_PUBLIC_FUNC CairoCtx {
@@ -287,6 +332,7 @@ namespace mdc {
     void set_font(const FontSpec &font) const;
     void get_text_extents(const FontSpec &font, const std::string &text, cairo_text_extents_t &extents);
     void get_text_extents(const FontSpec &font, const char *text, cairo_text_extents_t &extents);
+    std::shared_ptr<const TextRun> get_text_run(const FontSpec &font, const std::string &text);
     bool get_font_extents(const FontSpec &font, cairo_font_extents_t &extents);
 
     inline void set_source_surface(cairo_surface_t *srf, double x, double y) {
@@ -98,83 +98,63 @@ void TextFigure::reset_shrinked_text() {
 }
 
 /**
- * Returns the width for a piece of text depending on the used font setting.
- *
- * @param cr The context to which rendering will occur.
- * @param font The actual font specification to be used for rendering.
- * @param ptr The text to compute the width for.
- * @param offset Limits the length of the text to be considered for computation.
- *
- * @return A value describing the computed text width.
+ * Returns the largest character index in [first, run.length()] for which the given predicate still holds.
+ * The predicate must hold for first and be monotonic, which is the case for anything comparing widths, as the
+ * advances are prefix sums.
  */
-static double get_text_width(CairoCtx *cr, const FontSpec &font, gchar *ptr, int offset,
-                             cairo_text_extents_t &extents) {
-  gchar save = ptr[offset];
-  ptr[offset] = 0;
-
-  cr->get_text_extents(font, ptr, extents);
-  ptr[offset] = save;
-
-  return extents.x_advance;
-}
-
-static std::string fit_text_to_width(CairoCtx *cr, const FontSpec &font, const std::string &text, double width,
-                                     cairo_text_extents_t &extents) {
-  gchar *ptr, *p, *prev;
-  // calculate length in characters of string and also a mapping from character -> offset
-  prev = p = ptr = g_strdup(text.c_str());
-  while (p != NULL && *p) {
-    double w;
-
-    if (floor(w = get_text_width(cr, font, ptr, (int)(p - ptr), extents)) >= width) {
-      g_free(ptr);
-      return text.substr(0, prev - ptr);
-    }
-
-    prev = p;
-    p = g_utf8_next_char(p);
+template <typename Fits>
+static size_t last_fitting_index(const TextRun &run, size_t first, Fits fits) {
+  size_t low = first, high = run.length();
+  while (low < high) {
+    size_t middle = low + (high - low + 1) / 2;
+    if (fits(middle))
+      low = middle;
+    else
+      high = middle - 1;
   }
+  return low;
+}
 
-  g_free(ptr);
+/**
+ * Returns the longest prefix of the text whose width (rounded down) stays below the given width.
+ *
+ * @param run The measured text.
+ * @param text The text that was measured.
+ * @param width The available width.
+ */
+static std::string fit_text_to_width(const TextRun &run, const std::string &text, double width) {
+  if (width <= 0)
+    return "";
 
-  return text;
+  size_t index = last_fitting_index(run, 0, [&](size_t i) { return floor(run.advance(i)) < width; });
+  return text.substr(0, run.byte_offset(index));
 }
 
-static base::Range fit_text_to_width_word_wrap(CairoCtx *cr, const FontSpec &font, const std::string &text,
-                                               double width, cairo_text_extents_t &extents) {
-  gchar *ptr, *p, *prev, *pp, *start;
-  // calculate length in characters of string and also a mapping from character -> offset
-  prev = pp = p = ptr = g_strdup(text.c_str());
-
-  // skip whitespaces at the beginning of the text
-  while (*p == ' ')
-    ++p;
-  start = prev = pp = p;
-
-  // pp points to the start of the word break sequence, while p points to the end (beginning of next word)
-  while (p != NULL && *p) {
-    prev = pp;
-
-    while (*p == ' ') // skip spaces in words, as they will be all trimmed at the end of the line
-      ++p;
-    pp = strchr(p, ' '); // try to find the next word
-    if (!pp && p < ptr + text.length())
-      pp = ptr + text.length();
-    p = pp;
-
-    // the ptr param must be mutable
-    if (p && get_text_width(cr, font, start, (int)(p - start), extents) > width) {
-      g_free(ptr);
-      return base::Range(start - ptr, prev - start);
-    }
-  }
-
-  if (p && get_text_width(cr, font, start, (int)(p - start), extents) < width) {
-    g_free(ptr);
-    return base::Range(start - ptr, p - start);
+/**
+ * Determines the part of the text starting at the given byte offset that fits into the given width when breaking
+ * lines at word boundaries. Leading spaces are skipped.
+ *
+ * @return The byte range of the line, which is empty if not even the first word fits.
+ */
+static base::Range fit_text_to_width_word_wrap(const TextRun &run, const std::string &text, size_t from,
+                                               double width) {
+  size_t start = from;
+  while (start < text.size() && text[start] == ' ')
+    ++start;
+
+  size_t first = run.index_at(start);
+  size_t last = last_fitting_index(run, first, [&](size_t i) { return run.width(first, i) <= width; });
+  size_t end = run.byte_offset(last);
+
+  if (end >= text.size())
+    return base::Range(start, text.size() - start);
+
+  // go back to the end of the last word that fits completely
+  for (; end > start; --end) {
+    if (text[end] == ' ' && text[end - 1] != ' ')
+      return base::Range(start, end - start);
   }
-  g_free(ptr);
-  return base::Range(0, text.length());
+  return base::Range(start, 0);
 }
 
 void TextFigure::draw_contents(CairoCtx *cr, const Rect &bounds) {
@@ -241,8 +221,8 @@ void TextFigure::draw_contents(CairoCtx *cr, const Rect &bounds) {
       if (_shrinked_text.empty()) {
         cr->get_text_extents(_font, "\xe2\x80\xa6", extents);
 
-        _shrinked_text =
-          fit_text_to_width(cr, _font, _text, bounds.size.width - 2 * _xpadding - extents.x_advance, extents);
+        _shrinked_text = fit_text_to_width(*cr->get_text_run(_font, _text), _text,
+                                           bounds.size.width - 2 * _xpadding - extents.x_advance);
         _shrinked_text.append("\xe2\x80\xa6");
       }
       text = _shrinked_text;
@@ -426,8 +406,11 @@ void TextLayout::relayout(CairoCtx *cr) {
 
 void TextLayout::layout_paragraph(CairoCtx *cr, Paragraph &para) {
   cairo_text_extents_t ext;
+  std::string text(_text, para.text_offset, para.text_length);
 
-  cr->get_text_extents(_font, std::string(_text.c_str() + para.text_offset, para.text_length), ext);
+  // The paragraph is measured only once, lines are then fitted using the advances of its characters.
+  std::shared_ptr<const TextRun> run = cr->get_text_run(_font, text);
+  run->get_extents(0, run->length(), ext);
 
   if (_fixed_size.width < 0 || ext.width < _fixed_size.width) {
     Line line;
@@ -440,29 +423,33 @@ void TextLayout::layout_paragraph(CairoCtx *cr, Paragraph &para) {
     _lines.push_back(line);
   } else {
     Line line;
-    size_t offset = para.text_offset;
-    size_t length = para.text_length;
-
-    for (;;) {
-      base::Range range =
-        fit_text_to_width_word_wrap(cr, _font, std::string(_text.c_str() + offset, length), _fixed_size.width, ext);
-      offset += range.position;
-      line.text_offset = offset;
-      if (range.size <= 0)
-        line.text_length = 1;
-      else
-        line.text_length = range.size;
+    size_t offset = 0;
+
+    while (offset < text.size()) {
+      base::Range range = fit_text_to_width_word_wrap(*run, text, offset, _fixed_size.width);
+      if (range.position >= text.size())
+        break; // only spaces left
+
+      size_t first = run->index_at(range.position);
+      size_t last;
+      if (range.size > 0)
+        last = run->index_at(range.position + range.size);
+      else {
+        // not even a single word fits, so break it at the last character that does (but take at least one)
+        last = last_fitting_index(*run, first, [&](size_t i) { return run->width(first, i) <= _fixed_size.width; });
+        last = std::max(last, first + 1);
+      }
+
+      line.text_offset = para.text_offset + range.position;
+      line.text_length = run->byte_offset(last) - range.position;
 
+      run->get_extents(first, last, ext);
       line.offset = Point(ceil(ext.x_bearing), ceil(ext.height * 2 + ext.y_bearing));
       line.size = Size(ceil(std::max(ext.width, ext.x_advance)), ceil(std::max(ext.height, ext.y_advance)));
 
       _lines.push_back(line);
 
-      if (line.text_offset + line.text_length >= para.text_length)
-        break;
-
-      offset += range.position + line.text_length;
-      length -= range.position + line.text_length;
+      offset = range.position + line.text_length;
     }
   }
 }
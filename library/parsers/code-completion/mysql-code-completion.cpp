@@ -524,14 +524,16 @@ static ObjectFlags determineQualifier(Scanner &scanner, MySQLLexer *lexer, size_
   if (scanner.tokenChannel() != 0)
     scanner.next(true); // First skip to the next non-hidden token.
 
-  if (!scanner.is(MySQLLexer::DOT_SYMBOL) && !lexer->isIdentifier(scanner.tokenType())) {
+  if (!scanner.is(MySQLLexer::DOT_SYMBOL) && !lexer->isIdentifierAfter(scanner.tokenType(), scanner.lookBack())) {
     // We are at the end of an incomplete identifier spec. Jump back, so that the other tests succeed.
     scanner.previous(true);
   }
 
   // Go left until we find something not related to an id or find at most 1 dot.
+  // Keywords after a dot (e.g. "t . order") are identifiers too.
   if (position > 0) {
-    if (lexer->isIdentifier(scanner.tokenType()) && scanner.lookBack() == MySQLLexer::DOT_SYMBOL)
+    if (scanner.lookBack() == MySQLLexer::DOT_SYMBOL &&
+        lexer->isIdentifierAfter(scanner.tokenType(), MySQLLexer::DOT_SYMBOL))
       scanner.previous(true);
     if (scanner.is(MySQLLexer::DOT_SYMBOL) && lexer->isIdentifier(scanner.lookBack()))
       scanner.previous(true);
@@ -570,24 +572,28 @@ static ObjectFlags determineSchemaTableQualifier(Scanner &scanner, MySQLLexer *l
     scanner.next(true);
 
   size_t tokenType = scanner.tokenType();
-  if (tokenType != MySQLLexer::DOT_SYMBOL && !lexer->isIdentifier(scanner.tokenType())) {
+  if (tokenType != MySQLLexer::DOT_SYMBOL && !lexer->isIdentifierAfter(scanner.tokenType(), scanner.lookBack())) {
     // Just like in the simpler function. If we have found no identifier or dot then we are at the
     // end of an incomplete definition. Simply seek back to the previous non-hidden token.
     scanner.previous(true);
   }
 
   // Go left until we find something not related to an id or at most 2 dots.
+  // Keywords after a dot (e.g. "s . order . c") are identifiers too.
   if (position > 0) {
-    if (lexer->isIdentifier(scanner.tokenType()) && (scanner.lookBack() == MySQLLexer::DOT_SYMBOL))
+    if ((scanner.lookBack() == MySQLLexer::DOT_SYMBOL) &&
+        lexer->isIdentifierAfter(scanner.tokenType(), MySQLLexer::DOT_SYMBOL))
       scanner.previous(true);
-    if (scanner.is(MySQLLexer::DOT_SYMBOL) && lexer->isIdentifier(scanner.lookBack())) {
-      scanner.previous(true);
-
-      // And once more.
-      if (scanner.lookBack() == MySQLLexer::DOT_SYMBOL) {
-        scanner.previous(true);
-        if (lexer->isIdentifier(scanner.lookBack()))
+    if (scanner.is(MySQLLexer::DOT_SYMBOL) && scanner.previous(true)) {
+      if (lexer->isIdentifierAfter(scanner.tokenType(), scanner.lookBack())) {
+        // And once more.
+        if (scanner.lookBack() == MySQLLexer::DOT_SYMBOL) {
           scanner.previous(true);
+          if (lexer->isIdentifier(scanner.lookBack()))
+            scanner.previous(true);
+        }
+      } else {
+        scanner.next(true); // Back to the dot.
       }
     }
   }
@@ -609,7 +615,7 @@ static ObjectFlags determineSchemaTableQualifier(Scanner &scanner, MySQLLexer *l
   scanner.next(true); // Skip dot.
   table = temp;
   schema = temp;
-  if (lexer->isIdentifier(scanner.tokenType())) {
+  if (lexer->isIdentifierAfter(scanner.tokenType(), MySQLLexer::DOT_SYMBOL)) {
     temp = base::unquote(scanner.tokenText());
     scanner.next(true);
 
@@ -808,6 +814,10 @@ std::vector<std::pair<int, std::string>> getCodeCompletionList(size_t caretLine,
   dfa::Vocabulary const &vocabulary = parser->getVocabulary();
 
   for (auto &candidate : context.completionCandidates.tokens) {
+    // Keywords not known in the current server version (the lexer would not produce them) are no candidates.
+    if (lexer != nullptr && !lexer->isKeywordForVersion(candidate.first))
+      continue;
+
     std::string entry = vocabulary.getDisplayName(candidate.first);
     if (entry.rfind("_SYMBOL") != std::string::npos)
       entry.resize(entry.size() - 7);
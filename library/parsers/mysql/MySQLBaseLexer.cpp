@@ -49,6 +49,48 @@ void MySQLBaseLexer::reset() {
 
 //----------------------------------------------------------------------------------------------------------------------
 
+namespace {
+
+  /**
+   * Maps between keyword token types (e.g. SELECT_SYMBOL) and the keyword ids from MySQLSymbolInfo.
+   * The vocabulary is the same for all lexer instances, so this is created only once.
+   */
+  struct KeywordTokenMap {
+    std::vector<std::string> keywordForType; // The keyword text or empty if the type is not a keyword.
+    std::vector<size_t> typeForKeyword;
+
+    KeywordTokenMap(dfa::Vocabulary const& vocabulary) {
+      size_t max = vocabulary.getMaxTokenType();
+      keywordForType.resize(max + 1);
+      typeForKeyword.resize(MySQLSymbolInfo::keywordCount(), Token::INVALID_TYPE);
+
+      static const std::string suffix = "_SYMBOL";
+      for (size_t type = 0; type <= max; ++type) {
+        std::string name = vocabulary.getSymbolicName(type);
+        if (name.size() <= suffix.size() || name.compare(name.size() - suffix.size(), suffix.size(), suffix) != 0)
+          continue;
+
+        name.resize(name.size() - suffix.size());
+        KeywordInfo info = MySQLSymbolInfo::keywordInfo(name, MySQLVersion::Unknown);
+        if (info.id == KeywordInfo::NotAKeyword)
+          continue;
+
+        keywordForType[type] = name;
+        if (typeForKeyword[info.id] == Token::INVALID_TYPE)
+          typeForKeyword[info.id] = type;
+      }
+    }
+  };
+
+  KeywordTokenMap const& keywordTokenMap(dfa::Vocabulary const& vocabulary) {
+    static KeywordTokenMap map(vocabulary);
+    return map;
+  }
+
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 /**
  * Returns true if the given token is an identifier. This includes all those keywords that are
  * allowed as identifiers when unquoted (non-reserved keywords).
@@ -61,36 +103,63 @@ bool MySQLBaseLexer::isIdentifier(size_t type) const {
   if (((sqlMode & AnsiQuotes) != 0) && (type == MySQLLexer::DOUBLE_QUOTED_TEXT))
     return true;
 
-  std::string symbol = getVocabulary().getSymbolicName(type);
-  if (!symbol.empty() && !MySQLSymbolInfo::isReservedKeyword(symbol, MySQLSymbolInfo::numberToVersion(serverVersion)))
-    return true;
+  auto &map = keywordTokenMap(getVocabulary());
+  if (type < map.keywordForType.size() && !map.keywordForType[type].empty()) {
+    MySQLVersion version = MySQLSymbolInfo::numberToVersion(serverVersion);
+    return !MySQLSymbolInfo::isReservedKeyword(map.keywordForType[type], version);
+  }
 
   return false;
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 
-size_t MySQLBaseLexer::keywordFromText(std::string const& name) {
-  // (My)SQL only uses ASCII chars for keywords so we can do a simple downcase here for comparison.
-  std::string transformed;
-  std::transform(name.begin(), name.end(), std::back_inserter(transformed), ::tolower);
+/**
+ * Like isIdentifier, but for a token following one of the given type. Any keyword directly after a dot is an
+ * identifier (e.g. the "order" in "t . order"), reserved or not. Use this when walking the parts of a qualified name.
+ */
+bool MySQLBaseLexer::isIdentifierAfter(size_t type, size_t previousType) const {
+  if (isIdentifier(type))
+    return true;
 
-  if (!MySQLSymbolInfo::isKeyword(transformed, MySQLSymbolInfo::numberToVersion(serverVersion)))
-    return INVALID_INDEX - 1; // INVALID_INDEX alone can be interpreted as EOF.
+  if (previousType != MySQLLexer::DOT_SYMBOL)
+    return false;
 
-  // Generate string -> enum value map, if not yet done.
-  if (_symbols.empty()) {
-    auto &vocabulary = getVocabulary();
-    size_t max = vocabulary.getMaxTokenType();
-    for (size_t i = 0; i <= max; ++i)
-      _symbols[vocabulary.getSymbolicName(i)] = i;
-  }
+  auto &map = keywordTokenMap(getVocabulary());
+  return type < map.keywordForType.size() && !map.keywordForType[type].empty();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Returns the token type for the given text, if that is a keyword in the current server version.
+ * Otherwise returns INVALID_INDEX - 1.
+ */
+size_t MySQLBaseLexer::keywordFromText(std::string const& name) {
+  // Case-insensitive and without allocations.
+  KeywordInfo info = MySQLSymbolInfo::keywordInfo(name, MySQLSymbolInfo::numberToVersion(serverVersion));
+  if (!info.keyword)
+    return INVALID_INDEX - 1; // INVALID_INDEX alone can be interpreted as EOF.
 
-  // Here we know for sure we got a keyword.
-  auto symbol = _symbols.find(transformed);
-  if (symbol == _symbols.end())
+  size_t type = keywordTokenMap(getVocabulary()).typeForKeyword[info.id];
+  if (type == Token::INVALID_TYPE)
     return INVALID_INDEX - 1;
-  return symbol->second;
+  return type;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Returns false if the given token type is a keyword in some server version, but not in the current one.
+ * Used to filter keyword candidates in code completion.
+ */
+bool MySQLBaseLexer::isKeywordForVersion(size_t type) const {
+  auto &map = keywordTokenMap(getVocabulary());
+  if (type >= map.keywordForType.size() || map.keywordForType[type].empty())
+    return true;
+
+  MySQLVersion version = MySQLSymbolInfo::numberToVersion(serverVersion);
+  return version == MySQLVersion::Unknown || MySQLSymbolInfo::isKeyword(map.keywordForType[type], version);
 }
 
 //----------------------------------------------------------------------------------------------------------------------
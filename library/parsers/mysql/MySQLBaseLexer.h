@@ -44,7 +44,9 @@ namespace parsers {
     virtual void reset() override;
 
     bool isIdentifier(size_t type) const;
+    bool isIdentifierAfter(size_t type, size_t previousType) const;
     size_t keywordFromText(std::string const& name);
+    bool isKeywordForVersion(size_t type) const;
 
     // Scans from the current token position to find out which query type we are dealing with in the input.
     MySQLQueryType determineQueryType();
@@ -76,7 +78,6 @@ namespace parsers {
 
   private:
     std::list<std::unique_ptr<antlr4::Token>> _pendingTokens;
-    std::map<std::string, size_t> _symbols; // A list of all defined symbols for lookup.
 
     std::unique_ptr<antlr4::Token> nextDefaultChannelToken();
     bool skipDefiner(std::unique_ptr<antlr4::Token> &token);
@@ -20,6 +20,9 @@
 # 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
 
 from datetime import datetime
+import functools
+
+import grt
 
 class TimeProfiler(object):
     """
@@ -59,4 +62,40 @@ class TimeProfiler(object):
                 return result
             return newfunc
         else:
-            return attr
\ No newline at end of file
+            return attr
+
+
+class TraceZone(object):
+    """
+    Records the time spent in a block of code in the Workbench trace (see --trace-file):
+
+        with TraceZone('migrate schema'):
+            ...
+    """
+    def __init__(self, name):
+        self.name = name
+        self.recording = False
+
+    def __enter__(self):
+        self.recording = grt.trace_enabled()
+        if self.recording:
+            grt.trace_begin(self.name)
+        return self
+
+    def __exit__(self, exc_type, exc_value, tb):
+        if self.recording:
+            grt.trace_end(self.name)
+        return False
+
+
+def traced(function):
+    """
+    Decorator recording each call of the decorated function as a zone in the Workbench trace.
+    """
+    name = '%s.%s' % (function.__module__, function.__name__)
+
+    @functools.wraps(function)
+    def wrapper(*args, **kwargs):
+        with TraceZone(name):
+            return function(*args, **kwargs)
+    return wrapper
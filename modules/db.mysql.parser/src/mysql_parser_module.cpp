@@ -21,10 +21,30 @@
  * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
  */
 
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstring>
+
+#if defined(__AVX2__)
+  #include <immintrin.h>
+  #define SPLITTER_USE_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  #include <emmintrin.h>
+  #define SPLITTER_USE_SSE2
+#endif
+
+#ifdef _MSC_VER
+  #include <intrin.h>
+#endif
+
 #include "base/string_utilities.h"
 #include "base/util_functions.h"
+#include "base/sqlstring.h"
 #include "base/log.h"
 
+#include "cppdbc.h"
+
 #include "grtpp_util.h"
 
 #include "mysql/mysql-recognition-types.h"
@@ -35,6 +55,7 @@
 
 #include "objimpl/wrapper/parser_ContextReference_impl.h"
 #include "grtdb/db_object_helpers.h"
+#include "grtdb/db_helpers.h"
 #include "code-completion/mysql-code-completion.h"
 
 #include "ObjectListeners.h"
@@ -2052,6 +2073,420 @@ size_t MySQLParserServicesImpl::parseSQLIntoCatalog(MySQLParserContext::Ref cont
 
 //----------------------------------------------------------------------------------------------------------------------
 
+//----------------- Native reverse engineering -------------------------------------------------------------------------
+
+namespace {
+
+  // A single object whose DDL must be fetched from the server via SHOW CREATE.
+  struct ReverseEngineerTask {
+    enum Type { Table, View, Procedure, Function };
+
+    Type type;
+    std::string schema;
+    std::string name;
+
+    // Filled by the worker which handled the task.
+    db_DatabaseObjectRef object;
+    DbObjectsRefsCache refCache;
+    std::string error;
+  };
+
+  // Shared state of the workers fetching and parsing DDL. Each worker has its own connection, its own parser
+  // context and its own scratch catalog, so nothing is shared between them except this task list.
+  struct ReverseEngineerQueue {
+    std::vector<ReverseEngineerTask> tasks;
+    size_t next = 0;
+    size_t finished = 0;
+    volatile bool cancelled = false;
+    std::exception_ptr error;
+    std::mutex mutex;
+    std::condition_variable condition;
+  };
+
+  sql::ConnectionWrapper openReverseEngineerConnection(const db_mgmt_ConnectionRef &connection,
+                                                        const grt::DictRef &options) {
+    sql::DriverManager *dm = sql::DriverManager::getDriverManager();
+    if (options.has_key("password")) {
+      sql::Authentication::Ref auth = sql::Authentication::create(connection, "");
+      auth->set_password(options.get_string("password").c_str());
+      return dm->getConnection(connection, dm->getTunnel(connection), auth);
+    }
+    return dm->getConnection(connection);
+  }
+
+  std::string showCreateStatement(sql::Connection *connection, const ReverseEngineerTask &task) {
+    static const char *objectTypes[] = { "TABLE", "TABLE", "PROCEDURE", "FUNCTION" };
+    static const int columns[] = { 2, 2, 3, 3 };
+
+    std::unique_ptr<sql::Statement> statement(connection->createStatement());
+    std::unique_ptr<sql::ResultSet> rs(statement->executeQuery(
+      base::strfmt("SHOW CREATE %s ", objectTypes[task.type]) +
+      std::string(base::sqlstring("!.!", 0) << task.schema << task.name)));
+    if (!rs->next())
+      return "";
+    return rs->getString(columns[task.type]);
+  }
+
+  void reverseEngineerWorker(ReverseEngineerQueue &queue, sql::ConnectionWrapper connection,
+                             MySQLParserContextImpl *context, db_mysql_CatalogRef scratchCatalog) {
+    try {
+      for (;;) {
+        ReverseEngineerTask *task;
+        {
+          std::lock_guard<std::mutex> lock(queue.mutex);
+          if (queue.cancelled || queue.next == queue.tasks.size())
+            return;
+          task = &queue.tasks[queue.next++];
+        }
+
+        std::string sql = showCreateStatement(connection.get(), *task);
+        if (sql.empty())
+          task->error = "Could not fetch information for " + task->schema + "." + task->name;
+        else {
+          db_mysql_SchemaRef schema =
+            ObjectListener::ensureSchemaExists(scratchCatalog, task->schema, context->caseSensitive);
+          std::string now = base::fmttime(0, DATETIME_FMT);
+
+          auto tree = context->parse(sql, task->type == ReverseEngineerTask::Procedure ||
+                                              task->type == ReverseEngineerTask::Function
+                                            ? MySQLParseUnit::PuCreateRoutine
+                                            : MySQLParseUnit::PuGeneric);
+          if (!context->errors.empty())
+            task->error = "Error parsing DDL for " + task->schema + "." + task->name + ": " +
+                          context->errors.front().message;
+          else {
+            switch (task->type) {
+              case ReverseEngineerTask::Table: {
+                db_mysql_TableRef table(grt::Initialized);
+                table->createDate(now);
+                table->lastChangeDate(now);
+                table->owner(schema);
+                TableListener listener(tree, scratchCatalog, schema, table, context->caseSensitive, false,
+                                       task->refCache);
+                table->oldName(table->name());
+                task->object = table;
+                break;
+              }
+
+              case ReverseEngineerTask::View: {
+                db_mysql_ViewRef view(grt::Initialized);
+                view->sqlDefinition(base::trim(sql));
+                view->createDate(now);
+                view->lastChangeDate(now);
+                view->owner(schema);
+                ViewListener listener(tree, scratchCatalog, view, context->caseSensitive);
+                view->oldName(view->name());
+                task->object = view;
+                break;
+              }
+
+              default: {
+                db_mysql_RoutineRef routine(grt::Initialized);
+                routine->sqlDefinition(base::trim(sql));
+                routine->createDate(now);
+                routine->lastChangeDate(now);
+                routine->owner(schema);
+                RoutineListener listener(tree, scratchCatalog, routine, context->caseSensitive);
+                routine->oldName(routine->name());
+                task->object = routine;
+                break;
+              }
+            }
+          }
+        }
+
+        {
+          std::lock_guard<std::mutex> lock(queue.mutex);
+          ++queue.finished;
+        }
+        queue.condition.notify_all();
+      }
+    } catch (...) {
+      {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.error)
+          queue.error = std::current_exception();
+        queue.cancelled = true;
+      }
+      queue.condition.notify_all();
+    }
+  }
+
+  /**
+   * Moves a parsed object from its scratch catalog into the target catalog, replacing an existing object
+   * with the same name, just like parseSQLIntoCatalog does.
+   */
+  void mergeReverseEngineeredObject(db_mysql_CatalogRef catalog, const db_DatabaseObjectRef &object,
+                                    bool caseSensitive) {
+    db_mysql_SchemaRef schema = ObjectListener::ensureSchemaExists(
+      catalog, db_mysql_SchemaRef::cast_from(object->owner())->name(), caseSensitive);
+    object->owner(schema);
+
+    if (db_mysql_TableRef::can_wrap(object)) {
+      db_mysql_TableRef table = db_mysql_TableRef::cast_from(object);
+      if (find_named_object_in_list(schema->views(), table->name()).is_valid())
+        return;
+      db_TableRef existing = find_named_object_in_list(schema->tables(), table->name());
+      if (existing.is_valid())
+        schema->tables()->remove(existing);
+      schema->tables().insert(table);
+    } else if (db_mysql_ViewRef::can_wrap(object)) {
+      db_mysql_ViewRef view = db_mysql_ViewRef::cast_from(object);
+      if (find_named_object_in_list(schema->tables(), view->name()).is_valid())
+        return;
+      db_ViewRef existing = find_named_object_in_list(schema->views(), view->name());
+      if (existing.is_valid())
+        schema->views()->remove(existing);
+      schema->views().insert(view);
+    } else {
+      db_mysql_RoutineRef routine = db_mysql_RoutineRef::cast_from(object);
+      db_RoutineRef existing = find_named_object_in_list(schema->routines(), routine->name());
+      if (existing.is_valid())
+        schema->routines()->remove(existing);
+      schema->routines().insert(routine);
+    }
+  }
+
+  // Builds a CREATE TRIGGER statement from a row of information_schema.TRIGGERS.
+  std::string triggerStatement(sql::ResultSet *rs) {
+    std::string definer = rs->getString(6);
+    std::string::size_type p = definer.rfind('@');
+    std::string user = p == std::string::npos ? definer : definer.substr(0, p);
+    std::string host = p == std::string::npos ? "%" : definer.substr(p + 1);
+
+    std::string result = base::sqlstring("CREATE DEFINER=!@! TRIGGER ! ", 0) << user << host << rs->getString(2);
+    result += rs->getString(3) + " " + rs->getString(4);
+    result += std::string(base::sqlstring(" ON ! FOR EACH ROW ", 0) << rs->getString(5));
+    result += rs->getString(7);
+    return result;
+  }
+
+  struct TriggerDefinition {
+    std::string statement;
+    std::string sqlMode; // The sql_mode the trigger was created with, it determines how the body is lexed.
+  };
+
+  // Returns a delimiter which doesn't occur in any of the given trigger statements.
+  std::string triggerDelimiter(const std::vector<TriggerDefinition> &triggers) {
+    std::string delimiter = "$$";
+    while (true) {
+      bool found = false;
+      for (auto &trigger : triggers) {
+        if (trigger.statement.find(delimiter) != std::string::npos) {
+          found = true;
+          break;
+        }
+      }
+      if (!found)
+        return delimiter;
+      delimiter += "$";
+    }
+  }
+
+} // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Reverse engineers the given schemata from a live server into the catalog. Object lists and triggers are read
+ * with a few set based information_schema queries. The DDL of tables, views and routines is fetched with
+ * SHOW CREATE over several connections and parsed in parallel, each worker using its own parser context and
+ * scratch catalog. The resulting objects are then moved into the target catalog on the calling thread.
+ *
+ * Recognized options: reverseEngineerTables, reverseEngineerViews, reverseEngineerRoutines,
+ * reverseEngineerTriggers (all default to 1), connectionCount (number of parallel connections, default 4)
+ * and password (used instead of a stored password if given).
+ *
+ * @result Returns the number of objects that could not be reverse engineered.
+ */
+size_t MySQLParserServicesImpl::reverseEngineerSchemata(db_mgmt_ConnectionRef connection, db_mysql_CatalogRef catalog,
+                                                        grt::StringListRef schemata, grt::DictRef options) {
+  bool getTables = options.get_int("reverseEngineerTables", 1) != 0;
+  bool getViews = options.get_int("reverseEngineerViews", 1) != 0;
+  bool getRoutines = options.get_int("reverseEngineerRoutines", 1) != 0;
+  bool getTriggers = options.get_int("reverseEngineerTriggers", 1) != 0;
+  size_t connectionCount = (size_t)std::max(1L, (long)options.get_int("connectionCount", 4));
+
+  if (schemata.count() == 0)
+    return 0;
+
+  grt::GRT::get()->send_progress(0, "Preparing...");
+
+  sql::ConnectionWrapper mainConnection = openReverseEngineerConnection(connection, options);
+  std::unique_ptr<sql::Statement> statement(mainConnection->createStatement());
+
+  std::string versionString;
+  std::string sqlMode;
+  bool caseSensitive = true;
+  {
+    std::unique_ptr<sql::ResultSet> rs(
+      statement->executeQuery("SELECT @@version, @@sql_mode, @@lower_case_table_names"));
+    if (rs->next()) {
+      versionString = rs->getString(1);
+      sqlMode = rs->getString(2);
+      caseSensitive = rs->getInt(3) == 0;
+    }
+  }
+
+  std::string schemaList;
+  for (size_t i = 0; i < schemata.count(); ++i) {
+    std::string name = schemata.get(i);
+    if (!schemaList.empty())
+      schemaList += ", ";
+    schemaList += std::string(base::sqlstring("?", 0) << name);
+    ObjectListener::ensureSchemaExists(catalog, name, caseSensitive);
+  }
+  GrtVersionRef version = bec::parse_version(versionString);
+
+  // Collect everything which needs a SHOW CREATE, sorted by schema and name so the merge order is stable.
+  ReverseEngineerQueue queue;
+  if (getTables || getViews) {
+    std::unique_ptr<sql::ResultSet> rs(statement->executeQuery(
+      "SELECT TABLE_SCHEMA, TABLE_NAME, TABLE_TYPE FROM information_schema.TABLES WHERE TABLE_SCHEMA IN (" +
+      schemaList + ") ORDER BY TABLE_SCHEMA, TABLE_NAME"));
+    while (rs->next()) {
+      bool isView = rs->getString(3) == "VIEW";
+      if (isView ? getViews : getTables)
+        queue.tasks.push_back({ isView ? ReverseEngineerTask::View : ReverseEngineerTask::Table, rs->getString(1),
+                                rs->getString(2) });
+    }
+  }
+
+  if (getRoutines) {
+    std::unique_ptr<sql::ResultSet> rs(statement->executeQuery(
+      "SELECT ROUTINE_SCHEMA, ROUTINE_NAME, ROUTINE_TYPE FROM information_schema.ROUTINES WHERE ROUTINE_SCHEMA IN (" +
+      schemaList + ") ORDER BY ROUTINE_SCHEMA, ROUTINE_TYPE DESC, ROUTINE_NAME"));
+    while (rs->next())
+      queue.tasks.push_back({ rs->getString(3) == "FUNCTION" ? ReverseEngineerTask::Function
+                                                              : ReverseEngineerTask::Procedure,
+                              rs->getString(1), rs->getString(2) });
+  }
+
+  // Triggers can be recreated completely from information_schema, no need for a SHOW CREATE TRIGGER each.
+  std::map<std::string, std::vector<TriggerDefinition>> triggers;
+  size_t triggerCount = 0;
+  if (getTriggers) {
+    // ACTION_ORDER only exists since 5.7.2, before that there can be only one trigger per timing and event anyway.
+    std::string order = bec::is_supported_mysql_version_at_least(version, 5, 7, 2) ? "ACTION_ORDER" : "CREATED";
+    std::unique_ptr<sql::ResultSet> rs(statement->executeQuery(
+      "SELECT TRIGGER_SCHEMA, TRIGGER_NAME, ACTION_TIMING, EVENT_MANIPULATION, EVENT_OBJECT_TABLE, DEFINER, "
+      "ACTION_STATEMENT, SQL_MODE FROM information_schema.TRIGGERS WHERE TRIGGER_SCHEMA IN (" +
+      schemaList + ") ORDER BY TRIGGER_SCHEMA, EVENT_OBJECT_TABLE, ACTION_TIMING, EVENT_MANIPULATION, " + order));
+    while (rs->next()) {
+      triggers[rs->getString(1)].push_back({ triggerStatement(rs.get()), rs->getString(8) });
+      ++triggerCount;
+    }
+  }
+
+  grt::GRT::get()->send_progress(0.1f, "Preparing...");
+
+  // Set up one parser context and scratch catalog per worker here, so the workers don't need to touch
+  // any shared GRT object.
+  size_t workerCount = std::min(connectionCount, queue.tasks.size());
+  std::vector<std::shared_ptr<MySQLParserContextImpl>> contexts;
+  std::vector<db_mysql_CatalogRef> scratchCatalogs;
+  for (size_t i = 0; i < workerCount; ++i) {
+    auto context = std::make_shared<MySQLParserContextImpl>(catalog->characterSets(), version, caseSensitive);
+    context->updateSqlMode(sqlMode);
+    contexts.push_back(context);
+
+    db_mysql_CatalogRef scratchCatalog(grt::Initialized);
+    scratchCatalog->name(catalog->name());
+    scratchCatalog->version(bec::parse_version(versionString));
+    scratchCatalog->defaultCharacterSetName(catalog->defaultCharacterSetName());
+    scratchCatalog->defaultCollationName(catalog->defaultCollationName());
+    for (auto type : catalog->simpleDatatypes())
+      scratchCatalog->simpleDatatypes().insert(type);
+    for (auto type : catalog->userDatatypes())
+      scratchCatalog->userDatatypes().insert(type);
+    scratchCatalogs.push_back(scratchCatalog);
+  }
+
+  // The first worker reuses the connection we already have.
+  std::vector<std::thread> workers;
+  for (size_t i = 0; i < workerCount; ++i) {
+    sql::ConnectionWrapper workerConnection = mainConnection;
+    if (i > 0) {
+      try {
+        workerConnection = openReverseEngineerConnection(connection, options);
+      } catch (std::exception &e) {
+        logWarning("Could not open additional connection for reverse engineering: %s\n", e.what());
+        break;
+      }
+    }
+    workers.push_back(std::thread(reverseEngineerWorker, std::ref(queue), workerConnection, contexts[i].get(),
+                                  scratchCatalogs[i]));
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(queue.mutex);
+    while (queue.finished < queue.tasks.size() && !queue.cancelled) {
+      queue.condition.wait_for(lock, std::chrono::milliseconds(250));
+      if (grt::GRT::get()->query_status())
+        queue.cancelled = true;
+      float progress = queue.tasks.empty() ? 1 : (float)queue.finished / queue.tasks.size();
+      grt::GRT::get()->send_progress(0.1f + 0.8f * progress,
+                                     base::strfmt("Reverse engineered %i of %i objects...", (int)queue.finished,
+                                                  (int)queue.tasks.size()));
+    }
+  }
+  for (auto &worker : workers)
+    worker.join();
+
+  if (queue.error)
+    std::rethrow_exception(queue.error);
+  if (queue.cancelled)
+    throw grt::user_cancelled("Reverse engineering cancelled");
+
+  // Merge in a fixed order, independent of which worker finished first.
+  grt::GRT::get()->send_progress(0.9f, "Merging objects into catalog...");
+  size_t errorCount = 0;
+  DbObjectsRefsCache refCache;
+  for (auto &task : queue.tasks) {
+    if (!task.error.empty()) {
+      grt::GRT::get()->send_error(task.error);
+      ++errorCount;
+      continue;
+    }
+    if (!task.object.is_valid())
+      continue;
+    mergeReverseEngineeredObject(catalog, task.object, caseSensitive);
+    refCache.insert(refCache.end(), task.refCache.begin(), task.refCache.end());
+  }
+  resolveReferences(catalog, refCache, caseSensitive);
+
+  if (triggerCount > 0) {
+    grt::GRT::get()->send_progress(0.95f, "Reverse engineering triggers...");
+    auto context = std::make_shared<MySQLParserContextImpl>(catalog->characterSets(), version, caseSensitive);
+    context->updateSqlMode(sqlMode);
+    for (auto &entry : triggers) {
+      std::string delimiter = triggerDelimiter(entry.second);
+
+      // Each run of triggers sharing the same sql_mode is parsed with that mode (e.g. ANSI_QUOTES or
+      // NO_BACKSLASH_ESCAPES change how the body must be read), like the server does when it loads them.
+      auto &list = entry.second;
+      for (size_t i = 0; i < list.size();) {
+        const std::string mode = list[i].sqlMode;
+        context->updateSqlMode(mode);
+
+        std::string sql = base::sqlstring("USE !;\nSET SESSION sql_mode = ?;\nDELIMITER ", 0) << entry.first << mode;
+        sql += delimiter + "\n";
+        for (; i < list.size() && list[i].sqlMode == mode; ++i)
+          sql += list[i].statement + delimiter + "\n";
+        sql += "DELIMITER ;\n";
+        sql += std::string(base::sqlstring("SET SESSION sql_mode = ?;\n", 0) << sqlMode);
+        errorCount += parseSQLIntoCatalog(context, catalog, sql, grt::DictRef(true));
+      }
+    }
+  }
+
+  grt::GRT::get()->send_progress(1, base::strfmt("Reverse engineered %i objects",
+                                                 (int)(queue.tasks.size() + triggerCount)));
+  return errorCount;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 size_t MySQLParserServicesImpl::doSyntaxCheck(parser_ContextReferenceRef context_ref, const std::string &sql,
                                               const std::string &type) {
   MySQLParserContext::Ref context = parser_context_from_grt(context_ref);
@@ -2225,6 +2660,87 @@ size_t MySQLParserServicesImpl::renameSchemaReferences(MySQLParserContext::Ref c
 
 //----------------------------------------------------------------------------------------------------------------------
 
+static inline unsigned int firstSetBit(unsigned int mask) {
+#ifdef _MSC_VER
+  unsigned long index;
+  _BitScanForward(&index, mask);
+  return (unsigned int)index;
+#else
+  return (unsigned int)__builtin_ctz(mask);
+#endif
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * A small set of byte values the statement splitter has to look at. Everything else can be skipped in bulk,
+ * which is done 16 or 32 bytes at a time if SSE2 or AVX2 are available.
+ */
+class StopBytes {
+public:
+  StopBytes(std::initializer_list<unsigned char> bytes) {
+    memset(_table, 0, sizeof(_table));
+    for (auto byte : bytes) {
+      if (_table[byte])
+        continue;
+      _table[byte] = true;
+#if defined(SPLITTER_USE_AVX2)
+      _vectors[_count] = _mm256_set1_epi8((char)byte);
+#elif defined(SPLITTER_USE_SSE2)
+      _vectors[_count] = _mm_set1_epi8((char)byte);
+#endif
+      ++_count;
+    }
+  }
+
+  /**
+   * Returns the first position in [head, end) which holds one of the stop bytes or end, if there is none.
+   * A head beyond end is returned unchanged.
+   */
+  const unsigned char *find(const unsigned char *head, const unsigned char *end) const {
+#if defined(SPLITTER_USE_AVX2)
+    while (end - head >= 32) {
+      __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(head));
+      __m256i hits = _mm256_cmpeq_epi8(block, _vectors[0]);
+      for (size_t i = 1; i < _count; ++i)
+        hits = _mm256_or_si256(hits, _mm256_cmpeq_epi8(block, _vectors[i]));
+      unsigned int mask = (unsigned int)_mm256_movemask_epi8(hits);
+      if (mask != 0)
+        return head + firstSetBit(mask);
+      head += 32;
+    }
+#elif defined(SPLITTER_USE_SSE2)
+    while (end - head >= 16) {
+      __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(head));
+      __m128i hits = _mm_cmpeq_epi8(block, _vectors[0]);
+      for (size_t i = 1; i < _count; ++i)
+        hits = _mm_or_si128(hits, _mm_cmpeq_epi8(block, _vectors[i]));
+      unsigned int mask = (unsigned int)_mm_movemask_epi8(hits);
+      if (mask != 0)
+        return head + firstSetBit(mask);
+      head += 16;
+    }
+#endif
+
+    while (head < end && !_table[*head])
+      ++head;
+    return head;
+  }
+
+private:
+  static const size_t MaxStopBytes = 16;
+
+  bool _table[256];
+  size_t _count = 0;
+#if defined(SPLITTER_USE_AVX2)
+  __m256i _vectors[MaxStopBytes];
+#elif defined(SPLITTER_USE_SSE2)
+  __m128i _vectors[MaxStopBytes];
+#endif
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
 static const unsigned char *skipLeadingWhitespace(const unsigned char *head, const unsigned char *tail) {
   while (head < tail && *head <= ' ')
     head++;
@@ -2267,6 +2783,9 @@ grt::BaseListRef MySQLParserServicesImpl::getSqlStatementRanges(const std::strin
 /**
  * A statement splitter to take a list of sql statements and split them into individual statements,
  * return their position and length in the original string (instead the copied strings).
+ *
+ * Only quotes, comment starts, line breaks, the delimiter and a possible DELIMITER keyword need the state machine
+ * below. Runs of other characters (and the content of strings and comments) are skipped with StopBytes::find.
  */
 size_t MySQLParserServicesImpl::determineStatementRanges(const char *sql, size_t length,
   const std::string &initialDelimiter, std::vector<StatementRange> &ranges, const std::string &lineBreak) {
@@ -2286,6 +2805,16 @@ size_t MySQLParserServicesImpl::determineStatementRanges(const char *sql, size_t
   size_t statementStart = 0;
   bool haveContent = false; // Set when anything else but comments were found for the current statement.
 
+  static const StopBytes doubleQuoteStops = { '"', '\\' };
+  static const StopBytes singleQuoteStops = { '\'', '\\' };
+  static const StopBytes backTickStops = { '`', '\\' };
+  const StopBytes lineStops = { *newLine };
+  const StopBytes commentStops = { '*', *newLine };
+  auto contentStopsFor = [&]() {
+    return StopBytes{ '/', '-', '#', '"', '\'', '`', 'd', 'D', *newLine, *delimiterHead };
+  };
+  StopBytes contentStops = contentStopsFor();
+
   while (tail < end) {
     switch (*tail) {
       case '/': { // Possible multi line comment or hidden (conditional) command.
@@ -2293,7 +2822,10 @@ size_t MySQLParserServicesImpl::determineStatementRanges(const char *sql, size_t
           tail += 2;
           bool isHiddenCommand = (*tail == '!');
           while (true) {
-            while (tail < end && *tail != '*') {
+            while (true) {
+              tail = commentStops.find(tail, end);
+              if (tail >= end || *tail == '*')
+                break;
               if (isLineBreak(tail, newLine))
                 ++currentLine;
               tail++;
@@ -2327,8 +2859,12 @@ size_t MySQLParserServicesImpl::determineStatementRanges(const char *sql, size_t
         if (*(tail + 1) == '-' && (*end_char == ' ' || *end_char == '\t' || isLineBreak(end_char, newLine))) {
           // Skip everything until the end of the line.
           tail += 2;
-          while (tail < end && !isLineBreak(tail, newLine))
+          while (tail < end) {
+            tail = lineStops.find(tail, end);
+            if (tail >= end || isLineBreak(tail, newLine))
+              break;
             tail++;
+          }
 
           if (!haveContent) {
             head = tail;
@@ -2341,8 +2877,12 @@ size_t MySQLParserServicesImpl::determineStatementRanges(const char *sql, size_t
       }
 
       case '#': { // MySQL single line comment.
-        while (tail < end && !isLineBreak(tail, newLine))
+        while (tail < end) {
+          tail = lineStops.find(tail, end);
+          if (tail >= end || isLineBreak(tail, newLine))
+            break;
           tail++;
+        }
 
         if (!haveContent) {
           head = tail;
@@ -2357,11 +2897,15 @@ size_t MySQLParserServicesImpl::determineStatementRanges(const char *sql, size_t
       case '`': { // Quoted string/id. Skip this in a local loop.
         haveContent = true;
         unsigned char quote = *tail++;
-        while (tail < end && *tail != quote) {
-          // Skip any escaped character too.
-          if (*tail == '\\')
-            tail++;
-          tail++;
+        const StopBytes &quoteStops =
+          quote == '"' ? doubleQuoteStops : (quote == '\'' ? singleQuoteStops : backTickStops);
+        while (tail < end) {
+          tail = quoteStops.find(tail, end);
+          if (tail >= end || *tail == quote)
+            break;
+
+          // Skip the escaped character too.
+          tail += 2;
         }
         if (*tail == quote)
           tail++; // Skip trailing quote char if one was there.
@@ -2392,6 +2936,7 @@ size_t MySQLParserServicesImpl::determineStatementRanges(const char *sql, size_t
               ++run;
             delimiter = base::trim(std::string(reinterpret_cast<const char *>(tail), run - tail));
             delimiterHead = reinterpret_cast<const unsigned char *>(delimiter.c_str());
+            contentStops = contentStopsFor();
 
             // Skip over the delimiter statement and any following line breaks.
             while (isLineBreak(run, newLine)) {
@@ -2410,6 +2955,15 @@ size_t MySQLParserServicesImpl::determineStatementRanges(const char *sql, size_t
       }
 
       default:
+        if (haveContent) {
+          // Nothing but the line count and the delimiter can change until the next stop byte.
+          const unsigned char *next = contentStops.find(tail, end);
+          if (next > tail) {
+            tail = next;
+            break;
+          }
+        }
+
         if (isLineBreak(tail, newLine)) {
           ++currentLine;
           if (!haveContent)
@@ -37,6 +37,7 @@
 #include "grtsqlparser/mysql_parser_services.h"
 
 #include "grts/structs.db.mysql.h"
+#include "grts/structs.db.mgmt.h"
 #include "grts/structs.wrapper.h"
 
 #define DOC_MYSQLPARSERSERVICESIMPL                                            \
@@ -96,6 +97,14 @@ public:
                                 "sql the SQL script to be parsed\n"
                                 "options Options for processing"),
 
+    DECLARE_MODULE_FUNCTION_DOC(MySQLParserServicesImpl::reverseEngineerSchemata,
+                                "Reverse engineers the given schemata from a live server into a grt catalog. "
+                                "DDL is fetched and parsed in parallel over multiple connections.",
+                                "connection the connection to the server\n"
+                                "catalog the Catalog where the reverse engineered objects will be stored\n"
+                                "schemata the names of the schemata to reverse engineer\n"
+                                "options Options for processing (object types, connectionCount, password)"),
+
     DECLARE_MODULE_FUNCTION_DOC(MySQLParserServicesImpl::doSyntaxCheck,
                                 "Parses the given sql to see if there's any syntax error.",
                                 "context_ref a previously created parser context reference\n"
@@ -175,6 +184,9 @@ public:
   virtual size_t parseSQLIntoCatalog(parsers::MySQLParserContext::Ref context, db_mysql_CatalogRef catalog,
                                      const std::string &sql, grt::DictRef options) override;
 
+  size_t reverseEngineerSchemata(db_mgmt_ConnectionRef connection, db_mysql_CatalogRef catalog,
+                                 grt::StringListRef schemata, grt::DictRef options);
+
   size_t doSyntaxCheck(parser_ContextReferenceRef context_ref, const std::string &sql, const std::string &type);
   virtual size_t checkSqlSyntax(parsers::MySQLParserContext::Ref context, const char *sql, size_t length,
                                 MySQLParseUnit type) override;
@@ -30,6 +30,7 @@
 #include "grts/structs.db.mgmt.h"
 
 #include "wb_tunnel.h"
+#include "status_sampler.h"
 
 #define DOC_DbMySQLQueryImpl                                                       \
   "Query execution and utility routines for  MySQL servers.\n"                     \
@@ -42,7 +43,12 @@
 class DbMySQLQueryImpl : public grt::ModuleImplBase {
 public:
   DbMySQLQueryImpl(grt::CPPModuleLoader *loader)
-    : grt::ModuleImplBase(loader), _last_error_code(0), _connection_id(0), _resultset_id(0), _tunnel_id(0) {
+    : grt::ModuleImplBase(loader),
+      _last_error_code(0),
+      _connection_id(0),
+      _resultset_id(0),
+      _tunnel_id(0),
+      _sampler_id(0) {
   }
 
   virtual ~DbMySQLQueryImpl() {
@@ -169,6 +175,49 @@ public:
                                 "Utility function to return a dictionary containing name/value pairs for the server "
                                 "variables, as returned by SHOW VARIABLES.",
                                 "conn_id the connection id"),
+    DECLARE_MODULE_FUNCTION_DOC(DbMySQLQueryImpl::openStatusSampler,
+                                "Opens a separate connection to the server and starts sampling SHOW GLOBAL STATUS on "
+                                "a background thread. The numeric status variables are kept as time series, with "
+                                "full resolution for the last minutes and as 10 second averages for some hours.\n"
+                                "Returns a sampler id or -1 on error. Samplers must be closed with "
+                                "closeStatusSampler() after use.",
+                                "info the connection information object for the MySQL instance to sample\n"
+                                "password the password to use, null to look it up as openConnection() does\n"
+                                "interval seconds between samples, fractions allowed"),
+    DECLARE_MODULE_FUNCTION_DOC(DbMySQLQueryImpl::closeStatusSampler,
+                                "Stops the sampler and closes its connection.", "sampler the sampler id"),
+    DECLARE_MODULE_FUNCTION_DOC(DbMySQLQueryImpl::statusSamplerError,
+                                "Returns the error that stopped the sampler, or an empty string while it runs.",
+                                "sampler the sampler id"),
+    DECLARE_MODULE_FUNCTION_DOC(DbMySQLQueryImpl::statusSamplerTime,
+                                "Returns the time of the last sample in seconds since the epoch, 0 if there is none yet.",
+                                "sampler the sampler id"),
+    DECLARE_MODULE_FUNCTION_DOC(DbMySQLQueryImpl::statusSamplerVariables,
+                                "Returns a dictionary with the status variables of the last sample, as strings.",
+                                "sampler the sampler id"),
+    DECLARE_MODULE_FUNCTION_DOC(DbMySQLQueryImpl::statusSamplerValues,
+                                "Returns the last sampled values of the given status variables, in the same order. "
+                                "Unknown or non-numeric variables give 0.",
+                                "sampler the sampler id\n"
+                                "names the status variable names"),
+    DECLARE_MODULE_FUNCTION_DOC(DbMySQLQueryImpl::statusSamplerRates,
+                                "Returns the average change per second of the given status variables over the last "
+                                "window seconds, in the same order. Variables without enough samples give 0.",
+                                "sampler the sampler id\n"
+                                "names the status variable names\n"
+                                "window number of seconds to average over"),
+    DECLARE_MODULE_FUNCTION_DOC(DbMySQLQueryImpl::statusSamplerTimes,
+                                "Returns the sample times, oldest first.",
+                                "sampler the sampler id\n"
+                                "history 1 for the times of the 10 second averages, 0 for the recent samples"),
+    DECLARE_MODULE_FUNCTION_DOC(DbMySQLQueryImpl::statusSamplerSeries,
+                                "Returns the values of a status variable, oldest first and matching "
+                                "statusSamplerTimes(). Gaps are NaN. With rates the result is the change per second "
+                                "between consecutive samples and has one element less.",
+                                "sampler the sampler id\n"
+                                "name the status variable name\n"
+                                "rates 1 to return changes per second instead of values\n"
+                                "history 1 for the 10 second averages, 0 for the recent samples"),
     NULL);
 
   // returns connection-id or -1 for error
@@ -232,6 +281,17 @@ public:
 
   std::string scramblePassword(const std::string &pass);
 
+  // returns sampler-id or -1 for error
+  int openStatusSampler(const db_mgmt_ConnectionRef &info, const grt::StringRef &password, double interval);
+  int closeStatusSampler(int sampler);
+  std::string statusSamplerError(int sampler);
+  double statusSamplerTime(int sampler);
+  grt::DictRef statusSamplerVariables(int sampler);
+  grt::DoubleListRef statusSamplerValues(int sampler, const grt::StringListRef &names);
+  grt::DoubleListRef statusSamplerRates(int sampler, const grt::StringListRef &names, double window);
+  grt::DoubleListRef statusSamplerTimes(int sampler, int history);
+  grt::DoubleListRef statusSamplerSeries(int sampler, const std::string &name, int rates, int history);
+
 private:
   struct ConnectionInfo {
     typedef std::shared_ptr<ConnectionInfo> Ref;
@@ -262,12 +322,17 @@ private:
   std::map<int, ConnectionInfo::Ref> _connections;
   std::map<int, sql::ResultSet *> _resultsets;
   std::map<int, std::shared_ptr<wb::SSHTunnel> > _tunnels;
+  std::map<int, std::shared_ptr<StatusSampler> > _samplers;
   std::string _last_error;
   int _last_error_code;
 
   int _connection_id;
   base::refcount_t _resultset_id;
   int _tunnel_id;
+  int _sampler_id;
+
+  sql::ConnectionWrapper connect(const db_mgmt_ConnectionRef &info, const grt::StringRef &password);
+  std::shared_ptr<StatusSampler> get_sampler(int sampler);
 };
 
 GRT_MODULE_ENTRY_POINT(DbMySQLQueryImpl);
@@ -282,9 +347,19 @@ int DbMySQLQueryImpl::openConnection(const db_mgmt_ConnectionRef &info) {
   return openConnectionP(info, grt::StringRef());
 }
 
-int DbMySQLQueryImpl::openConnectionP(const db_mgmt_ConnectionRef &info, const grt::StringRef &password) {
+sql::ConnectionWrapper DbMySQLQueryImpl::connect(const db_mgmt_ConnectionRef &info, const grt::StringRef &password) {
   sql::DriverManager *dm = sql::DriverManager::getDriverManager();
 
+  if (password.is_valid()) {
+    sql::Authentication::Ref auth = sql::Authentication::create(info, "");
+    auth->set_password(password.c_str());
+
+    return dm->getConnection(info, dm->getTunnel(info), auth);
+  }
+  return dm->getConnection(info);
+}
+
+int DbMySQLQueryImpl::openConnectionP(const db_mgmt_ConnectionRef &info, const grt::StringRef &password) {
   if (!info.is_valid())
     throw std::invalid_argument("connection info is NULL");
 
@@ -296,14 +371,7 @@ int DbMySQLQueryImpl::openConnectionP(const db_mgmt_ConnectionRef &info, const g
       base::MutexLock lock(_mutex);
       new_connection_id = ++_connection_id;
     }
-    sql::ConnectionWrapper conn;
-    if (password.is_valid()) {
-      sql::Authentication::Ref auth = sql::Authentication::create(info, "");
-      auth->set_password(password.c_str());
-
-      conn = dm->getConnection(info, dm->getTunnel(info), auth);
-    } else
-      conn = dm->getConnection(info);
+    sql::ConnectionWrapper conn = connect(info, password);
 
     base::MutexLock lock(_mutex);
     _connections[new_connection_id] = ConnectionInfo::Ref(new ConnectionInfo(conn));
@@ -812,3 +880,116 @@ int DbMySQLQueryImpl::closeTunnel(int tunnel) {
   _tunnels.erase(tunnel);
   return 0;
 }
+
+int DbMySQLQueryImpl::openStatusSampler(const db_mgmt_ConnectionRef &info, const grt::StringRef &password,
+                                        double interval) {
+  if (!info.is_valid())
+    throw std::invalid_argument("connection info is NULL");
+
+  CLEAR_ERROR();
+  try {
+    std::shared_ptr<StatusSampler> sampler(new StatusSampler(connect(info, password), interval));
+
+    base::MutexLock lock(_mutex);
+    _samplers[++_sampler_id] = sampler;
+    return _sampler_id;
+  } catch (sql::SQLException &exc) {
+    _last_error = exc.what();
+    _last_error_code = exc.getErrorCode();
+    return -1;
+  } catch (std::exception &exc) {
+    // e.g. the SSH tunnel could not be opened or the password prompt was cancelled
+    _last_error = exc.what();
+    return -1;
+  }
+}
+
+int DbMySQLQueryImpl::closeStatusSampler(int sampler) {
+  std::shared_ptr<StatusSampler> closed = get_sampler(sampler);
+  {
+    base::MutexLock lock(_mutex);
+    _samplers.erase(sampler);
+  }
+
+  // Waits for the sampling thread, so do that without holding the lock.
+  closed.reset();
+  return 0;
+}
+
+std::shared_ptr<StatusSampler> DbMySQLQueryImpl::get_sampler(int sampler) {
+  base::MutexLock lock(_mutex);
+  if (_samplers.find(sampler) == _samplers.end())
+    throw std::invalid_argument("Invalid status sampler");
+  return _samplers[sampler];
+}
+
+std::string DbMySQLQueryImpl::statusSamplerError(int sampler) {
+  return get_sampler(sampler)->last_error();
+}
+
+double DbMySQLQueryImpl::statusSamplerTime(int sampler) {
+  double time = 0;
+  get_sampler(sampler)->read([&](const StatusSeries &series) { time = series.last_time(); });
+  return time;
+}
+
+grt::DictRef DbMySQLQueryImpl::statusSamplerVariables(int sampler) {
+  // Copy first, GRT values should not be created while the sampling thread waits.
+  StatusSeries::Rows rows;
+  get_sampler(sampler)->read([&](const StatusSeries &series) { rows = series.last_rows(); });
+
+  grt::DictRef dict(true);
+  for (const auto &row : rows)
+    dict.gset(row.first, row.second);
+  return dict;
+}
+
+static std::vector<std::string> string_list(const grt::StringListRef &list) {
+  std::vector<std::string> result;
+  result.reserve(list.count());
+  for (size_t i = 0; i < list.count(); ++i)
+    result.push_back(list[i]);
+  return result;
+}
+
+static grt::DoubleListRef double_list(const std::vector<double> &values) {
+  grt::DoubleListRef list(grt::Initialized);
+  for (double value : values)
+    list.insert(grt::DoubleRef(value));
+  return list;
+}
+
+grt::DoubleListRef DbMySQLQueryImpl::statusSamplerValues(int sampler, const grt::StringListRef &names) {
+  std::vector<std::string> variables = string_list(names);
+  std::vector<double> values(variables.size(), 0.0);
+  get_sampler(sampler)->read([&](const StatusSeries &series) {
+    for (size_t i = 0; i < variables.size(); ++i)
+      series.value(variables[i], values[i]);
+  });
+  return double_list(values);
+}
+
+grt::DoubleListRef DbMySQLQueryImpl::statusSamplerRates(int sampler, const grt::StringListRef &names, double window) {
+  std::vector<std::string> variables = string_list(names);
+  std::vector<double> rates(variables.size(), 0.0);
+  get_sampler(sampler)->read([&](const StatusSeries &series) {
+    for (size_t i = 0; i < variables.size(); ++i)
+      series.rate(variables[i], window, rates[i]);
+  });
+  return double_list(rates);
+}
+
+grt::DoubleListRef DbMySQLQueryImpl::statusSamplerTimes(int sampler, int history) {
+  std::vector<double> times;
+  get_sampler(sampler)->read([&](const StatusSeries &series) { times = series.times(history != 0); });
+  return double_list(times);
+}
+
+grt::DoubleListRef DbMySQLQueryImpl::statusSamplerSeries(int sampler, const std::string &name, int rates,
+                                                         int history) {
+  std::vector<double> values;
+  get_sampler(sampler)->read([&](const StatusSeries &series) {
+    values = rates ? series.rates(name, history != 0) : series.values(name, history != 0);
+  });
+  return double_list(values);
+}
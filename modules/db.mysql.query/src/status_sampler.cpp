@@ -0,0 +1,314 @@
+/*
+ * Copyright (c) 2020, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <memory>
+
+#include "base/log.h"
+
+#include "status_sampler.h"
+
+DEFAULT_LOG_DOMAIN("StatusSampler")
+
+static const double RecentSpan = 300;      // seconds of full resolution samples
+static const double BucketSpan = 10;       // seconds folded into one down-sampled value
+static const double HistorySpan = 4 * 3600; // seconds of down-sampled values
+
+static const double NaN = std::numeric_limits<double>::quiet_NaN();
+
+//--------------------------------------------------------------------------------------------------
+
+static bool parse_number(const std::string &text, double &number) {
+  if (text.empty())
+    return false;
+
+  char *end = nullptr;
+  number = strtod(text.c_str(), &end);
+  return *end == '\0';
+}
+
+//--------------------------------------------------------------------------------------------------
+
+static double rate_between(double time1, double value1, double time2, double value2) {
+  if (std::isnan(value1) || std::isnan(value2) || time2 <= time1)
+    return NaN;
+
+  // Counters go back to 0 on a server restart or FLUSH STATUS.
+  return std::max(0.0, (value2 - value1) / (time2 - time1));
+}
+
+//----------------- StatusSeries -------------------------------------------------------------------
+
+StatusSeries::StatusSeries(size_t capacity, double bucket_span, size_t history_capacity)
+  : _times(capacity),
+    _history_times(history_capacity),
+    _capacity(capacity),
+    _history_capacity(history_capacity),
+    _bucket_span(bucket_span),
+    _bucket_start(0),
+    _bucket_time_sum(0),
+    _bucket_samples(0) {
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void StatusSeries::add_sample(double time, const Rows &rows) {
+  if (_bucket_samples > 0 && time - _bucket_start >= _bucket_span)
+    close_bucket();
+
+  for (Metric &metric : _metrics)
+    metric.sample = NaN;
+
+  for (const auto &row : rows) {
+    double number;
+    if (!parse_number(row.second, number))
+      continue;
+
+    auto entry = _index.find(row.first);
+    if (entry == _index.end()) {
+      // Variables showing up later (e.g. with a plugin being loaded) start with gaps to line up with the others.
+      Metric metric = {RingBuffer<double>(_capacity), RingBuffer<double>(_history_capacity), 0, 0, NaN};
+      for (size_t i = 0; i < _times.size(); ++i)
+        metric.values.push_back(NaN);
+      for (size_t i = 0; i < _history_times.size(); ++i)
+        metric.history.push_back(NaN);
+      entry = _index.emplace(row.first, _metrics.size()).first;
+      _metrics.push_back(std::move(metric));
+    }
+    _metrics[entry->second].sample = number;
+  }
+
+  _times.push_back(time);
+  for (Metric &metric : _metrics) {
+    metric.values.push_back(metric.sample);
+    if (!std::isnan(metric.sample)) {
+      metric.bucket_sum += metric.sample;
+      ++metric.bucket_count;
+    }
+  }
+
+  if (_bucket_samples == 0)
+    _bucket_start = time;
+  _bucket_time_sum += time;
+  ++_bucket_samples;
+
+  _last_rows = rows;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void StatusSeries::close_bucket() {
+  _history_times.push_back(_bucket_time_sum / _bucket_samples);
+  for (Metric &metric : _metrics) {
+    metric.history.push_back(metric.bucket_count > 0 ? metric.bucket_sum / metric.bucket_count : NaN);
+    metric.bucket_sum = 0;
+    metric.bucket_count = 0;
+  }
+  _bucket_time_sum = 0;
+  _bucket_samples = 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+const StatusSeries::Metric *StatusSeries::find(const std::string &name) const {
+  auto entry = _index.find(name);
+  return entry == _index.end() ? nullptr : &_metrics[entry->second];
+}
+
+//--------------------------------------------------------------------------------------------------
+
+double StatusSeries::last_time() const {
+  return _times.size() > 0 ? _times.back() : 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool StatusSeries::value(const std::string &name, double &value) const {
+  const Metric *metric = find(name);
+  if (metric == nullptr || metric->values.size() == 0 || std::isnan(metric->values.back()))
+    return false;
+
+  value = metric->values.back();
+  return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Average change per second over (at least) the given number of seconds, up to the last sample. Windows shorter
+ * than the sampling interval give the rate between the last two samples.
+ */
+bool StatusSeries::rate(const std::string &name, double window, double &rate) const {
+  const Metric *metric = find(name);
+  if (metric == nullptr || _times.size() < 2 || std::isnan(metric->values.back()))
+    return false;
+
+  size_t last = _times.size() - 1;
+  size_t first = last;
+  for (size_t i = last; i-- > 0;) {
+    if (std::isnan(metric->values[i]))
+      continue;
+    first = i;
+    if (_times[last] - _times[i] >= window)
+      break;
+  }
+  if (first == last)
+    return false;
+
+  rate = rate_between(_times[first], metric->values[first], _times[last], metric->values[last]);
+  return !std::isnan(rate);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+std::vector<double> StatusSeries::times(bool history) const {
+  const RingBuffer<double> &times = history ? _history_times : _times;
+
+  std::vector<double> result;
+  result.reserve(times.size());
+  for (size_t i = 0; i < times.size(); ++i)
+    result.push_back(times[i]);
+  return result;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+std::vector<double> StatusSeries::values(const std::string &name, bool history) const {
+  std::vector<double> result;
+  const Metric *metric = find(name);
+  if (metric == nullptr)
+    return result;
+
+  const RingBuffer<double> &values = history ? metric->history : metric->values;
+  result.reserve(values.size());
+  for (size_t i = 0; i < values.size(); ++i)
+    result.push_back(values[i]);
+  return result;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+std::vector<double> StatusSeries::rates(const std::string &name, bool history) const {
+  std::vector<double> result;
+  const Metric *metric = find(name);
+  if (metric == nullptr)
+    return result;
+
+  const RingBuffer<double> &times = history ? _history_times : _times;
+  const RingBuffer<double> &values = history ? metric->history : metric->values;
+  if (values.size() < 2)
+    return result;
+
+  result.reserve(values.size() - 1);
+  for (size_t i = 1; i < values.size(); ++i)
+    result.push_back(rate_between(times[i - 1], values[i - 1], times[i], values[i]));
+  return result;
+}
+
+//----------------- StatusSampler ------------------------------------------------------------------
+
+StatusSampler::StatusSampler(sql::ConnectionWrapper connection, double interval)
+  : _connection(connection),
+    _interval(std::max(interval, 0.1)),
+    _series((size_t)(RecentSpan / _interval) + 1, BucketSpan, (size_t)(HistorySpan / BucketSpan)),
+    _stop(false) {
+  _thread = std::thread(&StatusSampler::run, this);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+StatusSampler::~StatusSampler() {
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stop = true;
+  }
+  _wakeup.notify_all();
+  _thread.join();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+std::string StatusSampler::last_error() {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _last_error;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void StatusSampler::read(const std::function<void(const StatusSeries &)> &reader) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  reader(_series);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void StatusSampler::run() {
+  StatusSeries::Rows rows;
+  auto next = std::chrono::steady_clock::now();
+  auto interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+    std::chrono::duration<double>(_interval));
+
+  std::unique_lock<std::mutex> lock(_mutex);
+  while (!_stop) {
+    lock.unlock();
+
+    // The rows are assigned in place, so after the first round the strings rarely need new memory.
+    std::string error;
+    size_t count = 0;
+    try {
+      std::unique_ptr<sql::Statement> statement(_connection->createStatement());
+      std::unique_ptr<sql::ResultSet> rs(statement->executeQuery("SHOW GLOBAL STATUS"));
+      while (rs->next()) {
+        if (count == rows.size())
+          rows.emplace_back();
+        rows[count].first = rs->getString(1);
+        rows[count].second = rs->getString(2);
+        ++count;
+      }
+    } catch (std::exception &exc) {
+      error = exc.what();
+    }
+    rows.resize(count);
+    double now = std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+
+    lock.lock();
+    if (!error.empty()) {
+      logError("Sampling server status failed, stopping: %s\n", error.c_str());
+      _last_error = error;
+      break;
+    }
+    _series.add_sample(now, rows);
+
+    // A slow server delays the following samples instead of causing a burst of them.
+    next = std::max(next + interval, std::chrono::steady_clock::now());
+    _wakeup.wait_until(lock, next, [this]() { return _stop; });
+  }
+  lock.unlock();
+
+  // Frees what the client library keeps per thread.
+  sql::DriverManager::getDriverManager()->thread_cleanup();
+}
@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) 2020, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "cppdbc.h"
+
+/**
+ * Fixed size buffer that overwrites its oldest item once full. Items are indexed oldest first.
+ */
+template <class T>
+class RingBuffer {
+public:
+  RingBuffer(size_t capacity = 0) : _items(capacity), _first(0), _count(0) {
+  }
+
+  size_t size() const {
+    return _count;
+  }
+
+  size_t capacity() const {
+    return _items.size();
+  }
+
+  const T &operator[](size_t index) const {
+    return _items[(_first + index) % _items.size()];
+  }
+
+  const T &back() const {
+    return (*this)[_count - 1];
+  }
+
+  void push_back(const T &item) {
+    if (_items.empty())
+      return;
+
+    if (_count < _items.size())
+      _items[(_first + _count++) % _items.size()] = item;
+    else {
+      _items[_first] = item;
+      _first = (_first + 1) % _items.size();
+    }
+  }
+
+private:
+  std::vector<T> _items;
+  size_t _first;
+  size_t _count;
+};
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Time series of the numeric status variables of a server. Every sample is appended to a ring of recent values
+ * and folded into an average per bucket, which goes into a second, much longer ring once the bucket is complete.
+ * All series of a kind share the same time stamps, variables missing in a sample get NaN.
+ *
+ * Not thread safe, see StatusSampler.
+ */
+class StatusSeries {
+public:
+  typedef std::vector<std::pair<std::string, std::string> > Rows;
+
+  StatusSeries(size_t capacity, double bucket_span, size_t history_capacity);
+
+  void add_sample(double time, const Rows &rows);
+
+  // Time of the last sample, 0 if there is none.
+  double last_time() const;
+  // Variable names and values as returned by the server for the last sample, including non-numeric ones.
+  const Rows &last_rows() const {
+    return _last_rows;
+  }
+
+  bool value(const std::string &name, double &value) const;
+  bool rate(const std::string &name, double window, double &rate) const;
+
+  // Recent (or down-sampled) time stamps and values, oldest first.
+  std::vector<double> times(bool history) const;
+  std::vector<double> values(const std::string &name, bool history) const;
+  // Change per second between consecutive values, one less than there are times. Counter resets give 0.
+  std::vector<double> rates(const std::string &name, bool history) const;
+
+private:
+  struct Metric {
+    RingBuffer<double> values;
+    RingBuffer<double> history;
+    double bucket_sum;
+    size_t bucket_count;
+    double sample; // value in the sample being added
+  };
+
+  std::unordered_map<std::string, size_t> _index;
+  std::vector<Metric> _metrics;
+  RingBuffer<double> _times;
+  RingBuffer<double> _history_times;
+  Rows _last_rows;
+
+  size_t _capacity;
+  size_t _history_capacity;
+  double _bucket_span;
+  double _bucket_start;
+  double _bucket_time_sum;
+  size_t _bucket_samples;
+
+  const Metric *find(const std::string &name) const;
+  void close_bucket();
+};
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Queries SHOW GLOBAL STATUS on its own connection and thread at a fixed interval and collects the results in a
+ * StatusSeries. Sampling stops at the first error, which is then available from last_error().
+ */
+class StatusSampler {
+public:
+  StatusSampler(sql::ConnectionWrapper connection, double interval);
+  ~StatusSampler();
+
+  std::string last_error();
+
+  // Runs the reader with the series locked against the sampling thread. Keep it short.
+  void read(const std::function<void(const StatusSeries &)> &reader);
+
+private:
+  sql::ConnectionWrapper _connection;
+  double _interval;
+  StatusSeries _series;
+  std::string _last_error;
+  bool _stop;
+
+  std::mutex _mutex;
+  std::condition_variable _wakeup;
+  std::thread _thread;
+
+  void run();
+};
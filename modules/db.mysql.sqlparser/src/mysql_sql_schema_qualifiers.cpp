@@ -0,0 +1,213 @@
+/*
+ * Copyright (c) 2020, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#include <algorithm>
+#include <vector>
+
+#include <glib.h>
+
+#include "base/string_utilities.h"
+
+#include "mysql/MySQLLexer.h"
+
+#include "mysql_sql_schema_qualifiers.h"
+
+using namespace parsers;
+
+class Mysql_sql_schema_qualifiers::Lexer {
+public:
+  antlr4::ANTLRInputStream input;
+  MySQLLexer lexer;
+
+  Lexer() : lexer(&input) {
+    lexer.removeErrorListeners();
+  }
+
+  // Any keyword following a dot is a name too (e.g. the "order" in "s . order").
+  bool is_name(const std::vector<antlr4::Token *> &tokens, size_t index) {
+    if (index >= tokens.size())
+      return false;
+    size_t previous_type = index > 0 ? tokens[index - 1]->getType() : antlr4::Token::INVALID_TYPE;
+    return lexer.isIdentifierAfter(tokens[index]->getType(), previous_type);
+  }
+};
+
+//--------------------------------------------------------------------------------------------------
+
+static bool is_type(const std::vector<antlr4::Token *> &tokens, size_t index, size_t type) {
+  return index < tokens.size() && tokens[index]->getType() == type;
+}
+
+static bool is_quoted(const antlr4::Token *token) {
+  return token->getType() == MySQLLexer::BACK_TICK_QUOTED_ID || token->getType() == MySQLLexer::DOUBLE_QUOTED_TEXT;
+}
+
+/**
+ * Byte offsets of the code points in the text, as the lexer counts characters, not bytes. The list is one longer than
+ * the number of code points, for the end of the text. A leading BOM is skipped by the input stream, so it's skipped
+ * here too.
+ */
+static std::vector<size_t> code_point_offsets(const std::string &text) {
+  std::vector<size_t> offsets;
+  offsets.reserve(text.size() + 1);
+
+  size_t start = text.compare(0, 3, "\xEF\xBB\xBF") == 0 ? 3 : 0;
+  for (size_t i = start; i < text.size(); ++i) {
+    if (((unsigned char)text[i] & 0xC0) != 0x80)
+      offsets.push_back(i);
+  }
+  offsets.push_back(text.size());
+  return offsets;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+Mysql_sql_schema_qualifiers::Mysql_sql_schema_qualifiers(long server_version, const std::string &sql_mode,
+                                                         const std::string &old_schema_name,
+                                                         const std::string &new_schema_name, bool case_sensitive)
+  : _lexer(new Lexer()),
+    _old_schema_name(old_schema_name),
+    _new_schema_name(new_schema_name),
+    _case_sensitive(case_sensitive),
+    _trigger_row_name(base::same_string(old_schema_name, "new", false) ||
+                      base::same_string(old_schema_name, "old", false)) {
+  _lexer->lexer.serverVersion = server_version;
+  _lexer->lexer.sqlModeFromString(sql_mode);
+
+  // Quoting may escape characters of the name and case folding is only cheap for ASCII.
+  _quick_check = std::all_of(_old_schema_name.begin(), _old_schema_name.end(), [](char c) {
+    return (unsigned char)c < 0x80 && c != '`' && c != '"' && c != '\\';
+  });
+}
+
+//--------------------------------------------------------------------------------------------------
+
+Mysql_sql_schema_qualifiers::~Mysql_sql_schema_qualifiers() {
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool Mysql_sql_schema_qualifiers::may_contain_old_name(const std::string &sql_text) const {
+  if (!_quick_check)
+    return true;
+
+  if (_case_sensitive)
+    return sql_text.find(_old_schema_name) != std::string::npos;
+
+  return std::search(sql_text.begin(), sql_text.end(), _old_schema_name.begin(), _old_schema_name.end(),
+                     [](char a, char b) { return g_ascii_tolower(a) == g_ascii_tolower(b); }) != sql_text.end();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+Mysql_sql_schema_qualifiers::Result Mysql_sql_schema_qualifiers::rename(std::string &sql_text) {
+  if (sql_text.empty() || !may_contain_old_name(sql_text))
+    return Unchanged;
+
+  std::vector<std::unique_ptr<antlr4::Token> > all_tokens;
+  try {
+    _lexer->input.load(sql_text);
+    _lexer->lexer.reset();
+    _lexer->lexer.setInputStream(&_lexer->input);
+    all_tokens = _lexer->lexer.getAllTokens();
+  } catch (std::exception &) {
+    // e.g. invalid UTF-8, leave it to the full parser
+    return Ambiguous;
+  }
+
+  std::vector<antlr4::Token *> tokens;
+  tokens.reserve(all_tokens.size());
+  for (auto &token : all_tokens) {
+    if (token->getChannel() == antlr4::Token::DEFAULT_CHANNEL)
+      tokens.push_back(token.get());
+  }
+
+  // In a trigger NEW.col and OLD.col are columns of the rows being changed, but NEW.t in a table reference is a table.
+  bool in_trigger = _trigger_row_name && std::any_of(tokens.begin(), tokens.end(), [](const antlr4::Token *token) {
+    return token->getType() == MySQLLexer::TRIGGER_SYMBOL;
+  });
+
+  // Indexes of the tokens that qualify a name with the old schema.
+  std::vector<size_t> qualifiers;
+  bool has_two_part_names = false;
+  bool used_as_plain_name = false;
+  for (size_t i = 0; i < tokens.size(); ++i) {
+    if (!_lexer->is_name(tokens, i) ||
+        !base::same_string(is_quoted(tokens[i]) ? base::unquote(tokens[i]->getText()) : tokens[i]->getText(),
+                           _old_schema_name, _case_sensitive))
+      continue;
+
+    if (!is_type(tokens, i + 1, MySQLLexer::DOT_SYMBOL) || is_type(tokens, i - 1, MySQLLexer::DOT_SYMBOL)) {
+      used_as_plain_name = true;
+      continue;
+    }
+
+    size_t parts = 1;
+    for (size_t j = i; is_type(tokens, j + 1, MySQLLexer::DOT_SYMBOL) &&
+                       (_lexer->is_name(tokens, j + 2) || is_type(tokens, j + 2, MySQLLexer::MULT_OPERATOR));
+         j += 2)
+      ++parts;
+
+    if (parts == 1)
+      used_as_plain_name = true;
+    else {
+      if (parts == 2) {
+        if (in_trigger)
+          return Ambiguous;
+        has_two_part_names = true;
+      }
+      qualifiers.push_back(i);
+    }
+  }
+
+  if (has_two_part_names && used_as_plain_name)
+    return Ambiguous;
+  if (qualifiers.empty())
+    return Unchanged;
+
+  std::vector<size_t> offsets;
+  bool ascii = std::all_of(sql_text.begin(), sql_text.end(), [](char c) { return (unsigned char)c < 0x80; });
+  if (!ascii)
+    offsets = code_point_offsets(sql_text);
+
+  for (std::vector<size_t>::const_reverse_iterator i = qualifiers.rbegin(); i != qualifiers.rend(); ++i) {
+    const antlr4::Token *token = tokens[*i];
+    size_t start = token->getStartIndex();
+    size_t stop = token->getStopIndex() + 1;
+    if (_new_schema_name.empty()) {
+      // drop the qualifier with its quotes and the dot following it
+      stop = tokens[*i + 1]->getStopIndex() + 1;
+    } else if (is_quoted(token)) {
+      ++start;
+      --stop;
+    }
+
+    if (!ascii) {
+      start = offsets[start];
+      stop = offsets[stop];
+    }
+    sql_text.replace(start, stop - start, _new_schema_name);
+  }
+
+  return Renamed;
+}
@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2020, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "mysql_sql_parser_public_interface.h"
+
+/** Renames the schema qualifiers of object names in SQL text, using only the token stream of the MySQL lexer.
+ *
+ * Names with three parts (schema.table.column) always start with a schema. In two part names the first part can be
+ * a schema or a table (or alias), which can't be told apart without a parse tree. It's taken as schema if the old
+ * schema name isn't used as a plain identifier anywhere else in the text. Otherwise the text is reported as ambiguous
+ * and must be handled by a full parse. The same goes for two part names in triggers if the old schema is named NEW or
+ * OLD, as those are also the rows the trigger works on.
+ *
+ * The text outside of the renamed qualifiers is kept byte for byte. An instance keeps its lexer between calls and
+ * must not be shared between threads.
+ *
+ * @ingroup sqlparser
+ */
+class MYSQL_SQL_PARSER_PUBLIC_FUNC Mysql_sql_schema_qualifiers {
+public:
+  enum Result { Unchanged, Renamed, Ambiguous };
+
+  Mysql_sql_schema_qualifiers(long server_version, const std::string &sql_mode, const std::string &old_schema_name,
+                              const std::string &new_schema_name, bool case_sensitive);
+  ~Mysql_sql_schema_qualifiers();
+
+  Result rename(std::string &sql_text);
+
+private:
+  class Lexer;
+  std::unique_ptr<Lexer> _lexer;
+
+  std::string _old_schema_name;
+  std::string _new_schema_name;
+  bool _case_sensitive;
+  bool _trigger_row_name; // whether the old name is also NEW or OLD in a trigger
+  bool _quick_check; // whether a text can be skipped if it doesn't contain the old name literally
+
+  bool may_contain_old_name(const std::string &sql_text) const;
+};
@@ -24,7 +24,12 @@
 #include <glib.h>
 #include <boost/signals2.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
 #include "mysql_sql_schema_rename.h"
+#include "grtdb/db_helpers.h"
 #include "grtsqlparser/module_utils.h"
 #include "mysql_sql_parser_fe.h"
 #include "myx_statement_parser.h"
@@ -59,8 +64,14 @@ int Mysql_sql_schema_rename::rename_schema_references(std::string &sql, const st
 
   _messages_enabled = false;
 
+  std::string sql_mode = bec::GRTManager::get()->get_app_option_string("SqlMode");
+  Mysql_sql_schema_qualifiers qualifiers(server_version(), sql_mode, _old_schema_name, _new_schema_name,
+                                         _case_sensitive_identifiers);
+  if (qualifiers.rename(sql) != Mysql_sql_schema_qualifiers::Ambiguous)
+    return pr_processed;
+
   _process_sql_statement = boost::bind(&Mysql_sql_schema_rename::process_sql_statement, this, _1);
-  Mysql_sql_parser_fe sql_parser_fe(bec::GRTManager::get()->get_app_option_string("SqlMode"));
+  Mysql_sql_parser_fe sql_parser_fe(sql_mode);
   sql_parser_fe.ignore_dml = false;
 
   rename_schema_references(sql, sql_parser_fe, 1);
@@ -87,32 +98,44 @@ int Mysql_sql_schema_rename::rename_schema_references(db_CatalogRef catalog, con
     add_log_message(msg, 0);
   }
 
-  _process_sql_statement = boost::bind(&Mysql_sql_schema_rename::process_sql_statement, this, _1);
-  Mysql_sql_parser_fe sql_parser_fe(bec::GRTManager::get()->get_app_option_string("SqlMode"));
-  sql_parser_fe.ignore_dml = false;
-
+  // The GRT values are only touched here, the worker threads get plain copies of the SQL texts.
+  std::vector<Sql_object> objects;
   ListRef<db_mysql_Schema> schemata = _catalog->schemata();
   for (size_t n = 0, count = schemata.count(); n < count; ++n) {
     _active_schema = schemata.get(n);
 
-    // views
-    rename_schema_references<db_mysql_View>(_active_schema->views(), &db_mysql_View::sqlDefinition,
-                                            &db_mysql_View::sqlDefinition, 0, sql_parser_fe);
+    collect_objects(ListRef<db_DatabaseDdlObject>::cast_from(_active_schema->views()), 0, objects);
+    collect_objects(ListRef<db_DatabaseDdlObject>::cast_from(_active_schema->routines()), 1, objects);
 
-    // routines
-    rename_schema_references<db_mysql_Routine>(_active_schema->routines(), &db_mysql_Routine::sqlDefinition,
-                                               &db_mysql_Routine::sqlDefinition, 1, sql_parser_fe);
+    grt::ListRef<db_mysql_Table> tables = _active_schema->tables();
+    for (size_t n = 0, count = tables.count(); n < count; ++n)
+      collect_objects(ListRef<db_DatabaseDdlObject>::cast_from(tables.get(n)->triggers()), 1, objects);
+  }
 
-    // tables + triggers
-    {
-      grt::ListRef<db_mysql_Table> tables = _active_schema->tables();
+  rename_in_objects(objects);
 
-      // tables
-      for (size_t n = 0, count = tables.count(); n < count; ++n) {
-        // triggers
-        rename_schema_references<db_mysql_Trigger>(tables.get(n)->triggers(), &db_mysql_Trigger::sqlDefinition,
-                                                   &db_mysql_Trigger::sqlDefinition, 1, sql_parser_fe);
-      }
+  // The old parser isn't reentrant, so statements that need it are done one after the other.
+  Mysql_sql_parser_fe sql_parser_fe(bec::GRTManager::get()->get_app_option_string("SqlMode"));
+  sql_parser_fe.ignore_dml = false;
+  _process_sql_statement = boost::bind(&Mysql_sql_schema_rename::process_sql_statement, this, _1);
+
+  for (Sql_object &object : objects) {
+    if (object.result == Mysql_sql_schema_qualifiers::Ambiguous) {
+      _active_schema = object.schema;
+      if (rename_schema_references(object.sql_text, sql_parser_fe, object.delim_wrapping))
+        object.result = Mysql_sql_schema_qualifiers::Renamed;
+    }
+
+    if (object.result == Mysql_sql_schema_qualifiers::Renamed) {
+      object.object->sqlDefinition(object.sql_text);
+
+      std::string log_msg;
+      log_msg.append(object.object.get_metaclass()->get_attribute("caption"))
+        .append(" ")
+        .append(object.object->name())
+        .append(" updated with regard to new schema name.");
+      ++_processed_obj_count;
+      add_log_message(log_msg, 0);
     }
   }
 
@@ -126,31 +149,51 @@ int Mysql_sql_schema_rename::rename_schema_references(db_CatalogRef catalog, con
   return pr_processed;
 }
 
-template <typename T>
-void Mysql_sql_schema_rename::rename_schema_references(grt::ListRef<T> obj_list,
-                                                       grt::StringRef (T::*sql_text_prop_r)() const,
-                                                       void (T::*sql_text_prop_w)(const grt::StringRef &),
-                                                       int delim_wrapping, Mysql_sql_parser_fe &sql_parser_fe) {
+void Mysql_sql_schema_rename::collect_objects(grt::ListRef<db_DatabaseDdlObject> obj_list, int delim_wrapping,
+                                              std::vector<Sql_object> &objects) {
   for (size_t n = 0, count = obj_list.count(); n < count; ++n) {
-    grt::Ref<T> db_obj = obj_list.get(n);
-    std::string sql_text = (db_obj.content().*sql_text_prop_r)();
-
-    if (rename_schema_references(sql_text, sql_parser_fe, delim_wrapping)) {
-      (db_obj.content().*sql_text_prop_w)(sql_text);
-
-      {
-        std::string log_msg;
-        log_msg.append(db_obj.get_metaclass()->get_attribute("caption"))
-          .append(" ")
-          .append(db_obj->name())
-          .append(" updated with regard to new schema name.");
-        ++_processed_obj_count;
-        add_log_message(log_msg, 0);
-      }
-    }
+    db_DatabaseDdlObjectRef db_obj = obj_list.get(n);
+    objects.push_back(
+      {db_obj, _active_schema, db_obj->sqlDefinition(), delim_wrapping, Mysql_sql_schema_qualifiers::Unchanged});
   }
 }
 
+/**
+ * Renames the schema qualifiers in the texts of the given objects. Larger catalogs are split over several threads,
+ * each with its own lexer. Only the texts and results in the list are modified.
+ */
+void Mysql_sql_schema_rename::rename_in_objects(std::vector<Sql_object> &objects) {
+  const size_t MinObjectsPerThread = 32;
+
+  long version = server_version();
+  std::string sql_mode = bec::GRTManager::get()->get_app_option_string("SqlMode");
+  std::atomic<size_t> next(0);
+
+  auto rename_objects = [&]() {
+    Mysql_sql_schema_qualifiers qualifiers(version, sql_mode, _old_schema_name, _new_schema_name,
+                                           _case_sensitive_identifiers);
+    for (size_t i = next++; i < objects.size(); i = next++)
+      objects[i].result = qualifiers.rename(objects[i].sql_text);
+  };
+
+  size_t thread_count = std::min<size_t>(std::thread::hardware_concurrency(),
+                                         (objects.size() + MinObjectsPerThread - 1) / MinObjectsPerThread);
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < thread_count; ++i)
+    threads.emplace_back(rename_objects);
+  rename_objects();
+  for (std::thread &thread : threads)
+    thread.join();
+}
+
+long Mysql_sql_schema_rename::server_version() const {
+  if (_catalog.is_valid())
+    return bec::version_to_int(_catalog->version());
+
+  std::string version = bec::GRTManager::get()->get_app_option_string("DefaultTargetMySQLVersion");
+  return bec::version_to_int(version.empty() ? GrtVersionRef() : bec::parse_version(version));
+}
+
 int Mysql_sql_schema_rename::process_sql_statement(const SqlAstNode *tree) {
   // on parsing error log error message
   if (!tree) {
@@ -255,13 +298,13 @@ bool Mysql_sql_schema_rename::rename_schema_references(std::string &sql_text, My
 
   (void)parse_sql_script(sql_parser_fe, sql_text.c_str());
 
-  rename_schema_references(sql_text);
+  bool renamed = rename_schema_references(sql_text);
   if (delim_wrapping) {
     sql_text.erase(sql_text.size() - end_delim.size(), end_delim.size());
     sql_text.erase(0, begin_delim.size());
   }
 
-  return true;
+  return renamed;
 }
 
 bool Mysql_sql_schema_rename::rename_schema_references(std::string &sql_text) {
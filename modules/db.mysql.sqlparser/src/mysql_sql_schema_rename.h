@@ -23,14 +23,20 @@
 
 #pragma once
 
+#include <vector>
+
 #include "mysql_sql_parser_base.h"
+#include "mysql_sql_schema_qualifiers.h"
 #include "grtsqlparser/sql_schema_rename.h"
 
 /** Searches catalog objects' statements for occurences of old schema name and replaces them with new one.
+ *
+ * The statements are scanned on the token level (see Mysql_sql_schema_qualifiers), on several threads for larger
+ * catalogs. Only statements where that can't decide what a name refers to are parsed completely.
  *
  * @ingroup sqlparser
  */
-class Mysql_sql_schema_rename : protected Mysql_sql_parser_base, virtual public Sql_schema_rename {
+class MYSQL_SQL_PARSER_PUBLIC_FUNC Mysql_sql_schema_rename : protected Mysql_sql_parser_base, virtual public Sql_schema_rename {
 public:
   typedef std::shared_ptr<Mysql_sql_schema_rename> Ref;
   static Ref create() {
@@ -49,10 +55,19 @@ public:
                                const std::string &new_schema_name);
 
 protected:
-  template <typename T>
-  void rename_schema_references(grt::ListRef<T> obj_list, grt::StringRef (T::*sql_text_prop_r)() const,
-                                void (T::*sql_text_prop_w)(const grt::StringRef &), int delim_wrapping,
-                                Mysql_sql_parser_fe &parser_fe);
+  // The SQL of a catalog object and what the token scan made of it.
+  struct Sql_object {
+    db_DatabaseDdlObjectRef object;
+    db_mysql_SchemaRef schema;
+    std::string sql_text;
+    int delim_wrapping;
+    Mysql_sql_schema_qualifiers::Result result;
+  };
+
+  void collect_objects(grt::ListRef<db_DatabaseDdlObject> obj_list, int delim_wrapping,
+                       std::vector<Sql_object> &objects);
+  void rename_in_objects(std::vector<Sql_object> &objects);
+  long server_version() const;
 
   int process_sql_statement(const SqlAstNode *tree);
   void process_sql_statement_item(const SqlAstNode *item);
@@ -226,10 +226,6 @@ def reverseEngineer(connection, catalog_name, schemata_list, context):
     catalog.simpleDatatypes.remove_all()
     catalog.simpleDatatypes.extend(connection.driver.owner.simpleDatatypes)
     
-    table_names_per_schema = {}
-    routine_names_per_schema = {}
-    trigger_names_per_schema = {}
-    
     def filter_warnings(mtype, text, detail):
         # filter out parser warnings about stub creation/reuse from the message stream, since
         # they're harmless
@@ -239,139 +235,26 @@ def reverseEngineer(connection, catalog_name, schemata_list, context):
         return False
     
     version = getServerVersion(connection)
-    
-    get_tables = context.get("reverseEngineerTables", True)
-    get_triggers = context.get("reverseEngineerTriggers", True) and (version.majorNumber, version.minorNumber, version.releaseNumber) >= (5, 1, 21)
-    get_views = context.get("reverseEngineerViews", True)
-    get_routines = context.get("reverseEngineerRoutines", True)
-    
-    # calculate total workload 1st
-    
-    # 10% of the progress is for preparation
-    
-    grt.send_progress(0, "Preparing...")
-    total = 0
-    i = 0.0
-    for schema_name in schemata_list:
-        check_interruption()
-        if get_tables and get_views:
-            table_names = getAllTableNames(connection, catalog_name, schema_name)
-        elif get_tables:
-            table_names = getTableNames(connection, catalog_name, schema_name)
-        elif get_views:
-            table_names = getViewNames(connection, catalog_name, schema_name)
-        else:
-            table_name = []
-        total += len(table_names)
-        table_names_per_schema[schema_name] = table_names
-        check_interruption()
-        if get_routines:
-            procedure_names = getProcedureNames(connection, catalog_name, schema_name)
-            check_interruption()
-            function_names = getFunctionNames(connection, catalog_name, schema_name)
-            check_interruption()
-            total += len(procedure_names)
-            total += len(function_names)
-            routine_names_per_schema[schema_name] = procedure_names, function_names
-        else:
-            routine_names_per_schema[schema_name] = [], []
-        if get_triggers:
-            trigger_names = getTriggerNames(connection, catalog_name, schema_name)
-            total += len(trigger_names)
-        else:
-            trigger_names = []
-        trigger_names_per_schema[schema_name] = trigger_names
-        
-        grt.send_progress(0.1 * (i/len(schemata_list)), "Preparing...")
-        i += 1.0
-
-    def wrap_sql(sql, schema):
-        return "USE `%s`;\n%s"%(escape_sql_identifier(schema), sql)
-
-    def wrap_routine_sql(sql):
-        return "DELIMITER " + grt.root.wb.options.options['SqlDelimiter'] + "\n" + sql
-
-    i = 0.0
-    for schema_name in schemata_list:
-        schema = grt.classes.db_mysql_Schema()
-        schema.owner = catalog
-        schema.name = schema_name
-        catalog.schemata.append(schema)
-        context = grt.modules.MySQLParserServices.createNewParserContext(catalog.characterSets, getServerVersion(connection), getServerMode(connection), 1)
-        options = {}
 
-        if get_tables or get_views:
-            grt.send_info("Reverse engineering tables from %s" % schema_name)
-            for table_name in table_names_per_schema[schema_name]:
-                check_interruption()
-                grt.send_progress(0.1 + 0.9 * (i / total), "Retrieving table %s.%s..." % (schema_name, table_name))
-                result = execute_query(connection, "SHOW CREATE TABLE `%s`.`%s`" % (escape_sql_identifier(schema_name), escape_sql_identifier(table_name)))
-                i += 0.5
-                grt.send_progress(0.1 + 0.9 * (i / total), "Reverse engineering %s.%s..." % (schema_name, table_name))
-                if result and result.nextRow():
-                    sql = result.stringByIndex(2)
-                    grt.push_message_handler(filter_warnings)
-                    grt.begin_progress_step(0.1 + 0.9 * (i / total), 0.1 + 0.9 * ((i+0.5) / total))
-                    grt.modules.MySQLParserServices.parseSQLIntoCatalogSql(context, catalog, wrap_sql(sql, schema_name), options)
-                    grt.end_progress_step()
-                    grt.pop_message_handler()
-                    i += 0.5
-                else:
-                    raise Exception("Could not fetch table information for %s.%s" % (schema_name, table_name))
-
-        if get_triggers:
-            grt.send_info("Reverse engineering triggers from %s" % schema_name)
-            for trigger_name in trigger_names_per_schema[schema_name]:
-                check_interruption()
-                grt.send_progress(0.1 + 0.9 * (i / total), "Retrieving trigger %s.%s..." % (schema_name, trigger_name))
-                result = execute_query(connection, "SHOW CREATE TRIGGER `%s`.`%s`" % (escape_sql_identifier(schema_name), escape_sql_identifier(trigger_name)))
-                i += 0.5
-                grt.send_progress(0.1 + 0.9 * (i / total), "Reverse engineering %s.%s..." % (schema_name, trigger_name))
-                if result and result.nextRow():
-                    sql = result.stringByName("SQL Original Statement")
-                    grt.begin_progress_step(0.1 + 0.9 * (i / total), 0.1 + 0.9 * ((i+0.5) / total))
-                    grt.modules.MySQLParserServices.parseSQLIntoCatalogSql(context, catalog, wrap_sql(wrap_routine_sql(sql), schema_name), options)
-                    grt.end_progress_step()
-                    i += 0.5
-                else:
-                    raise Exception("Could not fetch trigger information for %s.%s" % (schema_name, trigger_name))
-        
-        if get_routines:
-            grt.send_info("Reverse engineering stored procedures from %s" % schema_name)
-            procedure_names, function_names = routine_names_per_schema[schema_name]
-            for name in procedure_names:
-                check_interruption()
-                grt.send_progress(0.1 + 0.9 * (i / total), "Retrieving stored procedure %s.%s..." % (schema_name, name))
-                result = execute_query(connection, "SHOW CREATE PROCEDURE `%s`.`%s`" % (escape_sql_identifier(schema_name), escape_sql_identifier(name)))
-                i += 0.5
-                grt.send_progress(0.1 + 0.9 * (i / total), "Reverse engineering %s.%s..." % (schema_name, name))
-                if result and result.nextRow():
-                    sql = result.stringByName("Create Procedure")
-                    grt.begin_progress_step(0.1 + 0.9 * (i / total), 0.1 + 0.9 * ((i+0.5) / total))
-                    grt.modules.MySQLParserServices.parseSQLIntoCatalogSql(context, catalog, wrap_sql(wrap_routine_sql(sql), schema_name), options)
-                    grt.end_progress_step()
-                    i += 0.5
-                else:
-                    raise Exception("Could not fetch procedure information for %s.%s" % (schema_name, name))
-
-            grt.send_info("Reverse engineering functions from %s" % schema_name)
-            for name in function_names:
-                check_interruption()
-                grt.send_progress(0.1 + 0.9 * (i / total), "Retrieving function %s.%s..." % (schema_name, name))
-                result = execute_query(connection, "SHOW CREATE FUNCTION `%s`.`%s`" % (escape_sql_identifier(schema_name), escape_sql_identifier(name)))
-                i += 0.5
-                grt.send_progress(0.1 + 0.9 * (i / total), "Reverse engineering %s.%s..." % (schema_name, name))
-                if result and result.nextRow():
-                    sql = result.stringByName("Create Function")
-                    grt.begin_progress_step(0.1 + 0.9 * (i / total), 0.1 + 0.9 * ((i+0.5) / total))
-                    grt.modules.MySQLParserServices.parseSQLIntoCatalogSql(context, catalog, wrap_sql(wrap_routine_sql(sql), schema_name), options)
-                    grt.end_progress_step()
-                    i += 0.5
-                else:
-                    raise Exception("Could not fetch function information for %s.%s" % (schema_name, name))
-
-    grt.send_progress(1.0, "Reverse engineered %i objects" % total)
-    
+    # The actual work is done natively: object lists come from information_schema and the DDL is
+    # fetched and parsed in parallel over several connections.
+    options = {}
+    options["reverseEngineerTables"] = int(context.get("reverseEngineerTables", True))
+    options["reverseEngineerTriggers"] = int(context.get("reverseEngineerTriggers", True) and (version.majorNumber, version.minorNumber, version.releaseNumber) >= (5, 1, 21))
+    options["reverseEngineerViews"] = int(context.get("reverseEngineerViews", True))
+    options["reverseEngineerRoutines"] = int(context.get("reverseEngineerRoutines", True))
+    options["connectionCount"] = int(context.get("connectionCount", 4))
+    password = get_connection(connection).password
+    if password is not None:
+        options["password"] = password
+
+    grt.send_info("Reverse engineering %i schemas" % len(schemata_list))
+    grt.push_message_handler(filter_warnings)
+    try:
+        grt.modules.MySQLParserServices.reverseEngineerSchemata(connection, catalog, schemata_list, options)
+    finally:
+        grt.pop_message_handler()
+
     # check for any stub tables left
     empty_schemas = []
     for schema in catalog.schemata:
@@ -33,7 +33,11 @@
 #include "grt/common.h"
 
 #include <algorithm>
+#include <atomic>
 #include <ctype.h>
+#include <exception>
+#include <memory>
+#include <thread>
 
 #include "module_db_mysql.h"
 #include "module_db_mysql_shared_code.h"
@@ -336,22 +340,19 @@ void DiffSQLGeneratorBE::generate_create_stmt(db_mysql_SchemaRef schema) {
   callback->create_schema(schema);
 
   grt::ListRef<db_mysql_Table> tables = schema->tables();
-  for (size_t count = tables.count(), i = 0; i < count; i++) {
-    db_mysql_TableRef table = tables.get(i);
-    generate_create_stmt(table);
-  }
+  generate_in_parallel(tables.count(), [&](DiffSQLGeneratorBE &generator, size_t i) {
+    generator.generate_create_stmt(tables.get(i));
+  });
 
   grt::ListRef<db_mysql_View> views = schema->views();
-  for (size_t count = views.count(), i = 0; i < count; i++) {
-    db_mysql_ViewRef view = views.get(i);
-    generate_create_stmt(view);
-  }
+  generate_in_parallel(views.count(), [&](DiffSQLGeneratorBE &generator, size_t i) {
+    generator.generate_create_stmt(views.get(i));
+  });
 
   grt::ListRef<db_mysql_Routine> routines = schema->routines();
-  for (size_t count = routines.count(), i = 0; i < count; i++) {
-    db_mysql_RoutineRef routine = routines.get(i);
-    generate_create_stmt(routine);
-  }
+  generate_in_parallel(routines.count(), [&](DiffSQLGeneratorBE &generator, size_t i) {
+    generator.generate_create_stmt(routines.get(i));
+  });
 }
 
 void DiffSQLGeneratorBE::generate_create_stmt(db_UserRef user) {
@@ -1151,20 +1152,20 @@ void DiffSQLGeneratorBE::generate_alter_stmt(db_mysql_SchemaRef schema, const gr
     if (attr_change->get_attr_name().compare("tables") == 0) {
       const grt::MultiChange *list_change = static_cast<const grt::MultiChange *>(attr_change->get_subchange().get());
       const grt::ChangeSet *tables_cs = list_change->subchanges();
-      for (grt::ChangeSet::const_iterator e2 = tables_cs->end(), jt = tables_cs->begin(); jt != e2; jt++) {
-        const grt::DiffChange *table_change = jt->get();
+      generate_in_parallel(tables_cs->changes.size(), [&](DiffSQLGeneratorBE &generator, size_t i) {
+        const grt::DiffChange *table_change = tables_cs->changes[i].get();
         if (table_change->get_change_type() == grt::ListItemModified) {
-          generate_alter_stmt_drops(
+          generator.generate_alter_stmt_drops(
             db_mysql_TableRef::cast_from(
               static_cast<const grt::ListItemModifiedChange *>(table_change)->get_new_value()),
             static_cast<const grt::ListItemModifiedChange *>(table_change)->get_subchange().get());
         } else if (table_change->get_change_type() == grt::ListItemOrderChanged) {
           const grt::ListItemOrderChange *oc = static_cast<const grt::ListItemOrderChange *>(table_change);
           if (oc->get_subchange())
-            generate_alter_stmt_drops(db_mysql_TableRef::cast_from(oc->get_subchange()->get_new_value()),
-                                      oc->get_subchange()->get_subchange().get());
+            generator.generate_alter_stmt_drops(db_mysql_TableRef::cast_from(oc->get_subchange()->get_new_value()),
+                                                oc->get_subchange()->get_subchange().get());
         }
-      }
+      });
     }
   }
 
@@ -1175,19 +1176,19 @@ void DiffSQLGeneratorBE::generate_alter_stmt(db_mysql_SchemaRef schema, const gr
       const grt::ChangeSet *tables_cs = list_change->subchanges();
 
       // 1st pass, do everything except FKs
-      for (grt::ChangeSet::const_iterator e2 = tables_cs->end(), jt = tables_cs->begin(); jt != e2; jt++) {
-        const grt::DiffChange *table_change = jt->get();
+      generate_in_parallel(tables_cs->changes.size(), [&](DiffSQLGeneratorBE &generator, size_t i) {
+        const grt::DiffChange *table_change = tables_cs->changes[i].get();
         switch (table_change->get_change_type()) {
           case grt::ListItemAdded:
-            generate_create_stmt(
+            generator.generate_create_stmt(
               db_mysql_TableRef::cast_from(static_cast<const grt::ListItemAddedChange *>(table_change)->get_value()));
             break;
           case grt::ListItemRemoved:
-            generate_drop_stmt(
+            generator.generate_drop_stmt(
               db_mysql_TableRef::cast_from(static_cast<const grt::ListItemRemovedChange *>(table_change)->get_value()));
             break;
           case grt::ListItemModified:
-            generate_alter_stmt(
+            generator.generate_alter_stmt(
               db_mysql_TableRef::cast_from(
                 static_cast<const grt::ListItemModifiedChange *>(table_change)->get_new_value()),
               static_cast<const grt::ListItemModifiedChange *>(table_change)->get_subchange().get(),
@@ -1196,39 +1197,40 @@ void DiffSQLGeneratorBE::generate_alter_stmt(db_mysql_SchemaRef schema, const gr
           case grt::ListItemOrderChanged: {
             const grt::ListItemOrderChange *oc = static_cast<const grt::ListItemOrderChange *>(table_change);
             if (oc->get_subchange())
-              generate_alter_stmt(db_mysql_TableRef::cast_from(oc->get_subchange()->get_new_value()),
-                                  oc->get_subchange()->get_subchange().get(),
-                                  _separate_foreign_keys ? EverythingButForeignKeys : Everything);
+              generator.generate_alter_stmt(db_mysql_TableRef::cast_from(oc->get_subchange()->get_new_value()),
+                                            oc->get_subchange()->get_subchange().get(),
+                                            _separate_foreign_keys ? EverythingButForeignKeys : Everything);
           } break;
           default:
             break;
         }
-      }
+      });
 
       if (_separate_foreign_keys) {
         // 2nd pass, do FKs only
-        for (grt::ChangeSet::const_iterator e2 = tables_cs->end(), jt = tables_cs->begin(); jt != e2; jt++) {
-          const grt::DiffChange *table_change = jt->get();
+        generate_in_parallel(tables_cs->changes.size(), [&](DiffSQLGeneratorBE &generator, size_t i) {
+          const grt::DiffChange *table_change = tables_cs->changes[i].get();
           switch (table_change->get_change_type()) {
             case grt::ListItemAdded:
             case grt::ListItemRemoved:
               break;
             case grt::ListItemModified:
-              generate_alter_stmt(db_mysql_TableRef::cast_from(
-                                    static_cast<const grt::ListItemModifiedChange *>(table_change)->get_new_value()),
-                                  static_cast<const grt::ListItemModifiedChange *>(table_change)->get_subchange().get(),
-                                  OnlyForeignKeys); // FK only
+              generator.generate_alter_stmt(
+                db_mysql_TableRef::cast_from(
+                  static_cast<const grt::ListItemModifiedChange *>(table_change)->get_new_value()),
+                static_cast<const grt::ListItemModifiedChange *>(table_change)->get_subchange().get(),
+                OnlyForeignKeys); // FK only
               break;
             case grt::ListItemOrderChanged: {
               const grt::ListItemOrderChange *oc = static_cast<const grt::ListItemOrderChange *>(table_change);
               if (oc->get_subchange())
-                generate_alter_stmt(db_mysql_TableRef::cast_from(oc->get_subchange()->get_new_value()),
-                                    oc->get_subchange()->get_subchange().get(), OnlyForeignKeys);
+                generator.generate_alter_stmt(db_mysql_TableRef::cast_from(oc->get_subchange()->get_new_value()),
+                                              oc->get_subchange()->get_subchange().get(), OnlyForeignKeys);
             } break;
             default:
               break;
           }
-        }
+        });
       }
     } else if (attr_change->get_attr_name().compare("views") == 0) {
       const grt::MultiChange *list_change = static_cast<const grt::MultiChange *>(attr_change->get_subchange().get());
@@ -1374,7 +1376,8 @@ DiffSQLGeneratorBE::DiffSQLGeneratorBE(grt::DictRef options, grt::DictRef dbtrai
     _skip_fk_indexes(false),
     _case_sensitive(false),
     _use_oid_as_dict_key(false),
-    _separate_foreign_keys(true) {
+    _separate_foreign_keys(true),
+    _worker_thread_count(0) {
   if (!options.is_valid())
     return;
   _case_sensitive = (dbtraits.get_int("CaseSensitive", _case_sensitive) != 0);
@@ -1386,6 +1389,8 @@ DiffSQLGeneratorBE::DiffSQLGeneratorBE(grt::DictRef options, grt::DictRef dbtrai
   _gen_create_index = (options.get_int("GenerateCreateIndex", _gen_create_index) != 0);
   _use_filtered_lists = options.get_int("UseFilteredLists", _use_filtered_lists) != 0;
   _separate_foreign_keys = options.get_int("SeparateForeignKeys", _separate_foreign_keys) != 0;
+  ssize_t worker_thread_count = options.get_int("WorkerThreadCount", 0);
+  _worker_thread_count = worker_thread_count > 0 ? (size_t)worker_thread_count : 0;
   cb->setOmitSchemas(options.get_int("OmitSchemas", 0) != 0);
   cb->set_gen_use(options.get_int("GenerateUse", 0) != 0);
   fill_set_from_list(grt::StringListRef::cast_from(options.get("UserFilterList", empty_list)), _filtered_users);
@@ -1396,6 +1401,61 @@ DiffSQLGeneratorBE::DiffSQLGeneratorBE(grt::DictRef options, grt::DictRef dbtrai
   fill_set_from_list(grt::StringListRef::cast_from(options.get("TriggerFilterList", empty_list)), _filtered_triggers);
 }
 
+// Below this number of objects generating the text in parallel doesn't pay off.
+static const size_t MIN_PARALLEL_OBJECT_COUNT = 32;
+
+void DiffSQLGeneratorBE::generate_in_parallel(size_t count,
+                                              const std::function<void(DiffSQLGeneratorBE &, size_t)> &task) {
+  size_t thread_count = std::min<size_t>(
+    _worker_thread_count > 0 ? _worker_thread_count : std::thread::hardware_concurrency(), count);
+  std::vector<std::unique_ptr<DiffSQLGeneratorBEActionInterface>> workers;
+  if (count >= MIN_PARALLEL_OBJECT_COUNT && thread_count > 1) {
+    for (size_t i = 0; i < count; i++) {
+      DiffSQLGeneratorBEActionInterface *worker = callback->clone_for_worker();
+      if (worker == nullptr) {
+        workers.clear();
+        break;
+      }
+      workers.emplace_back(worker);
+    }
+  }
+
+  if (workers.empty()) {
+    for (size_t i = 0; i < count; i++)
+      task(*this, i);
+    return;
+  }
+
+  // Every item gets a callback of its own to record its output, while each thread uses a copy of the generator
+  // to switch between those callbacks.
+  std::atomic<size_t> next_item(0);
+  std::vector<std::exception_ptr> errors(count);
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < thread_count; t++) {
+    threads.emplace_back([&]() {
+      DiffSQLGeneratorBE generator(*this);
+      size_t i;
+      while ((i = next_item++) < count) {
+        generator.callback = workers[i].get();
+        try {
+          task(generator, i);
+        } catch (...) {
+          errors[i] = std::current_exception();
+        }
+      }
+    });
+  }
+
+  for (auto &thread : threads)
+    thread.join();
+
+  for (size_t i = 0; i < count; i++) {
+    if (errors[i])
+      std::rethrow_exception(errors[i]);
+    callback->merge_worker_output(workers[i].get());
+  }
+}
+
 void DiffSQLGeneratorBE::process_diff_change(grt::ValueRef org_object, grt::DiffChange *diff, grt::DictRef map) {
   this->target_list = grt::StringListRef();
   this->target_map = map;
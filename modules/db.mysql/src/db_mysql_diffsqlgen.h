@@ -52,6 +52,7 @@
 #include "grtpp_module_cpp.h"
 #include "grts/structs.db.mysql.h"
 
+#include <functional>
 #include <set>
 
 namespace grt {
@@ -96,6 +97,7 @@ class DiffSQLGeneratorBE {
   bool _case_sensitive;
   bool _use_oid_as_dict_key;
   bool _separate_foreign_keys;
+  size_t _worker_thread_count; // 0 for one per core
   std::set<std::string> _filtered_schemata, _filtered_tables, _filtered_views, _filtered_routines, _filtered_triggers,
     _filtered_users;
 
@@ -179,6 +181,14 @@ class DiffSQLGeneratorBE {
 
   void do_process_diff_change(grt::ValueRef org_object, grt::DiffChange *);
 
+  /**
+   * Runs the task for the items [0, count) on worker threads, if the callback supports that, otherwise one after the
+   * other on the calling thread. Each item is processed by a copy of this generator with a callback of its own, whose
+   * output is merged back in item order, so the result is the same as when processing the items sequentially.
+   * The task must only read the GRT objects it works on.
+   */
+  void generate_in_parallel(size_t count, const std::function<void(DiffSQLGeneratorBE &, size_t)> &task);
+
 public:
   /**
    * DiffSQLGeneratorBE c-tor
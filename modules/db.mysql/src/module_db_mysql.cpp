@@ -284,8 +284,26 @@ namespace {
     grt::ListRef<GrtNamedObject> target_object_list;
     bool disable_object_list;
 
+    // Statements recorded by a worker copy (see clone_for_worker()), in the order they were generated.
+    struct RecordedStatement {
+      GrtNamedObjectRef object;
+      std::string sql;
+      bool alter;
+      bool front;
+    };
+    bool _recording;
+    std::vector<RecordedStatement> _recorded;
+
+    // Taken once on the main thread for worker copies, as module functions must not be called from other threads.
+    grt::ListRef<db_mysql_StorageEngine> _known_engines;
+
     void remember_alter(const GrtNamedObjectRef& obj, const std::string& sql);
     void remember(const GrtNamedObjectRef& obj, const std::string& sql, const bool front = false);
+    void store_alter(const GrtNamedObjectRef& obj, const std::string& sql);
+    void store(const GrtNamedObjectRef& obj, const std::string& sql, const bool front);
+    bool was_remembered(const GrtNamedObjectRef& obj) const;
+
+    db_mysql_StorageEngineRef engine_by_name(const std::string& name) const;
 
     void alter_table_property(std::string& to, const std::string& name, const std::string& value);
 
@@ -421,11 +439,14 @@ namespace {
     virtual void disable_list_insert(const bool flag) {
       disable_object_list = flag;
     };
+
+    virtual DiffSQLGeneratorBEActionInterface* clone_for_worker();
+    virtual void merge_worker_output(DiffSQLGeneratorBEActionInterface* worker);
   };
 
   ActionGenerateSQL::ActionGenerateSQL(grt::ValueRef target, grt::ListRef<GrtNamedObject> obj_list,
                                        const grt::DictRef options, bool use_oids_as_key = false)
-    : padding(2), _use_oids_as_dict_key(use_oids_as_key), disable_object_list(false) {
+    : padding(2), _use_oids_as_dict_key(use_oids_as_key), disable_object_list(false), _recording(false) {
     first_column = false;
     first_change = false;
     empty_length = 0;
@@ -686,7 +707,7 @@ namespace {
 
   void ActionGenerateSQL::create_table_fk(db_mysql_ForeignKeyRef fk) {
     grt::StringRef ename = db_mysql_TableRef::cast_from(fk->owner())->tableEngine();
-    db_mysql_StorageEngineRef engine = bec::TableHelper::get_engine_by_name(ename);
+    db_mysql_StorageEngineRef engine = engine_by_name(ename);
     if (engine.is_valid() && !engine->supportsForeignKeys())
       return;
 
@@ -1188,6 +1209,7 @@ namespace {
   }
 
   void ActionGenerateSQL::alter_table_indexes_begin(db_mysql_TableRef) {
+    indexAlter.clear();
   }
 
   void ActionGenerateSQL::alter_table_add_index(db_mysql_IndexRef index) {
@@ -1310,7 +1332,7 @@ namespace {
 
   void ActionGenerateSQL::alter_table_add_fk(db_mysql_ForeignKeyRef fk) {
     grt::StringRef ename = db_mysql_TableRef::cast_from(fk->owner())->tableEngine();
-    db_mysql_StorageEngineRef engine = bec::TableHelper::get_engine_by_name(ename);
+    db_mysql_StorageEngineRef engine = engine_by_name(ename);
     if (engine.is_valid() && !engine->supportsForeignKeys())
       return;
     if (first_fk_create)
@@ -1329,7 +1351,7 @@ namespace {
 
   void ActionGenerateSQL::alter_table_drop_fk(db_mysql_ForeignKeyRef fk) {
     grt::StringRef ename = db_mysql_TableRef::cast_from(fk->owner())->tableEngine();
-    db_mysql_StorageEngineRef engine = bec::TableHelper::get_engine_by_name(ename);
+    db_mysql_StorageEngineRef engine = engine_by_name(ename);
     if (engine.is_valid() && !engine->supportsForeignKeys())
       return;
 
@@ -1418,17 +1440,7 @@ namespace {
       db_mysql_TriggerRef preceding = find_ordering_for_trigger(trigger, position);
       if (preceding.is_valid()) {
         // check if the remember() at the end of this method was called for the "preceding" object
-        bool flag = false;
-        if (target_list.is_valid()) {
-          if (target_object_list.get_index(preceding) != grt::BaseListRef::npos)
-            flag = true;
-        } else {
-          if (target_map
-                .get(_use_oids_as_dict_key ? preceding.id() : get_full_object_name_for_key(preceding, _case_sensitive))
-                .is_valid())
-            flag = true;
-        }
-        if (!flag) {
+        if (!was_remembered(preceding)) {
           trigger_definition = "CREATE";
           if (!trigger->definer().empty()) {
             std::string definer = trigger->definer();
@@ -1617,9 +1629,29 @@ namespace {
   }
 
   void ActionGenerateSQL::remember(const GrtNamedObjectRef& obj, const std::string& sql, const bool front) {
+    if (target_list.is_valid() && disable_object_list)
+      return;
+
+    if (_recording)
+      _recorded.push_back({ obj, sql, false, front });
+    else
+      store(obj, sql, front);
+  }
+
+  // in case of ALTERs there could be > 1 statement to remember
+  // so we use grt::StringListRefs as needed
+  void ActionGenerateSQL::remember_alter(const GrtNamedObjectRef& obj, const std::string& sql) {
+    if (target_list.is_valid() && disable_object_list)
+      return;
+
+    if (_recording)
+      _recorded.push_back({ obj, sql, true, false });
+    else
+      store_alter(obj, sql);
+  }
+
+  void ActionGenerateSQL::store(const GrtNamedObjectRef& obj, const std::string& sql, const bool front) {
     if (target_list.is_valid()) {
-      if (disable_object_list)
-        return;
       target_list.insert(grt::StringRef(sql), front ? 0 : (size_t)StringListRef::npos);
       if (target_object_list.is_valid())
         target_object_list.insert(obj, front ? 0 : (size_t)StringListRef::npos);
@@ -1629,12 +1661,8 @@ namespace {
     }
   }
 
-  // in case of ALTERs there could be > 1 statement to remember
-  // so we use grt::StringListRefs as needed
-  void ActionGenerateSQL::remember_alter(const GrtNamedObjectRef& obj, const std::string& sql) {
+  void ActionGenerateSQL::store_alter(const GrtNamedObjectRef& obj, const std::string& sql) {
     if (target_list.is_valid()) {
-      if (disable_object_list)
-        return;
       target_list.insert(grt::StringRef(sql));
       if (target_object_list.is_valid())
         target_object_list.insert(obj);
@@ -1660,6 +1688,56 @@ namespace {
     }
   }
 
+  bool ActionGenerateSQL::was_remembered(const GrtNamedObjectRef& obj) const {
+    for (auto& statement : _recorded) {
+      if (statement.object == obj)
+        return true;
+    }
+
+    if (target_list.is_valid())
+      return target_object_list.get_index(obj) != grt::BaseListRef::npos;
+    return target_map.get(_use_oids_as_dict_key ? obj.id() : get_full_object_name_for_key(obj, _case_sensitive))
+      .is_valid();
+  }
+
+  db_mysql_StorageEngineRef ActionGenerateSQL::engine_by_name(const std::string& name) const {
+    if (!_known_engines.is_valid())
+      return bec::TableHelper::get_engine_by_name(name);
+
+    for (grt::ListRef<db_mysql_StorageEngine>::const_iterator iter = _known_engines.begin();
+         iter != _known_engines.end(); ++iter) {
+      if ((*iter)->name() == name)
+        return *iter;
+    }
+    return db_mysql_StorageEngineRef();
+  }
+
+  // Worker copies only generate text from the objects they are given. The target containers are shared with this
+  // instance, but they are only read while the workers run and written in merge_worker_output().
+  DiffSQLGeneratorBEActionInterface* ActionGenerateSQL::clone_for_worker() {
+    if (!_known_engines.is_valid()) {
+      grt::Module* module = grt::GRT::get()->get_module("DbMySQL");
+      if (module == nullptr)
+        return nullptr;
+      _known_engines = grt::ListRef<db_mysql_StorageEngine>::cast_from(
+        module->call_function("getKnownEngines", grt::BaseListRef(true)));
+    }
+
+    ActionGenerateSQL* worker = new ActionGenerateSQL(*this);
+    worker->_recording = true;
+    worker->_recorded.clear();
+    return worker;
+  }
+
+  void ActionGenerateSQL::merge_worker_output(DiffSQLGeneratorBEActionInterface* worker) {
+    for (auto& statement : static_cast<ActionGenerateSQL*>(worker)->_recorded) {
+      if (statement.alter)
+        store_alter(statement.object, statement.sql);
+      else
+        store(statement.object, statement.sql, statement.front);
+    }
+  }
+
 } // namespace
 
 DbMySQLImpl::DbMySQLImpl(grt::CPPModuleLoader* ldr) : grt::ModuleImplBase(ldr), _default_traits(true) {
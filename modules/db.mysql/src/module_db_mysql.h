@@ -198,6 +198,15 @@ public:
   virtual void alter_schema_default_collate(db_mysql_SchemaRef, grt::StringRef value) = 0;
   virtual void alter_schema_props_end(db_mysql_SchemaRef) = 0;
   virtual void disable_list_insert(const bool flag) = 0;
+
+  // parallel generation
+  // Returns a copy of this callback which records its output instead of storing it, so it can generate the text
+  // for a single object on a worker thread. Returns nullptr if the callback cannot be used that way.
+  virtual DiffSQLGeneratorBEActionInterface *clone_for_worker() {
+    return nullptr;
+  };
+  // Stores the output recorded by a worker copy as if it had been generated by this callback.
+  virtual void merge_worker_output(DiffSQLGeneratorBEActionInterface *worker){};
 };
 
 #define DOC_DbMySQLImpl                                          \
@@ -0,0 +1,434 @@
+/*
+ * Copyright (c) 2020, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#include <algorithm>
+#include <climits>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+
+#include "base/file_utilities.h"
+#include "base/util_functions.h"
+
+#include "log_indexer.h"
+
+static const size_t BlockSize = 1024 * 1024;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static inline char ascii_lower(char c) {
+  return (c >= 'A' && c <= 'Z') ? c - 'A' + 'a' : c;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// Days since 1970-01-01 of a date in the proleptic Gregorian calendar.
+static time_t days_from_civil(int year, int month, int day) {
+  year -= month <= 2;
+  const int era = (year >= 0 ? year : year - 399) / 400;
+  const int yoe = year - era * 400;
+  const int doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+  const int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return (time_t)era * 146097 + doe - 719468;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// Reads between min and max digits at pos.
+static bool read_number(const std::string &text, size_t &pos, size_t min, size_t max, int &value) {
+  size_t start = pos;
+  value = 0;
+  while (pos < text.size() && pos - start < max && text[pos] >= '0' && text[pos] <= '9')
+    value = value * 10 + (text[pos++] - '0');
+  return pos - start >= min;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+LogIndexer::LogIndexer(Format format) : _format(format), _offset_hour(-1), _utc_offset(0) {
+  reset();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void LogIndexer::reset(uint64_t start) {
+  _offsets.clear();
+  _times.clear();
+  _size = start;
+  _line_start = start;
+  _line_head.clear();
+  _skip_line = start > 0;
+  _last_time = 0;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void LogIndexer::add_data(const char *data, size_t length) {
+  const char *end = data + length;
+  while (data < end) {
+    const char *newline = (const char *)memchr(data, '\n', end - data);
+    const char *stop = newline ? newline : end;
+
+    if (!_skip_line && _line_head.size() < LineHeadSize)
+      _line_head.append(data, std::min((size_t)(stop - data), LineHeadSize - _line_head.size()));
+    _size += stop - data;
+    if (!newline)
+      break;
+
+    ++_size;
+    end_line();
+    data = newline + 1;
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool LogIndexer::update_from_file(const std::string &path) {
+  std::int64_t file_size = get_file_size(path.c_str());
+  if (file_size < 0)
+    return false;
+  if ((uint64_t)file_size < _size)
+    reset();
+  if ((uint64_t)file_size == _size)
+    return true;
+
+  std::ifstream stream = base::openBinaryInputStream(path);
+  if (!stream.is_open() || !stream.seekg(_size))
+    return false;
+
+  std::vector<char> buffer(BlockSize);
+  while (_size < (uint64_t)file_size) {
+    stream.read(buffer.data(), (std::streamsize)std::min<uint64_t>(buffer.size(), file_size - _size));
+    if (stream.gcount() <= 0)
+      return false;
+    add_data(buffer.data(), (size_t)stream.gcount());
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+uint64_t LogIndexer::record_start(size_t record) const {
+  return record < _offsets.size() ? _offsets[record] : _line_start;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+uint64_t LogIndexer::record_end(size_t record) const {
+  return record + 1 < _offsets.size() ? _offsets[record + 1] : _line_start;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+time_t LogIndexer::record_time(size_t record) const {
+  return record < _times.size() ? _times[record] : 0;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+size_t LogIndexer::find_time(time_t time) const {
+  // records without a time stamp inherit the previous one, so the list is sorted unless the server clock went back
+  return std::partition_point(_times.begin(), _times.end(), [time](uint32_t t) { return (time_t)t < time; }) -
+         _times.begin();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+size_t LogIndexer::page_end(size_t first, size_t max_records, uint64_t max_bytes) const {
+  size_t count = _offsets.size();
+  if (first >= count)
+    return count;
+
+  size_t end = first + std::min(count - first, std::max<size_t>(max_records, 1));
+  uint64_t limit = _offsets[first] + max_bytes;
+
+  // records first .. next - 2 end at or before the limit
+  size_t next = std::upper_bound(_offsets.begin() + first + 1, _offsets.begin() + end, limit) - _offsets.begin();
+  if (next == end && record_end(end - 1) <= limit)
+    return end;
+  return std::max(first + 1, next - 1);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+size_t LogIndexer::page_start(size_t end, size_t max_records, uint64_t max_bytes) const {
+  end = std::min(end, _offsets.size());
+  if (end == 0)
+    return 0;
+
+  size_t first = end - std::min(end, std::max<size_t>(max_records, 1));
+  uint64_t last_end = record_end(end - 1);
+  uint64_t limit = last_end > max_bytes ? last_end - max_bytes : 0;
+
+  size_t start = std::lower_bound(_offsets.begin() + first, _offsets.begin() + end, limit) - _offsets.begin();
+  return std::min(start, end - 1);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// Finds the first occurrence of folded, which must be lower case already, ignoring the case of ASCII letters.
+static const char *find_folded(const char *begin, const char *end, const std::string &folded) {
+  const size_t length = folded.size();
+  const char first = folded[0];
+  for (const char *p = begin; end - p >= (ptrdiff_t)length; ++p) {
+    if (ascii_lower(*p) != first)
+      continue;
+
+    size_t i = 1;
+    while (i < length && ascii_lower(p[i]) == folded[i])
+      ++i;
+    if (i == length)
+      return p;
+  }
+  return end;
+}
+
+std::vector<size_t> LogIndexer::search(const char *data, size_t length, uint64_t offset, const std::string &text,
+                                       size_t max) const {
+  std::vector<size_t> records;
+  if (text.empty() || _offsets.empty())
+    return records;
+
+  std::string folded(text);
+  std::transform(folded.begin(), folded.end(), folded.begin(), ascii_lower);
+  const char *end = data + length;
+  const char *position = data;
+  while (position < end && records.size() < max) {
+    const char *hit = find_folded(position, end, folded);
+    if (hit == end)
+      break;
+
+    uint64_t hit_offset = offset + (hit - data);
+    if (hit_offset >= _line_start)
+      break;
+
+    // continue after the record with the hit, or at the first record if the hit came before it
+    uint64_t next;
+    auto record = std::upper_bound(_offsets.begin(), _offsets.end(), hit_offset);
+    if (record == _offsets.begin())
+      next = _offsets.front();
+    else {
+      records.push_back(record - _offsets.begin() - 1);
+      next = record_end(records.back());
+    }
+
+    if (next - offset >= length)
+      break;
+    position = data + (next - offset);
+  }
+  return records;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool LogIndexer::search_file(const std::string &path, const std::string &text, size_t first, size_t max,
+                             std::vector<size_t> &records) const {
+  records.clear();
+  if (text.empty() || first >= _offsets.size())
+    return true;
+
+  std::ifstream stream = base::openBinaryInputStream(path);
+  if (!stream.is_open())
+    return false;
+
+  std::vector<char> buffer(BlockSize);
+  uint64_t position = _offsets[first];
+  while (position < _line_start && records.size() < max) {
+    size_t length = (size_t)std::min<uint64_t>(buffer.size(), _line_start - position);
+    if (!stream.seekg(position) || !stream.read(buffer.data(), length))
+      return false;
+
+    // blocks overlap by the search text length, hits in the overlap may be found twice
+    for (size_t record : search(buffer.data(), length, position, text, max - records.size())) {
+      if (records.empty() || record > records.back())
+        records.push_back(record);
+    }
+    if (position + length >= _line_start)
+      break;
+
+    uint64_t next = position + length - std::min(length - 1, text.size() - 1);
+    if (!records.empty())
+      next = std::max(next, record_end(records.back()));
+    position = next;
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void LogIndexer::end_line() {
+  if (_skip_line)
+    _skip_line = false;
+  else {
+    if (!_line_head.empty() && _line_head.back() == '\r')
+      _line_head.pop_back();
+
+    time_t time = 0;
+    if (is_record_start(_line_head, time)) {
+      if (time > 0)
+        _last_time = (uint32_t)std::min<time_t>(time, UINT_MAX);
+      _offsets.push_back(_line_start);
+      _times.push_back(_last_time);
+    }
+  }
+
+  _line_head.clear();
+  _line_start = _size;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Checks a line against the record formats used by the log viewer and extracts the time stamp of the record, if any:
+ *   error log:   any non empty line, time stamps as "2019-01-31T12:00:00.123456Z", "2019-01-31 12:00:00" or
+ *                "190131 12:00:00"
+ *   general log: a time stamp or blanks followed by a thread id
+ *   slow log:    "# Time: " followed by a time stamp
+ */
+bool LogIndexer::is_record_start(const std::string &line, time_t &time) const {
+  time = 0;
+  switch (_format) {
+    case ErrorLog:
+      if (line.empty())
+        return false;
+      parse_time(line, 0, time);
+      return true;
+
+    case GeneralLog:
+      if (!line.empty() && (line[0] == ' ' || line[0] == '\t')) {
+        size_t pos = line.find_first_not_of(" \t");
+        return pos != std::string::npos && line[pos] >= '0' && line[pos] <= '9';
+      }
+      return parse_time(line, 0, time);
+
+    case SlowLog:
+      if (line.compare(0, 8, "# Time: ") != 0)
+        return false;
+      parse_time(line, 8, time);
+      return true;
+  }
+  return false;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Parses "YYYY-MM-DD[T ]HH:MM:SS[.ffffff][Z|+hh:mm]" or "YYMMDD HH:MM:SS" at start. Time stamps with a zone are UTC
+ * (or have an explicit offset), all others are in the local time of the server, which is assumed to be the local time
+ * here too.
+ */
+bool LogIndexer::parse_time(const std::string &line, size_t start, time_t &time) const {
+  size_t pos = start;
+  int year, month, day, hour, minute, second;
+
+  if (!read_number(line, pos, 2, 6, year))
+    return false;
+  if (pos - start == 6) {
+    day = year % 100;
+    month = year / 100 % 100;
+    year = year / 10000;
+  } else if (pos - start <= 4 && pos < line.size() && line[pos] == '-') {
+    ++pos;
+    if (!read_number(line, pos, 1, 2, month) || pos >= line.size() || line[pos++] != '-' ||
+        !read_number(line, pos, 2, 2, day))
+      return false;
+  } else
+    return false;
+
+  bool iso = pos < line.size() && line[pos] == 'T';
+  if (iso)
+    ++pos;
+  else {
+    size_t blanks = pos;
+    while (pos < line.size() && line[pos] == ' ' && pos - blanks < 2)
+      ++pos;
+    if (pos == blanks)
+      return false;
+  }
+
+  if (!read_number(line, pos, 1, 2, hour) || pos >= line.size() || line[pos++] != ':' ||
+      !read_number(line, pos, 2, 2, minute) || pos >= line.size() || line[pos++] != ':' ||
+      !read_number(line, pos, 2, 2, second))
+    return false;
+
+  if (year < 100)
+    year += 2000;
+  if (month < 1 || month > 12 || day < 1 || day > 31 || hour > 23 || minute > 59 || second > 60)
+    return false;
+
+  time_t seconds = days_from_civil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second;
+
+  if (iso) {
+    if (pos < line.size() && line[pos] == '.') {
+      int fraction;
+      ++pos;
+      read_number(line, pos, 0, 9, fraction);
+    }
+    if (pos < line.size() && line[pos] == 'Z') {
+      time = seconds;
+      return true;
+    }
+    if (pos < line.size() && (line[pos] == '+' || line[pos] == '-')) {
+      int sign = line[pos++] == '-' ? -1 : 1;
+      int offset_hours, offset_minutes = 0;
+      if (!read_number(line, pos, 2, 2, offset_hours))
+        return false;
+      if (pos < line.size() && line[pos] == ':')
+        ++pos;
+      read_number(line, pos, 0, 2, offset_minutes);
+      time = seconds - sign * (offset_hours * 3600 + offset_minutes * 60);
+      return true;
+    }
+  }
+
+  time = local_to_utc(seconds);
+  return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+time_t LogIndexer::local_to_utc(time_t local_seconds) const {
+  time_t hour = local_seconds / 3600;
+  if (hour != _offset_hour) {
+    // the offset at the local time taken as UTC, corrected once for times close to a DST change
+    time_t utc = local_seconds;
+    for (int i = 0; i < 2; ++i) {
+      struct tm tm;
+#ifdef _MSC_VER
+      if (localtime_s(&tm, &utc) != 0)
+        return local_seconds;
+#else
+      if (localtime_r(&utc, &tm) == nullptr)
+        return local_seconds;
+#endif
+      time_t local = days_from_civil(tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday) * 86400 + tm.tm_hour * 3600 +
+                     tm.tm_min * 60 + tm.tm_sec;
+      _utc_offset = local - utc;
+      utc = local_seconds - _utc_offset;
+    }
+    _offset_hour = hour;
+  }
+  return local_seconds - _utc_offset;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2020, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <vector>
+
+/**
+ * Index of the records in a MySQL server log file (error, general or slow query log): the byte offset and the time
+ * stamp of every record, found with a single pass over the file. Files that grow are indexed incrementally, only the
+ * new data is scanned. Pages of records can then be read directly from their offsets, a time can be located with a
+ * binary search and text searches only need to map hits back to records.
+ *
+ * The data comes either from a local file or, for remote files, is passed in block by block in file order. Indexing
+ * may start in the middle of a file (e.g. to only index the tail of a big remote log), the first partial line is
+ * skipped then. A record is only added once its first line is complete.
+ */
+class LogIndexer {
+public:
+  enum Format { ErrorLog, GeneralLog, SlowLog };
+
+  LogIndexer(Format format);
+
+  void reset(uint64_t start = 0);
+
+  // Scans the next bytes of the log, continuing where the previous call stopped.
+  void add_data(const char *data, size_t length);
+  // Indexes what was added to the file since the last call, starts over if the file got smaller (log rotation).
+  // Returns false if the file can't be read.
+  bool update_from_file(const std::string &path);
+
+  // Offset of the next byte to be scanned.
+  uint64_t size() const {
+    return _size;
+  }
+  size_t record_count() const {
+    return _offsets.size();
+  }
+
+  uint64_t record_start(size_t record) const;
+  // The last record ends with the last complete line.
+  uint64_t record_end(size_t record) const;
+  // Seconds since the epoch, 0 if neither the record nor one before it had a time stamp.
+  time_t record_time(size_t record) const;
+  // Index of the first record at or after the given time, record_count() if there is none.
+  size_t find_time(time_t time) const;
+
+  // A page starting at the first record (or ending before the end record), with at most max_records records and
+  // max_bytes bytes, but at least one record. Return the end or the first record of the page.
+  size_t page_end(size_t first, size_t max_records, uint64_t max_bytes) const;
+  size_t page_start(size_t end, size_t max_records, uint64_t max_bytes) const;
+
+  // Records containing the text (ignoring ASCII case) in a block of the file starting at offset, at most max ones.
+  std::vector<size_t> search(const char *data, size_t length, uint64_t offset, const std::string &text,
+                             size_t max) const;
+  // The same for a local file, starting at the given record. Returns false if the file can't be read.
+  bool search_file(const std::string &path, const std::string &text, size_t first, size_t max,
+                   std::vector<size_t> &records) const;
+
+private:
+  static const size_t LineHeadSize = 64; // enough to recognize the start of a record and parse its time stamp
+
+  Format _format;
+  std::vector<uint64_t> _offsets;
+  std::vector<uint32_t> _times; // seconds since the epoch, 32 bit to keep the index small
+
+  uint64_t _size;
+  uint64_t _line_start;
+  std::string _line_head; // the first bytes of the line being scanned
+  bool _skip_line;
+  uint32_t _last_time;
+
+  // local time offsets are looked up once per hour of wall time
+  mutable time_t _offset_hour;
+  mutable time_t _utc_offset;
+
+  void end_line();
+  bool is_record_start(const std::string &line, time_t &time) const;
+  bool parse_time(const std::string &line, size_t start, time_t &time) const;
+  time_t local_to_utc(time_t local_seconds) const;
+};
@@ -21,11 +21,18 @@
  * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
  */
 
+#include <algorithm>
+#include <map>
+#include <memory>
+
 #include "grtpp_module_cpp.h"
 
 #include "grts/structs.db.mgmt.h"
 #include "grt/spatial_handler.h"
 #include "base/log.h"
+#include "base/threading.h"
+
+#include "log_indexer.h"
 
 #define Utilities_VERSION "1.0.0"
 
@@ -33,7 +40,7 @@ DEFAULT_LOG_DOMAIN("utilities");
 
 class UtilitiesImpl : public grt::ModuleImplBase {
 public:
-  UtilitiesImpl(grt::CPPModuleLoader *loader) : grt::ModuleImplBase(loader) {
+  UtilitiesImpl(grt::CPPModuleLoader *loader) : grt::ModuleImplBase(loader), _log_index_id(0) {
   }
 
   DEFINE_INIT_MODULE(Utilities_VERSION, "Oracle and/or its affiliates", grt::ModuleImplBase,
@@ -44,6 +51,75 @@ public:
                      DECLARE_MODULE_FUNCTION_DOC(UtilitiesImpl::fetchAuthorityCodeFromFile,
                                                  "Load WKT SRS from file and extract EPSG code from it.",
                                                  "path the path to file that contains SRS WKT."),
+                     DECLARE_MODULE_FUNCTION_DOC(UtilitiesImpl::openLogIndex,
+                                                 "Creates an index of the records in a MySQL server log file. Fill it "
+                                                 "with updateLogIndex() for local files or feedLogIndex() for data "
+                                                 "read in some other way and release it with closeLogIndex().",
+                                                 "format the log format: 0 for the error log, 1 for the general "
+                                                 "query log and 2 for the slow query log"),
+                     DECLARE_MODULE_FUNCTION_DOC(UtilitiesImpl::closeLogIndex, "Releases a log index.",
+                                                 "index the log index id"),
+                     DECLARE_MODULE_FUNCTION_DOC(UtilitiesImpl::resetLogIndex,
+                                                 "Clears a log index, to feed it again from the given offset. A "
+                                                 "partial line at that offset is skipped.",
+                                                 "index the log index id\n"
+                                                 "start the file offset of the data that will be fed next"),
+                     DECLARE_MODULE_FUNCTION_DOC(UtilitiesImpl::updateLogIndex,
+                                                 "Indexes what was added to a local log file since the last update, "
+                                                 "or the whole file again if it got smaller. Returns the number of "
+                                                 "records.",
+                                                 "index the log index id\n"
+                                                 "path the path of the log file"),
+                     DECLARE_MODULE_FUNCTION_DOC(UtilitiesImpl::feedLogIndex,
+                                                 "Indexes the next block of a log file, which must continue where the "
+                                                 "previous one ended. Returns the number of records.",
+                                                 "index the log index id\n"
+                                                 "data the data to index"),
+                     DECLARE_MODULE_FUNCTION_DOC(UtilitiesImpl::logIndexSize,
+                                                 "Returns the file offset up to which the log was indexed.",
+                                                 "index the log index id"),
+                     DECLARE_MODULE_FUNCTION_DOC(UtilitiesImpl::logIndexRecordCount,
+                                                 "Returns the number of indexed records.", "index the log index id"),
+                     DECLARE_MODULE_FUNCTION_DOC(UtilitiesImpl::logIndexRecordRange,
+                                                 "Returns the start and end file offsets of a range of records.",
+                                                 "index the log index id\n"
+                                                 "first the first record\n"
+                                                 "end the record after the last one"),
+                     DECLARE_MODULE_FUNCTION_DOC(UtilitiesImpl::logIndexPage,
+                                                 "Returns the first and end record of a page of records starting at "
+                                                 "(or, going backwards, ending before) the given record. A page has "
+                                                 "at least one record.",
+                                                 "index the log index id\n"
+                                                 "record the first record of the page or the one after its last\n"
+                                                 "maxRecords the maximum number of records in the page\n"
+                                                 "maxBytes the maximum size of the page\n"
+                                                 "backwards 1 to get the page before record"),
+                     DECLARE_MODULE_FUNCTION_DOC(UtilitiesImpl::logIndexRecordTime,
+                                                 "Returns the time stamp of a record in seconds since the epoch, "
+                                                 "taken from the last record with one. 0 if there is none.",
+                                                 "index the log index id\n"
+                                                 "record the record"),
+                     DECLARE_MODULE_FUNCTION_DOC(UtilitiesImpl::logIndexFindTime,
+                                                 "Returns the first record at or after a time, or the number of "
+                                                 "records if there is none.",
+                                                 "index the log index id\n"
+                                                 "time seconds since the epoch"),
+                     DECLARE_MODULE_FUNCTION_DOC(UtilitiesImpl::searchLogIndexFile,
+                                                 "Searches an indexed local log file for records containing a text, "
+                                                 "ignoring case. Returns the records found.",
+                                                 "index the log index id\n"
+                                                 "path the path of the log file\n"
+                                                 "text the text to find\n"
+                                                 "first the record to start at\n"
+                                                 "max the maximum number of records to return"),
+                     DECLARE_MODULE_FUNCTION_DOC(UtilitiesImpl::searchLogIndexData,
+                                                 "Searches a block of an indexed log file for records containing a "
+                                                 "text, ignoring case. Returns the records found.",
+                                                 "index the log index id\n"
+                                                 "data the block of the log file\n"
+                                                 "offset the file offset of the block\n"
+                                                 "text the text to find\n"
+                                                 "max the maximum number of records to return"),
                      NULL);
 
   db_mgmt_RdbmsRef loadRdbmsInfo(db_mgmt_ManagementRef owner, const std::string &path) {
@@ -69,6 +145,119 @@ public:
       logError("Unable to get contents of a file: %s\n", path.c_str());
     return epsg;
   }
+
+  int openLogIndex(int format) {
+    if (format < LogIndexer::ErrorLog || format > LogIndexer::SlowLog)
+      throw std::invalid_argument("Invalid log format");
+
+    base::MutexLock lock(_log_index_mutex);
+    _log_indexes[++_log_index_id] = std::make_shared<LogIndexer>((LogIndexer::Format)format);
+    return _log_index_id;
+  }
+
+  int closeLogIndex(int index) {
+    base::MutexLock lock(_log_index_mutex);
+    if (_log_indexes.erase(index) == 0)
+      throw std::invalid_argument("Invalid log index");
+    return 1;
+  }
+
+  int resetLogIndex(int index, double start) {
+    get_log_index(index)->reset(start > 0 ? (uint64_t)start : 0);
+    return 1;
+  }
+
+  int updateLogIndex(int index, const std::string &path) {
+    std::shared_ptr<LogIndexer> indexer = get_log_index(index);
+    if (!indexer->update_from_file(path)) {
+      logError("Unable to index log file: %s\n", path.c_str());
+      throw std::runtime_error("Could not read log file " + path);
+    }
+    return (int)indexer->record_count();
+  }
+
+  int feedLogIndex(int index, const std::string &data) {
+    std::shared_ptr<LogIndexer> indexer = get_log_index(index);
+    indexer->add_data(data.data(), data.size());
+    return (int)indexer->record_count();
+  }
+
+  grt::IntegerRef logIndexSize(int index) {
+    return grt::IntegerRef((ssize_t)get_log_index(index)->size());
+  }
+
+  int logIndexRecordCount(int index) {
+    return (int)get_log_index(index)->record_count();
+  }
+
+  grt::IntegerListRef logIndexRecordRange(int index, int first, int end) {
+    std::shared_ptr<LogIndexer> indexer = get_log_index(index);
+    grt::IntegerListRef range(grt::Initialized);
+    range.insert(grt::IntegerRef((ssize_t)indexer->record_start(std::max(first, 0))));
+    range.insert(grt::IntegerRef((ssize_t)(end > first ? indexer->record_end(end - 1) : indexer->record_start(first))));
+    return range;
+  }
+
+  grt::IntegerListRef logIndexPage(int index, int record, int maxRecords, double maxBytes, int backwards) {
+    std::shared_ptr<LogIndexer> indexer = get_log_index(index);
+    size_t max_records = (size_t)std::max(maxRecords, 1);
+    uint64_t max_bytes = maxBytes > 0 ? (uint64_t)maxBytes : 0;
+    size_t first, end;
+    if (backwards) {
+      end = std::min((size_t)std::max(record, 0), indexer->record_count());
+      first = indexer->page_start(end, max_records, max_bytes);
+    } else {
+      first = std::min((size_t)std::max(record, 0), indexer->record_count());
+      end = indexer->page_end(first, max_records, max_bytes);
+    }
+
+    grt::IntegerListRef page(grt::Initialized);
+    page.insert(grt::IntegerRef((ssize_t)first));
+    page.insert(grt::IntegerRef((ssize_t)end));
+    return page;
+  }
+
+  double logIndexRecordTime(int index, int record) {
+    return (double)get_log_index(index)->record_time((size_t)std::max(record, 0));
+  }
+
+  int logIndexFindTime(int index, double time) {
+    return (int)get_log_index(index)->find_time((time_t)time);
+  }
+
+  grt::IntegerListRef searchLogIndexFile(int index, const std::string &path, const std::string &text, int first,
+                                         int max) {
+    std::vector<size_t> records;
+    if (!get_log_index(index)->search_file(path, text, (size_t)std::max(first, 0), (size_t)std::max(max, 0), records))
+      throw std::runtime_error("Could not read log file " + path);
+    return record_list(records);
+  }
+
+  grt::IntegerListRef searchLogIndexData(int index, const std::string &data, double offset, const std::string &text,
+                                         int max) {
+    return record_list(get_log_index(index)->search(data.data(), data.size(), offset > 0 ? (uint64_t)offset : 0, text,
+                                                    (size_t)std::max(max, 0)));
+  }
+
+private:
+  base::Mutex _log_index_mutex;
+  std::map<int, std::shared_ptr<LogIndexer> > _log_indexes;
+  int _log_index_id;
+
+  std::shared_ptr<LogIndexer> get_log_index(int index) {
+    base::MutexLock lock(_log_index_mutex);
+    auto iterator = _log_indexes.find(index);
+    if (iterator == _log_indexes.end())
+      throw std::invalid_argument("Invalid log index");
+    return iterator->second;
+  }
+
+  static grt::IntegerListRef record_list(const std::vector<size_t> &records) {
+    grt::IntegerListRef list(grt::Initialized);
+    for (size_t record : records)
+      list.insert(grt::IntegerRef((ssize_t)record));
+    return list;
+  }
 };
 
 GRT_MODULE_ENTRY_POINT(UtilitiesImpl);
@@ -71,6 +71,14 @@ DBSearchFilterPanel::DBSearchFilterPanel()
   _limits_box.add(&_limit_total, false, true);
   _limit_total.signal_changed()->connect(std::bind(update_numeric, std::ref(_limit_total)));
   _limit_total.set_value("100000");
+  _connections_hint.set_text("Connections");
+  _connections_hint.set_text_align(mforms::MiddleRight);
+  _connections.set_size(40, -1);
+  _connections.set_tooltip("Number of server connections used to search tables in parallel.");
+  _limits_box.add(&_connections_hint, false, true);
+  _limits_box.add(&_connections, false, true);
+  _connections.signal_changed()->connect(std::bind(update_numeric, std::ref(_connections)));
+  _connections.set_value("4");
 
   _search_all_type_check.set_text("Search columns of all types");
   _search_all_type_check.set_tooltip(
@@ -114,6 +122,7 @@ void DBSearchFilterPanel::set_searching(bool flag) {
   _filter_selector.set_enabled(!flag);
   _limit_table.set_enabled(!flag);
   _limit_total.set_enabled(!flag);
+  _connections.set_enabled(!flag);
 
   if (flag)
     _search_button.set_text("Stop");
@@ -23,6 +23,10 @@
 
 #ifndef _DB_SEARCH_FILTER_PANEL_H_
 #define _DB_SEARCH_FILTER_PANEL_H_
+
+#include <algorithm>
+#include <cstdlib>
+
 #include "mforms/mforms.h"
 
 class DBSearchFilterPanel : public mforms::Box {
@@ -40,6 +44,8 @@ private:
   mforms::TextEntry _limit_table;
   mforms::Label _limit_total_hint;
   mforms::TextEntry _limit_total;
+  mforms::Label _connections_hint;
+  mforms::TextEntry _connections;
   mforms::Button _search_button;
 
 public:
@@ -62,6 +68,23 @@ public:
     _limit_total.set_value(i);
   }
 
+  // The number of connections for the search pool, the default if the entry is not a number.
+  int get_connection_count() {
+    static const int DefaultConnectionCount = 4;
+    static const int MaxConnectionCount = 32;
+
+    std::string value = _connections.get_string_value();
+    char *end = nullptr;
+    long count = strtol(value.c_str(), &end, 10);
+    if (value.empty() || end == value.c_str() || *end != '\0')
+      return DefaultConnectionCount;
+    return (int)std::min(std::max(count, 1L), (long)MaxConnectionCount);
+  }
+
+  void set_connection_count(const std::string &i) {
+    _connections.set_value(i);
+  }
+
   bool search_all_types() {
     return _search_all_type_check.get_active();
   }
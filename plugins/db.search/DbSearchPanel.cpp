@@ -23,6 +23,12 @@
 
 #include "DbSearchPanel.h"
 #include <sstream>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
 #include "grtui/grt_wizard_form.h"
 #include "grtui/connection_page.h"
 #include "grt/grt_string_list_model.h"
@@ -84,8 +90,22 @@ public:
     column_data_t data;
   };
 
+  // Everything needed to search a single table, collected up front from information_schema.
+  struct TableTask {
+    std::string schema;
+    std::string table;
+    std::list<std::string> pk_columns;
+    std::list<std::string> select_columns;
+    bool match_PK;
+    double data_length;
+
+    TableTask() : match_PK(false), data_length(0) {
+    }
+  };
+
 private:
   sql::ConnectionWrapper _db_conn;
+  std::vector<sql::ConnectionWrapper> _extra_connections;
   grt::StringListRef _filter_list;
   std::string _search_keyword;
   std::string _state;
@@ -94,43 +114,47 @@ private:
   int _limit_total;
   int _limt_per_table;
   int _limit_counter;
+  int _table_timeout;
   std::vector<SearchResultEntry> _search_result;
   volatile bool _working;
   volatile bool _stop;
   volatile bool _starting;
   volatile bool _paused;
   bool _invert;
-  int _searched_tables;
-  int _matched_rows;
+  std::atomic<int> _searched_tables;
+  std::atomic<int> _matched_rows;
   std::string _cast_to;
   int _search_data_type;
   base::Mutex _search_result_mutex;
   base::Mutex _pause_mutex;
 
+  // Scheduling state shared by the search workers. _limit_counter is the part of the total
+  // LIMIT budget which is not yet reserved by a running table query.
+  std::deque<TableTask> _tasks;
+  size_t _table_count;
+  int _in_flight;
+  std::exception_ptr _error;
+  std::mutex _schedule_mutex;
+  std::condition_variable _schedule_cond;
+
 protected:
-  typedef std::function<void(const std::string&, const std::string&, const std::list<std::string>&,
-                             const std::list<std::string>&, const std::string&, const bool match_PK)>
-    select_func_t;
+  typedef std::function<size_t(sql::Connection*, const TableTask&, const std::string&)> select_func_t;
   void run(select_func_t select_func);
-  void select_data(const std::string& schema_name, const std::string& table_name,
-                   const std::list<std::string>& pk_columns, const std::list<std::string>& select_columns,
-                   const std::string& limit_clause, const bool match_PK);
-  void count_data(const std::string& schema_name, const std::string& table_name,
-                  const std::list<std::string>& pk_columns, const std::list<std::string>& select_columns,
-                  const std::string& limit_clause, const bool match_PK);
+  void fetch_tasks(std::vector<TableTask>& tasks);
+  bool next_task(TableTask& task, int& limit);
+  void finish_task(int limit, size_t rows);
+  void search_worker(sql::ConnectionWrapper conn, select_func_t select_func);
+  void set_state(const std::string& state);
+  size_t select_data(sql::Connection* conn, const TableTask& task, const std::string& limit_clause);
+  size_t count_data(sql::Connection* conn, const TableTask& task, const std::string& limit_clause);
 
 public:
-  /*
-      DBSearch():_working(false), _stop(false)
-      {
-          _pause_mutex = g_mutex_new();
-          _search_result_mutex = g_mutex_new();
-      };
-    */
-  DBSearch(sql::ConnectionWrapper connection, const std::string& search_keyword, const grt::StringListRef& filter_list,
-           const SearchMode search_mode, const int limit_total, const int limt_per_table, const bool invert,
-           const int search_data_type, const std::string cast_to)
+  DBSearch(sql::ConnectionWrapper connection, const std::vector<sql::ConnectionWrapper>& extra_connections,
+           const std::string& search_keyword, const grt::StringListRef& filter_list, const SearchMode search_mode,
+           const int limit_total, const int limt_per_table, const bool invert, const int search_data_type,
+           const std::string cast_to, const int table_timeout)
     : _db_conn(connection),
+      _extra_connections(extra_connections),
       _filter_list(filter_list),
       _search_keyword(search_keyword),
       _state("Starting"),
@@ -139,6 +163,7 @@ public:
       _limit_total(limit_total),
       _limt_per_table(limt_per_table),
       _limit_counter(0),
+      _table_timeout(table_timeout),
       _working(false),
       _stop(false),
       _starting(false),
@@ -147,7 +172,9 @@ public:
       _searched_tables(0),
       _matched_rows(0),
       _cast_to(cast_to),
-      _search_data_type(search_data_type) {
+      _search_data_type(search_data_type),
+      _table_count(0),
+      _in_flight(0) {
   }
 
   ~DBSearch() {
@@ -182,6 +209,7 @@ public:
   float get_progress() const {
     return _progress;
   }
+  // Must be called with the search result mutex locked, as the workers update the state concurrently.
   std::string get_state() const {
     return _state;
   }
@@ -217,10 +245,19 @@ void DBSearch::stop() {
     toggle_pause();
   if (!_working)
     return;
-  _stop = true;
+  {
+    std::lock_guard<std::mutex> lock(_schedule_mutex);
+    _stop = true;
+  }
+  _schedule_cond.notify_all();
   while (_working)
     ;
-  _state = "Cancelled";
+  set_state("Cancelled");
+}
+
+void DBSearch::set_state(const std::string& state) {
+  base::MutexLock lock(_search_result_mutex);
+  _state = state;
 }
 
 std::string DBSearch::build_where(const std::string& col, const std::string& data) const {
@@ -302,53 +339,47 @@ std::string DBSearch::build_select_query(const std::string& schema, const std::s
   return result;
 }
 
-void DBSearch::count_data(const std::string& schema_name, const std::string& table_name,
-                          const std::list<std::string>& pk_columns, const std::list<std::string>& select_columns,
-                          const std::string& limit_clause, const bool match_PK) {
-  std::string query = build_count_query(schema_name, table_name, select_columns, limit_clause, match_PK);
+size_t DBSearch::count_data(sql::Connection* conn, const TableTask& task, const std::string& limit_clause) {
+  std::string query = build_count_query(task.schema, task.table, task.select_columns, limit_clause, task.match_PK);
   if (query.empty())
-    return;
+    return 0;
 
-  std::unique_ptr<sql::Statement> stmt(_db_conn->createStatement());
+  std::unique_ptr<sql::Statement> stmt(conn->createStatement());
   std::unique_ptr<sql::ResultSet> rs(stmt->executeQuery(query));
-  if (_limit_counter > 0)
-    _limit_counter -= (int)rs->rowsCount();
   SearchResultEntry result;
-  result.schema = schema_name;
-  result.table = table_name;
-  result.keys = pk_columns;
+  result.schema = task.schema;
+  result.table = task.table;
+  result.keys = task.pk_columns;
   result.query = query;
   while (rs->next()) {
     std::vector<std::pair<std::string, std::string> > data;
-    data.reserve(select_columns.size());
+    data.reserve(task.select_columns.size());
     data.push_back(std::pair<std::string, std::string>("COUNT", rs->getString(1)));
     _matched_rows += rs->getInt(1);
     result.data.push_back(data);
   }
   base::MutexLock lock(_search_result_mutex);
   _search_result.push_back(result);
+  return rs->rowsCount();
 };
 
-void DBSearch::select_data(const std::string& schema_name, const std::string& table_name,
-                           const std::list<std::string>& pk_columns, const std::list<std::string>& select_columns,
-                           const std::string& limit_clause, const bool match_PK) {
-  std::string query = build_select_query(schema_name, table_name, select_columns, limit_clause, match_PK);
+size_t DBSearch::select_data(sql::Connection* conn, const TableTask& task, const std::string& limit_clause) {
+  std::string query = build_select_query(task.schema, task.table, task.select_columns, limit_clause, task.match_PK);
   if (query.empty())
-    return;
-  std::unique_ptr<sql::Statement> stmt(_db_conn->createStatement());
+    return 0;
+  std::unique_ptr<sql::Statement> stmt(conn->createStatement());
   std::unique_ptr<sql::ResultSet> rs(stmt->executeQuery(query));
-  if (_limit_counter > 0)
-    _limit_counter -= (int)rs->rowsCount();
   SearchResultEntry result;
-  result.schema = schema_name;
-  result.table = table_name;
+  result.schema = task.schema;
+  result.table = task.table;
   result.query = query;
-  result.keys = pk_columns;
+  result.keys = task.pk_columns;
   while (rs->next()) {
     size_t col_idx = 1;
     std::vector<std::pair<std::string, std::string> > data;
-    data.reserve(select_columns.size());
-    for (std::list<std::string>::const_iterator It = select_columns.begin(); It != select_columns.end(); ++It)
+    data.reserve(task.select_columns.size());
+    for (std::list<std::string>::const_iterator It = task.select_columns.begin(); It != task.select_columns.end();
+         ++It)
       data.push_back(std::pair<std::string, std::string>(*It, rs->getString((int)col_idx++)));
     if (!data.empty())
       result.data.push_back(data);
@@ -358,18 +389,223 @@ void DBSearch::select_data(const std::string& schema_name, const std::string& ta
     base::MutexLock lock(_search_result_mutex);
     _search_result.push_back(result);
   }
+  return result.data.size();
 };
 
 void DBSearch::search() {
-  run(std::bind(&DBSearch::select_data, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3,
-                std::placeholders::_4, std::placeholders::_5, std::placeholders::_6));
+  run(std::bind(&DBSearch::select_data, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
 };
 
 void DBSearch::count() {
-  run(std::bind(&DBSearch::count_data, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3,
-                std::placeholders::_4, std::placeholders::_5, std::placeholders::_6));
+  run(std::bind(&DBSearch::count_data, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
 };
 
+//--------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Resolves the schema.table.column filters into the list of tables to search, together with the columns to
+ * select from each of them. All column and key metadata is read in a single information_schema query instead
+ * of issuing SHOW COLUMNS per table.
+ */
+void DBSearch::fetch_tasks(std::vector<TableTask>& tasks) {
+  std::string table_filter;
+  std::string column_filter;
+  for (size_t count = _filter_list.count(), i = 0; i < count; i++) {
+    std::string schema_pattern = _filter_list.get(i);
+    size_t dotpos = schema_pattern.find('.');
+    std::string table_pattern;
+    if (dotpos != std::string::npos)
+      table_pattern = schema_pattern.substr(dotpos + 1);
+    schema_pattern = schema_pattern.substr(0, dotpos);
+
+    dotpos = table_pattern.find('.');
+    std::string column_pattern;
+    if (dotpos != std::string::npos)
+      column_pattern = table_pattern.substr(dotpos + 1);
+    else
+      column_pattern = "%";
+    table_pattern = table_pattern.substr(0, dotpos);
+    if (table_pattern.empty())
+      table_pattern = "%";
+
+    std::string condition;
+    if (schema_pattern.empty() || schema_pattern.find('%') != std::string::npos)
+      condition = std::string(base::sqlstring("c.TABLE_NAME LIKE ?", 0) << table_pattern);
+    else
+      condition = std::string(base::sqlstring("c.TABLE_SCHEMA = ? AND c.TABLE_NAME LIKE ?", 0) << schema_pattern
+                                                                                            << table_pattern);
+
+    // Wildcard table patterns only pick up base tables, explicitly selected views are searched too.
+    if (table_pattern == "%")
+      condition.append(" AND t.TABLE_TYPE = 'BASE TABLE'");
+
+    if (!table_filter.empty()) {
+      table_filter.append(" OR ");
+      column_filter.append(" OR ");
+    }
+    table_filter.append("(").append(condition).append(")");
+    column_filter.append("(").append(condition);
+    column_filter.append(std::string(base::sqlstring(" AND c.COLUMN_NAME LIKE ?)", 0) << column_pattern));
+  }
+
+  if (table_filter.empty())
+    return;
+
+  std::string query =
+    "SELECT c.TABLE_SCHEMA, c.TABLE_NAME, c.COLUMN_NAME, c.COLUMN_TYPE, c.COLUMN_KEY, IFNULL(t.DATA_LENGTH, 0), (" +
+    column_filter +
+    ") AS column_matched "
+    "FROM information_schema.COLUMNS c JOIN information_schema.TABLES t "
+    "ON t.TABLE_SCHEMA = c.TABLE_SCHEMA AND t.TABLE_NAME = c.TABLE_NAME WHERE " +
+    table_filter + " ORDER BY c.TABLE_SCHEMA, c.TABLE_NAME, c.ORDINAL_POSITION";
+
+  std::unique_ptr<sql::Statement> stmt(_db_conn->createStatement());
+  std::unique_ptr<sql::ResultSet> rs(stmt->executeQuery(query));
+
+  // Key columns which did not match any column pattern. Used to identify rows if no matching column is a key.
+  std::list<std::string> other_pk_columns;
+  TableTask task;
+  auto flush_task = [&]() {
+    if (task.table.empty())
+      return;
+    if (task.pk_columns.empty() && !task.select_columns.empty()) {
+      for (std::list<std::string>::const_iterator It = other_pk_columns.begin(); It != other_pk_columns.end(); ++It) {
+        task.select_columns.push_front(*It);
+        task.pk_columns.push_back(*It);
+      }
+      // set PK col to be the first, or push empty string to indicate that there is no PK at all
+      if (task.pk_columns.empty())
+        task.select_columns.push_front("");
+    }
+    if (!task.select_columns.empty())
+      tasks.push_back(task);
+    task = TableTask();
+    other_pk_columns.clear();
+  };
+
+  while (rs->next()) {
+    if (_stop)
+      return;
+
+    std::string schema_name = rs->getString(1);
+    std::string table_name = rs->getString(2);
+    if (schema_name != task.schema || table_name != task.table) {
+      flush_task();
+      task.schema = schema_name;
+      task.table = table_name;
+      task.data_length = rs->getDouble(6);
+    }
+
+    std::string column = rs->getString(3);
+    std::string column_type = rs->getString(4);
+    bool is_pk = rs->getString(5) == "PRI";
+    if (rs->getInt(7) == 0) {
+      if (is_pk)
+        other_pk_columns.push_back(column);
+      continue;
+    }
+
+    if ((_search_data_type == search_all_types) ||
+        ((_search_data_type & numeric_type) && is_numeric_type(column_type)) ||
+        ((_search_data_type & datetime_type) && is_datetime_type(column_type)) ||
+        ((_search_data_type & text_type) && is_string_type(column_type))) {
+      if (is_pk) {
+        task.select_columns.push_front(column);
+        task.pk_columns.push_back(column);
+        task.match_PK = true; // PK should be searched, not just displayed
+      }
+      task.select_columns.push_back(column);
+    } else if (is_pk) {
+      task.select_columns.push_front(column);
+      task.pk_columns.push_back(column);
+    }
+  }
+  flush_task();
+}
+
+//--------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Hands out the next table to a worker and reserves its share of the total row limit. If the budget is used up
+ * while other tables are still being searched, the caller waits until these return their unused reservation.
+ */
+bool DBSearch::next_task(TableTask& task, int& limit) {
+  std::unique_lock<std::mutex> lock(_schedule_mutex);
+  while (!_stop && !_tasks.empty() && _limit_counter == 0 && _in_flight > 0)
+    _schedule_cond.wait(lock);
+
+  if (_stop || _tasks.empty() || _limit_counter == 0)
+    return false;
+
+  task = _tasks.front();
+  _tasks.pop_front();
+
+  limit = _limt_per_table;
+  if (_limit_counter > 0) {
+    if (limit == 0 || _limit_counter < limit)
+      limit = _limit_counter;
+    _limit_counter -= limit;
+  }
+  ++_in_flight;
+  return true;
+}
+
+void DBSearch::finish_task(int limit, size_t rows) {
+  {
+    std::lock_guard<std::mutex> lock(_schedule_mutex);
+    if (_limit_total > 0 && (size_t)limit > rows)
+      _limit_counter += limit - (int)rows;
+    --_in_flight;
+    _progress = (++_searched_tables * 1.f) / _table_count;
+  }
+  _schedule_cond.notify_all();
+}
+
+void DBSearch::search_worker(sql::ConnectionWrapper conn, select_func_t select_func) {
+  try {
+    if (_table_timeout > 0) {
+      try {
+        std::unique_ptr<sql::Statement> stmt(conn->createStatement());
+        stmt->execute(base::strfmt("SET SESSION max_execution_time = %i", _table_timeout * 1000));
+      } catch (std::exception& exc) {
+        logInfo("Per table search timeout not supported by server: %s\n", exc.what());
+      }
+    }
+
+    TableTask task;
+    int limit = 0;
+    for (;;) {
+      wait_if_paused();
+      if (!next_task(task, limit))
+        break;
+
+      set_state(std::string("SELECT data from ") + task.schema + "." + task.table);
+      std::string limit_clause;
+      if (limit > 0)
+        limit_clause = base::strfmt("LIMIT %i", limit);
+
+      size_t rows = 0;
+      try {
+        rows = select_func(conn.get(), task, limit_clause);
+      } catch (sql::SQLException& exc) {
+        // ER_QUERY_TIMEOUT, the table took longer than allowed. Skip it and go on with the others.
+        if (exc.getErrorCode() != 3024) {
+          finish_task(limit, 0);
+          throw;
+        }
+        logWarning("Search in %s.%s timed out\n", task.schema.c_str(), task.table.c_str());
+      }
+      finish_task(limit, rows);
+    }
+  } catch (...) {
+    std::lock_guard<std::mutex> lock(_schedule_mutex);
+    if (!_error)
+      _error = std::current_exception();
+    _stop = true;
+    _schedule_cond.notify_all();
+  }
+}
+
 void DBSearch::run(select_func_t select_func) {
   struct working_state_guard {
     volatile bool& _state;
@@ -385,181 +621,45 @@ void DBSearch::run(select_func_t select_func) {
   _starting = false;
   _working = true;
   _stop = false;
+  _error = nullptr;
   _limit_counter = _limit_total ? _limit_total : -1;
-  _state = "Fetch schema list";
+  _in_flight = 0;
   _searched_tables = 0;
   _matched_rows = 0;
-  std::map<std::string, std::vector<std::string> > schemas;
-  std::map<std::string, std::vector<std::string> > schemas_tables;
-  {
-    std::unique_ptr<sql::Statement> stmt(_db_conn->createStatement());
-    for (size_t count = _filter_list.count(), i = 0; i < count; i++) {
-      wait_if_paused();
-      if (_stop) {
-        _working = false;
-        return;
-      }
-      std::string schema_pattern = _filter_list.get(i);
-      size_t dotpos = schema_pattern.find('.');
-      std::string table_column;
-      if (dotpos != std::string::npos)
-        table_column = schema_pattern.substr(dotpos + 1);
-      schema_pattern = schema_pattern.substr(0, dotpos);
-      if (schema_pattern.empty() || schema_pattern.find('%') != std::string::npos) {
-        schema_pattern = "%";
-        std::unique_ptr<sql::ResultSet> rs(
-          stmt->executeQuery(std::string(base::sqlstring("SHOW DATABASES LIKE ?", 0) << schema_pattern)));
-        while (rs->next()) {
-          std::string schema = rs->getString(1);
-          schemas[schema].push_back(table_column);
-        }
-      } else
-        schemas[schema_pattern].push_back(table_column);
-    }
-  }
-  {
-    std::unique_ptr<sql::Statement> stmt(_db_conn->createStatement());
-    for (std::map<std::string, std::vector<std::string> >::const_iterator It = schemas.begin(); It != schemas.end();
-         ++It) {
-      std::string schema_name = It->first;
-      _state = std::string("Populate tables in ") + schema_name;
-      std::vector<std::string> tables = It->second;
-      for (std::vector<std::string>::const_iterator It_tables = tables.begin(); It_tables != tables.end();
-           ++It_tables) {
-        wait_if_paused();
-        if (_stop) {
-          _working = false;
-          return;
-        }
-        std::string table_pattern = *It_tables;
-        size_t dotpos = table_pattern.find('.');
-        std::string column_pattern;
-        if (dotpos != std::string::npos)
-          column_pattern = table_pattern.substr(dotpos + 1);
-        else
-          column_pattern = '%';
-        table_pattern = table_pattern.substr(0, dotpos);
-        if (table_pattern.empty())
-          table_pattern = "%";
-
-        std::string query;
-        if (table_pattern == "%") {
-          query.append(base::sqlstring("SHOW FULL TABLES FROM ! WHERE Table_type = 'BASE TABLE'", 0) << schema_name);
-        } else {
-          query.append(base::sqlstring("SHOW TABLES FROM ! LIKE ?", 0) << schema_name << table_pattern);
-        }
-        std::unique_ptr<sql::ResultSet> rs(stmt->executeQuery(query));
-        while (rs->next()) {
-          std::string table = rs->getString(1);
-          schemas_tables[schema_name + '.' + table].push_back(column_pattern);
-        }
-      }
-    }
-  }
-  int cntr = 0;
-  for (std::map<std::string, std::vector<std::string> >::const_iterator It = schemas_tables.begin();
-       It != schemas_tables.end(); ++It) {
-    // Pick columns
-    std::string table_name = It->first;
-    size_t dotpos = table_name.find('.');
-    std::string schema_name = table_name.substr(0, dotpos);
-    _state = std::string("SELECT data from ") + schema_name + "." + table_name;
-    table_name = table_name.substr(++dotpos);
-    std::vector<std::string> columns = It->second;
-    std::string like_clause;
-    static const std::string like_pattern = "Field LIKE ? OR ";
-    for (std::vector<std::string>::const_iterator It_cols = columns.begin(); It_cols != columns.end(); ++It_cols)
-      like_clause.append(std::string(base::sqlstring(like_pattern.c_str(), base::UseAnsiQuotes) << *It_cols));
-    like_clause.append("FALSE");
-
-    wait_if_paused();
-    if (_stop) {
-      _working = false;
-      return;
-    }
-
-    std::list<std::string> pk_columns;
-    bool match_PK = false;
-    std::list<std::string> select_columns;
-    try {
-      std::unique_ptr<sql::Statement> stmt(_db_conn->createStatement());
-      std::unique_ptr<sql::ResultSet> rs(
-        stmt->executeQuery(std::string(base::sqlstring("SHOW COLUMNS FROM !.! WHERE ", base::QuoteOnlyIfNeeded)
-                                       << schema_name << table_name)
-                             .append(like_clause)));
-      while (rs->next()) {
-        std::string column = rs->getString(1);
-        std::string column_type = rs->getString(2);
-        if ((_search_data_type == search_all_types) ||
-            ((_search_data_type & numeric_type) && is_numeric_type(column_type)) ||
-            ((_search_data_type & datetime_type) && is_datetime_type(column_type)) ||
-            ((_search_data_type & text_type) && is_string_type(column_type))) {
-          if (rs->getString(4) == "PRI") {
-            select_columns.push_front(column);
-            pk_columns.push_back(column);
-            match_PK = true; // PK should be searched, not just displayed
-          }
-          select_columns.push_back(column);
-        } else {
-          if (rs->getString(4) == "PRI") {
-            select_columns.push_front(column);
-            pk_columns.push_back(column);
-          }
-        }
-      }
-    } catch (std::exception& exc) {
-      logWarning("Could not get columns list from %s.%s: %s\n", schema_name.c_str(), table_name.c_str(), exc.what());
-    }
-    // Add PK col if there is at least one column matching pattern and it it wasn't added during col patterns search
-    if (pk_columns.empty() && !select_columns.empty()) {
-      try {
-        std::unique_ptr<sql::Statement> stmt(_db_conn->createStatement());
-        std::unique_ptr<sql::ResultSet> rs(stmt->executeQuery(
-          std::string(base::sqlstring("SHOW COLUMNS FROM !.! WHERE `Key` = 'PRI'", base::QuoteOnlyIfNeeded)
-                      << schema_name << table_name)));
-        while (rs->next()) {
-          select_columns.push_back(rs->getString(1));
-          pk_columns.push_back(rs->getString(1));
-        }
-        // set PK col to be the first, or push empty string to indicate that there is no PK at all
-        if (pk_columns.empty())
-          select_columns.push_front("");
-      } catch (std::exception& exc) {
-        logWarning("Could not get columns list from %s.%s: %s\n", schema_name.c_str(), table_name.c_str(), exc.what());
-      }
-    }
+  set_state("Fetch column list");
 
-    { // Build select from columns fetched on previous step and use it to collect data
-      wait_if_paused();
-      if (_stop) {
-        _working = false;
-        return;
-      }
-      ++cntr;
-      std::string limit_clause("");
-      if (_limit_counter > 0) {
-        size_t limit = std::min(_limit_counter, _limt_per_table);
-        std::stringstream sout;
-        sout << "LIMIT " << limit;
-        limit_clause = sout.str();
-      } else if (_limt_per_table) {
-        std::stringstream sout;
-        sout << "LIMIT " << _limt_per_table;
-        limit_clause = sout.str();
-      }
+  std::vector<TableTask> tasks;
+  fetch_tasks(tasks);
+  if (_stop) {
+    _working = false;
+    return;
+  }
 
-      _progress = (cntr * 1.f) / (schemas_tables.size());
-      select_func(schema_name, table_name, pk_columns, select_columns, limit_clause, match_PK);
-      _searched_tables++;
+  // Search big tables last, so the small ones produce results quickly and none of the workers
+  // ends up alone with a huge table which it started late.
+  std::stable_sort(tasks.begin(), tasks.end(),
+                   [](const TableTask& a, const TableTask& b) { return a.data_length < b.data_length; });
+  _tasks.assign(tasks.begin(), tasks.end());
+  _table_count = _tasks.size();
+
+  // The main connection is used by the first worker, the others get one of the extra connections the caller
+  // opened for us.
+  size_t worker_count = std::min(_extra_connections.size() + 1, _table_count);
+  std::vector<std::thread> workers;
+  for (size_t i = 1; i < worker_count; ++i)
+    workers.push_back(std::thread(&DBSearch::search_worker, this, _extra_connections[i - 1], select_func));
+  if (worker_count > 0)
+    search_worker(_db_conn, select_func);
+  for (std::vector<std::thread>::iterator It = workers.begin(); It != workers.end(); ++It)
+    It->join();
+
+  if (_error)
+    std::rethrow_exception(_error);
 
-      if ((_limit_total > 0) && (_limit_counter <= 0))
-        break;
-    }
-  }
   if (_searched_tables == 0)
-    _state = "No tables were searched";
+    set_state("No tables were searched");
   else
-    _state = base::strfmt("Search completed in %i tables", _searched_tables);
+    set_state(base::strfmt("Search completed in %i tables", (int)_searched_tables));
   _progress = 1;
   _working = false;
 }
@@ -802,10 +902,13 @@ void DBSearchPanel::load_model(mforms::TreeNodeRef tnode) {
   }
 };
 
-void DBSearchPanel::search(sql::ConnectionWrapper connection, const std::string& search_keyword,
-                           const grt::StringListRef& filter_list, const SearchMode search_mode, const int limit_total,
-                           const int limt_per_table, const bool invert, const int search_data_type,
-                           const std::string cast_to, std::function<void(grt::ValueRef)> finished_callback,
+void DBSearchPanel::search(sql::ConnectionWrapper connection,
+                           const std::vector<sql::ConnectionWrapper>& extra_connections,
+                           const std::string& search_keyword, const grt::StringListRef& filter_list,
+                           const SearchMode search_mode, const int limit_total, const int limt_per_table,
+                           const bool invert, const int search_data_type, const std::string cast_to,
+                           const int table_timeout,
+                           std::function<void(grt::ValueRef)> finished_callback,
                            std::function<void()> failed_callback) {
   if (_searcher)
     return;
@@ -818,8 +921,9 @@ void DBSearchPanel::search(sql::ConnectionWrapper connection, const std::string&
   _search_finished = false;
   if (_update_timer)
     bec::GRTManager::get()->cancel_timer(_update_timer);
-  _searcher = std::shared_ptr<DBSearch>(new DBSearch(connection, search_keyword, filter_list, search_mode, limit_total,
-                                                     limt_per_table, invert, search_data_type, cast_to));
+  _searcher = std::shared_ptr<DBSearch>(new DBSearch(connection, extra_connections, search_keyword, filter_list,
+                                                     search_mode, limit_total, limt_per_table, invert, search_data_type,
+                                                     cast_to, table_timeout));
   load_model(_results_tree.root_node());
   std::function<void()> fsearch = (std::bind(&DBSearch::search, _searcher.get()));
   // fsearch = (std::bind(&DBSearch::count, _searcher.get()));//COUNT test
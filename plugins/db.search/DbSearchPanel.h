@@ -55,9 +55,13 @@ protected:
 public:
   DBSearchPanel();
   ~DBSearchPanel();
-  void search(sql::ConnectionWrapper connection, const std::string& search_keyword,
-              const grt::StringListRef& filter_list, const SearchMode search_mode, const int limit_total,
-              const int limt_per_table, const bool invert, const int search_data_type, const std::string cast_to,
+  // Tables are searched in parallel over the given connections. The first one is used for the metadata and the first
+  // worker, each extra connection gets a worker of its own. All must be opened by the caller, as opening one may
+  // ask for a password. table_timeout is the maximum time in seconds a single table query may take (0 for no limit).
+  void search(sql::ConnectionWrapper connection, const std::vector<sql::ConnectionWrapper>& extra_connections,
+              const std::string& search_keyword, const grt::StringListRef& filter_list, const SearchMode search_mode,
+              const int limit_total, const int limt_per_table, const bool invert, const int search_data_type,
+              const std::string cast_to, const int table_timeout,
               std::function<void(grt::ValueRef)> finished_callback, std::function<void()> failed_callback);
   void toggle_pause();
   bool stop_search_if_working();
@@ -38,6 +38,8 @@
 
 #define MODULE_VERSION "2.0.0"
 
+DEFAULT_LOG_DOMAIN("db.search");
+
 #include <sstream>
 #include <boost/assign/list_of.hpp>
 #include <boost/lambda/bind.hpp>
@@ -157,6 +159,8 @@ private:
     int limit_total = _filter_panel.get_limit_total();
     int search_type = _filter_panel.get_search_type();
     bool invert = _filter_panel.exclude();
+    int connection_count = _filter_panel.get_connection_count();
+    int table_timeout = (int)bec::GRTManager::get()->get_app_option_int("db.search:SearchTableTimeout", 0);
     sql::DriverManager *dm = sql::DriverManager::getDriverManager();
     mforms::App::get()->set_status_text("Opening new connection...");
     sql::ConnectionWrapper wrapper;
@@ -166,20 +170,33 @@ private:
       mforms::App::get()->set_status_text(ucancel.what());
       return;
     }
+    // The other connections of the pool are opened here as well and not in the search threads, since the
+    // connection might have to ask for a password. Not being able to open them just means a slower search.
+    std::vector<sql::ConnectionWrapper> extra_connections;
+    for (int i = 1; i < connection_count; ++i) {
+      try {
+        extra_connections.push_back(dm->getConnection(_editor->connection()));
+      } catch (std::exception &exc) {
+        logWarning("Could not open additional search connection: %s\n", exc.what());
+        break;
+      }
+    }
     mforms::App::get()->set_status_text("Searching...");
 
     bec::GRTManager::get()->set_app_option("db.search:SearchType", grt::IntegerRef(search_type));
     bec::GRTManager::get()->set_app_option("db.search:SearchLimit", grt::IntegerRef(limit_total));
     bec::GRTManager::get()->set_app_option("db.search:SearchLimitPerTable", grt::IntegerRef(limit_table));
     bec::GRTManager::get()->set_app_option("db.search:SearchInvert", grt::IntegerRef(invert));
+    bec::GRTManager::get()->set_app_option("db.search:SearchConnections", grt::IntegerRef(connection_count));
 
     _filter_panel.set_searching(true);
     _search_panel.show(true);
 
     _search_panel.search(
-      wrapper, search_keyword, filters, SearchMode(search_type), limit_total, limit_table, invert,
+      wrapper, extra_connections, search_keyword, filters, SearchMode(search_type), limit_total, limit_table, invert,
       _filter_panel.search_all_types() ? search_all_types : text_type, _filter_panel.search_all_types() ? "CHAR" : "",
-      std::bind(&DBSearchView::finished_search, this), std::bind(&DBSearchView::failed_search, this));
+      table_timeout, std::bind(&DBSearchView::finished_search, this),
+      std::bind(&DBSearchView::failed_search, this));
   }
 
 public:
@@ -219,6 +236,8 @@ public:
     _filter_panel.set_limit_table(
       base::strfmt("%li", bec::GRTManager::get()->get_app_option_int("db.search:SearchLimitPerTable", 100)));
     _filter_panel.set_exclude(bec::GRTManager::get()->get_app_option_int("db.search:SearchInvert", 0) != 0);
+    _filter_panel.set_connection_count(
+      base::strfmt("%li", bec::GRTManager::get()->get_app_option_int("db.search:SearchConnections", 4)));
 
     _tree_selection = _editor->schemaTreeSelection();
     _filter_panel.search_button()->set_enabled(_tree_selection.count() > 0);
@@ -26,10 +26,12 @@
 #include <stdint.h>
 #include <cstdlib>
 #include <cstdio>
+#include <algorithm>
 
 #include <mysql.h>
 
 #include "base/log.h"
+#include "base/profiling.h"
 #include "base/string_utilities.h"
 #include "base/sqlstring.h"
 
@@ -225,6 +227,38 @@ std::string QueryBuilder::build_query() {
   return q;
 }
 
+// Splits a qualified name like [catalog].[schema] or "schema" into its unquoted parts.
+static std::vector<std::string> split_quoted_name(const std::string &name) {
+  std::vector<std::string> parts;
+  size_t pos = 0;
+  while (pos < name.size()) {
+    std::string part;
+    char close = name[pos] == '[' ? ']' : (name[pos] == '"' || name[pos] == '`') ? name[pos] : 0;
+    if (close) {
+      // a doubled closing quote stands for the quote itself
+      for (++pos; pos < name.size(); ++pos) {
+        if (name[pos] == close) {
+          if (pos + 1 < name.size() && name[pos + 1] == close)
+            ++pos;
+          else
+            break;
+        }
+        part.push_back(name[pos]);
+      }
+      ++pos;
+    } else {
+      size_t end = name.find('.', pos);
+      part = name.substr(pos, end == std::string::npos ? std::string::npos : end - pos);
+      pos += part.size();
+    }
+    parts.push_back(part);
+    if (pos < name.size() && name[pos] != '.')
+      return std::vector<std::string>();
+    ++pos;
+  }
+  return parts;
+}
+
 std::string ConnectionError::process(SQLRETURN retcode, SQLSMALLINT htype, SQLHANDLE handle) {
   SQLINTEGER i = 0;
   SQLINTEGER native;
@@ -862,6 +896,53 @@ size_t ODBCCopyDataSource::count_rows(const std::string &schema, const std::stri
   return (size_t)count;
 }
 
+bool ODBCCopyDataSource::estimate_table_size(const std::string &schema, const std::string &table, long long &rows,
+                                             long long &bytes) {
+  // schema can be qualified with the catalog, like [db].[dbo] for SQL Server
+  std::vector<std::string> schema_parts = split_quoted_name(schema);
+  std::vector<std::string> table_parts = split_quoted_name(table);
+  if (schema_parts.empty() || schema_parts.size() > 2 || table_parts.size() != 1)
+    return false;
+  std::string catalog = schema_parts.size() == 2 ? schema_parts[0] : "";
+
+  SQLHSTMT stmt;
+  SQLRETURN ret;
+  if (!SQL_SUCCEEDED(ret = SQLAllocHandle(SQL_HANDLE_STMT, _dbc, &stmt)))
+    throw ConnectionError("SQLAllocHandle", ret, SQL_HANDLE_DBC, _dbc);
+
+  // The driver statistics give the table cardinality, or at least the cardinality of its indexes. SQL_QUICK only
+  // returns what the server has at hand, without scanning anything.
+  rows = -1;
+  bytes = -1;
+  long long index_rows = -1;
+  ret = SQLStatistics(stmt, catalog.empty() ? NULL : (SQLCHAR *)catalog.c_str(), catalog.empty() ? 0 : SQL_NTS,
+                      (SQLCHAR *)schema_parts.back().c_str(), SQL_NTS, (SQLCHAR *)table_parts[0].c_str(), SQL_NTS,
+                      SQL_INDEX_ALL, SQL_QUICK);
+  if (SQL_SUCCEEDED(ret)) {
+    while (SQL_SUCCEEDED(SQLFetch(stmt))) {
+      SQLSMALLINT type;
+      SQLINTEGER cardinality;
+      SQLLEN type_length, cardinality_length;
+      if (!SQL_SUCCEEDED(SQLGetData(stmt, 7, SQL_C_SSHORT, &type, 0, &type_length)) ||
+          !SQL_SUCCEEDED(SQLGetData(stmt, 11, SQL_C_SLONG, &cardinality, 0, &cardinality_length)) ||
+          type_length == SQL_NULL_DATA || cardinality_length == SQL_NULL_DATA || cardinality < 0)
+        continue;
+
+      if (type == SQL_TABLE_STAT) {
+        rows = cardinality;
+        break;
+      }
+      index_rows = std::max(index_rows, (long long)cardinality);
+    }
+  } else
+    logDebug("SQLStatistics failed for %s.%s\n", schema.c_str(), table.c_str());
+  SQLFreeHandle(SQL_HANDLE_STMT, stmt);
+
+  if (rows < 0)
+    rows = index_rows;
+  return rows >= 0;
+}
+
 std::shared_ptr<std::vector<ColumnInfo> > ODBCCopyDataSource::begin_select_table(
   const std::string &schema, const std::string &table, const std::vector<std::string> &pk_columns,
   const std::string &select_expression, const CopySpec &spec, const std::vector<std::string> &last_pkeys) {
@@ -1186,19 +1267,17 @@ bool ODBCCopyDataSource::fetch_row(RowBuffer &rowbuffer) {
   return false;
 }
 
-MySQLCopyDataSource::MySQLCopyDataSource(const std::string &hostname, int port, const std::string &username,
-                                         const std::string &password, const std::string &socket,
-                                         bool use_cleartext_plugin, unsigned int connection_timeout)
-  : _select_stmt(NULL), _has_long_data(false) {
-  this->_connection_timeout = connection_timeout;
+void open_mysql_connection(MYSQL *mysql, const std::string &hostname, int port, const std::string &username,
+                           const std::string &password, const std::string &socket, bool use_cleartext_plugin,
+                           unsigned int connection_timeout) {
   std::string host = hostname;
-  mysql_init(&_mysql);
+  mysql_init(mysql);
 
   if (port > 0) {
     // Forces usage of TCP connection if indicated on the connection
     // settings (a port is specified)
     int proto = MYSQL_PROTOCOL_TCP;
-    mysql_options(&_mysql, MYSQL_OPT_PROTOCOL, &proto);
+    mysql_options(mysql, MYSQL_OPT_PROTOCOL, &proto);
 
     logInfo("Connecting to MySQL server at %s:%i with user %s\n", hostname.c_str(), port, username.c_str());
   } else {
@@ -1216,7 +1295,7 @@ MySQLCopyDataSource::MySQLCopyDataSource(const std::string &hostname, int port,
     logInfo("Connecting to MySQL server using socket %s with user %s\n", socket.c_str(), username.c_str());
   }
 
-  mysql_options(&_mysql, MYSQL_OPT_CONNECT_TIMEOUT, &_connection_timeout);
+  mysql_options(mysql, MYSQL_OPT_CONNECT_TIMEOUT, &connection_timeout);
 
 #if MYSQL_VERSION_ID >= 80004
   if (use_cleartext_plugin)
@@ -1225,7 +1304,7 @@ MySQLCopyDataSource::MySQLCopyDataSource(const std::string &hostname, int port,
 
   #if MYSQL_VERSION_ID >= 50527
     my_bool use_cleartext = use_cleartext_plugin;
-    mysql_options(&_mysql, MYSQL_ENABLE_CLEARTEXT_PLUGIN, &use_cleartext);
+    mysql_options(mysql, MYSQL_ENABLE_CLEARTEXT_PLUGIN, &use_cleartext);
   #else
     if (use_cleartext_plugin)
       logWarning("Trying to use the ClearText plugin, but it's not supported by libmysqlclient\n");
@@ -1233,12 +1312,21 @@ MySQLCopyDataSource::MySQLCopyDataSource(const std::string &hostname, int port,
 
 #endif
 
-  if (!mysql_real_connect(&_mysql, host.c_str(), username.c_str(), password.c_str(), NULL, port, socket.c_str(),
+  if (!mysql_real_connect(mysql, host.c_str(), username.c_str(), password.c_str(), NULL, port, socket.c_str(),
                           CLIENT_COMPRESS)) {
-    logError("Failed opening connection to MySQL: %s\n", mysql_error(&_mysql));
-    throw ConnectionError("mysql_real_connect", &_mysql);
+    logError("Failed opening connection to MySQL: %s\n", mysql_error(mysql));
+    throw ConnectionError("mysql_real_connect", mysql);
   }
   logInfo("Connection to MySQL opened\n");
+}
+
+MySQLCopyDataSource::MySQLCopyDataSource(const std::string &hostname, int port, const std::string &username,
+                                         const std::string &password, const std::string &socket,
+                                         bool use_cleartext_plugin, unsigned int connection_timeout)
+  : _select_stmt(NULL), _has_long_data(false) {
+  this->_connection_timeout = connection_timeout;
+  open_mysql_connection(&_mysql, hostname, port, username, password, socket, use_cleartext_plugin,
+                        connection_timeout);
 
   std::string q = "SET NAMES 'utf8'";
   if (mysql_real_query(&_mysql, q.data(), (unsigned long)q.length()) != 0)
@@ -1311,6 +1399,34 @@ size_t MySQLCopyDataSource::count_rows(const std::string &schema, const std::str
   return (size_t)count;
 }
 
+bool MySQLCopyDataSource::estimate_table_size(const std::string &schema, const std::string &table, long long &rows,
+                                              long long &bytes) {
+  std::string q = base::strfmt(
+    "SELECT TABLE_ROWS, DATA_LENGTH FROM information_schema.TABLES WHERE TABLE_SCHEMA = '%s' AND TABLE_NAME = '%s'",
+    base::escape_sql_string(base::unquote(schema)).c_str(), base::escape_sql_string(base::unquote(table)).c_str());
+
+  if (mysql_query(&_mysql, q.data()) != 0)
+    throw ConnectionError("mysql_query(" + q + ")", &_mysql);
+
+  MYSQL_RES *result;
+  if ((result = mysql_use_result(&_mysql)) == NULL)
+    throw ConnectionError("Getting table size", &_mysql);
+
+  rows = -1;
+  bytes = -1;
+  MYSQL_ROW row;
+  while ((row = mysql_fetch_row(result))) {
+    if (row[0])
+      rows = base::atoi<long long>(row[0], -1ll);
+    if (row[1])
+      bytes = base::atoi<long long>(row[1], -1ll);
+  }
+
+  mysql_free_result(result);
+
+  return rows >= 0 || bytes >= 0;
+}
+
 std::shared_ptr<std::vector<ColumnInfo> > MySQLCopyDataSource::begin_select_table(
   const std::string &schema, const std::string &table, const std::vector<std::string> &pk_columns,
   const std::string &select_expression, const CopySpec &spec, const std::vector<std::string> &last_pkeys) {
@@ -2495,7 +2611,7 @@ void MySQLCopyDataTarget::restore_triggers(std::set<std::string> &schemas) {
   }
 }
 
-TaskQueue::TaskQueue() {
+TaskQueue::TaskQueue() : _total_size(0), _copied_size(0), _started(false) {
 }
 
 void TaskQueue::add_task(const TableParam &task) {
@@ -2512,14 +2628,83 @@ bool TaskQueue::get_task(TableParam &task) {
     ret_val = true;
     task = _tasks.front();
     _tasks.erase(_tasks.begin());
+
+    if (!_started) {
+      _started = true;
+      _start_time = std::chrono::steady_clock::now();
+    }
   }
 
   return ret_val;
 }
 
+/**
+ * The size used for scheduling: the data length if known, otherwise the row count. Estimates of different tables
+ * come from the same source, so they are comparable. Returns -1 if there is no estimate.
+ */
+double TaskQueue::estimated_size(const TableParam &task) {
+  double size = task.estimated_bytes > 0 ? (double)task.estimated_bytes : (double)task.estimated_rows;
+  if (size < 0)
+    return -1;
+
+  // only part of the table may be copied
+  long long limit = -1;
+  if (task.copy_spec.type == CopyCount)
+    limit = task.copy_spec.row_count;
+  if (task.copy_spec.max_count > 0 && (limit < 0 || task.copy_spec.max_count < limit))
+    limit = task.copy_spec.max_count;
+  if (limit >= 0 && task.estimated_rows > limit)
+    size = size * limit / task.estimated_rows;
+
+  return size;
+}
+
+void TaskQueue::schedule_largest_first(CopyDataSource *source) {
+  base::MutexLock lock(_task_mutex);
+
+  size_t estimated = 0;
+  _total_size = 0;
+  for (TableParam &task : _tasks) {
+    try {
+      if (source->estimate_table_size(task.source_schema, task.source_table, task.estimated_rows,
+                                      task.estimated_bytes))
+        ++estimated;
+    } catch (std::exception &e) {
+      logWarning("Could not get the size of %s.%s: %s\n", task.source_schema.c_str(), task.source_table.c_str(),
+                 e.what());
+    }
+    _total_size += std::max(estimated_size(task), 0.0);
+  }
+
+  // Longest processing time first. Tables without an estimate go first, they might be the big ones.
+  std::stable_sort(_tasks.begin(), _tasks.end(), [](const TableParam &a, const TableParam &b) {
+    double a_size = estimated_size(a), b_size = estimated_size(b);
+    if (a_size < 0 || b_size < 0)
+      return a_size < 0 && b_size >= 0;
+    return a_size > b_size;
+  });
+
+  logInfo("Got size estimates for %i of %i tables, copying them largest first\n", (int)estimated, (int)_tasks.size());
+}
+
+void TaskQueue::task_done(const TableParam &task) {
+  base::MutexLock lock(_task_mutex);
+
+  _copied_size += std::max(estimated_size(task), 0.0);
+  if (_total_size <= 0 || _copied_size <= 0)
+    return;
+
+  // assumes the remaining data is copied at the average rate so far
+  double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - _start_time).count();
+  int remaining = (int)(elapsed * std::max(_total_size - _copied_size, 0.0) / _copied_size);
+  printf("Copied %i%% of the estimated data, estimated time left %im%02is\n", (int)(100 * _copied_size / _total_size),
+         remaining / 60, remaining % 60);
+  fflush(stdout);
+}
+
 CopyDataTask::CopyDataTask(const std::string name, CopyDataSource *psource, MySQLCopyDataTarget *ptarget,
                            TaskQueue *ptasks, bool show_progress)
-  : _source(psource), _target(ptarget) {
+  : _source(psource), _target(ptarget), _table_count(0), _copied_size(0), _busy_time(0) {
   _name = name;
   _tasks = ptasks;
   _show_progress = show_progress;
@@ -2530,21 +2715,45 @@ CopyDataTask::CopyDataTask(const std::string name, CopyDataSource *psource, MySQ
 gpointer CopyDataTask::thread_func(gpointer data) {
   CopyDataTask *self = (CopyDataTask *)data;
 
+  base::Tracer::set_thread_name(self->_name);
+
   TableParam tparam;
 
   while (self->_tasks->get_task(tparam)) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
     self->copy_table(tparam);
+    self->_busy_time += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    self->_table_count++;
+    self->_copied_size += std::max(TaskQueue::estimated_size(tparam), 0.0);
+    self->_tasks->task_done(tparam);
   }
 
   return NULL;
 }
 
+void CopyDataTask::report_utilization(double elapsed_time) {
+  double total_size = _tasks->total_size();
+  printf("%s: copied %i tables", _name.c_str(), (int)_table_count);
+  if (total_size > 0)
+    printf(" (%i%% of the estimated data)", (int)(100 * _copied_size / total_size));
+  if (elapsed_time > 0)
+    printf(", busy %i%% of the time", (int)(100 * std::min(_busy_time / elapsed_time, 1.0)));
+  printf("\n");
+  fflush(stdout);
+}
+
 void CopyDataTask::copy_table(const TableParam &task) {
   std::shared_ptr<std::vector<ColumnInfo> > columns;
 
   long long i = 0, total = 0;
   int inserted_records;
 
+  const char *rows_counter = NULL;
+  if (base::Tracer::is_enabled())
+    rows_counter = base::Tracer::intern(_name + " rows");
+  TRACE_ZONE(base::Tracer::is_enabled() ? base::Tracer::intern(task.target_schema + "." + task.target_table) : NULL);
+
   time_t start = time(NULL);
   try {
     std::vector<std::string> last_pkeys;
@@ -2573,6 +2782,8 @@ void CopyDataTask::copy_table(const TableParam &task) {
 
       if (_show_progress && inserted_records)
         report_progress(task.target_schema, task.target_table, i, total);
+      if (rows_counter != NULL && inserted_records)
+        base::Tracer::counter(rows_counter, i);
 
       _target->row_buffer().clear();
 
@@ -38,6 +38,7 @@
 #include <stdexcept>
 #include <memory>
 #include <functional>
+#include <chrono>
 
 #ifdef __APPLE
 #pragma GCC diagnostic ignored "-Wdeprecated-register"
@@ -96,6 +97,11 @@ public:
   }
 };
 
+// Connects the given (uninitialized) MYSQL handle, throws ConnectionError on failure.
+void open_mysql_connection(MYSQL *mysql, const std::string &hostname, int port, const std::string &username,
+                           const std::string &password, const std::string &socket, bool use_cleartext_plugin,
+                           unsigned int connection_timeout);
+
 enum SourceType { ST_MYSQL, ST_ODBC, ST_PYTHON };
 
 struct ColumnInfo {
@@ -164,6 +170,10 @@ struct TableParam {
   std::vector<std::string> source_pk_columns;
   std::vector<std::string> target_pk_columns;
   CopySpec copy_spec;
+
+  // size of the source table according to the catalog statistics, -1 if not known
+  long long estimated_rows = -1;
+  long long estimated_bytes = -1;
 };
 
 class CopyDataSource {
@@ -206,6 +216,11 @@ public:
   virtual size_t count_rows(const std::string &schema, const std::string &table,
                             const std::vector<std::string> &pk_columns, const CopySpec &spec,
                             const std::vector<std::string> &last_pkeys) = 0;
+  // Cheap size estimate from the catalog statistics, false if the source has none. Either value can be -1.
+  virtual bool estimate_table_size(const std::string &schema, const std::string &table, long long &rows,
+                                   long long &bytes) {
+    return false;
+  }
   virtual std::shared_ptr<std::vector<ColumnInfo> > begin_select_table(
     const std::string &schema, const std::string &table, const std::vector<std::string> &pk_columns,
     const std::string &select_expression, const CopySpec &spec, const std::vector<std::string> &last_pkeys) = 0;
@@ -245,6 +260,8 @@ public:
   virtual size_t count_rows(const std::string &schema, const std::string &table,
                             const std::vector<std::string> &pk_columns, const CopySpec &spec,
                             const std::vector<std::string> &last_pkeys);
+  virtual bool estimate_table_size(const std::string &schema, const std::string &table, long long &rows,
+                                   long long &bytes);
   virtual std::shared_ptr<std::vector<ColumnInfo> > begin_select_table(
     const std::string &schema, const std::string &table, const std::vector<std::string> &pk_columns,
     const std::string &select_expression, const CopySpec &spec, const std::vector<std::string> &last_pkeys);
@@ -266,6 +283,8 @@ public:
   virtual size_t count_rows(const std::string &schema, const std::string &table,
                             const std::vector<std::string> &pk_columns, const CopySpec &spec,
                             const std::vector<std::string> &last_pkeys);
+  virtual bool estimate_table_size(const std::string &schema, const std::string &table, long long &rows,
+                                   long long &bytes);
   virtual std::shared_ptr<std::vector<ColumnInfo> > begin_select_table(
     const std::string &schema, const std::string &table, const std::vector<std::string> &pk_columns,
     const std::string &select_expression, const CopySpec &spec, const std::vector<std::string> &last_pkeys);
@@ -399,10 +418,26 @@ private:
   std::vector<TableParam> _tasks;
   base::Mutex _task_mutex;
 
+  // estimated sizes (bytes or rows, see estimated_size()) for the ETA
+  double _total_size;
+  double _copied_size;
+  bool _started;
+  std::chrono::steady_clock::time_point _start_time;
+
 public:
   TaskQueue();
   void add_task(const TableParam &task);
   bool get_task(TableParam &task);
+  void task_done(const TableParam &task);
+
+  // Fills in the table sizes from the source catalog statistics and orders the tasks largest first, so that
+  // workers don't end up idle while the last one copies a big table it only started late.
+  void schedule_largest_first(CopyDataSource *source);
+
+  static double estimated_size(const TableParam &task);
+  double total_size() {
+    return _total_size;
+  }
 
   size_t size() {
     return _tasks.size();
@@ -422,6 +457,10 @@ private:
 
   GThread *_thread;
 
+  size_t _table_count;
+  double _copied_size;
+  double _busy_time;
+
   static gpointer thread_func(gpointer data);
 
   void copy_table(const TableParam &task);
@@ -435,4 +474,5 @@ public:
   void wait() {
     g_thread_join(_thread);
   }
+  void report_utilization(double elapsed_time);
 };
@@ -32,6 +32,7 @@
 
 #include "python_copy_data_source.h" // python stuff need to be 1st #include
 #include "copytable.h"
+#include "mysql_dumper.h"
 
 #include <cstdio>
 #include <cstdlib>
@@ -40,6 +41,7 @@
 #include <iostream>
 
 #include "base/log.h"
+#include "base/profiling.h"
 #include "base/sqlstring.h"
 
 #undef tolower
@@ -177,6 +179,16 @@ static void show_help() {
   printf("--abort-on-oversized-blobs\n");
   printf("--max-count=<max rows count>\n");
   printf("--resume\n");
+  printf("Dump to SQL files instead of copying (MySQL source only, no target needed):\n");
+  printf("--dump-to=<folder>|<file>\n");
+  printf("--dump-single-file\n");
+  printf("--dump-no-data\n");
+  printf("--dump-no-create-info\n");
+  printf("--dump-skip-triggers\n");
+  printf("--dump-include-schema\n");
+  printf("--dump-no-snapshot\n");
+  printf("--dump-chunk-rows=<rows>\n");
+  printf("--dump-table <source schema> <source table>\n");
   printf("Table Specification from file:\n");
   printf("--table-file=<filename>\n");
   printf("<source schema><TAB><source table><TAB><target schema><TAB><target "
@@ -192,6 +204,7 @@ static void show_help() {
   printf("\n");
   printf("--log-file=<file_path>\n");
   printf("--log-level=<level>\n");
+  printf("--trace-file=<file_path>\n");
   printf("--thread-count=<count>\n");
   printf("--bulk-insert-batch-size=<size>\n");
   printf("--disable-triggers-on=<schema>\n");
@@ -368,6 +381,7 @@ int main(int argc, char **argv) {
   bool target_use_cleartext_plugin = false;
   std::string log_level;
   std::string log_file;
+  std::string trace_file;
 
   bool passwords_from_stdin = false;
   bool count_only = false;
@@ -384,6 +398,7 @@ int main(int argc, char **argv) {
   long long max_count = 0;
 
   std::string table_file;
+  DumpOptions dump_options;
 
   std::set<std::string> trigger_schemas;
   std::string source_rdbms_type = "unknown";
@@ -437,6 +452,8 @@ int main(int argc, char **argv) {
       log_level = argval;
     else if (check_arg_with_value(argv, i, "--log-file", argval, true))
       log_file = argval;
+    else if (check_arg_with_value(argv, i, "--trace-file", argval, true))
+      trace_file = argval;
     else if (check_arg_with_value(argv, i, "--odbc-source", argval, true)) {
       source_type = ST_ODBC;
       source_connstring = base::trim(argval, "\"");
@@ -473,6 +490,35 @@ int main(int argc, char **argv) {
       disable_triggers_on_copy = false;
     else if (strcmp(argv[i], "--resume") == 0)
       resume = true;
+    else if (check_arg_with_value(argv, i, "--dump-to", argval, true))
+      dump_options.output_path = argval;
+    else if (strcmp(argv[i], "--dump-single-file") == 0)
+      dump_options.single_file = true;
+    else if (strcmp(argv[i], "--dump-no-data") == 0)
+      dump_options.dump_data = false;
+    else if (strcmp(argv[i], "--dump-no-create-info") == 0)
+      dump_options.dump_structure = false;
+    else if (strcmp(argv[i], "--dump-skip-triggers") == 0)
+      dump_options.dump_triggers = false;
+    else if (strcmp(argv[i], "--dump-include-schema") == 0)
+      dump_options.include_schema = true;
+    else if (strcmp(argv[i], "--dump-no-snapshot") == 0)
+      dump_options.consistent_snapshot = false;
+    else if (check_arg_with_value(argv, i, "--dump-chunk-rows", argval, true))
+      dump_options.chunk_rows = base::atoi<long long>(argval, 500000ll);
+    else if (strcmp(argv[i], "--dump-table") == 0) {
+      TableParam param;
+
+      if (i + 2 >= argc) {
+        fprintf(stderr, "%s: Missing value for table dump specification\n", argv[0]);
+        exit(1);
+      }
+      param.source_schema = argv[++i];
+      param.source_table = argv[++i];
+      param.copy_spec.type = CopyAll;
+
+      tables.add_task(param);
+    }
     else if (check_arg_with_value(argv, i, "--disable-triggers-on", argval, true)) {
       // disabling/enabling triggers are standalone operations and mutually
       // exclusive
@@ -675,6 +721,11 @@ int main(int argc, char **argv) {
   // uses std_error
   base::Logger logger(true, log_file);
 
+  if (!trace_file.empty()) {
+    base::Tracer::start(trace_file);
+    base::Tracer::set_thread_name("main");
+  }
+
   if (!log_level.empty()) {
     if (!set_log_level(log_level)) {
       fprintf(stderr, "%s: invalid argument '%s' for option %s\n", argv[0], log_level.data(), "--log-level");
@@ -696,9 +747,11 @@ int main(int argc, char **argv) {
     base::Logger::active_level(level);
   }
 
+  bool dump_only = !dump_options.output_path.empty();
+
   // If needed, reads the tasks from the table definition file
   if (!table_file.empty()) {
-    if (!read_tasks_from_file(table_file, count_only, tables, trigger_schemas, resume, max_count)) {
+    if (!read_tasks_from_file(table_file, count_only || dump_only, tables, trigger_schemas, resume, max_count)) {
       fprintf(stderr, "Invalid table definitions format in file: %s\n", table_file.data());
       exit(1);
     }
@@ -712,7 +765,12 @@ int main(int argc, char **argv) {
     exit(1);
   }
 
-  if (target_connstring.empty() && !(count_only && !resume)) {
+  if (dump_only && source_type != ST_MYSQL) {
+    fprintf(stderr, "Dumping is only supported for MySQL sources\n");
+    exit(1);
+  }
+
+  if (target_connstring.empty() && !(count_only && !resume) && !dump_only) {
     fprintf(stderr, "Missing target DB server\n");
     exit(1);
   }
@@ -749,7 +807,7 @@ int main(int argc, char **argv) {
   std::string target_user;
   int target_port = -1;
   std::string target_socket;
-  if (!(count_only && !resume) &&
+  if (!(count_only && !resume) && !dump_only &&
       !parse_mysql_connstring(target_connstring, target_user, target_password,
                               target_host, target_port, target_socket)) {
     fprintf(stderr, "Invalid MySQL connection string %s for target database. "
@@ -769,10 +827,10 @@ int main(int argc, char **argv) {
       exit(1);
     }
 
-    if ((count_only && !resume) || reenable_triggers || disable_triggers) {
+    if ((count_only && !resume) || dump_only || reenable_triggers || disable_triggers) {
       char *ptr = strtok(password, "\t\r\n");
       if (ptr) {
-        if (count_only)
+        if (count_only || dump_only)
           source_password = ptr;
         else
           target_password = ptr;
@@ -846,6 +904,16 @@ int main(int argc, char **argv) {
         }
         count_rows(psource, task.source_schema, task.source_table, task.source_pk_columns, task.copy_spec, last_pkeys);
       }
+    } else if (dump_only) {
+      dump_options.thread_count = thread_count;
+      dump_options.show_progress = show_progress;
+
+      MySQLDumper dumper(source_host, source_port, source_user, source_password, source_socket,
+                         source_use_cleartext_plugin, source_connection_timeout, dump_options);
+      TableParam task;
+      while (tables.get_task(task))
+        dumper.add_table(task.source_schema, task.source_table);
+      dumper.dump();
     } else if (reenable_triggers || disable_triggers) {
       std::unique_ptr<MySQLCopyDataTarget> ptarget;
       ptarget.reset(new MySQLCopyDataTarget(
@@ -872,21 +940,31 @@ int main(int argc, char **argv) {
         ptarget_conn->backup_triggers(trigger_schemas);
       }
 
-      for (int index = 0; index < thread_count; index++) {
+      auto create_source = [&]() -> CopyDataSource * {
         if (source_type == ST_ODBC) {
           SQLAllocHandle(SQL_HANDLE_ENV, SQL_NULL_HANDLE, &odbc_env);
           SQLSetEnvAttr(odbc_env, SQL_ATTR_ODBC_VERSION, (void *)SQL_OV_ODBC3, 0);
 
-          psource = new ODBCCopyDataSource(odbc_env, source_connstring,
-                                           source_password, source_is_utf8,
-                                           source_rdbms_type);
+          return new ODBCCopyDataSource(odbc_env, source_connstring,
+                                        source_password, source_is_utf8,
+                                        source_rdbms_type);
         } else if (source_type == ST_MYSQL)
-          psource = new MySQLCopyDataSource(
+          return new MySQLCopyDataSource(
               source_host, source_port, source_user, source_password,
               source_socket, source_use_cleartext_plugin,
               source_connection_timeout);
-        else
-          psource = new PythonCopyDataSource(source_connstring, source_password);
+        return new PythonCopyDataSource(source_connstring, source_password);
+      };
+
+      // The sizes come from the catalog statistics, which the Python sources don't have.
+      if (!check_types_only && tables.size() > 1 && source_type != ST_PYTHON) {
+        std::unique_ptr<CopyDataSource> estimate_source(create_source());
+        tables.schedule_largest_first(estimate_source.get());
+      }
+
+      std::chrono::steady_clock::time_point copy_start = std::chrono::steady_clock::now();
+      for (int index = 0; index < thread_count; index++) {
+        psource = create_source();
 
         ptarget = new MySQLCopyDataTarget(
             target_host, target_port, target_user, target_password,
@@ -915,6 +993,10 @@ int main(int argc, char **argv) {
       for (size_t index = 0; index < threads.size(); index++)
         threads[index]->wait();
 
+      double elapsed_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - copy_start).count();
+      for (size_t index = 0; index < threads.size(); index++)
+        threads[index]->report_utilization(elapsed_time);
+
       // Finally destroys the threads and connections
       for (size_t index = 0; index < threads.size(); index++)
         delete threads[index];
@@ -946,6 +1028,8 @@ int main(int argc, char **argv) {
     manager = nullptr;
   }
 
+  base::Tracer::stop();
+
   printf("FINISHED\n");
   fflush(stdout);
 
@@ -0,0 +1,883 @@
+/*
+ * Copyright (c) 2020, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <set>
+
+#include "mysql_dumper.h"
+
+#include "base/file_functions.h"
+#include "base/file_utilities.h"
+#include "base/log.h"
+#include "base/profiling.h"
+#include "base/sqlstring.h"
+#include "base/string_utilities.h"
+
+DEFAULT_LOG_DOMAIN("copytable");
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// The same file name mangling as done by the Data Export for the files it creates.
+static std::string normalize_filename(const std::string &name) {
+  std::string result = name;
+  for (char &c : result) {
+    if (c == ':' || c == '/' || c == '\\')
+      c = '_';
+  }
+  return result;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static std::string quote_identifier(const std::string &name) {
+  return base::sqlstring("!", 0) << name;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static bool parse_key_value(const std::string &text, long long &value) {
+  if (text.empty())
+    return false;
+
+  char *end = nullptr;
+  errno = 0;
+  value = strtoll(text.c_str(), &end, 10);
+  return errno == 0 && end != nullptr && *end == '\0';
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static bool write_all(FILE *file, const std::string &text) {
+  return text.empty() || fwrite(text.data(), 1, text.size(), file) == text.size();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static void append_file(FILE *target, const std::string &path) {
+  FILE *source = base_fopen(path.c_str(), "rb");
+  if (source == nullptr)
+    throw std::runtime_error("Could not open temporary dump file " + path + ": " + strerror(errno));
+
+  char buffer[256 * 1024];
+  size_t count;
+  while ((count = fread(buffer, 1, sizeof(buffer), source)) > 0) {
+    if (fwrite(buffer, 1, count, target) != count) {
+      fclose(source);
+      throw std::runtime_error(std::string("Error writing dump file: ") + strerror(errno));
+    }
+  }
+  fclose(source);
+  base::tryRemove(path);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+MySQLDumper::MySQLDumper(const std::string &hostname, int port, const std::string &username,
+                         const std::string &password, const std::string &socket, bool use_cleartext_plugin,
+                         unsigned int connection_timeout, const DumpOptions &options)
+  : _hostname(hostname),
+    _port(port),
+    _username(username),
+    _password(password),
+    _socket(socket),
+    _use_cleartext_plugin(use_cleartext_plugin),
+    _connection_timeout(connection_timeout),
+    _options(options),
+    _charset("utf8"),
+    _next_chunk(0),
+    _failed(false) {
+  if (_options.thread_count < 1)
+    _options.thread_count = 1;
+  if (_options.chunk_rows < 1)
+    _options.chunk_rows = 1;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+MySQLDumper::~MySQLDumper() {
+  disconnect_all();
+  for (auto &output : _outputs) {
+    if (output->file != nullptr)
+      fclose(output->file);
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void MySQLDumper::add_table(const std::string &schema, const std::string &table) {
+  std::unique_ptr<Table> entry(new Table());
+  entry->schema = schema;
+  entry->name = table;
+  _tables.push_back(std::move(entry));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+MYSQL *MySQLDumper::connect() {
+  MYSQL *mysql = new MYSQL;
+  try {
+    open_mysql_connection(mysql, _hostname, _port, _username, _password, _socket, _use_cleartext_plugin,
+                          _connection_timeout);
+  } catch (...) {
+    mysql_close(mysql);
+    delete mysql;
+    throw;
+  }
+
+  // utf8mb4 is available since 5.5.3.
+  if (mysql_get_server_version(mysql) >= 50503)
+    _charset = "utf8mb4";
+  _server_version = mysql_get_server_info(mysql);
+
+  execute(mysql, "SET NAMES " + _charset);
+
+  // Like mysqldump, dump TIMESTAMP values in UTC, so they can be loaded into a server in any time zone.
+  execute(mysql, "SET SESSION time_zone = '+00:00'");
+  execute(mysql, "/*!40101 SET SESSION sql_mode = '' */");
+
+  return mysql;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void MySQLDumper::disconnect_all() {
+  for (auto &worker : _workers) {
+    if (worker.mysql != nullptr) {
+      mysql_close(worker.mysql);
+      delete worker.mysql;
+      worker.mysql = nullptr;
+    }
+  }
+  _workers.clear();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void MySQLDumper::execute(MYSQL *mysql, const std::string &query) {
+  if (mysql_real_query(mysql, query.data(), (unsigned long)query.length()) != 0)
+    throw ConnectionError(query, mysql);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::vector<std::vector<std::string> > MySQLDumper::query(MYSQL *mysql, const std::string &query) {
+  execute(mysql, query);
+
+  MYSQL_RES *result = mysql_store_result(mysql);
+  if (result == nullptr)
+    throw ConnectionError(query, mysql);
+
+  std::vector<std::vector<std::string> > rows;
+  unsigned int field_count = mysql_num_fields(result);
+  MYSQL_ROW row;
+  while ((row = mysql_fetch_row(result)) != nullptr) {
+    unsigned long *lengths = mysql_fetch_lengths(result);
+    std::vector<std::string> values;
+    for (unsigned int i = 0; i < field_count; ++i)
+      values.push_back(row[i] != nullptr ? std::string(row[i], lengths[i]) : std::string());
+    rows.push_back(values);
+  }
+  mysql_free_result(result);
+
+  return rows;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void MySQLDumper::load_table_info(MYSQL *mysql, Table &table) {
+  std::string q = base::sqlstring("SHOW CREATE TABLE !.!", 0) << table.schema << table.name;
+  auto rows = query(mysql, q);
+  if (rows.empty() || rows[0].size() < 2)
+    throw std::runtime_error("Could not get the definition of table " + table.schema + "." + table.name);
+  table.create_statement = rows[0][1];
+
+  // Generated columns can't be inserted, so they are left out of the data.
+  // Note: 8.0 also reports DEFAULT_GENERATED for columns with expression defaults, which are ordinary columns.
+  q = base::sqlstring(
+        "SELECT COLUMN_NAME, EXTRA, COLUMN_KEY, DATA_TYPE FROM information_schema.COLUMNS "
+        "WHERE TABLE_SCHEMA = ? AND TABLE_NAME = ? ORDER BY ORDINAL_POSITION",
+        0)
+      << table.schema << table.name;
+  std::vector<std::string> key_columns;
+  std::string key_type;
+  table.column_list.clear();
+  for (auto &row : query(mysql, q)) {
+    std::string extra = base::toupper(row[1]);
+    if (extra.find("VIRTUAL GENERATED") != std::string::npos || extra.find("STORED GENERATED") != std::string::npos)
+      continue;
+
+    if (!table.column_list.empty())
+      table.column_list += ",";
+    table.column_list += quote_identifier(row[0]);
+
+    if (row[2] == "PRI") {
+      key_columns.push_back(row[0]);
+      key_type = base::tolower(row[3]);
+    }
+  }
+
+  // Only a single integer key can be split into ranges.
+  table.key_column.clear();
+  if (key_columns.size() == 1 && (key_type == "tinyint" || key_type == "smallint" || key_type == "mediumint" ||
+                                  key_type == "int" || key_type == "bigint"))
+    table.key_column = key_columns[0];
+
+  q = base::sqlstring("SELECT TABLE_ROWS FROM information_schema.TABLES WHERE TABLE_SCHEMA = ? AND TABLE_NAME = ?", 0)
+      << table.schema << table.name;
+  rows = query(mysql, q);
+  table.estimated_rows = rows.empty() ? 0 : base::atoi<long long>(rows[0][0], 0ll);
+
+  table.triggers.clear();
+  if (_options.dump_triggers) {
+    q = base::sqlstring("SHOW TRIGGERS FROM ! LIKE ?", 0) << table.schema << table.name;
+    for (auto &trigger : query(mysql, q)) {
+      // The LIKE pattern could match other tables too (_ and % are wildcards).
+      if (trigger.size() < 3 || trigger[2] != table.name)
+        continue;
+
+      std::string show_trigger = base::sqlstring("SHOW CREATE TRIGGER !.!", 0) << table.schema << trigger[0];
+      auto definition = query(mysql, show_trigger);
+      if (definition.empty() || definition[0].size() < 3)
+        continue;
+
+      // Columns: Trigger, sql_mode, SQL Original Statement, ...
+      std::string text = "/*!50003 SET @saved_sql_mode = @@sql_mode */ ;;\n";
+      text += "/*!50003 SET sql_mode = " + std::string(base::sqlstring("?", 0) << definition[0][1]) + " */ ;;\n";
+      text += definition[0][2] + " ;;\n";
+      text += "/*!50003 SET sql_mode = @saved_sql_mode */ ;;\n";
+      table.triggers.push_back(text);
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void MySQLDumper::plan_chunks(MYSQL *mysql, Table &table) {
+  if (!_options.dump_data)
+    return;
+
+  long long min_value = 0, max_value = 0;
+  bool can_split = !table.key_column.empty() && table.estimated_rows > _options.chunk_rows;
+  if (can_split) {
+    std::string q = base::sqlstring("SELECT MIN(!), MAX(!) FROM !.!", 0)
+                    << table.key_column << table.key_column << table.schema << table.name;
+    auto rows = query(mysql, q);
+
+    // Unsigned BIGINT values beyond the signed range are not split, which is good enough.
+    can_split = !rows.empty() && parse_key_value(rows[0][0], min_value) && parse_key_value(rows[0][1], max_value) &&
+                max_value > min_value;
+  }
+
+  if (!can_split) {
+    std::unique_ptr<Chunk> chunk(new Chunk());
+    chunk->table = &table;
+    chunk->index = 0;
+    chunk->done = false;
+    _chunks.push_back(std::move(chunk));
+    table.chunks_left = 1;
+    return;
+  }
+
+  // The ranges are computed on the unsigned span, to avoid overflows with extreme key values. The first and last
+  // chunk are open ended, which makes sure every row is dumped exactly once, even if the key values changed since
+  // MIN/MAX were read. A single chunk has no condition at all.
+  unsigned long long span = (unsigned long long)max_value - (unsigned long long)min_value;
+  unsigned long long count = (unsigned long long)((table.estimated_rows + _options.chunk_rows - 1) / _options.chunk_rows);
+  if (count > span)
+    count = span;
+  unsigned long long step = span / count + (span % count != 0 ? 1 : 0);
+
+  std::string key = quote_identifier(table.key_column);
+  long long lower = min_value;
+  for (unsigned long long i = 0; i < count; ++i) {
+    std::unique_ptr<Chunk> chunk(new Chunk());
+    chunk->table = &table;
+    chunk->index = (size_t)i;
+    chunk->done = false;
+
+    // Rounding up the step can push the last bounds past MAX, so they are capped to stay in range.
+    long long upper = (long long)((unsigned long long)min_value + std::min((i + 1) * step, span));
+    if (count == 1)
+      chunk->where.clear();
+    else if (i + 1 == count)
+      chunk->where = base::strfmt("%s >= %lld", key.c_str(), lower);
+    else if (i == 0)
+      chunk->where = base::strfmt("%s < %lld", key.c_str(), upper);
+    else
+      chunk->where = base::strfmt("%s >= %lld AND %s < %lld", key.c_str(), lower, key.c_str(), upper);
+    lower = upper;
+
+    _chunks.push_back(std::move(chunk));
+  }
+  table.chunks_left = (int)count;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::string MySQLDumper::file_header(const std::string &schema) {
+  // The Data Import reads the schema name from the "-- Host:" line.
+  std::string text = "-- MySQL dump (parallel dump engine of " + std::string("wbcopytables") + ")\n--\n";
+  text += "-- Host: " + (_hostname.empty() ? std::string("localhost") : _hostname) + "    Database: " + schema + "\n";
+  text += "-- ------------------------------------------------------\n";
+  text += "-- Server version\t" + _server_version + "\n\n";
+  text += "/*!40101 SET @OLD_CHARACTER_SET_CLIENT=@@CHARACTER_SET_CLIENT */;\n";
+  text += "/*!40101 SET @OLD_CHARACTER_SET_RESULTS=@@CHARACTER_SET_RESULTS */;\n";
+  text += "/*!40101 SET @OLD_COLLATION_CONNECTION=@@COLLATION_CONNECTION */;\n";
+  text += "/*!40101 SET NAMES " + _charset + " */;\n";
+  text += "/*!40103 SET @OLD_TIME_ZONE=@@TIME_ZONE */;\n";
+  text += "/*!40103 SET TIME_ZONE='+00:00' */;\n";
+  text += "/*!40014 SET @OLD_UNIQUE_CHECKS=@@UNIQUE_CHECKS, UNIQUE_CHECKS=0 */;\n";
+  text += "/*!40014 SET @OLD_FOREIGN_KEY_CHECKS=@@FOREIGN_KEY_CHECKS, FOREIGN_KEY_CHECKS=0 */;\n";
+  text += "/*!40101 SET @OLD_SQL_MODE=@@SQL_MODE, SQL_MODE='NO_AUTO_VALUE_ON_ZERO' */;\n";
+  text += "/*!40111 SET @OLD_SQL_NOTES=@@SQL_NOTES, SQL_NOTES=0 */;\n";
+  return text;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::string MySQLDumper::file_footer() {
+  std::string text = "/*!40103 SET TIME_ZONE=@OLD_TIME_ZONE */;\n\n";
+  text += "/*!40101 SET SQL_MODE=@OLD_SQL_MODE */;\n";
+  text += "/*!40014 SET FOREIGN_KEY_CHECKS=@OLD_FOREIGN_KEY_CHECKS */;\n";
+  text += "/*!40014 SET UNIQUE_CHECKS=@OLD_UNIQUE_CHECKS */;\n";
+  text += "/*!40101 SET CHARACTER_SET_CLIENT=@OLD_CHARACTER_SET_CLIENT */;\n";
+  text += "/*!40101 SET CHARACTER_SET_RESULTS=@OLD_CHARACTER_SET_RESULTS */;\n";
+  text += "/*!40101 SET COLLATION_CONNECTION=@OLD_COLLATION_CONNECTION */;\n";
+  text += "/*!40111 SET SQL_NOTES=@OLD_SQL_NOTES */;\n\n";
+
+  char date[64];
+  time_t now = time(nullptr);
+  strftime(date, sizeof(date), "%Y-%m-%d %H:%M:%S", localtime(&now));
+  text += "-- Dump completed on " + std::string(date) + "\n";
+  return text;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::string MySQLDumper::schema_header(MYSQL *mysql, const std::string &schema) {
+  std::string text = "\n--\n-- Current Database: " + quote_identifier(schema) + "\n--\n\n";
+  if (_options.include_schema) {
+    auto rows = query(mysql, base::sqlstring("SHOW CREATE DATABASE !", 0) << schema);
+    if (!rows.empty() && rows[0].size() > 1) {
+      std::string create = rows[0][1];
+      if (base::hasPrefix(create, "CREATE DATABASE `"))
+        create = "CREATE DATABASE /*!32312 IF NOT EXISTS*/ " + create.substr(strlen("CREATE DATABASE "));
+      text += create + ";\n\n";
+    }
+  }
+  text += "USE " + quote_identifier(schema) + ";\n";
+  return text;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::string MySQLDumper::table_structure(const Table &table) {
+  std::string name = quote_identifier(table.name);
+  std::string text = "\n--\n-- Table structure for table " + name + "\n--\n\n";
+  text += "DROP TABLE IF EXISTS " + name + ";\n";
+  text += table.create_statement + ";\n";
+  return text;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::string MySQLDumper::table_triggers(const Table &table) {
+  if (table.triggers.empty())
+    return "";
+
+  std::string text = "DELIMITER ;;\n";
+  for (auto &trigger : table.triggers)
+    text += trigger;
+  text += "DELIMITER ;\n";
+  return text;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void MySQLDumper::plan_outputs(MYSQL *mysql) {
+  // Chunks are dumped in the order of this list, so keep them in the order in which they appear in the output.
+  auto add_text = [](Output &output, const std::string &text) {
+    if (!output.segments.empty() && output.segments.back().chunk == nullptr)
+      output.segments.back().text += text;
+    else
+      output.segments.push_back({ text, nullptr });
+  };
+
+  auto new_output = [this](const std::string &path) -> Output & {
+    std::unique_ptr<Output> output(new Output());
+    output->path = path;
+    output->file = base_fopen(path.c_str(), "wb");
+    if (output->file == nullptr)
+      throw std::runtime_error("Could not create dump file " + path + ": " + strerror(errno));
+    output->next_segment = 0;
+    output->busy = false;
+    _outputs.push_back(std::move(output));
+    return *_outputs.back();
+  };
+
+  std::set<std::string> used_paths;
+  std::string current_schema;
+  size_t chunk_index = 0;
+  for (auto &table : _tables) {
+    Output *output;
+    if (_options.single_file) {
+      if (_outputs.empty())
+        add_text(new_output(_options.output_path), file_header(""));
+      output = _outputs.back().get();
+      if (table->schema != current_schema) {
+        add_text(*output, schema_header(mysql, table->schema));
+        current_schema = table->schema;
+      }
+    } else {
+      std::string base_name = normalize_filename(table->schema) + "_" + normalize_filename(table->name);
+      std::string path = base::makePath(_options.output_path, base_name + ".sql");
+      for (int i = 0; used_paths.count(path) > 0 || base::file_exists(path); ++i)
+        path = base::makePath(_options.output_path, base_name + base::strfmt("%i.sql", i));
+      used_paths.insert(path);
+
+      output = &new_output(path);
+      add_text(*output, file_header(table->schema));
+      if (_options.include_schema)
+        add_text(*output, schema_header(mysql, table->schema));
+    }
+    table->output = _outputs.size() - 1;
+
+    if (_options.dump_structure)
+      add_text(*output, table_structure(*table));
+
+    if (_options.dump_data) {
+      std::string name = quote_identifier(table->name);
+      add_text(*output, "\n--\n-- Dumping data for table " + name + "\n--\n\n");
+      add_text(*output, "LOCK TABLES " + name + " WRITE;\n/*!40000 ALTER TABLE " + name + " DISABLE KEYS */;\n");
+      while (chunk_index < _chunks.size() && _chunks[chunk_index]->table == table.get())
+        output->segments.push_back({ "", _chunks[chunk_index++].get() });
+      add_text(*output, "/*!40000 ALTER TABLE " + name + " ENABLE KEYS */;\nUNLOCK TABLES;\n");
+    }
+
+    if (_options.dump_triggers)
+      add_text(*output, table_triggers(*table));
+
+    if (!_options.single_file)
+      add_text(*output, file_footer());
+  }
+
+  if (_options.single_file && !_outputs.empty())
+    add_text(*_outputs.back(), file_footer());
+
+  // Temporary files are only needed for chunks which can't be written directly. They live next to the output.
+  for (size_t i = 0; i < _chunks.size(); ++i) {
+    Output &output = *_outputs[_chunks[i]->table->output];
+    _chunks[i]->temp_file = base::strfmt("%s.%i.part", output.path.c_str(), (int)i);
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void MySQLDumper::dump() {
+  TRACE_ZONE("MySQLDumper::dump");
+
+  if (_options.single_file) {
+    std::string folder = base::dirname(_options.output_path);
+    if (!folder.empty() && !base::is_directory(folder))
+      base::create_directory(folder, 0700, true);
+  } else if (!base::is_directory(_options.output_path))
+    base::create_directory(_options.output_path, 0700, true);
+
+  // The coordinating connection is also the first worker.
+  _workers.reserve(_options.thread_count);
+  _workers.push_back({ this, connect(), nullptr });
+  MYSQL *main = _workers[0].mysql;
+
+  // Reading the metadata and starting the transactions of all connections must happen while nobody can change
+  // data, otherwise each connection would see a different state of the database. A single connection doesn't
+  // need that, like mysqldump --single-transaction.
+  bool locked = false;
+  if (_options.consistent_snapshot && _options.thread_count > 1) {
+    if (mysql_query(main, "FLUSH TABLES WITH READ LOCK") == 0)
+      locked = true;
+    else {
+      logWarning("Could not lock tables for a consistent snapshot (%s), connections may see different data\n",
+                 mysql_error(main));
+      printf("WARNING:Could not lock tables (%s), the dump may not be consistent across connections\n",
+             mysql_error(main));
+      fflush(stdout);
+    }
+  }
+
+  try {
+    for (auto &table : _tables)
+      load_table_info(main, *table);
+
+    for (int i = 1; i < _options.thread_count; ++i)
+      _workers.push_back({ this, connect(), nullptr });
+
+    if (_options.consistent_snapshot) {
+      for (auto &worker : _workers) {
+        execute(worker.mysql, "SET SESSION TRANSACTION ISOLATION LEVEL REPEATABLE READ");
+        execute(worker.mysql, "START TRANSACTION /*!40100 WITH CONSISTENT SNAPSHOT */");
+      }
+    }
+  } catch (...) {
+    if (locked)
+      mysql_query(main, "UNLOCK TABLES");
+    throw;
+  }
+
+  if (locked)
+    execute(main, "UNLOCK TABLES");
+
+  // Chunk boundaries need not be consistent with the snapshot (the outer chunks are open ended).
+  for (auto &table : _tables)
+    plan_chunks(main, *table);
+  plan_outputs(main);
+
+  logInfo("Dumping %i tables in %i chunks using %i connections\n", (int)_tables.size(), (int)_chunks.size(),
+          (int)_workers.size());
+
+  // Tables without data only need their text written out. They are reported like the others, so that the progress
+  // of the caller is complete.
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    for (auto &output : _outputs)
+      flush_output(*output, lock);
+  }
+  if (!_options.dump_data && !_failed) {
+    for (auto &table : _tables) {
+      printf("BEGIN:%s.%s:Dumping structure of table %s.%s\n", table->schema.c_str(), table->name.c_str(),
+             table->schema.c_str(), table->name.c_str());
+      printf("END:%s.%s:Finished dumping structure of table %s.%s\n", table->schema.c_str(), table->name.c_str(),
+             table->schema.c_str(), table->name.c_str());
+    }
+    fflush(stdout);
+  }
+
+  for (size_t i = 1; i < _workers.size(); ++i)
+    _workers[i].thread = base::create_thread(&MySQLDumper::thread_func, &_workers[i]);
+  run_worker(main);
+  for (size_t i = 1; i < _workers.size(); ++i) {
+    if (_workers[i].thread != nullptr)
+      g_thread_join(_workers[i].thread);
+  }
+
+  disconnect_all();
+
+  bool complete = true;
+  for (auto &output : _outputs) {
+    if (output->next_segment < output->segments.size())
+      complete = false;
+    if (fclose(output->file) != 0)
+      complete = false;
+    output->file = nullptr;
+  }
+
+  if (_failed || !complete) {
+    cleanup_temp_files();
+    throw std::runtime_error(_error.empty() ? std::string("Dump incomplete") : _error);
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+gpointer MySQLDumper::thread_func(gpointer data) {
+  Worker *worker = static_cast<Worker *>(data);
+  base::Tracer::set_thread_name("MySQLDumper");
+  worker->dumper->run_worker(worker->mysql);
+  return nullptr;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void MySQLDumper::run_worker(MYSQL *mysql) {
+  while (!_failed) {
+    Chunk *chunk;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (_next_chunk >= _chunks.size())
+        break;
+      chunk = _chunks[_next_chunk++].get();
+    }
+
+    try {
+      dump_chunk(mysql, *chunk);
+    } catch (std::exception &exc) {
+      report_failure(*chunk->table, exc.what());
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void MySQLDumper::dump_chunk(MYSQL *mysql, Chunk &chunk) {
+  Table &table = *chunk.table;
+  Output &output = *_outputs[table.output];
+
+  TRACE_ZONE(base::Tracer::is_enabled() ? base::Tracer::intern(table.schema + "." + table.name) : nullptr);
+
+  if (!table.started.exchange(true)) {
+    table.start_time = time(nullptr);
+    printf("BEGIN:%s.%s:Dumping approximately %lli rows from table %s.%s\n", table.schema.c_str(),
+           table.name.c_str(), table.estimated_rows, table.schema.c_str(), table.name.c_str());
+    fflush(stdout);
+  }
+
+  // Write straight into the output if everything before this chunk is written already.
+  bool direct = false;
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    flush_output(output, lock);
+    if (!output.busy && output.next_segment < output.segments.size() &&
+        output.segments[output.next_segment].chunk == &chunk) {
+      output.busy = true;
+      direct = true;
+    }
+  }
+
+  FILE *file = direct ? output.file : base_fopen(chunk.temp_file.c_str(), "wb");
+  if (file == nullptr)
+    throw std::runtime_error("Could not create temporary dump file " + chunk.temp_file + ": " + strerror(errno));
+
+  std::string q = "SELECT " + table.column_list + " FROM " + quote_identifier(table.schema) + "." +
+                  quote_identifier(table.name);
+  if (!chunk.where.empty())
+    q += " WHERE " + chunk.where;
+
+  bool write_failed = false;
+  long long rows = 0;
+  std::string error;
+  if (mysql_real_query(mysql, q.data(), (unsigned long)q.length()) != 0)
+    error = q + ": " + mysql_error(mysql);
+  else {
+    MYSQL_RES *result = mysql_use_result(mysql);
+    if (result == nullptr)
+      error = q + ": " + mysql_error(mysql);
+    else {
+      enum ValueKind { Number, Binary, Text };
+
+      unsigned int field_count = mysql_num_fields(result);
+      MYSQL_FIELD *fields = mysql_fetch_fields(result);
+      std::vector<ValueKind> kinds;
+      for (unsigned int i = 0; i < field_count; ++i) {
+        switch (fields[i].type) {
+          case MYSQL_TYPE_DECIMAL:
+          case MYSQL_TYPE_NEWDECIMAL:
+          case MYSQL_TYPE_TINY:
+          case MYSQL_TYPE_SHORT:
+          case MYSQL_TYPE_LONG:
+          case MYSQL_TYPE_INT24:
+          case MYSQL_TYPE_LONGLONG:
+          case MYSQL_TYPE_FLOAT:
+          case MYSQL_TYPE_DOUBLE:
+          case MYSQL_TYPE_YEAR:
+            kinds.push_back(Number);
+            break;
+          case MYSQL_TYPE_BIT:
+          case MYSQL_TYPE_GEOMETRY:
+            kinds.push_back(Binary);
+            break;
+          case MYSQL_TYPE_STRING:
+          case MYSQL_TYPE_VAR_STRING:
+          case MYSQL_TYPE_VARCHAR:
+          case MYSQL_TYPE_TINY_BLOB:
+          case MYSQL_TYPE_MEDIUM_BLOB:
+          case MYSQL_TYPE_LONG_BLOB:
+          case MYSQL_TYPE_BLOB:
+            // Binary data is written as hex literal, which survives any charset conversion.
+            kinds.push_back(fields[i].charsetnr == 63 ? Binary : Text);
+            break;
+          default: // Temporal values, JSON, ENUM, SET.
+            kinds.push_back(Text);
+            break;
+        }
+      }
+
+      std::string prefix = "INSERT INTO " + quote_identifier(table.name) + " (" + table.column_list + ") VALUES ";
+      std::string statement;
+      std::vector<char> escaped;
+      static const char *hex_digits = "0123456789ABCDEF";
+
+      MYSQL_ROW row;
+      while (!_failed && (row = mysql_fetch_row(result)) != nullptr) {
+        unsigned long *lengths = mysql_fetch_lengths(result);
+
+        statement += statement.empty() ? prefix + "(" : ",(";
+        for (unsigned int i = 0; i < field_count; ++i) {
+          if (i > 0)
+            statement += ',';
+          if (row[i] == nullptr)
+            statement += "NULL";
+          else if (kinds[i] == Number)
+            statement.append(row[i], lengths[i]);
+          else if (kinds[i] == Binary) {
+            if (lengths[i] == 0)
+              statement += "''";
+            else {
+              statement += "0x";
+              for (unsigned long j = 0; j < lengths[i]; ++j) {
+                unsigned char c = (unsigned char)row[i][j];
+                statement += hex_digits[c >> 4];
+                statement += hex_digits[c & 0x0F];
+              }
+            }
+          } else {
+            escaped.resize(lengths[i] * 2 + 1);
+            unsigned long length = mysql_real_escape_string(mysql, escaped.data(), row[i], lengths[i]);
+            statement += '\'';
+            statement.append(escaped.data(), length);
+            statement += '\'';
+          }
+        }
+        statement += ')';
+        ++rows;
+
+        if (statement.size() >= _options.max_insert_size) {
+          statement += ";\n";
+          write_failed = !write_all(file, statement) || write_failed;
+          statement.clear();
+
+          long long total = (table.rows_dumped += rows);
+          rows = 0;
+          if (_options.show_progress) {
+            printf("PROGRESS:%s.%s:%lli:%lli\n", table.schema.c_str(), table.name.c_str(), total,
+                   std::max(total, table.estimated_rows));
+            fflush(stdout);
+          }
+        }
+      }
+
+      if (mysql_errno(mysql) != 0)
+        error = q + ": " + mysql_error(mysql);
+
+      if (!statement.empty()) {
+        statement += ";\n";
+        write_failed = !write_all(file, statement) || write_failed;
+      }
+      mysql_free_result(result);
+    }
+  }
+  table.rows_dumped += rows;
+
+  if (write_failed && error.empty())
+    error = std::string("Error writing dump file: ") + strerror(errno);
+
+  if (direct) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    output.busy = false;
+    if (error.empty()) {
+      chunk.done = true;
+      ++output.next_segment;
+      flush_output(output, lock);
+    }
+  } else {
+    if (fclose(file) != 0 && error.empty())
+      error = std::string("Error writing temporary dump file: ") + strerror(errno);
+    if (error.empty()) {
+      std::unique_lock<std::mutex> lock(_mutex);
+      chunk.done = true;
+      flush_output(output, lock);
+    }
+  }
+
+  if (!error.empty())
+    throw std::runtime_error(error);
+
+  if (--table.chunks_left == 0) {
+    time_t duration = time(nullptr) - table.start_time;
+    long long total = table.rows_dumped;
+    if (_options.show_progress) {
+      printf("PROGRESS:%s.%s:%lli:%lli\n", table.schema.c_str(), table.name.c_str(), total, total);
+    }
+    printf("END:%s.%s:Finished dumping %lli rows in %im%02is\n", table.schema.c_str(), table.name.c_str(), total,
+           (int)(duration / 60), (int)(duration % 60));
+    fflush(stdout);
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Writes all segments of the output which are ready, in order. Must be called with _mutex locked.
+ * Copying the temporary file of a chunk happens without holding the lock, while the output is marked busy.
+ */
+void MySQLDumper::flush_output(Output &output, std::unique_lock<std::mutex> &lock) {
+  while (!output.busy && !_failed && output.next_segment < output.segments.size()) {
+    Segment &segment = output.segments[output.next_segment];
+    if (segment.chunk == nullptr) {
+      if (!write_all(output.file, segment.text)) {
+        _failed = true;
+        _error = "Error writing dump file " + output.path + ": " + strerror(errno);
+        return;
+      }
+      ++output.next_segment;
+      continue;
+    }
+
+    if (!segment.chunk->done)
+      break;
+
+    output.busy = true;
+    lock.unlock();
+    std::string error;
+    try {
+      append_file(output.file, segment.chunk->temp_file);
+    } catch (std::exception &exc) {
+      error = exc.what();
+    }
+    lock.lock();
+    output.busy = false;
+
+    if (!error.empty()) {
+      _failed = true;
+      _error = error;
+      return;
+    }
+    ++output.next_segment;
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void MySQLDumper::report_failure(const Table &table, const std::string &error) {
+  logError("Error dumping table %s.%s: %s\n", table.schema.c_str(), table.name.c_str(), error.c_str());
+  printf("ERROR:%s.%s:%s\n", table.schema.c_str(), table.name.c_str(), error.c_str());
+  fflush(stdout);
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  if (_error.empty())
+    _error = "Error dumping table " + table.schema + "." + table.name + ": " + error;
+  _failed = true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void MySQLDumper::cleanup_temp_files() {
+  for (auto &chunk : _chunks) {
+    if (base::file_exists(chunk->temp_file))
+      base::tryRemove(chunk->temp_file);
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2020, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "copytable.h"
+
+struct DumpOptions {
+  std::string output_path; // A folder (one file per table) or a file (single_file).
+  bool single_file;
+  bool dump_structure;
+  bool dump_data;
+  bool dump_triggers;
+  bool include_schema;      // Add CREATE DATABASE statements.
+  bool consistent_snapshot; // All connections read from the same snapshot.
+  long long chunk_rows;     // Tables with more (estimated) rows are split into chunks of roughly this size.
+  size_t max_insert_size;   // Maximum length of a single extended INSERT statement.
+  int thread_count;
+  bool show_progress;
+
+  DumpOptions()
+    : single_file(false),
+      dump_structure(true),
+      dump_data(true),
+      dump_triggers(true),
+      include_schema(false),
+      consistent_snapshot(true),
+      chunk_rows(500000),
+      max_insert_size(1024 * 1024),
+      thread_count(1),
+      show_progress(false) {
+  }
+};
+
+/**
+ * Writes a logical dump of a list of tables, loadable with the mysql client just like the output of mysqldump.
+ *
+ * The dump is done over thread_count connections which read from the same consistent snapshot (synchronized via
+ * FLUSH TABLES WITH READ LOCK, if the user has the privilege for it). Large tables with an integer primary key are
+ * split into primary key ranges, so that several connections can dump the same table at the same time.
+ * Each chunk is written either directly into its output file (if all data before it has been written already)
+ * or into a temporary file, which is appended to the output at its position once everything before it is done.
+ * That keeps the output ordered, regardless of the order in which chunks finish.
+ */
+class MySQLDumper {
+public:
+  MySQLDumper(const std::string &hostname, int port, const std::string &username, const std::string &password,
+              const std::string &socket, bool use_cleartext_plugin, unsigned int connection_timeout,
+              const DumpOptions &options);
+  ~MySQLDumper();
+
+  void add_table(const std::string &schema, const std::string &table);
+
+  // Runs the dump, throws on failure.
+  void dump();
+
+private:
+  struct Table;
+
+  struct Chunk {
+    Table *table;
+    size_t index;
+    std::string where;
+    std::string temp_file;
+    bool done;
+  };
+
+  struct Table {
+    std::string schema;
+    std::string name;
+    std::string create_statement;
+    std::string column_list;
+    std::string key_column; // Integer (primary) key used to split the table into chunks, if any.
+    std::vector<std::string> triggers;
+    long long estimated_rows;
+    size_t output;
+
+    std::atomic<long long> rows_dumped;
+    std::atomic<int> chunks_left;
+    std::atomic<bool> started;
+    time_t start_time;
+
+    Table() : estimated_rows(0), output(0), rows_dumped(0), chunks_left(0), started(false), start_time(0) {
+    }
+  };
+
+  struct Segment {
+    std::string text;
+    Chunk *chunk; // nullptr for plain text.
+  };
+
+  struct Worker {
+    MySQLDumper *dumper;
+    MYSQL *mysql;
+    GThread *thread;
+  };
+
+  struct Output {
+    std::string path;
+    FILE *file;
+    std::vector<Segment> segments;
+    size_t next_segment;
+    bool busy; // Somebody is writing to the file without holding the lock.
+  };
+
+  std::string _hostname;
+  int _port;
+  std::string _username;
+  std::string _password;
+  std::string _socket;
+  bool _use_cleartext_plugin;
+  unsigned int _connection_timeout;
+  DumpOptions _options;
+
+  std::string _charset;
+  std::string _server_version;
+
+  std::vector<std::unique_ptr<Table> > _tables;
+  std::vector<std::unique_ptr<Chunk> > _chunks;
+  std::vector<std::unique_ptr<Output> > _outputs;
+  std::vector<Worker> _workers;
+
+  std::mutex _mutex;
+  size_t _next_chunk;
+  std::atomic<bool> _failed;
+  std::string _error;
+
+  static gpointer thread_func(gpointer data);
+
+  MYSQL *connect();
+  void execute(MYSQL *mysql, const std::string &query);
+  std::vector<std::vector<std::string> > query(MYSQL *mysql, const std::string &query);
+
+  void load_table_info(MYSQL *mysql, Table &table);
+  void plan_chunks(MYSQL *mysql, Table &table);
+  void plan_outputs(MYSQL *mysql);
+
+  std::string file_header(const std::string &schema);
+  std::string file_footer();
+  std::string schema_header(MYSQL *mysql, const std::string &schema);
+  std::string table_structure(const Table &table);
+  std::string table_triggers(const Table &table);
+
+  void disconnect_all();
+  void run_worker(MYSQL *mysql);
+  void dump_chunk(MYSQL *mysql, Chunk &chunk);
+  void flush_output(Output &output, std::unique_lock<std::mutex> &lock);
+  void report_failure(const Table &table, const std::string &error);
+  void cleanup_temp_files();
+};
@@ -25,7 +25,6 @@ import threading
 import time
 import Queue
 import StringIO
-import traceback
 
 from workbench.utils import Version
 from workbench.db_utils import MySQLConnection, MySQLError, QueryError, strip_password, escape_sql_string
@@ -212,6 +211,8 @@ class WbAdminControl(object):
         self.status_variables = {} # 1st time is updated by us and then in a fixed interval by the monitoring thread
         self.status_variables_time = None
         self.status_variable_poll_interval = 3
+        self.status_sample_interval = 0.5 # how often the native sampler queries the server, in seconds
+        self.status_sampler = None
 
         # Sets the default logging callback
         self.log_cb = self.raw_log
@@ -553,37 +554,57 @@ uses_ssh: %i uses_wmi: %i\n""" % (self.server_profile.uses_ssh, self.server_prof
 
     #---------------------------------------------------------------------------
     def server_polling_thread(self):
-        try:
-            password = self.get_mysql_password()
-            self.poll_connection = MySQLConnection(self.server_profile.db_connection_params, password=password)
-            self.poll_connection.connect()
-        except MySQLError, err:
-            log_error("Error creating SQL connection for monitoring: %r\n" % err)
-            self.poll_connection = None
-            mforms.Utilities.driver_shutdown()
+        # Sampling itself runs in native code on its own connection and thread (see DbMySQLQuery.openStatusSampler),
+        # this thread only publishes the latest values as a dict for the pages that want them that way.
+        password = self.get_mysql_password()
+        sampler = grt.modules.DbMySQLQuery.openStatusSampler(self.server_profile.db_connection_params, password, self.status_sample_interval)
+        if sampler < 0:
+            log_error("Error creating SQL connection for monitoring: %s\n" % grt.modules.DbMySQLQuery.lastError())
             return None
+        self.status_sampler = sampler
 
         log_debug("Monitoring thread running...\n")
-        time.sleep(self.status_variable_poll_interval)
         try:
-            # runs in a separate thread to fetch status variables
             while self.running:
-                log_debug3("Poll server status\n")
-                variables = {}
-                result = self.poll_connection.executeQuery("SHOW GLOBAL STATUS")
-                while result and result.nextRow():
-                    variables[result.stringByName("Variable_name")] = result.stringByName("Value")
+                error = grt.modules.DbMySQLQuery.statusSamplerError(sampler)
+                if error:
+                    log_error("Error in monitoring thread: %s\n" % error)
+                    break
 
-                self.status_variables, self.status_variables_time = variables, time.time()
+                timestamp = grt.modules.DbMySQLQuery.statusSamplerTime(sampler)
+                if timestamp and timestamp != self.status_variables_time:
+                    log_debug3("Poll server status\n")
+                    self.status_variables, self.status_variables_time = dict(grt.modules.DbMySQLQuery.statusSamplerVariables(sampler)), timestamp
 
                 time.sleep(self.status_variable_poll_interval)
-        except QueryError:
-            log_error("Error in monitoring thread: %s\n" % traceback.format_exc())
+        finally:
+            self.status_sampler = None
+            grt.modules.DbMySQLQuery.closeStatusSampler(sampler)
 
         log_debug("Monitoring thread done.\n")
-        self.poll_connection.disconnect()
-        self.poll_connection = None
-        mforms.Utilities.driver_shutdown()
+
+    #---------------------------------------------------------------------------
+    def status_values(self, names):
+        """Returns the last sampled values of the given status variables as a list of floats, or None if the sampler isn't running."""
+        sampler = self.status_sampler
+        if sampler is None or not names:
+            return None
+        try:
+            return list(grt.modules.DbMySQLQuery.statusSamplerValues(sampler, names))
+        except SystemError:
+            # the sampler was closed in the meantime
+            return None
+
+    #---------------------------------------------------------------------------
+    def status_rates(self, names, window):
+        """Returns a dict with the change per second of the given status variables over the last window seconds, or None if the sampler isn't running."""
+        sampler = self.status_sampler
+        if sampler is None or not names:
+            return None
+        try:
+            return dict(zip(names, grt.modules.DbMySQLQuery.statusSamplerRates(sampler, names, window)))
+        except SystemError:
+            return None
 
     #---------------------------------------------------------------------------
     def get_mysql_password(self):
@@ -76,6 +76,17 @@ Methods:
                        of the current records in the existent log set (if
                        available). E.g. 'Records 1..50 of 145'
 
+File based readers additionally implement:
+
+    seek_time(ts):     Returns the records starting at the first one logged at
+                       or after the given time (seconds since the epoch).
+
+    time_range(s, e):  Returns the (first, end) indexes of the records logged
+                       between two times.
+
+    search(text):      Returns the records starting at the next one that contains
+                       the given text or None if there is none.
+
 
     refresh():         After calling this function the log reader should be able
                        to manage new log entries that were added since the last
@@ -97,6 +108,8 @@ Current limitations:
 
 import re
 
+import grt
+
 from workbench.log import log_info, log_error, log_warning
 
 from wb_server_management import SudoTailInputFile, LocalInputFile, SFTPInputFile
@@ -285,8 +298,20 @@ class BaseLogFileReader(object):
     '''
         The base class for logs stored in files unreadable to the current user.
 
+        The records of the file are located with a native index (see openLogIndex() in the Utilities
+        module) which is built with a single pass over the file and updated incrementally as the file
+        grows. Pages, time stamps and text searches are then served from the record offsets in it.
+
         **This is not intended for direct instantiation.**
         '''
+    # the log format for the index: 0 = error log, 1 = general query log, 2 = slow query log
+    index_format = None
+    # the maximum number of records in a page
+    page_size = 1000
+    # files that are not local are read with the server helpers, only their most recent part is indexed
+    remote_index_limit = 64 * 1024 * 1024
+    remote_block_size = 1024 * 1024
+
     def __init__(self, ctrl_be, log_file_param, pat, chunk_size, truncate_long_lines, append_gaps=True):
         """Constructor
 
@@ -296,7 +321,7 @@ class BaseLogFileReader(object):
             :type log_file_param: str/file
             :param pat: A regular expression pattern that matches a log entry
             :type pat: regular expression object
-            :param chunk_size: The size in bytes of the chunks that are read from the log file
+            :param chunk_size: The maximum size in bytes of a page of records read from the log file
             :type chunk_size: int
             :param truncate_long_lines: Whether the log entries that are long should be abbreviated
             :type truncate_long_lines: bool
@@ -391,28 +416,43 @@ class BaseLogFileReader(object):
             self.file_size = self.log_file.size
 
         self.chunk_size = chunk_size
-        # chunk_start is the start of the chunk to be read (ie, we start reading from the end of the file, so we get the last page starting from there)
-        self.chunk_start = max(0, self.file_size - chunk_size)
-        self.chunk_end = self.file_size
 
-        self.record_count = 0
+        self.index = None
+        self.index_start = None
+        self.indexed_locally = isinstance(self.log_file, LocalInputFile)
+        if not use_event_viewer:
+            self.index = grt.modules.Utilities.openLogIndex(self.index_format)
+            if not self.indexed_locally and self.file_size > self.remote_index_limit:
+                self.partial_support = 'Only the most recent %s of this log file are shown.' % self._format_size(self.remote_index_limit)
 
+        self.record_count = 0
+        # the current page as a range of records, None to show the most recent ones once the index is updated
+        self.page_first = None
+        self.page_end = 0
 
+    def __del__(self):
+        if getattr(self, 'index', None) is not None:
+            try:
+                grt.modules.Utilities.closeLogIndex(self.index)
+            except SystemError:
+                pass
 
     def has_previous(self):
         '''
-            If there is a previous chunk that can be read.
+            If there is a previous page that can be read.
             '''
-        return self.chunk_start > 0
+        return bool(self.page_first)
 
     def has_next(self):
         '''
-            If there is a next chunk that can be read.
+            If there is a next page that can be read.
             '''
-        return self.chunk_end != self.file_size
+        return self.page_first is not None and self.page_end < self.record_count
 
     def range_text(self):
-        return '%s records starting at byte offset %s' % (self.record_count, self.chunk_start)
+        if self.page_first is None or self.page_end <= self.page_first:
+            return 'No records'
+        return 'Records %d..%d of %d' % (self.page_first + 1, self.page_end, self.record_count)
 
     def size_text(self):
         return self._format_size(self.file_size)
@@ -434,12 +474,6 @@ class BaseLogFileReader(object):
                 return '%.1f %s' % (bytes/units[idx-1][0], units[idx-1][1])
         return '%.1f %s' % (bytes/units[-1][0], units[-1][1])
 
-    def _get_offset_to_first_record(self, data):
-        match = self.pat.search(data)
-        if match:
-            return match.start()
-        return 0
-
     def _extract_record(self, found):
         return list(found.groups())
 
@@ -451,8 +485,6 @@ class BaseLogFileReader(object):
         found = self.pat2.search(data)
         if found:
             end = found.start()
-            if self.chunk_start > 0:  # optional?
-                self.chunk_start += end
         while found:
             start = found.start()
             if start-end > 1 and self.append_gaps:  # there's a gap between occurrences of the pattern
@@ -468,7 +500,6 @@ class BaseLogFileReader(object):
             if self.truncate_long_lines:
                 records[-1][-1] = self._shorten_query_field(records[-1][-1])  # now shorten the last record
 
-        self.record_count = len(records)
         return records
 
     def _shorten_query_field(self, data):
@@ -485,66 +516,162 @@ class BaseLogFileReader(object):
         return abbr if l <= 256 else abbr + ' [truncated, %s total]' % size
 
 
+    def _get_range(self, start, end):
+        data = self.log_file.get_range(start, end)
+        if not isinstance(data, str):
+            raise IOError('Could not read from the log file %s' % self.log_file.path)
+        return data
+
+    def _update_index(self):
+        '''
+            Indexes what was added to the log file since the last update. Local files are read by the
+            index itself, other files are read in blocks here and passed to the index.
+            '''
+        utilities = grt.modules.Utilities
+        try:
+            if self.indexed_locally:
+                self.record_count = utilities.updateLogIndex(self.index, self.log_file.path)
+                self.file_size = utilities.logIndexSize(self.index)
+            else:
+                indexed = utilities.logIndexSize(self.index)
+                if self.index_start is None or self.file_size < indexed:  # not indexed yet or rotated
+                    self.index_start = max(0, self.file_size - self.remote_index_limit)
+                    utilities.resetLogIndex(self.index, float(self.index_start))
+                    indexed = self.index_start
+                while indexed < self.file_size:
+                    data = self._get_range(indexed, min(self.file_size, indexed + self.remote_block_size))
+                    if not data:
+                        break
+                    self.record_count = utilities.feedLogIndex(self.index, data)
+                    indexed += len(data)
+                self.record_count = utilities.logIndexRecordCount(self.index)
+        except SystemError, error:
+            raise IOError('Could not index the log file %s: %s' % (self.log_file.path, error))
+
+        if self.page_first is not None and self.page_first >= self.record_count:
+            self.page_first = None
+
+    def _set_page(self, record, backwards=False):
+        page = grt.modules.Utilities.logIndexPage(self.index, record, self.page_size, float(self.chunk_size), 1 if backwards else 0)
+        self.page_first, self.page_end = page[0], page[1]
+
+    def _read_page(self):
+        if self.page_end <= self.page_first:
+            return []
+        offsets = grt.modules.Utilities.logIndexRecordRange(self.index, self.page_first, self.page_end)
+        return self._parse_chunk(self._get_range(offsets[0], offsets[1]))
+
+    def _find_records(self, text, first, count):
+        '''
+            Returns the indexes of at most count records containing text, starting at the first one.
+            '''
+        utilities = grt.modules.Utilities
+        try:
+            if self.indexed_locally:
+                return list(utilities.searchLogIndexFile(self.index, self.log_file.path, text, first, count))
+
+            found = []
+            while first < self.record_count and len(found) < count:
+                page = utilities.logIndexPage(self.index, first, self.record_count, float(self.remote_block_size), 0)
+                offsets = utilities.logIndexRecordRange(self.index, page[0], page[1])
+                found.extend(utilities.searchLogIndexData(self.index, self._get_range(offsets[0], offsets[1]), float(offsets[0]), text, count - len(found)))
+                first = page[1]
+            return found
+        except SystemError, error:
+            raise IOError('Could not search the log file %s: %s' % (self.log_file.path, error))
+
     def current(self):
         '''
-            Returns a list with the records in the current chunk.
+            Returns a list with the records in the current page.
             Each record is a list with the values for each column of
             the corresponding log entry.
             '''
-        data = self.log_file.get_range(self.chunk_start, self.chunk_end)
-        if self.chunk_start > self.chunk_size / 10:
-            # adjust the start of the current chunk to the start of the 1st record (if we're not too close to the top)
-            offset = self._get_offset_to_first_record(data)
-            self.chunk_start += offset
-        else:
-            offset = 0
-        return self._parse_chunk(data[offset:])
+        if self.index is None:
+            return []
+        self._update_index()
+        if self.page_first is None:
+            self._set_page(self.record_count, backwards=True)
+        return self._read_page()
 
     def previous(self):
         '''
-            Returns a list with the records in the previous chunk.
+            Returns a list with the records in the previous page.
             Each record is a list with the values for each column of
             the corresponding log entry.
             '''
-        if self.chunk_start == 0:
+        if not self.page_first:
             return []
-        self.chunk_end = self.chunk_start
-        self.chunk_start = max(0, self.chunk_start - self.chunk_size)
-        return self.current()
+        self._set_page(self.page_first, backwards=True)
+        return self._read_page()
     
     def next(self):
         '''
-            Returns a list with the records in the next chunk.
+            Returns a list with the records in the next page.
             Each record is a list with the values for each column of
             the corresponding log entry.
             '''
-        if self.chunk_end == self.file_size:
+        if not self.has_next():
             return []
-        self.chunk_start = self.chunk_end
-        self.chunk_end = min(self.chunk_start + self.chunk_size, self.file_size)
-        return self.current()
+        self._set_page(self.page_end)
+        return self._read_page()
     
     def first(self):
         '''
-            Returns a list with the records in the first chunk
+            Returns a list with the records in the first page
             '''
-        self.chunk_start = 0
-        self.chunk_end = self.chunk_size
-        return self.current()
+        self._update_index()
+        self._set_page(0)
+        return self._read_page()
     
     def last(self):
         '''
-            Returns a list with the records in the first chunk
+            Returns a list with the records in the last page
+            '''
+        self._update_index()
+        self._set_page(self.record_count, backwards=True)
+        return self._read_page()
+
+    def seek_time(self, timestamp):
+        '''
+            Returns a list with the records in the page starting at the first record
+            logged at or after the given time (seconds since the epoch)
+            '''
+        self._update_index()
+        record = grt.modules.Utilities.logIndexFindTime(self.index, float(timestamp))
+        if record >= self.record_count:
+            return self.last()
+        self._set_page(record)
+        return self._read_page()
+
+    def time_range(self, start, end):
+        '''
+            Returns the range (first, end) of the records logged between the given
+            times (seconds since the epoch)
             '''
-        self.chunk_start = max(0, self.file_size - self.chunk_size)
-        self.chunk_end = self.file_size
-        return self.current()
+        self._update_index()
+        utilities = grt.modules.Utilities
+        return (utilities.logIndexFindTime(self.index, float(start)), utilities.logIndexFindTime(self.index, float(end)))
+
+    def search(self, text, start_record=None):
+        '''
+            Looks for the next record containing text (ignoring case), by default starting
+            after the first record of the current page. Returns a list with the records in the
+            page starting at the record found or None if there is none.
+            '''
+        self._update_index()
+        if start_record is None:
+            start_record = self.page_first + 1 if self.page_first is not None else 0
+        found = self._find_records(text, start_record, 1)
+        if not found:
+            return None
+        self._set_page(found[0])
+        return self._read_page()
 
     def refresh(self):
         '''
-            Checks if the log file has been updated since it was opened and if so
-            reopen the file again to keep going with the changes.
-            Warning: this function only supports appending to the log file.
+            Checks if the log file has been updated since it was opened. The new records
+            are indexed with the next page read, which will be the most recent one if
+            that was shown before.
             '''
         if self.log_file.path == "stderr":
             return
@@ -552,8 +679,8 @@ class BaseLogFileReader(object):
             new_size = self.log_file.size
             if new_size != self.file_size:
                 self.file_size = new_size
-                self.chunk_start = max(0, self.file_size - self.chunk_size)
-                self.chunk_end = self.file_size
+                if self.page_first is not None and self.page_end >= self.record_count:
+                    self.page_first = None
 
 
 #==============================================================================
@@ -562,6 +689,8 @@ class ErrorLogFileReader(BaseLogFileReader):
     This class enables the retrieval of log entries in a MySQL error
     log file.
     '''
+    index_format = 0
+
     def __init__(self, ctrl_be, file_name, chunk_size=64 * 1024, truncate_long_lines=True):
         # The error log is a mess, there are several different formats for each entry and a new one comes up every version
         mysql_56 = r'^(?P<v56>(\d{2,4}-\d{1,2}-\d{2} {1,2}\d{1,2}:\d{2}:\d{2}) (\d+) \[(.*)\] (.*?))$'
@@ -610,17 +739,6 @@ class ErrorLogFileReader(BaseLogFileReader):
         else:
             return ["", "", "", g[-1]]
 
-    def current(self):
-        records = super(ErrorLogFileReader, self).current()
-        if self.chunk_end < self.file_size:
-            # check if the last record is truncated
-            rec = records[-1]
-            if not any(f != "" for f in rec[:-1]):
-                # the last record wasn't recognized, it's probably truncated so leave it out of this chunk
-                self.chunk_end -= len(rec[-1])
-                del records[-1]
-        return records
-
 
 #==============================================================================
 class GeneralLogFileReader(BaseLogFileReader):
@@ -628,6 +746,8 @@ class GeneralLogFileReader(BaseLogFileReader):
     This class enables the retrieval of log entries in a MySQL general query
     log file.
     '''
+    index_format = 1
+
     def __init__(self, ctrl_be, file_name, chunk_size=64 * 1024, truncate_long_lines=True):
         pat = re.compile(r'^(?P<v57>(\d{2,4}-\d{1,2}-\d{2}T{1,2}\d{1,2}:\d{2}:\d{2}.\d+Z)[\t ]*(\d+)\s*(.*?)(?:\t+| {2,})(.*?))$|^(?P<v56>(\d{6} {1,2}\d{1,2}:\d{2}:\d{2}[\t ]+|[\t ]+)(\s*\d+)(\s*.*?)(?:\t+| {2,})(.*?))$', re.M)
 
@@ -656,6 +776,8 @@ class SlowLogFileReader(BaseLogFileReader):
     This class enables the retrieval of log entries in a MySQL slow query
     log file.
     '''
+    index_format = 2
+
     def __init__(self, ctrl_be, file_name, chunk_size=64 * 1024, truncate_long_lines=True, append_gaps=False):
         mysql_57 = r'(?:^|\n)(?P<v57># Time: (\d{2,4}-\d{1,2}-\d{2}T{1,2}\d{1,2}:\d{2}:\d{2}.\d+Z).*?\n# User@Host: (.*?)\n# Query_time: +([0-9.]+) +Lock_time: +([\d.]+) +Rows_sent: +(\d+) +Rows_examined: +(\d+)\s*\n(.*?)(?=\n# |\n[^\n]+, Version: |$))'
         mysql_56 = r'(?:^|\n)(?P<v56># Time: (\d{6} {1,2}\d{1,2}:\d{2}:\d{2}).*?\n# User@Host: (.*?)\n# Query_time: +([0-9.]+) +Lock_time: +([\d.]+) +Rows_sent: +(\d+) +Rows_examined: +(\d+)\s*\n(.*?)(?=\n# |\n[^\n]+, Version: |$))'
@@ -99,6 +99,7 @@ class DBStatusDataSource(DataSource):
         self.mon_be = mon_be
         self.sources = {}
         self.rev_sources = {}
+        self.variable_names = [] # keys of rev_sources, in a fixed order for fetching their values in one go
         log_debug2('DBStatusDataSource created.\n')
 
     def add_source(self, name, definition, widget):
@@ -124,6 +125,7 @@ class DBStatusDataSource(DataSource):
             else:
                 rev_src = []
                 self.rev_sources[status_variable_name] = rev_src
+                self.variable_names.append(status_variable_name)
             rev_src.append((src, i))
 
         if 'min' in definition and 'max' in definition:
@@ -131,15 +133,19 @@ class DBStatusDataSource(DataSource):
 
     def poll(self):
         #log_debug3('%s:%s.poll()' % (_this_file, self.__class__.__name__), 'DBStatusDataSource poll.\n')
-        if self.ctrl_be.status_variables:
-            # update monitor stuff
-            for name in self.rev_sources:
-                rev_src = self.rev_sources[name]
-                value = float(self.ctrl_be.status_variables[name])
-                # rev_src contains list of sources and index of current variable in the sources
-                for (src, i) in rev_src:
-                    src.set_var(i, value)
-                    src.calculate()
+        # The native sampler has the latest values already parsed, fall back to the dict if it isn't running.
+        values = self.ctrl_be.status_values(self.variable_names)
+        if values is None:
+            if not self.ctrl_be.status_variables:
+                return
+            values = [float(self.ctrl_be.status_variables[name]) for name in self.variable_names]
+
+        # update monitor stuff
+        for name, value in zip(self.variable_names, values):
+            # rev_src contains list of sources and index of current variable in the sources
+            for (src, i) in self.rev_sources[name]:
+                src.set_var(i, value)
+                src.calculate()
 
 #===============================================================================
 class ShellDataSource(DataSource):
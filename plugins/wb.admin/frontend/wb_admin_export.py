@@ -102,6 +102,21 @@ def get_path_to_mysqldump():
         return None
 
 
+def get_path_to_wbcopytables():
+    """get path to the wbcopytables tool, which contains the native (parallel) dump engine"""
+    if sys.platform == "win32":
+        path = mforms.App.get().get_executable_path("wbcopytables.exe")
+    elif sys.platform == "darwin":
+        path = mforms.App.get().get_executable_path("wbcopytables")
+    else:
+        path = mforms.App.get().get_executable_path("wbcopytables-bin")
+        if not os.path.exists(path):
+            path = os.path.join(os.path.dirname(grt.root.wb.registry.appExecutablePath), "wbcopytables-bin")
+    if type(path) == unicode:
+        path = path.encode("utf8")
+    return path if os.path.exists(path) else None
+
+
 def get_mysqldump_version():
     path = get_path_to_mysqldump()
     if not path:
@@ -350,6 +365,96 @@ class DumpThread(threading.Thread):
         self.done = True
 
 
+class NativeDumpThread(DumpThread):
+    """Dumps tables with the native dump engine of wbcopytables, which dumps over several connections in parallel.
+    Views, routines and events (passed in operations) are still dumped by mysqldump afterwards."""
+    def __init__(self, command, operations, pwd, owner, log_queue, native_args, table_count, table_file):
+        DumpThread.__init__(self, command, operations, pwd, owner, log_queue)
+        self.native_args = native_args
+        self.table_count = table_count
+        self.table_file = table_file
+
+    def run_native_dump(self):
+        log_debug("Executing command: %s\n" % " ".join(self.native_args))
+        self.print_log_message("Running: " + " ".join(self.native_args))
+
+        if platform.system() == 'Windows':
+            info = subprocess.STARTUPINFO()
+            info.dwFlags |= _subprocess.STARTF_USESHOWWINDOW
+            info.wShowWindow = _subprocess.SW_HIDE
+            p1 = subprocess.Popen(self.native_args, stdin=subprocess.PIPE, stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                                  universal_newlines=True, startupinfo=info)
+        else:
+            p1 = subprocess.Popen(self.native_args, stdin=subprocess.PIPE, stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                                  universal_newlines=True, close_fds=True)
+        self.process_handle = p1
+
+        p1.stdin.write(self.pwd.encode("utf-8") if isinstance(self.pwd, unicode) else self.pwd)
+        p1.stdin.write("\n")
+        p1.stdin.close()
+
+        # schema.table -> fraction done
+        table_progress = {}
+        tables_done = 0
+        for line in iter(p1.stdout.readline, ""):
+            if self.abort_requested:
+                break
+            msgtype, _, msg = line.strip().partition(":")
+            if msgtype == "PROGRESS":
+                name, _, total = msg.rpartition(":")
+                name, _, current = name.rpartition(":")
+                try:
+                    table_progress[name] = min(1.0, float(current) / max(1, int(total)))
+                except ValueError:
+                    pass
+            elif msgtype == "BEGIN":
+                name, _, text = msg.partition(":")
+                table_progress[name] = 0.0
+                self.print_log_message(time.strftime(u'%X ') + text)
+            elif msgtype == "END":
+                name, _, text = msg.partition(":")
+                table_progress[name] = 1.0
+                tables_done += 1
+                self.status_text = "%i of %i exported." % (tables_done, self.table_count)
+                self.print_log_message(time.strftime(u'%X ') + text)
+            elif msgtype == "ERROR":
+                self.error_count += 1
+                self.print_log_message("Error: " + msg)
+            elif line.strip() and msgtype != "FINISHED":
+                if 'Access denied for user' in line:
+                    self.e = wb_common.InvalidPasswordError('Wrong username/password!')
+                self.print_log_message(line.strip())
+
+            if self.table_count:
+                self.progress = sum(table_progress.values()) / self.table_count
+
+        exitcode = p1.wait()
+        self.process_handle = None
+        os.remove(self.table_file)
+        if exitcode != 0 and not self.abort_requested:
+            log_warning("Dump task exited with code %s\n" % exitcode)
+            self.print_log_message("Operation failed with exitcode " + str(exitcode))
+            if not self.error_count:
+                self.error_count += 1
+
+    def run(self):
+        try:
+            self.progress = 0
+            self.run_native_dump()
+        except Exception, exc:
+            import traceback
+            traceback.print_exc()
+            self.error_count += 1
+            self.print_log_message(u"Error executing task %s" % exc)
+
+        if self.operations and not self.abort_requested and not self.e:
+            DumpThread.run(self)
+        else:
+            if not self.abort_requested:
+                self.progress = 1
+            self.done = True
+
+
 class TableListModel(object):
     def __init__(self):
         self.tables_by_schema = {}
@@ -528,6 +633,7 @@ class WbAdminSchemaListTab(mforms.Box):
             #self.dump_view_check = None
             self.dump_routines_check = None
             self.dump_events_check = None
+            self.native_dump_check = None
         else:
             self.filelabel = newLabel("All selected database objects will be exported into a single, self-contained file.")
             self.folderlabel = newLabel("Each table will be exported into a separate file. This allows a selective restore, but may be slower.")
@@ -546,6 +652,8 @@ class WbAdminSchemaListTab(mforms.Box):
             self.dump_routines_check.set_name("Dump Stored Procedures and Functions")
             self.dump_events_check = newCheckBox()
             self.dump_events_check.set_name("Dump Events")
+            self.native_dump_check = newCheckBox()
+            self.native_dump_check.set_name("Use Parallel Dump Engine")
 
         self.filelabel.set_enabled(False)
         self.filelabel.set_style(mforms.SmallStyle)
@@ -616,7 +724,7 @@ class WbAdminSchemaListTab(mforms.Box):
             export_options.set_name("Export Options")
             export_options.set_homogeneous(True)
             export_options.set_padding(4)
-            export_options.set_row_count(1)
+            export_options.set_row_count(2)
             export_options.set_column_count(2)
             export_options.set_row_spacing(2)
             export_options.set_column_spacing(2)
@@ -626,6 +734,8 @@ class WbAdminSchemaListTab(mforms.Box):
             export_options.add(self.single_transaction_check,0,1,0,1)
         if self.include_schema_check:
             export_options.add(self.include_schema_check,1,2,0,1)
+        if self.native_dump_check:
+            export_options.add(self.native_dump_check,0,2,1,2)
             
         if self.dump_routines_check:
             export_objects_opts.add(self.dump_routines_check,0,1,0,1)
@@ -754,6 +864,7 @@ class WbAdminSchemaListTab(mforms.Box):
             #self.dump_view_check.set_text("Dump Views")
             self.dump_routines_check.set_text("Dump Stored Procedures and Functions")
             self.dump_events_check.set_text("Dump Events")
+            self.native_dump_check.set_text("Dump Tables in Parallel over Several Connections (without mysqldump)")
 
             self.folderradio.set_text("Export to Dump Project Folder")
             self.export_button.set_text("Start Export")
@@ -1751,9 +1862,31 @@ class WbAdminExportTab(WbAdminSchemaListTab):
             self.progress_tab.set_start_enabled(True)
             return
 
+        use_native_dump = self.native_dump_check.get_active() and self.can_use_native_dump(conn)
+
         # assemble list of operations/command calls to be performed
         operations = []
-        if save_to_folder:
+        if use_native_dump:
+            # tables are dumped by the native engine, only views, routines and events are left for mysqldump
+            native_tables = []
+            include_schema = self.include_schema_check.get_active()
+            for schema, tables in schemas_to_dump:
+                views = [table for table in tables if self.table_list_model.is_view(schema, table)]
+                native_tables += [(schema, table) for table in tables if not self.table_list_model.is_view(schema, table)]
+                if views or dump_routines or dump_events:
+                    args = []
+                    if dump_routines:
+                        args.append("--routines")
+                    if dump_events:
+                        args.append("--events")
+                    if skip_column_statistics:
+                        args.append('--skip-column-statistics')
+                    if save_to_folder:
+                        make_pipe = lambda schema=schema: self.dump_to_folder(schema, "routines", include_schema)
+                    else:
+                        make_pipe = lambda schema=schema: self.append_to_file(schema)
+                    operations.append(self.ViewsRoutinesEventsDumpData(schema, views, args, make_pipe))
+        elif save_to_folder:
             if not os.path.exists(self.path):
                 try:
                     os.makedirs(self.path, mode=0700)
@@ -1946,11 +2079,69 @@ class WbAdminExportTab(WbAdminSchemaListTab):
         self.progress_tab.did_start()
         self.progress_tab.set_status("Export is running...")
 
-        self.dump_thread = DumpThread(cmd, operations, password, self, (self.progress_tab.logging_lock, self.progress_tab.log_queue))
+        if use_native_dump:
+            table_file, native_args = self.native_dump_args(conn, tunnel, native_tables, save_to_folder, skip_data, skip_table_structure, dump_triggers)
+            self.dump_thread = NativeDumpThread(cmd, operations, password, self, (self.progress_tab.logging_lock, self.progress_tab.log_queue),
+                                                native_args, len(native_tables), table_file)
+        else:
+            self.dump_thread = DumpThread(cmd, operations, password, self, (self.progress_tab.logging_lock, self.progress_tab.log_queue))
         self.dump_thread.is_import = False
         self.dump_thread.start()
         self._update_progress_tm = Utilities.add_timeout(float(0.4), self._update_progress)
 
+    def can_use_native_dump(self, conn):
+        if not get_path_to_wbcopytables():
+            self.print_log_message("The wbcopytables tool was not found, using mysqldump instead of the parallel dump engine")
+            return False
+        if conn.get("useSSL", 0) and (conn.get("sslCert", "") or conn.get("sslCA", "") or conn.get("sslKey", "")):
+            self.print_log_message("The parallel dump engine does not support SSL certificates, using mysqldump instead")
+            return False
+        return True
+
+    def native_dump_args(self, conn, tunnel, tables, save_to_folder, skip_data, skip_table_structure, dump_triggers):
+        """Returns the table list file and the command line for the native dump engine of wbcopytables."""
+        if self.server_profile.db_connection_params.driver.name == "MysqlNativeSocket":
+            source = "%s@::%s" % (conn["userName"], conn.get("socket", ""))
+        else:
+            host = tunnel.port and "127.0.0.1" or conn["hostName"] or "localhost"
+            port = tunnel.port or conn["port"] or 3306
+            source = "%s@%s:%s" % (conn["userName"], host, port)
+
+        dic = grt.root.wb.options.options
+        thread_count = dic.has_key("wb.admin.export:nativeDumpThreads") and dic["wb.admin.export:nativeDumpThreads"] or 4
+
+        fd, table_file = tempfile.mkstemp(suffix=".txt")
+        f = os.fdopen(fd, "w")
+        for schema, table in tables:
+            line = "%s\t%s\n" % (schema, table)
+            f.write(line.encode("utf-8") if isinstance(line, unicode) else line)
+        f.close()
+
+        args = [get_path_to_wbcopytables(), "--mysql-source=%s" % source, "--passwords-from-stdin", "--progress",
+                "--thread-count=%i" % thread_count, "--dump-to=%s" % self.path, "--table-file=%s" % table_file]
+        if not save_to_folder:
+            args.append("--dump-single-file")
+        if skip_data:
+            args.append("--dump-no-data")
+        if skip_table_structure:
+            args.append("--dump-no-create-info")
+        if not dump_triggers:
+            args.append("--dump-skip-triggers")
+        if self.include_schema_check.get_active():
+            args.append("--dump-include-schema")
+        if conn.get("OPT_ENABLE_CLEARTEXT_PLUGIN", ""):
+            args.append("--source-use-cleartext")
+        return table_file, [arg.encode("utf-8") if isinstance(arg, unicode) else arg for arg in args]
+
+    def append_to_file(self, schema):
+        # appends the mysqldump output for views and routines to the file written by the native dump engine
+        self.close_pipe()
+        self.out_pipe = open(self.path, "a")
+        use = "\nUSE `%s`;\n" % escape_sql_identifier(schema)
+        self.out_pipe.write(use.encode("utf-8") if isinstance(use, unicode) else use)
+        self.out_pipe.flush()
+        return self.out_pipe
+
     def _update_progress(self):
         r = self.update_progress()
         if not r:
@@ -2397,6 +2588,7 @@ class WbAdminExport(WbAdminTabBase):
             dic["wb.admin.export:dumpRoutines"] = self.export_tab.dump_routines_check.get_active()
             dic["wb.admin.export:dumpEvents"] = self.export_tab.dump_events_check.get_active()
             dic["wb.admin.export:dumpTriggers"] = self.export_tab.dump_triggers_check.get_active()
+            dic["wb.admin.export:nativeDump"] = self.export_tab.native_dump_check.get_active()
             dic["wb.admin.export:skipData"] = self.export_tab.dump_type_selector.get_selected_index()
             for key, value in self.get_export_options({}).items():
                 dic["wb.admin.export.option:"+key] = value
@@ -2421,6 +2613,8 @@ class WbAdminExport(WbAdminTabBase):
             self.export_tab.dump_events_check.set_active(dic["wb.admin.export:dumpEvents"] != 0)
         if dic.has_key("wb.admin.export:dumpTriggers"):
             self.export_tab.dump_triggers_check.set_active(dic["wb.admin.export:dumpTriggers"] != 0)
+        if dic.has_key("wb.admin.export:nativeDump"):
+            self.export_tab.native_dump_check.set_active(dic["wb.admin.export:nativeDump"] != 0)
         if dic.has_key("wb.admin.export:skipData"):
             self.export_tab.dump_type_selector.set_selected(dic["wb.admin.export:skipData"] != 0)
         values = {}
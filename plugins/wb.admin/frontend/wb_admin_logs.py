@@ -172,7 +172,8 @@ Use cases for the server logs
 """
 
 import grt
-from mforms import newBox, newLabel, newTreeView, newTabView, newButton
+import time
+from mforms import newBox, newLabel, newTreeView, newTabView, newButton, newTextEntry
 import mforms
 from wb_log_reader import GeneralQueryLogReader, SlowQueryLogReader, GeneralLogFileReader, SlowLogFileReader, ErrorLogFileReader
 import wb_admin_config_file_be
@@ -211,6 +212,7 @@ class LogView(mforms.Box):
         self.tree = None
         self.bbox = None
         self.warning_box = None
+        self.search_entry = None
         self.update_ui()
 
         self.worker = None
@@ -331,6 +333,32 @@ class LogView(mforms.Box):
         self._menu.add_item_with_title("Copy Details", self.copy_details, "Copy Details", "Copy Details")
         self.tree.set_context_menu(self._menu)
 
+        # file based logs are indexed and can be searched or positioned by time
+        self.search_entry = None
+        self.time_entry = None
+        if getattr(self.log_reader, 'index', None) is not None:
+            self.search_entry = newTextEntry(mforms.SearchEntry)
+            self.search_entry.set_size(160, -1)
+            self.search_entry.set_placeholder_text("Search")
+            self.search_entry.add_action_callback(self.search_action)
+            self.bbox.add(self.search_entry, False, True)
+
+            self.find_button = newButton()
+            self.find_button.set_text("Find Next")
+            self.bbox.add(self.find_button, False, True)
+            self.find_button.add_clicked_callback(self.go_find)
+
+            self.time_entry = newTextEntry()
+            self.time_entry.set_size(140, -1)
+            self.time_entry.set_placeholder_text("YYYY-MM-DD HH:MM:SS")
+            self.time_entry.add_action_callback(self.time_action)
+            self.bbox.add(self.time_entry, False, True)
+
+            self.time_button = newButton()
+            self.time_button.set_text("Go to Time")
+            self.bbox.add(self.time_button, False, True)
+            self.time_button.add_clicked_callback(self.go_time)
+
         self.bbox.add(newLabel(""), True, True)
 
         self.bof_button = newButton()
@@ -381,6 +409,45 @@ class LogView(mforms.Box):
         self.refresh(data)
         self.worker = None
 
+    def _disable_buttons(self):
+        self.bof_button.set_enabled(False)
+        self.back_button.set_enabled(False)
+        self.eof_button.set_enabled(False)
+        self.next_button.set_enabled(False)
+        self.refresh_button.set_enabled(False)
+        if self.search_entry:
+            self.find_button.set_enabled(False)
+            self.time_button.set_enabled(False)
+
+    def _enable_buttons(self):
+        self.bof_button.set_enabled(self.log_reader.has_previous())
+        self.back_button.set_enabled(self.log_reader.has_previous())
+        self.eof_button.set_enabled(self.log_reader.has_next())
+        self.next_button.set_enabled(self.log_reader.has_next())
+        self.refresh_button.set_enabled(True)
+        if self.search_entry:
+            self.find_button.set_enabled(True)
+            self.time_button.set_enabled(True)
+
+    def _run_in_worker(self, work, done):
+        # Searching and seeking may have to index megabytes of new log data first (fetched over SFTP for
+        # remote logs) and then scan the whole file, so they run in a thread like the page reads.
+        # done is called with the result of work back in the main thread.
+        if self.worker:
+            return
+        self._disable_buttons()
+        self.worker = WorkerThreadHelper(lambda out: out((work(),)),
+                                         lambda data: self._handle_worker_result(data, done))
+        self.worker.start(0.1)
+
+    def _handle_worker_result(self, data, done):
+        self.worker = None
+        if isinstance(data, Exception):
+            self._enable_buttons()
+            self._show_error(data)
+            return
+        done(data[0])
+
     def refresh(self, records=None):
         if self.log_reader:
             if self.log_reader.log_file and self.log_reader.log_file.path == "stderr":
@@ -396,11 +463,7 @@ class LogView(mforms.Box):
 
                 if records is None:
                     if not self.worker:
-                        self.bof_button.set_enabled(False)
-                        self.back_button.set_enabled(False)
-                        self.eof_button.set_enabled(False)
-                        self.next_button.set_enabled(False)
-                        self.refresh_button.set_enabled(False)
+                        self._disable_buttons()
                         # this will create a thread which will read the log data and once it finishes,
                         # self.refresh will be called with the data
                         self.worker = WorkerThreadHelper(self.read_data_worker, self.handle_worker_data)
@@ -413,11 +476,7 @@ class LogView(mforms.Box):
                         row.set_string(idx, col.strip())
                 self.range_label.set_text(self.log_reader.range_text())
                 self.size_label.set_text(self.log_reader.size_text())
-                self.bof_button.set_enabled(self.log_reader.has_previous())
-                self.back_button.set_enabled(self.log_reader.has_previous())
-                self.eof_button.set_enabled(self.log_reader.has_next())
-                self.next_button.set_enabled(self.log_reader.has_next())
-                self.refresh_button.set_enabled(True)
+                self._enable_buttons()
             except (ServerIOError, RuntimeError, LogFileAccessError, OperationCancelledError, InvalidPasswordError, IOError, ValueError), error:
                 self._show_error(error)
 
@@ -466,6 +525,41 @@ class LogView(mforms.Box):
         except (ServerIOError, RuntimeError, LogFileAccessError, OperationCancelledError, InvalidPasswordError, IOError, ValueError), error:
             self._show_error(error)
 
+    def search_action(self, action):
+        if action == mforms.EntryActivate:
+            self.go_find()
+
+    def go_find(self):
+        text = self.search_entry.get_string_value()
+        if not text:
+            return
+        def found(records):
+            if records is None:
+                self._enable_buttons()
+                mforms.Utilities.show_message("Search Log", "No more entries containing '%s' were found." % text, "OK", "", "")
+                return
+            self.refresh(records)
+        self._run_in_worker(lambda: self.log_reader.search(text), found)
+
+    def time_action(self, action):
+        if action == mforms.EntryActivate:
+            self.go_time()
+
+    def go_time(self):
+        text = self.time_entry.get_string_value().strip()
+        if not text:
+            return
+        for fmt in ("%Y-%m-%d %H:%M:%S", "%Y-%m-%d %H:%M", "%Y-%m-%d"):
+            try:
+                timestamp = time.mktime(time.strptime(text, fmt))
+                break
+            except ValueError:
+                pass
+        else:
+            mforms.Utilities.show_error("Go to Time", "'%s' is not a valid time, use the format YYYY-MM-DD HH:MM:SS." % text, "OK", "", "")
+            return
+        self._run_in_worker(lambda: self.log_reader.seek_time(timestamp), self.refresh)
+
 
 class LogViewGeneric(LogView):
     def __init__(self, owner, BackendLogReaderClass, *args):
@@ -206,9 +206,17 @@ class RenderBox(mforms.PyDrawBox):
                 self.tooltip.show_and_track(self, xx, yy, mforms.StartRight)
 
 
+class SampledValues(dict):
+    # Status variables together with the rates the native sampler computed for them, see CDifferencePerSecond.handle()
+    def __init__(self, values, rates):
+        dict.__init__(self, values)
+        self.rates = rates
+
+
 class CDifferencePerSecond(object):
     def __init__(self, expr):
         self.expr = expr
+        self.variables = re.findall(r"%\((\w+)\)s", expr) if expr else []
 
         self.reset()
 
@@ -228,6 +236,14 @@ class CDifferencePerSecond(object):
 
         if not self.expr:
             return result
+
+        rates = getattr(values, "rates", None)
+        if rates is not None:
+            # The expressions only add counters up, so they can be applied to the rates of the single counters.
+            try:
+                return eval(self.expr % rates)
+            except Exception, e:
+                return None
       
         try:
             value = eval(self.expr % values)
@@ -286,6 +302,12 @@ class CMakeTuple(object):
         self.items = items
 
 
+    def rate_variables(self):
+        l = []
+        for i in self.items:
+            l += rate_variables(i)
+        return l
+
     def handle(self, values, timestamp):
         l = []
         for i in self.items:
@@ -293,6 +315,14 @@ class CMakeTuple(object):
         return tuple(l)
 
 
+def rate_variables(calc):
+    if isinstance(calc, CDifferencePerSecond):
+        return calc.variables
+    if isinstance(calc, CMakeTuple):
+        return calc.rate_variables()
+    return []
+
+
 READ_COLOR = (60/255.0, 178/255.0, 191/255.0)
 WRITE_COLOR = (253/255.0, 138/255.0, 39/255.0)
 
@@ -723,6 +753,9 @@ class WbAdminDashboard(WbAdminTabBase):
 
             self.widgets.append(w)
 
+        # counters for which the differences per second are needed
+        self.rate_variables = sorted(set(sum((rate_variables(getattr(w, "calc", None)) for w in self.widgets), [])))
+
         self.updateColors(None, None, None)
         self.refresh()
         self._refresh_tm = mforms.Utilities.add_timeout(self.ctrl_be.status_variable_poll_interval, self.refresh)
@@ -765,9 +798,11 @@ class WbAdminDashboard(WbAdminTabBase):
     def refresh(self):
         status_variables, timestamp = self.ctrl_be.status_variables, self.ctrl_be.status_variables_time
         if self.last_refresh_time != timestamp:
+            rates = self.ctrl_be.status_rates(self.rate_variables, self.ctrl_be.status_variable_poll_interval)
+            data = SampledValues(status_variables, rates) if rates is not None else status_variables
             for w in self.widgets:
                 if hasattr(w, 'process'):
-                    w.process(status_variables, timestamp)
+                    w.process(data, timestamp)
 
             self.drawbox.variable_values.update(status_variables)
 
@@ -24,7 +24,7 @@ from __future__ import with_statement
 # import the mforms module for GUI stuff
 import mforms
 
-import sys, os, csv
+import sys, os, csv, re
 
 import datetime
 import json
@@ -37,6 +37,22 @@ from wb_common import to_unicode
 
 last_location = ""
 
+# The numeric field accessors of server resultsets read the leading number of the value text, like strtoll() and
+# strtod() do, and return 0 if there is none (e.g. for NULL).
+_leading_int = re.compile(r'\s*[-+]?\d+')
+_leading_float = re.compile(r'\s*[-+]?(\d+\.?\d*|\.\d+)([eE][-+]?\d+)?')
+
+def int_field_value(value):
+    match = _leading_int.match(value or '')
+    return int(match.group(0)) if match else 0
+
+def float_field_value(value):
+    match = _leading_float.match(value or '')
+    return float(match.group(0)) if match else 0.0
+
+def string_field_value(value):
+    return value if value is not None else ''
+
 def showPowerImport(editor, selection):
     importer = PowerImport(editor, mforms.Form.main_form(), selection)
     importer.set_title("Table Data Import")
@@ -99,6 +115,7 @@ class base_module:
         self._is_import = is_import
         self._current_row = 0
         self._max_rows = 0
+        self._fetch_batch_size = 1000
         self._thread_event = None
         self._user_query = None
         self._decimal_separator = ','
@@ -392,38 +409,47 @@ class csv_module(base_module):
                                         quotechar = self.options['encolsestring']['value'], quoting = csv.QUOTE_NONNUMERIC if self.options['encolsestring']['value'] else csv.QUOTE_NONE)
                     output.writerow([value['name'].encode('utf-8') for value in self._columns])
                     ok = rset.goToFirstRow()
-                    
+
+                    # Rows are fetched in batches, which is much cheaper than going through the field accessors
+                    # for each cell. The values come in the string form sent by the server (geometry columns as WKT)
+                    # and are converted the way the int and float accessors would, so the file doesn't change.
+                    converters = []
+                    wkt_columns = []
+                    for index, col in enumerate(self._columns):
+                        if col['is_number'] or col['is_bignumber']:
+                            converters.append(int_field_value)
+                        elif col['is_float']:
+                            converters.append(float_field_value)
+                        else:
+                            if col['is_geometry']:
+                                wkt_columns.append(index)
+                            converters.append(string_field_value)
+                    self._current_row = 0.0
+
                     # Because there's no realiable way to use offset only, we'll do this here.
                     offset = 0
                     if self._offset and not self._limit:
                         offset = self._offset
-                    i = 0
                     while ok:
                         if self._thread_event and self._thread_event.is_set():
                             log_debug2("Worker thread was stopped by user")
                             self.update_progress(round(self._current_row / self._max_rows, 2), "Data export stopped by user request")
                             return False
 
-                        i += 1
-                        if offset > 0 and i <= offset:
-                            ok = rset.nextRow()
-                            continue
-                        self.item_count = self.item_count + 1 
-                        self._current_row = float(rset.currentRow + 1)
-                        self.update_progress(round(self._current_row / self._max_rows, 2), "Data export")
-                        row = []
-                        for col in self._columns:
-                            if col['is_number'] or col['is_bignumber']:
-                                row.append(rset.intFieldValueByName(col['name']))
-                            elif col['is_float']:
-                                row.append(rset.floatFieldValueByName(col['name']))
-                            elif col['is_geometry']:
-                                row.append(rset.geoStringFieldValueByName(col['name']))
-                            else:
-                                row.append(rset.stringFieldValueByName(col['name']))
-                        output.writerow(row)
+                        rows = rset.fetchStringRows(self._fetch_batch_size, wkt_columns).astuple()
+                        if not rows:
+                            break
+                        if offset > 0:
+                            skipped = min(offset, len(rows))
+                            offset -= skipped
+                            self._current_row += skipped
+                            rows = rows[skipped:]
+                        for row in rows:
+                            output.writerow([convert(value) for convert, value in zip(converters, row)])
                         csvfile.flush()
-                        ok = rset.nextRow()
+                        self.item_count = self.item_count + len(rows)
+                        self._current_row += len(rows)
+                        self.update_progress(round(self._current_row / self._max_rows, 2), "Data export")
                 self.update_progress(1.0, "Export finished")
         else:
             self._editor.executeManagementCommand(query, 1)
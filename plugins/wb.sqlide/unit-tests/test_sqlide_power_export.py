@@ -0,0 +1,277 @@
+# Copyright (c) 2020, Oracle and/or its affiliates. All rights reserved.
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License, version 2.0,
+# as published by the Free Software Foundation.
+#
+# This program is also distributed with certain software (including
+# but not limited to OpenSSL) that is licensed under separate terms, as
+# designated in a particular file or component or in included license
+# documentation.  The authors of MySQL hereby grant you an additional
+# permission to link the program and your derivative works with the
+# separately licensed software that they have included with MySQL.
+# This program is distributed in the hope that it will be useful,  but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+# the GNU General Public License, version 2.0, for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software Foundation, Inc.,
+# 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+
+
+import sys
+import os
+import csv
+import ctypes
+import ctypes.util
+import tempfile
+import unittest
+
+sys.path.insert(0, os.path.abspath(os.path.join(os.path.dirname(__file__), '..')))
+
+try:
+    import mforms
+except ImportError:
+    # Outside of Workbench: stub the modules imported by the export backend. The code tested here doesn't use them.
+    import types
+
+    def stub_module(name, **members):
+        module = types.ModuleType(name)
+        module.__dict__.update(members)
+        sys.modules[name] = module
+        return module
+
+    class Version(object):
+        @staticmethod
+        def fromgrt(version):
+            return None
+
+    def no_log(*args):
+        pass
+
+    stub_module('mforms')
+    stub_module('workbench')
+    stub_module('workbench.utils', Version=Version)
+    stub_module('workbench.log', log_debug3=no_log, log_debug2=no_log, log_error=no_log, log_warning=no_log)
+    stub_module('wb_common', to_unicode=lambda value: value)
+
+import sqlide_power_import_export_be
+
+
+if sys.platform == 'win32':
+    _libc = ctypes.cdll.msvcrt
+    _libc.strtoll = _libc._strtoi64
+else:
+    _libc = ctypes.CDLL(ctypes.util.find_library('c'))
+_libc.strtoll.restype = ctypes.c_longlong
+_libc.strtoll.argtypes = [ctypes.c_char_p, ctypes.c_void_p, ctypes.c_int]
+_libc.strtod.restype = ctypes.c_double
+_libc.strtod.argtypes = [ctypes.c_char_p, ctypes.c_void_p]
+
+
+class FakeColumn(object):
+    def __init__(self, name, column_type):
+        self.name = name
+        self.columnType = column_type
+
+
+class FakeList(list):
+    def astuple(self):
+        return tuple(tuple(row) for row in self)
+
+
+class FakeResultset(object):
+    """Works like a db.query.Resultset wrapping a server resultset. Values are kept as the text sent by the server
+    (None for NULL) and read the way the connector does: getString() gives '' for NULL, the numeric getters parse
+    the text with strtoll() and strtod()."""
+
+    def __init__(self, columns, rows):
+        self.columns = [FakeColumn(name, column_type) for name, column_type in columns]
+        self.rowCount = len(rows)
+        self._names = [name for name, column_type in columns]
+        self._rows = rows
+        self._cursor = 0
+
+    @property
+    def currentRow(self):
+        return self._cursor
+
+    def goToFirstRow(self):
+        self._cursor = 0
+        return 1 if self._rows else 0
+
+    def nextRow(self):
+        self._cursor += 1
+        return 1 if self._cursor < len(self._rows) else 0
+
+    @staticmethod
+    def to_wkt(text):
+        return 'WKT(%s)' % text.encode('hex')
+
+    def _text(self, row, column):
+        value = self._rows[row][column]
+        return value if value is not None else ''
+
+    def stringFieldValueByName(self, name):
+        return self._text(self._cursor, self._names.index(name))
+
+    def intFieldValueByName(self, name):
+        return _libc.strtoll(self.stringFieldValueByName(name), None, 10)
+
+    def floatFieldValueByName(self, name):
+        return _libc.strtod(self.stringFieldValueByName(name), None)
+
+    def geoStringFieldValueByName(self, name):
+        return self.to_wkt(self.stringFieldValueByName(name))
+
+    def fetchStringRows(self, count, wkt_columns):
+        rows = FakeList()
+        while count > 0 and self._cursor < len(self._rows):
+            row = []
+            for column in range(len(self._names)):
+                text = self._text(self._cursor, column)
+                row.append(self.to_wkt(text) if column in wkt_columns else text)
+            rows.append(row)
+            self._cursor += 1
+            count -= 1
+        return rows
+
+
+class FakeEditor(object):
+    serverVersion = None
+
+    def __init__(self, resultset):
+        self.resultset = resultset
+
+    def executeManagementQuery(self, query, flags):
+        return self.resultset
+
+
+def table_column(name, column_type):
+    # Like the column info the export wizard reads from SHOW COLUMNS.
+    return {'name': name, 'type': column_type, 'value': None,
+            'is_number': any(x in column_type for x in ['int', 'integer']),
+            'is_geometry': any(x in column_type for x in ['geometry', 'geometrycollection', 'linestring', 'multilinestring', 'multipoint', 'multipolygon', 'point', 'polygon']),
+            'is_bignumber': any(x in column_type for x in ['bigint']),
+            'is_float': any(x in column_type for x in ['decimal', 'float', 'double']),
+            'is_string': any(x in column_type for x in ['char', 'text', 'set', 'enum', 'json']),
+            'is_bin': any(x in column_type for x in ['blob', 'binary']),
+            'is_date_or_time': any(x in column_type for x in ['timestamp', 'datetime', 'date', 'time'])}
+
+
+def export_per_cell(module, rset, path):
+    """The CSV export as it was before the rows were fetched in batches, reading each cell through its accessor."""
+    with open(path, 'wb') as csvfile:
+        output = csv.writer(csvfile, delimiter = module.options['filedseparator']['value'],
+                            lineterminator = module.options['lineseparator']['value'],
+                            quotechar = module.options['encolsestring']['value'], quoting = csv.QUOTE_NONNUMERIC if module.options['encolsestring']['value'] else csv.QUOTE_NONE)
+        output.writerow([value['name'].encode('utf-8') for value in module._columns])
+        ok = rset.goToFirstRow()
+
+        offset = 0
+        if module._offset and not module._limit:
+            offset = module._offset
+        i = 0
+        while ok:
+            i += 1
+            if offset > 0 and i <= offset:
+                ok = rset.nextRow()
+                continue
+            row = []
+            for col in module._columns:
+                if col['is_number'] or col['is_bignumber']:
+                    row.append(rset.intFieldValueByName(col['name']))
+                elif col['is_float']:
+                    row.append(rset.floatFieldValueByName(col['name']))
+                elif col['is_geometry']:
+                    row.append(rset.geoStringFieldValueByName(col['name']))
+                else:
+                    row.append(rset.stringFieldValueByName(col['name']))
+            output.writerow(row)
+            ok = rset.nextRow()
+
+
+TABLE_COLUMNS = [('id', 'int(11)'), ('big', 'bigint(20) unsigned'), ('price', 'decimal(10,2)'), ('ratio', 'double'),
+                 ('f', 'float'), ('name', 'varchar(45)'), ('flags', 'bit(3)'), ('shape', 'geometry'),
+                 ('location', 'point'), ('created', 'datetime')]
+
+TABLE_ROWS = [
+    ('1', '9223372036854775807', '10.50', '0.1', '1.1', 'plain', '\x05', '\x00\x00\x00\x00\x01\x01', '\x00\x00\x00\x00\x01\x01', '2020-01-31 10:00:00'),
+    ('-2', '0', '-0.01', '1e+300', '3.40282e38', 'with "quotes";\nand a newline', '\x00', '\x00\x00\x00\x00', '\x00\x00\x00\x00', '0000-00-00 00:00:00'),
+    (None, None, None, None, None, None, None, '', '', None),
+    ('3', '42', '0.00', '-2.5e-7', '-0', '', '\x07', '1', '7', '1999-12-31 23:59:59'),
+    ('4', '9', '99999999.99', '123456789.123456789', '0.3', '\xc3\xa9t\xc3\xa9', '\x01', '\x02', '\x03', '2001-02-03 04:05:06'),
+]
+
+
+class TestCSVExport(unittest.TestCase):
+    def setUp(self):
+        handle, self.path = tempfile.mkstemp(suffix='.csv')
+        os.close(handle)
+        handle, self.reference_path = tempfile.mkstemp(suffix='.csv')
+        os.close(handle)
+
+    def tearDown(self):
+        os.remove(self.path)
+        os.remove(self.reference_path)
+
+    def export(self, columns, rows, user_query=None, offset=None, batch_size=None, enclose='"'):
+        module = sqlide_power_import_export_be.csv_module(FakeEditor(FakeResultset(columns, rows)), False)
+        module.options['encolsestring']['value'] = enclose
+        module.set_filepath(self.path)
+        module.set_table('test', 'data')
+        module.set_offset(offset)
+        if user_query:
+            module.set_user_query(user_query)
+        else:
+            module.set_columns([table_column(name, column_type) for name, column_type in columns])
+        if batch_size:
+            module._fetch_batch_size = batch_size
+        self.assertTrue(module.start_export())
+
+        export_per_cell(module, FakeResultset(columns, rows), self.reference_path)
+        with open(self.path, 'rb') as f:
+            result = f.read()
+        with open(self.reference_path, 'rb') as f:
+            reference = f.read()
+        return result, reference
+
+    def test_table_export_writes_the_same_values(self):
+        result, reference = self.export(TABLE_COLUMNS, TABLE_ROWS)
+        self.assertEqual(result, reference)
+
+    def test_table_export_without_quoting(self):
+        rows = [row[:5] + ('no quotes',) + row[6:] for row in TABLE_ROWS]
+        result, reference = self.export(TABLE_COLUMNS, rows, enclose='')
+        self.assertEqual(result, reference)
+
+    def test_batches_and_offset(self):
+        rows = [(str(i), str(i * 1000), '%d.25' % i, '%d.5' % i, '0.1', 'row %d' % i, '\x01', '', '', None)
+                for i in range(25)]
+        for batch_size in (1, 4, 25, 1000):
+            for offset in (None, 3, 10, 30):
+                result, reference = self.export(TABLE_COLUMNS, rows, offset=offset, batch_size=batch_size)
+                self.assertEqual(result, reference, 'batch size %d, offset %s' % (batch_size, offset))
+
+    def test_unsigned_bigint_beyond_signed_range(self):
+        # The int accessor wrapped these around, the batched export writes them as sent by the server.
+        rows = [('1', '18446744073709551615', '0', '0', '0', '', '', '', '', None)]
+        result, reference = self.export(TABLE_COLUMNS, rows)
+        self.assertIn('\n1;18446744073709551615;', result)
+
+    def test_query_export_keeps_server_strings(self):
+        # Result columns only have generic types, so every value is written as the server sent it.
+        columns = [('id', 'numeric'), ('ratio', 'numeric'), ('price', 'string'), ('flags', 'numeric'),
+                   ('data', 'blob'), ('shape', 'string')]
+        rows = [('1', '1.10', '10.50', '\x05', '\x00\xff', '\x00\x00\x00\x00\x01'),
+                ('-2', '3.40282e+38', '-0.01', '\x00', '', ''),
+                (None, None, None, None, None, None)]
+        result, reference = self.export(columns, rows, user_query='SELECT * FROM test.data', batch_size=2)
+        self.assertEqual(result, reference)
+        self.assertIn('"1.10"', result)
+        self.assertIn('"\x05"', result)
+
+
+if __name__ == '__main__':
+    unittest.main()
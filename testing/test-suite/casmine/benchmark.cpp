@@ -0,0 +1,350 @@
+/*
+ * Copyright (c) 2020, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <ctime>
+#include <algorithm>
+
+#include "rapidjson/ostreamwrapper.h"
+#include "rapidjson/prettywriter.h"
+
+#include "ansi-styles.h"
+#include "helpers.h"
+#include "casmine.h"
+#include "benchmark.h"
+
+using namespace casmine;
+using namespace std::chrono;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+  std::atomic<bool> countAllocations { false };
+  std::atomic<size_t> allocationCount { 0 };
+  std::atomic<size_t> allocatedBytes { 0 };
+
+  std::mutex resultsMutex;
+  std::vector<BenchmarkResult> results;
+
+  bool baselineLoaded = false;
+  rapidjson::Document baseline;
+
+  //--------------------------------------------------------------------------------------------------------------------
+
+  /**
+   * Loads the baseline file on first use. The file has the same format as the benchmark results written by a
+   * previous run, so such an output can directly serve as baseline for later runs.
+   */
+  rapidjson::Value const* getBaseline(std::string const& name) {
+    if (!baselineLoaded) {
+      baselineLoaded = true;
+      baseline.SetObject();
+
+      auto context = CasmineContext::get();
+      std::string fileName = std::get<std::string>(context->settings["benchmark-baseline"]);
+      if (fileName.empty())
+        fileName = context->getConfigurationStringValue("benchmarks/baseline");
+      if (fileName.empty())
+        return nullptr;
+
+      std::ifstream stream(expandPath(fileName));
+      if (!stream.good()) {
+        std::cerr << "Cannot open the benchmark baseline file " << fileName << std::endl;
+        return nullptr;
+      }
+
+      rapidjson::IStreamWrapper wrapper(stream);
+      rapidjson::ParseResult parseResult = baseline.ParseStream(wrapper);
+      if (parseResult.IsError() || !baseline.IsObject()) {
+        std::cerr << "Error while parsing the benchmark baseline file " << fileName << ": "
+          << GetParseError_En(parseResult.Code()) << std::endl;
+        baseline.SetObject();
+        return nullptr;
+      }
+    }
+
+    auto benchmarks = baseline.FindMember("benchmarks");
+    if (benchmarks == baseline.MemberEnd() || !benchmarks->value.IsObject())
+      return nullptr;
+
+    auto entry = benchmarks->value.FindMember(name.c_str());
+    if (entry == benchmarks->value.MemberEnd() || !entry->value.IsObject())
+      return nullptr;
+
+    return &entry->value;
+  }
+
+  //--------------------------------------------------------------------------------------------------------------------
+
+  double getNumber(rapidjson::Value const& object, char const* path1, char const* path2 = nullptr) {
+    auto member = object.FindMember(path1);
+    if (member == object.MemberEnd())
+      return -1;
+
+    rapidjson::Value const* value = &member->value;
+    if (path2 != nullptr) {
+      if (!value->IsObject())
+        return -1;
+      member = value->FindMember(path2);
+      if (member == value->MemberEnd())
+        return -1;
+      value = &member->value;
+    }
+
+    return value->IsNumber() ? value->GetDouble() : -1;
+  }
+
+  //--------------------------------------------------------------------------------------------------------------------
+
+  std::string formatChange(double current, double reference) {
+    std::stringstream ss;
+    ss.precision(1);
+    ss << std::fixed << (current / reference - 1) * 100 << "%";
+    return ss.str();
+  }
+
+  //--------------------------------------------------------------------------------------------------------------------
+
+  void compareWithBaseline(char const* file, size_t line, BenchmarkResult const& result, double tolerance) {
+    auto context = CasmineContext::get();
+    rapidjson::Value const* reference = getBaseline(result.name);
+    if (reference == nullptr) {
+      context->recordSuccess(file, line);
+      return;
+    }
+
+    bool failed = false;
+    double referenceMedian = getNumber(*reference, "wall", "median");
+    if (referenceMedian > 0 && result.wall.median > referenceMedian * (1 + tolerance)) {
+      failed = true;
+      context->recordFailure(file, line, "Benchmark \"" + result.name + "\": median wall time " +
+        std::to_string(static_cast<size_t>(result.wall.median)) + "µs is " +
+        formatChange(result.wall.median, referenceMedian) + " slower than the baseline (" +
+        std::to_string(static_cast<size_t>(referenceMedian)) + "µs)");
+    }
+
+    // Allocations are deterministic for most code, so any increase beyond the tolerance is a real change.
+    double referenceAllocations = getNumber(*reference, "allocations");
+    if (referenceAllocations > 0 && result.allocations > referenceAllocations * (1 + tolerance)) {
+      failed = true;
+      context->recordFailure(file, line, "Benchmark \"" + result.name + "\": " + std::to_string(result.allocations) +
+        " allocations per iteration, which is " + formatChange(static_cast<double>(result.allocations),
+        referenceAllocations) + " more than the baseline (" +
+        std::to_string(static_cast<size_t>(referenceAllocations)) + ")");
+    }
+
+    if (!failed)
+      context->recordSuccess(file, line);
+  }
+
+  //--------------------------------------------------------------------------------------------------------------------
+
+  template<typename Writer>
+  void writeStatistics(Writer &writer, char const* name, BenchmarkStatistics const& statistics) {
+    writer.Key(name);
+    writer.StartObject();
+    writer.Key("min");
+    writer.Double(statistics.min);
+    writer.Key("median");
+    writer.Double(statistics.median);
+    writer.Key("p90");
+    writer.Double(statistics.p90);
+    writer.Key("p99");
+    writer.Double(statistics.p99);
+    writer.Key("max");
+    writer.Double(statistics.max);
+    writer.Key("mean");
+    writer.Double(statistics.mean);
+    writer.EndObject();
+  }
+
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Nearest rank percentile (p in [0, 100]) of an already sorted sample list.
+ */
+double BenchmarkStatistics::percentile(std::vector<double> const& sortedSamples, double p) {
+  if (sortedSamples.empty())
+    return 0;
+
+  size_t rank = static_cast<size_t>(std::ceil(p * static_cast<double>(sortedSamples.size()) / 100));
+  if (rank == 0)
+    rank = 1;
+  return sortedSamples[std::min(rank, sortedSamples.size()) - 1];
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+BenchmarkStatistics BenchmarkStatistics::fromSamples(std::vector<double> samples) {
+  BenchmarkStatistics statistics;
+  if (samples.empty())
+    return statistics;
+
+  std::sort(samples.begin(), samples.end());
+  statistics.min = samples.front();
+  statistics.max = samples.back();
+  statistics.median = percentile(samples, 50);
+  statistics.p90 = percentile(samples, 90);
+  statistics.p99 = percentile(samples, 99);
+
+  double sum = 0;
+  for (double sample : samples)
+    sum += sample;
+  statistics.mean = sum / static_cast<double>(samples.size());
+
+  return statistics;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void casmine::recordAllocation(size_t size) {
+  if (countAllocations.load(std::memory_order_relaxed)) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool casmine::benchmarksEnabled() {
+  auto context = CasmineContext::get();
+  return std::get<bool>(context->settings["benchmarks"]) || context->getConfigurationBoolValue("benchmarks/enabled");
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Runs the given body a number of times without measuring (warm up), then repeatedly while collecting wall clock
+ * and CPU times as well as the number of allocations made by the body. The result is stored for the final report and
+ * compared against the baseline (if one was given), which records either a success or a failure for the current spec.
+ *
+ * Note: std::clock() measures process CPU time on POSIX systems, but wall time on Windows.
+ */
+BenchmarkResult casmine::runBenchmark(char const* file, size_t line, std::string const& name,
+  std::function<void()> body, BenchmarkOptions const& options) {
+
+  for (size_t i = 0; i < options.warmupIterations; ++i)
+    body();
+
+  std::vector<double> wallSamples;
+  std::vector<double> cpuSamples;
+  size_t totalAllocations = 0;
+  size_t totalBytes = 0;
+
+  high_resolution_clock::time_point start = high_resolution_clock::now();
+  while (true) {
+    size_t count = wallSamples.size();
+    if (count >= options.maxIterations)
+      break;
+    if (count >= options.iterations && high_resolution_clock::now() - start >= options.minDuration)
+      break;
+
+    allocationCount = 0;
+    allocatedBytes = 0;
+
+    std::clock_t cpuStart = std::clock();
+    high_resolution_clock::time_point wallStart = high_resolution_clock::now();
+    countAllocations = true;
+
+    body();
+
+    countAllocations = false;
+    auto wallTime = duration_cast<nanoseconds>(high_resolution_clock::now() - wallStart);
+    std::clock_t cpuEnd = std::clock();
+
+    wallSamples.push_back(static_cast<double>(wallTime.count()) / 1000);
+    cpuSamples.push_back(static_cast<double>(cpuEnd - cpuStart) * 1000000 / CLOCKS_PER_SEC);
+    totalAllocations += allocationCount;
+    totalBytes += allocatedBytes;
+  }
+
+  BenchmarkResult result;
+  result.name = name;
+  result.iterations = wallSamples.size();
+  result.wall = BenchmarkStatistics::fromSamples(wallSamples);
+  result.cpu = BenchmarkStatistics::fromSamples(cpuSamples);
+  if (result.iterations > 0) {
+    result.allocations = totalAllocations / result.iterations;
+    result.allocatedBytes = totalBytes / result.iterations;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(resultsMutex);
+    results.push_back(result);
+  }
+
+  auto context = CasmineContext::get();
+  if (std::get<bool>(context->settings["verbose"])) {
+    std::cout << std::endl << styleGrayOn << styleItalicOn << "  " << name << ": " << result.iterations
+      << " iterations, median " << static_cast<size_t>(result.wall.median) << "µs, p90 "
+      << static_cast<size_t>(result.wall.p90) << "µs, cpu " << static_cast<size_t>(result.cpu.median) << "µs, "
+      << result.allocations << " allocations (" << result.allocatedBytes << " bytes)" << stylesReset << std::endl;
+  }
+
+  compareWithBaseline(file, line, result, options.tolerance);
+
+  return result;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void casmine::writeBenchmarkResults(std::string const& fileName) {
+  std::lock_guard<std::mutex> lock(resultsMutex);
+  if (results.empty())
+    return;
+
+  std::ofstream stream(fileName);
+  if (!stream.good()) {
+    std::cerr << "Cannot write the benchmark results to " << fileName << std::endl;
+    return;
+  }
+
+  rapidjson::OStreamWrapper wrapper(stream);
+  rapidjson::PrettyWriter<rapidjson::OStreamWrapper> writer(wrapper);
+  writer.SetIndent('\t', 1);
+
+  writer.StartObject();
+  writer.Key("benchmarks");
+  writer.StartObject();
+  for (auto const& result : results) {
+    writer.Key(result.name.c_str());
+    writer.StartObject();
+    writer.Key("iterations");
+    writer.Uint64(result.iterations);
+    writeStatistics(writer, "wall", result.wall);
+    writeStatistics(writer, "cpu", result.cpu);
+    writer.Key("allocations");
+    writer.Uint64(result.allocations);
+    writer.Key("allocated bytes");
+    writer.Uint64(result.allocatedBytes);
+    writer.EndObject();
+  }
+  writer.EndObject();
+  writer.EndObject();
+
+  stream << std::endl;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
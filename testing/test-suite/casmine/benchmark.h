@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2020, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#pragma once
+
+#include "common.h"
+
+namespace casmine {
+
+// Runs a benchmark body under the current spec, records the statistics and compares them against the baseline.
+#define $benchmark(name, ...) casmine::runBenchmark(_N_, __LINE__, name, __VA_ARGS__)
+
+// Marks the current spec as pending unless benchmarks were enabled on the command line or in the configuration.
+#define $requireBenchmarks() \
+  if (!casmine::benchmarksEnabled()) \
+    $pending("benchmarks are disabled (use --benchmarks to enable them)")
+
+struct BenchmarkOptions {
+  size_t warmupIterations = 1;
+  size_t iterations = 10;
+
+  // If set, measured iterations continue past `iterations` until this much wall time was spent,
+  // but never more than `maxIterations`.
+  std::chrono::milliseconds minDuration = std::chrono::milliseconds(0);
+  size_t maxIterations = 1000;
+
+  // Relative slowdown (or allocation increase) against the baseline, which is tolerated before a failure is recorded.
+  double tolerance = 0.1;
+};
+
+struct BenchmarkStatistics {
+  double min = 0;
+  double median = 0;
+  double p90 = 0;
+  double p99 = 0;
+  double max = 0;
+  double mean = 0;
+
+  static double percentile(std::vector<double> const& sortedSamples, double p);
+  static BenchmarkStatistics fromSamples(std::vector<double> samples);
+};
+
+struct BenchmarkResult {
+  std::string name;
+  size_t iterations = 0;
+
+  BenchmarkStatistics wall; // In microseconds.
+  BenchmarkStatistics cpu;  // In microseconds, process CPU time.
+
+  // Per measured iteration. Only counted if the test binary installs the allocation hook (see main.cpp).
+  size_t allocations = 0;
+  size_t allocatedBytes = 0;
+};
+
+// Called by the global operator new replacement. Only counts while a benchmark iteration is being measured.
+void recordAllocation(size_t size);
+
+bool benchmarksEnabled();
+
+BenchmarkResult runBenchmark(char const* file, size_t line, std::string const& name, std::function<void()> body,
+  BenchmarkOptions const& options = BenchmarkOptions());
+
+// Writes all results collected so far as JSON to the given file. Does nothing if no benchmark ran.
+void writeBenchmarkResults(std::string const& fileName);
+
+}
@@ -28,6 +28,7 @@ using namespace casmine;
 using namespace rapidjson;
 
 using namespace std::chrono;
+using namespace std::string_literals;
 
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -48,6 +49,8 @@ CasmineContext::CasmineContext() {
   settings["verbose"] = false;
   settings["no-colors"] = false;
   settings["only-selected"] = false;
+  settings["benchmarks"] = false;
+  settings["benchmark-baseline"] = ""s;
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -219,6 +222,8 @@ void CasmineContext::runTests(std::string const& baseDir) {
     _pingThread.join();
   }
 
+  writeBenchmarkResults(_baseDir + "/benchmark-results.json");
+
   std::cout << styleGrayOn << styleItalicOn << "Cleaning up test data..." << stylesReset << std::endl << std::endl; 
 
 #ifdef __APPLE__
@@ -27,6 +27,7 @@
 #include "describe.h"
 #include "expect.h"
 #include "reporter.h"
+#include "benchmark.h"
 
 namespace casmine {
 
@@ -17,6 +17,9 @@
  * 02110-1301  USA
  */
 
+#include <cstdlib>
+#include <new>
+
 #include "ansi-styles.h"
 
 #include "string_utilities.h"
@@ -32,6 +35,43 @@ using namespace casmine;
 
 //----------------------------------------------------------------------------------------------------------------------
 
+// Global allocation hook for the benchmark allocation counters. The replacement is process wide on Linux and macOS.
+// On Windows each module has its own allocator binding, so only allocations made from code linked into the test
+// executable itself are counted there.
+
+void* operator new(std::size_t size) {
+  casmine::recordAllocation(size);
+  if (size == 0)
+    size = 1;
+
+  void *result = std::malloc(size);
+  if (result == nullptr)
+    throw std::bad_alloc();
+  return result;
+}
+
+void* operator new[](std::size_t size) {
+  return operator new(size);
+}
+
+void operator delete(void *pointer) noexcept {
+  std::free(pointer);
+}
+
+void operator delete[](void *pointer) noexcept {
+  std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept {
+  std::free(pointer);
+}
+
+void operator delete[](void *pointer, std::size_t) noexcept {
+  std::free(pointer);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 template<typename T>
 std::string printWithDefault(T value, std::string const& type) {
   std::stringstream ss;
@@ -109,6 +149,22 @@ int main(int argc, const char *argv[]) {
     })
   );
 
+  opts.addEntry(dataTypes::OptionEntry(dataTypes::OptionArgumentLogical,
+    0, "benchmarks", "Run the benchmark specs too (they are reported as pending otherwise)",
+    [&](const dataTypes::OptionEntry &entry, int *retval) {
+      context->settings["benchmarks"] = entry.value.logicalValue;
+      return true;
+    })
+  );
+
+  opts.addEntry(dataTypes::OptionEntry(dataTypes::OptionArgumentText,
+    "benchmark-baseline", "Compare benchmark results against this file (a benchmark-results.json from an earlier run)",
+    [&](const dataTypes::OptionEntry &entry, int *retval) {
+      context->settings["benchmark-baseline"] = entry.value.textValue;
+      return true;
+    }, "<file>")
+  );
+
   opts.addEntry(dataTypes::OptionEntry(dataTypes::OptionArgumentLogical,
     'o', "only", "Run only specs specified as the last arguments, use 'list-specs' to see available specs.",
     [&](const dataTypes::OptionEntry &entry, int *retval) {
@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2020, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#include <fstream>
+
+#include "base/file_utilities.h"
+#include "sqlide/sql_history_store.h"
+
+#include "casmine.h"
+
+// Opens stores on a directory of its own instead of the shared one in the user data dir.
+class SqlHistoryStoreTester {
+public:
+  static std::shared_ptr<SqlHistoryStore> open(const std::string &directory) {
+    return std::shared_ptr<SqlHistoryStore>(new SqlHistoryStore(directory));
+  }
+};
+
+namespace {
+
+$ModuleEnvironment() {};
+
+static std::string historyDir(const std::string &name) {
+  std::string directory = casmine::CasmineContext::get()->outputDir() + "/sql_history_" + name;
+  base::remove_recursive(directory);
+  base::create_directory(directory, 0700, true);
+  return directory;
+}
+
+static std::vector<std::string> statements(const std::vector<SqlHistoryStore::Entry> &entries) {
+  std::vector<std::string> result;
+  for (auto &entry : entries)
+    result.push_back(entry.statement);
+  return result;
+}
+
+$describe("SQL history store") {
+  $it("Stores statements and reads them back newest first", []() {
+    std::string directory = historyDir("entries");
+    {
+      auto store = SqlHistoryStoreTester::open(directory);
+      std::int64_t ticket =
+        store->add("2020-05-01", "10:00:00", { "SELECT * FROM actor", "SELECT * FROM film" }, "Local instance");
+      store->setDuration(ticket, 0.25);
+      store->add("2020-05-01", "10:01:00", { "UPDATE film SET title = 'x'" }, "Local instance");
+
+      $expect(store->dayCount("2020-05-01")).toBe(3U);
+      $expect(store->dayCount("2020-05-02")).toBe(0U);
+
+      std::vector<SqlHistoryStore::Entry> entries = store->dayEntries("2020-05-01", 0, 10);
+      $expect(statements(entries) ==
+              std::vector<std::string>({ "UPDATE film SET title = 'x'", "SELECT * FROM film", "SELECT * FROM actor" }))
+        .toBeTrue();
+      $expect(entries[0].day).toBe("2020-05-01");
+      $expect(entries[0].time).toBe("10:01:00");
+      $expect(entries[2].time).toBe("10:00:00");
+
+      // Paging.
+      $expect(statements(store->dayEntries("2020-05-01", 1, 1)) == std::vector<std::string>({ "SELECT * FROM film" }))
+        .toBeTrue();
+      $expect(store->dayEntries("2020-05-01", 3, 10).empty()).toBeTrue();
+    }
+
+    // Queued writes are done when the store goes away and are there for the next one.
+    {
+      auto store = SqlHistoryStoreTester::open(directory);
+      store->add("2020-05-02", "09:00:00", { "SELECT actor_id FROM film_actor" }, "Local instance");
+    }
+
+    auto store = SqlHistoryStoreTester::open(directory);
+    $expect(store->dayCount("2020-05-01")).toBe(3U);
+
+    // Search goes over all days, newest first.
+    $expect(store->searchCount("actor")).toBe(2U);
+    $expect(statements(store->searchEntries("actor", 0, 10)) ==
+            std::vector<std::string>({ "SELECT actor_id FROM film_actor", "SELECT * FROM actor" }))
+      .toBeTrue();
+    $expect(statements(store->searchEntries("actor", 1, 10)) == std::vector<std::string>({ "SELECT * FROM actor" }))
+      .toBeTrue();
+    $expect(store->searchCount("update film")).toBe(1U);
+    $expect(store->searchCount("insert")).toBe(0U);
+  });
+
+  $it("Groups entries by day", []() {
+    std::string directory = historyDir("days");
+    auto store = SqlHistoryStoreTester::open(directory);
+    store->add("2020-05-03", "08:00:00", { "SELECT 3" }, "");
+    store->add("2020-05-01", "08:00:00", { "SELECT 1", "SELECT 11" }, "");
+    store->add("2020-05-02", "08:00:00", { "SELECT 2" }, "");
+    store->add("2020-05-01", "09:00:00", { "SELECT 111" }, "");
+
+    $expect(store->days() == std::vector<std::string>({ "2020-05-01", "2020-05-02", "2020-05-03" })).toBeTrue();
+    $expect(statements(store->dayEntries("2020-05-01", 0, 10)) ==
+            std::vector<std::string>({ "SELECT 111", "SELECT 11", "SELECT 1" }))
+      .toBeTrue();
+
+    // A day file of an older version goes too.
+    std::ofstream(base::makePath(directory, "2020-05-02")) << "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>\n";
+
+    store->removeDays({ "2020-05-02", "2020-05-03" });
+    $expect(store->days() == std::vector<std::string>({ "2020-05-01" })).toBeTrue();
+    $expect(store->dayCount("2020-05-02")).toBe(0U);
+    $expect(store->dayCount("2020-05-01")).toBe(3U);
+    $expect(base::file_exists(base::makePath(directory, "2020-05-02"))).toBeFalse();
+  });
+
+  $it("Imports the history files of older versions once", []() {
+    std::string directory = historyDir("import");
+
+    // One file per day, one entry per line. "~" stands for the value of the previous entry.
+    std::ofstream(base::makePath(directory, "2019-12-30"))
+      << "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>\n"
+      << "<ENTRY timestamp='23:59:00'>SELECT * FROM actor</ENTRY>\n";
+    std::ofstream(base::makePath(directory, "2019-12-31"))
+      << "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>\n"
+      << "<ENTRY timestamp='10:00:00'>SELECT 1 &lt; 2</ENTRY>\n"
+      << "<ENTRY timestamp='~'>SELECT &apos;a&apos;&#x0A;FROM dual</ENTRY>\n"
+      << "<ENTRY timestamp='10:05:00'>~</ENTRY>\n";
+    std::ofstream(base::makePath(directory, "notes.txt")) << "not a history file\n";
+
+    {
+      auto store = SqlHistoryStoreTester::open(directory);
+      $expect(store->days() == std::vector<std::string>({ "2019-12-30", "2019-12-31" })).toBeTrue();
+
+      std::vector<SqlHistoryStore::Entry> entries = store->dayEntries("2019-12-31", 0, 10);
+      $expect(entries.size()).toBe(3U);
+      $expect(entries[0].time).toBe("10:05:00");
+      $expect(entries[0].statement).toBe("SELECT 'a'\nFROM dual");
+      $expect(entries[1].time).toBe("10:00:00");
+      $expect(entries[1].statement).toBe("SELECT 'a'\nFROM dual");
+      $expect(entries[2].time).toBe("10:00:00");
+      $expect(entries[2].statement).toBe("SELECT 1 < 2");
+
+      entries = store->dayEntries("2019-12-30", 0, 10);
+      $expect(entries.size()).toBe(1U);
+      $expect(entries[0].time).toBe("23:59:00");
+      $expect(entries[0].statement).toBe("SELECT * FROM actor");
+
+      // Imported entries can be searched like new ones.
+      $expect(store->searchCount("dual")).toBe(2U);
+    }
+
+    // The files stay, but aren't imported a second time.
+    $expect(base::file_exists(base::makePath(directory, "2019-12-31"))).toBeTrue();
+    auto store = SqlHistoryStoreTester::open(directory);
+    $expect(store->dayCount("2019-12-31")).toBe(3U);
+    $expect(store->dayCount("2019-12-30")).toBe(1U);
+  });
+}
+
+}
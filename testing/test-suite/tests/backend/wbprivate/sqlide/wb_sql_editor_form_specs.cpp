@@ -39,6 +39,7 @@
 #include "cppconn/sqlstring.h"
 
 #include "sqlide/wb_sql_editor_form.h"
+#include "sqlide/completion_cache.h"
 
 using namespace grt;
 using namespace wb;
@@ -95,6 +96,10 @@ public:
     bec::GRTManager::get()->perform_idle_tasks();
   }
 
+  CompletionCache *completion_cache() {
+    return _form->_completion_cache;
+  }
+
   std::vector<std::string> fetch_schema_list() {
     return _form->get_live_tree()->fetch_schema_list();
   }
@@ -674,6 +679,25 @@ $describe("SQL Editor Form") {
     $expect(pchildData->delete_rule).toEqual(4U, "TF006CHK005 : Unexpected foreign key delete rule");
     $expect(pchildData->referenced_table).toBe("language", "TF006CHK005 : Unexpected foreign key delete rule");
   });
+
+  $it("Explicit refresh doesn't use the completion cache.", [&]() {
+    CompletionCache *cache = data->formTester->completion_cache();
+    $expect(cache != nullptr).toBeTrue("TF007CHK001 : No completion cache");
+
+    cache->storeObjects("wb_sql_editor_form_test", { { "film", CompletionCache::Table, "stale", { "bogus" } } });
+
+    // The Refresh action of the schema tree. Discarding the cache happens before the schema list is requested.
+    data->formTester->load_schema_list();
+    $expect(cache->cachedSchemas().empty()).toBeTrue("TF007CHK002 : Completion cache was not discarded");
+
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    data->formTester->perform_idle_tasks();
+
+    for (auto &object : cache->schemaObjects("wb_sql_editor_form_test")) {
+      $expect(std::find(object.columns.begin(), object.columns.end(), "bogus") == object.columns.end())
+        .toBeTrue("TF007CHK003 : Cached columns of " + object.name + " were kept");
+    }
+  });
 }
 
 }
@@ -910,9 +910,6 @@ $describe("sql editor help test") {
     data->version = (unsigned long)(version->majorNumber() * 10000 + version->minorNumber() * 100 + version->releaseNumber());
 
     data->helpContext = new help::HelpContext(data->tester->getRdbms()->characterSets(), "", data->version);
-
-    // Wait for the help to load its data.
-    help::DbSqlEditorContextHelp::get()->waitForLoading();
   });
 
   $it("Single token topics or those derived from a single token.", [&](){
@@ -927,6 +924,33 @@ $describe("sql editor help test") {
     checkTopics(0, complexTests, data.get());
   });
 
+  $it("Binary help index", []() {
+    std::string json = "{\"topics\": ["
+      "{\"id\": \"Select\", \"description\": [{\"para\": \"Retrieves rows.\"}]},"
+      "{\"id\": \"CREATE TABLE\", \"syntax\": {}},"
+      "{\"id\": \"select\", \"description\": [{\"para\": \"Duplicate, replaces the first one.\"}]}"
+      "]}";
+
+    std::unique_ptr<help::HelpIndex> index = help::HelpIndex::fromData(help::HelpIndex::build(json));
+    $expect(index.get()).Not.toBeNull();
+    $expect(index->topicCount()).toBe(2U);
+    $expect(index->contains("SELECT")).toBeTrue();
+    $expect(index->contains("CREATE TABLE")).toBeTrue();
+    $expect(index->contains("select")).toBeFalse(); // Topics are stored upper case.
+    $expect(index->contains("UPDATE")).toBeFalse();
+
+    std::string topicJson;
+    $expect(index->topicJson("SELECT", topicJson)).toBeTrue();
+    $expect(topicJson).toContain("Duplicate");
+    $expect(index->topicJson("UPDATE", topicJson)).toBeFalse();
+
+    // Truncated or foreign data must be rejected.
+    std::string data = help::HelpIndex::build(json);
+    $expect(help::HelpIndex::fromData(data.substr(0, data.size() - 10)).get()).toBeNull();
+    $expect(help::HelpIndex::fromData("not an index").get()).toBeNull();
+    $expect(help::HelpIndex::fromData(help::HelpIndex::build("{}"))->topicCount()).toBe(0U);
+  });
+
   $afterAll([&]() {
     delete data->helpContext;
   });
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2020, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#include "casmine.h"
+#include "wb_test_helpers.h"
+
+// Benchmarks for loading large model files. Run with --benchmarks.
+
+namespace {
+
+$ModuleEnvironment() {};
+
+$TestData {
+  std::unique_ptr<WorkbenchTester> tester;
+  std::string modelFile = casmine::CasmineContext::get()->outputDir() + "/benchmark_5k_tables.mwb";
+};
+
+$describe("Model loading benchmarks") {
+
+  $beforeAll([this]() {
+    if (!casmine::benchmarksEnabled())
+      return;
+
+    data->tester.reset(new WorkbenchTester());
+    data->tester->initializeRuntime();
+
+    // Generate the model once, so the benchmark measures only loading it.
+    data->tester->createNewDocument();
+    addSyntheticTables(db_mysql_SchemaRef::cast_from(data->tester->getSchema()), 5000, 10);
+    $expect(data->tester->wb->save_as(data->modelFile)).toBeTrue();
+
+    $expect(data->tester->closeDocument()).toBeTrue();
+    data->tester->wb->close_document_finish();
+  });
+
+  $it("Open a model with 5000 tables", [this]() {
+    $requireBenchmarks();
+
+    size_t tableCount = 0;
+    casmine::BenchmarkOptions options;
+    options.iterations = 5;
+    $benchmark("model/open document (5000 tables)", [&]() {
+      data->tester->wb->open_document(data->modelFile);
+      tableCount = data->tester->getSchema()->tables().count();
+
+      data->tester->closeDocument();
+      data->tester->wb->close_document_finish();
+    }, options);
+
+    $expect(tableCount).toBe(5000U);
+  });
+
+}
+
+}
@@ -22,14 +22,20 @@
  */
 
 #include "workbench/wb_model_file.h"
+#include "workbench/wb_autosave_journal.h"
 
 #include "wb_test_helpers.h"
 
+#include "base/file_functions.h"
 #include "base/file_utilities.h"
 #include "base/utf8string.h"
 
 #include "casmine.h"
 
+#include <fstream>
+#include <map>
+#include <sstream>
+
 namespace {
 
 $ModuleEnvironment() {};
@@ -139,6 +145,142 @@ $describe("Tests for WB model file") {
     data->testModelSavingAndLoading(data->tmpDataDir + data->UnicodeBaseModelFile);
   });
 
+  $it("Archive members survive packing and unpacking", [this]() {
+    // Enough members to be compressed and extracted in parallel, including one that is too large to be
+    // compressed in memory.
+    std::string sourceDir = data->outputDir + "/pack_source";
+    std::string targetDir = data->outputDir + "/pack_target";
+    std::string archive = data->outputDir + "/pack_test.mwb";
+    base::remove_recursive(sourceDir);
+    base::remove_recursive(targetDir);
+    base_remove(archive);
+    base::create_directory(sourceDir + "/@db", 0700, true);
+    base::create_directory(sourceDir + "/@images", 0700, true);
+
+    std::map<std::string, std::string> contents;
+    contents["document.mwb.xml"] = std::string(100000, 'x');
+    contents["empty.txt"] = "";
+    contents["@db/data.db"] = std::string(65 * 1024 * 1024, 'd');
+    for (size_t i = 0; i < 10; ++i) {
+      std::string content;
+      for (size_t j = 0; j < 1000 * (i + 1); ++j)
+        content += std::to_string(i * j);
+      contents["@images/image" + std::to_string(i) + ".png"] = content;
+    }
+
+    for (auto &entry : contents) {
+      std::ofstream stream(sourceDir + "/" + entry.first, std::ios::binary);
+      stream << entry.second;
+    }
+
+    ModelFile mf(data->outputDir);
+    $expect([&]() { mf.pack_zip(archive, sourceDir); }).Not.toThrow();
+
+    std::list<std::string> files;
+    $expect([&]() { files = ModelFile::unpack_zip(archive, targetDir); }).Not.toThrow();
+    $expect(files.size()).toBe(contents.size());
+
+    for (auto &entry : contents) {
+      std::ifstream stream(targetDir + "/" + entry.first, std::ios::binary);
+      std::stringstream content;
+      content << stream.rdbuf();
+      $expect(content.str() == entry.second).toBeTrue("Content of " + entry.first + " differs");
+    }
+
+    base::remove_recursive(sourceDir);
+    base::remove_recursive(targetDir);
+    base_remove(archive);
+  });
+
+  $it("Autosave journal replays changes on top of the last full document", [this]() {
+    std::string path = data->outputDir + "/autosave.journal";
+    base_remove(path);
+
+    workbench_DocumentRef doc(grt::Initialized);
+    workbench_physical_ModelRef pmodel(grt::Initialized);
+    pmodel->owner(doc);
+    db_mysql_CatalogRef catalog(grt::Initialized);
+    catalog->owner(pmodel);
+    pmodel->catalog(catalog);
+    doc->physicalModels().insert(pmodel);
+
+    db_mysql_SchemaRef schema(grt::Initialized);
+    schema->owner(catalog);
+    schema->name("s1");
+    catalog->schemata().insert(schema);
+
+    db_mysql_TableRef table1(grt::Initialized);
+    table1->owner(schema);
+    table1->name("t1");
+    schema->tables().insert(table1);
+
+    std::string base = grt::GRT::get()->serialize_xml_data(doc);
+
+    doc->mark_global();
+    {
+      AutosaveJournal journal(path, "snapshot-1");
+      journal.track_changes(grt::GRT::get()->get_undo_manager());
+
+      grt::AutoUndo undo;
+      table1->name("t1_renamed");
+      db_mysql_TableRef table2(grt::Initialized);
+      table2->owner(schema);
+      table2->name("t2");
+      db_mysql_ColumnRef column(grt::Initialized);
+      column->owner(table2);
+      column->name("c1");
+      table2->columns().insert(column);
+      schema->tables().insert(table2);
+      undo.end("Add table");
+      $expect(journal.append()).toBeTrue();
+
+      grt::AutoUndo undo2;
+      schema->tables().remove(0);
+      undo2.end("Remove table");
+      $expect(journal.append()).toBeTrue();
+      $expect(journal.needs_snapshot()).toBeFalse();
+    }
+    doc->unmark_global();
+
+    workbench_DocumentRef recovered(workbench_DocumentRef::cast_from(grt::GRT::get()->unserialize_xml_data(base)));
+    db_SchemaRef recoveredSchema(recovered->physicalModels()[0]->catalog()->schemata()[0]);
+    $expect(recoveredSchema->tables().count()).toBe(1U);
+
+    $expect(AutosaveJournal::replay(path, recovered, "snapshot-1")).toBe(2U);
+    $expect(recoveredSchema->tables().count()).toBe(1U);
+    $expect(*recoveredSchema->tables()[0]->name()).toBe("t2");
+    $expect(recoveredSchema->tables()[0]->columns().count()).toBe(1U);
+    $expect(*recoveredSchema->tables()[0]->columns()[0]->name()).toBe("c1");
+    $expect(recoveredSchema->tables()[0]->owner().valueptr() == recoveredSchema.valueptr()).toBeTrue();
+
+    // Records describe state, so replaying them again doesn't change anything.
+    $expect(AutosaveJournal::replay(path, recovered, "snapshot-1")).toBe(2U);
+    $expect(recoveredSchema->tables().count()).toBe(1U);
+
+    // Records made for another snapshot are not applied.
+    workbench_DocumentRef newer(workbench_DocumentRef::cast_from(grt::GRT::get()->unserialize_xml_data(base)));
+    $expect(AutosaveJournal::replay(path, newer, "snapshot-2")).toBe(0U);
+    $expect(*newer->physicalModels()[0]->catalog()->schemata()[0]->tables()[0]->name()).toBe("t1");
+
+    base_remove(path);
+  });
+
+  $it("Autosave snapshot ids follow the snapshot content", [this]() {
+    std::string path = data->outputDir + "/autosave-snapshot.xml";
+    base_remove(path);
+    $expect(AutosaveJournal::snapshot_id(path)).toBe("");
+
+    std::ofstream(path) << "<data/>";
+    std::string id = AutosaveJournal::snapshot_id(path);
+    $expect(id).Not.toBe("");
+    $expect(AutosaveJournal::snapshot_id(path)).toBe(id);
+
+    std::ofstream(path) << "<data></data>";
+    $expect(AutosaveJournal::snapshot_id(path)).Not.toBe(id);
+
+    base_remove(path);
+  });
+
 }
 
 }
@@ -404,6 +404,64 @@ $describe("General Undo/Redo") {
 
   //--------------------------------------------------------------------------------------------------------------------
 
+  $it("Repeated member changes and undo memory limit", [this]() {
+    db_TableRef table(data->tester->getCatalog()->schemata()[0]->tables()[0]);
+    std::string oldComment = *table->comment();
+
+    data->resetUndoAccounting();
+
+    // Repeated changes of the same member in one action only keep the oldest value.
+    {
+      grt::AutoUndo undo;
+      for (int i = 0; i < 10; ++i)
+        table->comment("comment " + std::to_string(i));
+      undo.end("Change Comment");
+    }
+    data->checkOnlyOneUndoAdded();
+
+    grt::UndoGroup *group = dynamic_cast<grt::UndoGroup *>(data->um->get_undo_stack().back());
+    $expect(group).Not.toBeNull("undo group");
+    $expect(group->get_actions().size()).toBe(1U, "merged member changes");
+    grt::UndoObjectChangeAction *change = dynamic_cast<grt::UndoObjectChangeAction *>(group->get_actions().front());
+    $expect(change).Not.toBeNull("member change");
+    $expect(change->get_member()).toEqual("comment", "changed member");
+    $expect(*grt::StringRef::cast_from(change->get_value())).toEqual(oldComment, "oldest value");
+    $expect(group->memory_footprint()).toBeGreaterThan(0U, "footprint");
+
+    data->checkUndo();
+    $expect(*table->comment()).toEqual(oldComment, "comment restored");
+
+    // Old entries are dropped once the limit is exceeded, the newest one is always kept.
+    size_t oldLimit = data->um->get_undo_memory_limit();
+    data->resetUndoAccounting();
+    {
+      grt::AutoUndo undo;
+      table->comment("changed");
+      undo.end("Change Comment");
+    }
+    size_t savePoint = data->um->get_latest_closed_undo_serial();
+    {
+      grt::AutoUndo undo;
+      table->comment(oldComment);
+      undo.end("Change Comment");
+    }
+    $expect(data->um->get_undo_stack().size()).toEqual(data->lastUndoStackSize + 2, "2 undo actions");
+
+    data->um->set_undo_memory_limit(1);
+    $expect(data->um->get_undo_stack().size()).toEqual(1U, "only newest action kept");
+
+    // A save point taken at a dropped action must never match a later state.
+    $expect(data->um->get_latest_closed_undo_serial()).toBeGreaterThan(savePoint, "newer serial");
+    data->um->undo();
+    $expect(data->um->get_latest_closed_undo_serial()).Not.toEqual(savePoint, "dropped save point");
+    data->um->set_undo_memory_limit(oldLimit);
+
+    data->um->reset();
+    data->resetUndoAccounting();
+  });
+
+  //--------------------------------------------------------------------------------------------------------------------
+
   $it("Configuration: general settings", []() {
     $pending("not implemented");
   });
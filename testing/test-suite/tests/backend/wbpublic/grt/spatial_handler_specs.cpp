@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2020, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#include <cstdlib>
+#include <mutex>
+
+#include "grt/spatial_handler.h"
+
+#include "casmine.h"
+
+namespace {
+
+// Paints a fixed set of boxes, but only those reaching into the clip area, as the index query of a real layer does.
+class BoxLayer : public spatial::Layer {
+public:
+  std::vector<base::Rect> boxes;
+  std::vector<base::Rect> clip_areas;
+  std::mutex mutex;
+
+  BoxLayer() : spatial::Layer(spatial::new_layer_id(), base::Color(0, 0, 0)) {
+    set_show(true);
+  }
+
+  virtual void repaint(mdc::CairoCtx &cr, float scale, const base::Rect &clip_area) override {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      clip_areas.push_back(clip_area);
+    }
+
+    cr.set_color(base::Color(0, 0, 0));
+    for (const base::Rect &box : boxes) {
+      if (box.right() >= clip_area.left() && box.left() <= clip_area.right() && box.bottom() >= clip_area.top() &&
+          box.top() <= clip_area.bottom()) {
+        cr.rectangle(box);
+        cr.fill();
+      }
+    }
+  }
+};
+
+$ModuleEnvironment() {};
+
+$describe("Spatial view helpers") {
+
+  $it("Simplification keeps the end points and the shape within the tolerance", []() {
+    std::vector<base::Point> line;
+    for (int i = 0; i <= 100; ++i)
+      line.push_back(base::Point(i, i % 2 == 0 ? 0.0 : 0.1));
+    line.push_back(base::Point(101, 50));
+
+    std::vector<base::Point> simplified;
+    spatial::simplify_points(line, 0.5, simplified);
+    $expect(simplified.size()).toBe(3U);
+    $expect(simplified.front().x).toBe(0.0);
+    $expect(simplified[1].x).toBe(100.0);
+    $expect(simplified.back().y).toBe(50.0);
+
+    spatial::simplify_points(line, 0.05, simplified);
+    $expect(simplified.size()).toBe(line.size());
+  });
+
+  $it("Index queries return the same features as a full scan", []() {
+    std::vector<std::pair<spatial::FeatureIndex::Box, size_t> > items;
+    srand(42);
+    for (size_t i = 0; i < 1000; ++i) {
+      double x = rand() % 1000, y = rand() % 1000;
+      spatial::FeatureIndex::Box box = {x, y, x + rand() % 40, y + rand() % 40};
+      items.push_back(std::make_pair(box, i));
+    }
+
+    spatial::FeatureIndex index;
+    $expect(index.empty()).toBeTrue();
+    index.build(items);
+    $expect(index.empty()).toBeFalse();
+
+    for (int i = 0; i < 100; ++i) {
+      double x = rand() % 1000, y = rand() % 1000;
+      spatial::FeatureIndex::Box area = {x, y, x + rand() % 100, y + rand() % 100};
+
+      std::vector<size_t> expected, found;
+      for (size_t j = 0; j < items.size(); ++j) {
+        if (items[j].first.intersects(area))
+          expected.push_back(items[j].second);
+      }
+      index.query(area, found);
+      $expect(found == expected).toBeTrue();
+    }
+
+    index.clear();
+    $expect(index.empty()).toBeTrue();
+  });
+
+  $it("Layers painted in several bands show the features of every band", []() {
+    BoxLayer layer;
+    for (int y = 0; y < 120; y += 8)
+      layer.boxes.push_back(base::Rect(10, y, 10, 2));
+    std::deque<spatial::Layer *> layers(1, &layer);
+
+    // Layer coordinates are scaled by 2 vertically and shifted, like a zoomed and dragged view.
+    cairo_matrix_t view;
+    cairo_matrix_init(&view, 1, 0, 0, 2, 5, 10);
+
+    mdc::ImageSurface target(64, 256, CAIRO_FORMAT_ARGB32);
+    bool quitting = false;
+    spatial::paint_layers(target, view, layers, 1, 4, quitting);
+
+    $expect(layer.clip_areas.size()).toBe(4U);
+    for (const base::Rect &area : layer.clip_areas)
+      $expect(area.height()).toBe(32.0);
+
+    cairo_surface_t *surface = target.get_surface();
+    cairo_surface_flush(surface);
+    const unsigned char *data = cairo_image_surface_get_data(surface);
+    const int stride = cairo_image_surface_get_stride(surface);
+    for (const base::Rect &box : layer.boxes) {
+      int x = (int)box.left() + 5 + 5, y = (int)(box.top() + 1) * 2 + 10;
+      const uint32_t pixel = *(const uint32_t *)(data + y * stride + x * 4);
+      $expect(pixel >> 24).toBe(255U);
+    }
+  });
+}
+
+}
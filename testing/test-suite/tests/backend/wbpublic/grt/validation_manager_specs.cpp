@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2020, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#include "grt/validation_manager.h"
+#include "grtpp_undo_manager.h"
+#include "base/string_utilities.h"
+
+#include "wb_test_helpers.h"
+#include "casmine.h"
+
+using namespace bec;
+
+namespace {
+
+$ModuleEnvironment() {};
+
+// Reports tables whose name starts with "bad" and counts the validations of each table.
+class TableNameValidator : public grt::Validator {
+public:
+  std::map<std::string, int> validations;
+
+  virtual int validate(const Tag &tag, const grt::ObjectRef &object) {
+    if (tag != CHECK_NAME || !db_TableRef::can_wrap(object))
+      return 0;
+
+    ++validations[object.id()];
+    if (base::hasPrefix(*db_TableRef::cast_from(object)->name(), "bad")) {
+      ValidationManager::message(tag, object, "Invalid table name", grt::ErrorMsg);
+      return 1;
+    }
+    return 0;
+  }
+};
+
+$TestData {
+  std::unique_ptr<WorkbenchTester> tester;
+};
+
+$describe("Incremental validation") {
+
+  $beforeAll([this]() {
+    data->tester.reset(new WorkbenchTester());
+    data->tester->initializeRuntime();
+  });
+
+  $it("Only changed objects and their dependents are validated again", [this]() {
+    TableNameValidator validator;
+    ValidationManager::register_validator("db.Table", &validator);
+    $expect(ValidationManager::has_validators()).toBeTrue();
+
+    std::set<std::string> errors;
+    boost::signals2::scoped_connection connection = ValidationManager::signal_notify()->connect(
+      [&errors](const grt::Validator::Tag &tag, const grt::ObjectRef &object, const std::string &, const int level) {
+        if (level == grt::ErrorMsg)
+          errors.insert(object.id());
+        else if (level == grt::NoErrorMsg && tag != "*")
+          errors.erase(object.id());
+      });
+
+    db_mysql_CatalogRef catalog = createEmptyCatalog();
+    db_mysql_SchemaRef schema(grt::Initialized);
+    schema->owner(catalog);
+    schema->name("validation");
+    catalog->schemata().insert(schema);
+    addSyntheticTables(schema, 100, 5);
+
+    // table_1 references table_0, the view uses table_2.
+    db_mysql_TableRef table0 = schema->tables()[0];
+    db_mysql_TableRef table1 = schema->tables()[1];
+    db_mysql_TableRef table2 = schema->tables()[2];
+    db_mysql_TableRef table5 = schema->tables()[5];
+
+    db_mysql_ForeignKeyRef fk(grt::Initialized);
+    fk->owner(table1);
+    fk->name("fk_table_0");
+    fk->referencedTable(table0);
+    table1->foreignKeys().insert(fk);
+
+    db_mysql_ViewRef view(grt::Initialized);
+    view->owner(schema);
+    view->name("view_2");
+    view->sqlDefinition("CREATE VIEW view_2 AS SELECT * FROM validation.table_2");
+    schema->views().insert(view);
+
+    catalog->mark_global();
+
+    IncrementalValidator incremental({ CHECK_NAME });
+    incremental.attach(catalog, grt::GRT::get()->get_undo_manager());
+
+    // The first round validates everything: the schema, the tables and the view.
+    incremental.validate_all();
+    $expect(incremental.pending_count()).toEqual((size_t)0);
+    $expect(incremental.validated_count()).toEqual((size_t)102);
+    $expect(validator.validations.size()).toEqual((size_t)100);
+    $expect(errors.empty()).toBeTrue();
+
+    // Renaming a referenced table validates it and the table referencing it.
+    {
+      grt::AutoUndo undo;
+      table0->name("bad_table_0");
+      undo.end("Rename table");
+    }
+    $expect(incremental.pending_count()).toEqual((size_t)1);
+    incremental.validate_all();
+    $expect(incremental.validated_count()).toEqual((size_t)104);
+    $expect(validator.validations[table0.id()]).toEqual(2);
+    $expect(validator.validations[table1.id()]).toEqual(2);
+    $expect(validator.validations[table5.id()]).toEqual(1);
+    $expect(errors.size()).toEqual((size_t)1);
+    $expect(errors.count(table0.id())).toEqual((size_t)1);
+
+    // Changing a column validates the table owning it and the view using that table.
+    {
+      grt::AutoUndo undo;
+      table2->columns()[1]->comment("changed");
+      undo.end("Change column");
+    }
+    incremental.validate_all();
+    $expect(incremental.validated_count()).toEqual((size_t)106);
+    $expect(validator.validations[table2.id()]).toEqual(2);
+
+    // Renaming a table validates the views still using its old name.
+    {
+      grt::AutoUndo undo;
+      table2->name("renamed_table_2");
+      undo.end("Rename table");
+    }
+    incremental.validate_all();
+    $expect(incremental.validated_count()).toEqual((size_t)108);
+    $expect(validator.validations[table2.id()]).toEqual(3);
+
+    // Messages go away when the problem is fixed or the table is removed.
+    {
+      grt::AutoUndo undo;
+      table0->name("table_0");
+      table5->name("bad_table_5");
+      undo.end("Rename tables");
+    }
+    incremental.validate_all();
+    $expect(errors.size()).toEqual((size_t)1);
+    $expect(errors.count(table5.id())).toEqual((size_t)1);
+
+    {
+      grt::AutoUndo undo;
+      schema->tables().remove_value(table5);
+      undo.end("Remove table");
+    }
+    incremental.validate_all();
+    $expect(errors.empty()).toBeTrue();
+
+    incremental.detach();
+    grt::GRT::get()->get_metaclass("db.Table")->remove_validator(&validator);
+  });
+
+}
+
+}
@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2020, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#include <algorithm>
+#include <cstdio>
+
+#include "sqlide/completion_cache.h"
+
+#include "casmine.h"
+
+namespace {
+
+$ModuleEnvironment() {};
+
+typedef CompletionCache::SchemaObject SchemaObject;
+
+static std::string cacheDir() {
+  return casmine::CasmineContext::get()->outputDir();
+}
+
+// Starts every spec with an empty cache file.
+static void removeCacheFile(const std::string &connection) {
+  std::remove((cacheDir() + "/" + connection + ".completion_cache").c_str());
+}
+
+static std::vector<SchemaObject> sorted(std::vector<SchemaObject> objects) {
+  std::sort(objects.begin(), objects.end(), [](const SchemaObject &lhs, const SchemaObject &rhs) {
+    return lhs.name < rhs.name || (lhs.name == rhs.name && lhs.type < rhs.type);
+  });
+  return objects;
+}
+
+static void expectObject(const SchemaObject &object, const std::string &name, CompletionCache::ObjectType type,
+                         const std::string &stamp, const std::vector<std::string> &columns) {
+  $expect(object.name).toBe(name);
+  $expect((int)object.type).toBe((int)type, name);
+  $expect(object.stamp).toBe(stamp, name);
+  $expect(object.columns == columns).toBeTrue(name + ": unexpected columns");
+}
+
+$describe("Code completion cache") {
+  $it("Objects and columns survive reopening the cache", []() {
+    removeCacheFile("round_trip");
+    {
+      CompletionCache cache("round_trip", cacheDir());
+      cache.storeObjects("sakila", {
+        { "actor", CompletionCache::Table, "2020-01-01 10:00:00", { "actor_id", "first_name", "last_name", "x" } },
+        { "actor_info", CompletionCache::View, "e3b0c442", { "actor_id", "film_info" } },
+        { "rewards_report", CompletionCache::Procedure, "2020-01-02 10:00:00", {} },
+        { "get_customer_balance", CompletionCache::Function, "2020-01-03 10:00:00", {} },
+      });
+      cache.storeObjects("world", { { "city", CompletionCache::Table, "2020-01-04 10:00:00", { "id", "name" } } });
+
+      // Replacing an object replaces its whole column list.
+      cache.storeObjects("sakila", {
+        { "actor", CompletionCache::Table, "2020-01-05 10:00:00", { "actor_id", "first_name", "last_name" } },
+      });
+    }
+
+    CompletionCache cache("round_trip", cacheDir());
+    std::vector<std::string> schemas = cache.cachedSchemas();
+    std::sort(schemas.begin(), schemas.end());
+    $expect(schemas == std::vector<std::string>({ "sakila", "world" })).toBeTrue();
+
+    std::vector<SchemaObject> objects = sorted(cache.schemaObjects("sakila"));
+    $expect(objects.size()).toBe(4U);
+    expectObject(objects[0], "actor", CompletionCache::Table, "2020-01-05 10:00:00",
+                 { "actor_id", "first_name", "last_name" });
+    expectObject(objects[1], "actor_info", CompletionCache::View, "e3b0c442", { "actor_id", "film_info" });
+    expectObject(objects[2], "get_customer_balance", CompletionCache::Function, "2020-01-03 10:00:00", {});
+    expectObject(objects[3], "rewards_report", CompletionCache::Procedure, "2020-01-02 10:00:00", {});
+
+    objects = cache.schemaObjects("world");
+    $expect(objects.size()).toBe(1U);
+    expectObject(objects[0], "city", CompletionCache::Table, "2020-01-04 10:00:00", { "id", "name" });
+    $expect(cache.schemaObjects("unknown").empty()).toBeTrue();
+
+    cache.removeObjects("sakila", { { "actor", CompletionCache::Table, "", {} } });
+    cache.removeSchema("world");
+    $expect(cache.cachedSchemas() == std::vector<std::string>({ "sakila" })).toBeTrue();
+    objects = sorted(cache.schemaObjects("sakila"));
+    $expect(objects.size()).toBe(3U);
+    $expect(objects[0].name).toBe("actor_info");
+  });
+
+  $it("Changed, unstamped, new and dropped objects are found", []() {
+    removeCacheFile("compare");
+    CompletionCache cache("compare", cacheDir());
+    cache.storeObjects("sakila", {
+      { "actor", CompletionCache::Table, "2020-01-01 10:00:00", { "actor_id" } },
+      { "film", CompletionCache::Table, "2020-01-01 10:00:00", { "film_id" } },
+      { "actor_info", CompletionCache::View, "e3b0c442", { "actor_id" } },
+      { "film_list", CompletionCache::View, "98fc1c14", { "fid" } },
+      { "staff_list", CompletionCache::View, "", { "id" } },
+      { "inventory_in_stock", CompletionCache::Function, "2020-01-01 10:00:00", {} },
+      { "sales", CompletionCache::Table, "2020-01-01 10:00:00", { "id" } },
+    });
+
+    std::vector<SchemaObject> changed, removed;
+    cache.compareObjects("sakila", {
+      { "actor", CompletionCache::Table, "2020-01-01 10:00:00", {} },       // unchanged
+      { "film", CompletionCache::Table, "2020-01-01 10:00:00,2020-02-01 10:00:00", {} }, // updated
+      { "actor_info", CompletionCache::View, "e3b0c442", {} },              // same definition
+      { "film_list", CompletionCache::View, "5d41402a", {} },               // definition changed
+      { "staff_list", CompletionCache::View, "", {} },                      // definition not readable
+      { "customer", CompletionCache::Table, "2020-01-01 10:00:00", {} },    // new
+      { "sales", CompletionCache::View, "7215ee9c", {} },                   // table replaced by a view
+    }, changed, removed);
+
+    changed = sorted(changed);
+    $expect(changed.size()).toBe(5U);
+    expectObject(changed[0], "customer", CompletionCache::Table, "2020-01-01 10:00:00", {});
+    expectObject(changed[1], "film", CompletionCache::Table, "2020-01-01 10:00:00,2020-02-01 10:00:00", {});
+    expectObject(changed[2], "film_list", CompletionCache::View, "5d41402a", {});
+    expectObject(changed[3], "sales", CompletionCache::View, "7215ee9c", {});
+    expectObject(changed[4], "staff_list", CompletionCache::View, "", {});
+
+    removed = sorted(removed);
+    $expect(removed.size()).toBe(2U);
+    $expect(removed[0].name).toBe("inventory_in_stock");
+    $expect((int)removed[0].type).toBe((int)CompletionCache::Function);
+    $expect(removed[1].name).toBe("sales");
+    $expect((int)removed[1].type).toBe((int)CompletionCache::Table);
+
+    // Once stored, a view is only read again when its definition changes.
+    changed[3].columns = { "id", "total" };
+    cache.removeObjects("sakila", removed);
+    cache.storeObjects("sakila", changed);
+    changed.clear();
+    removed.clear();
+    cache.compareObjects("sakila", {
+      { "actor", CompletionCache::Table, "2020-01-01 10:00:00", {} },
+      { "film", CompletionCache::Table, "2020-01-01 10:00:00,2020-02-01 10:00:00", {} },
+      { "actor_info", CompletionCache::View, "e3b0c442", {} },
+      { "film_list", CompletionCache::View, "5d41402a", {} },
+      { "customer", CompletionCache::Table, "2020-01-01 10:00:00", {} },
+      { "sales", CompletionCache::View, "7215ee9c", {} },
+    }, changed, removed);
+    $expect(changed.empty()).toBeTrue();
+    $expect(removed.size()).toBe(1U);
+    $expect(removed[0].name).toBe("staff_list");
+
+    std::vector<SchemaObject> objects = sorted(cache.schemaObjects("sakila"));
+    $expect(objects.size()).toBe(7U);
+    expectObject(objects[5], "sales", CompletionCache::View, "7215ee9c", { "id", "total" });
+  });
+
+  $it("A cleared cache makes every object be read again", []() {
+    removeCacheFile("clear");
+    {
+      CompletionCache cache("clear", cacheDir());
+      cache.storeObjects("sakila", { { "actor", CompletionCache::Table, "2020-01-01 10:00:00", { "actor_id" } } });
+      cache.storeObjects("world", { { "city", CompletionCache::Table, "2020-01-01 10:00:00", { "id" } } });
+      cache.clear();
+      $expect(cache.cachedSchemas().empty()).toBeTrue();
+    }
+
+    CompletionCache cache("clear", cacheDir());
+    $expect(cache.cachedSchemas().empty()).toBeTrue();
+    $expect(cache.schemaObjects("sakila").empty()).toBeTrue();
+
+    std::vector<SchemaObject> changed, removed;
+    cache.compareObjects("sakila", { { "actor", CompletionCache::Table, "2020-01-01 10:00:00", {} } }, changed,
+                         removed);
+    $expect(changed.size()).toBe(1U);
+    $expect(removed.empty()).toBeTrue();
+  });
+}
+
+}
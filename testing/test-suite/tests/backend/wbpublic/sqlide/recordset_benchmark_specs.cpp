@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2020, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#include "sqlide/recordset_cdbc_storage.h"
+#include "sqlide/recordset_be.h"
+#include "cppdbc.h"
+
+#include "casmine.h"
+#include "wb_test_helpers.h"
+#include "wb_connection_helpers.h"
+
+// Benchmarks for filling and sorting result sets. Run with --benchmarks.
+
+namespace {
+
+$ModuleEnvironment() {};
+
+// Generates 100000 rows via cross joins, which works on all server versions (no recursive CTE needed).
+static const char *query =
+  "SELECT n, md5(n) AS hash, concat('row ', n) AS name, n * 1.5 AS value FROM ("
+  "SELECT a.d + b.d * 10 + c.d * 100 + e.d * 1000 + f.d * 10000 AS n FROM "
+  "(SELECT 0 d UNION SELECT 1 UNION SELECT 2 UNION SELECT 3 UNION SELECT 4 UNION SELECT 5 UNION SELECT 6 "
+  "UNION SELECT 7 UNION SELECT 8 UNION SELECT 9) a, "
+  "(SELECT 0 d UNION SELECT 1 UNION SELECT 2 UNION SELECT 3 UNION SELECT 4 UNION SELECT 5 UNION SELECT 6 "
+  "UNION SELECT 7 UNION SELECT 8 UNION SELECT 9) b, "
+  "(SELECT 0 d UNION SELECT 1 UNION SELECT 2 UNION SELECT 3 UNION SELECT 4 UNION SELECT 5 UNION SELECT 6 "
+  "UNION SELECT 7 UNION SELECT 8 UNION SELECT 9) c, "
+  "(SELECT 0 d UNION SELECT 1 UNION SELECT 2 UNION SELECT 3 UNION SELECT 4 UNION SELECT 5 UNION SELECT 6 "
+  "UNION SELECT 7 UNION SELECT 8 UNION SELECT 9) e, "
+  "(SELECT 0 d UNION SELECT 1 UNION SELECT 2 UNION SELECT 3 UNION SELECT 4 UNION SELECT 5 UNION SELECT 6 "
+  "UNION SELECT 7 UNION SELECT 8 UNION SELECT 9) f) numbers";
+
+static const size_t rowCount = 100000;
+
+$TestData {
+  std::unique_ptr<WorkbenchTester> tester;
+  sql::Dbc_connection_handler::Ref connection;
+  base::RecMutex connectionLock;
+
+  Recordset::Ref createRecordset() {
+    Recordset_cdbc_storage::Ref storage(Recordset_cdbc_storage::create());
+    storage->setUserConnectionGetter(
+      [this](sql::Dbc_connection_handler::Ref &conn, bool LockOnly = false) -> base::RecMutexLock {
+        base::RecMutexLock lock(connectionLock, false);
+        conn = connection;
+        return lock;
+      }
+    );
+
+    std::shared_ptr<sql::Statement> statement(connection->ref->createStatement());
+    statement->execute(query);
+    std::shared_ptr<sql::ResultSet> resultSet(statement->getResultSet());
+    storage->dbc_resultset(resultSet);
+
+    Recordset::Ref recordset = Recordset::create();
+    recordset->data_storage(storage);
+    return recordset;
+  }
+};
+
+static void dummy() {
+}
+
+$describe("Recordset benchmarks") {
+
+  $beforeAll([this]() {
+    if (!casmine::benchmarksEnabled())
+      return;
+
+    data->tester.reset(new WorkbenchTester());
+    data->tester->initializeRuntime();
+
+    sql::DriverManager *manager = sql::DriverManager::getDriverManager();
+    data->connection = sql::Dbc_connection_handler::Ref(new sql::Dbc_connection_handler());
+
+    db_mgmt_ConnectionRef connectionProperties(grt::Initialized);
+    setupConnectionEnvironment(connectionProperties);
+    data->connection->ref = manager->getConnection(connectionProperties, std::bind(dummy));
+
+    $expect(data->connection->ref.get()).Not.toBeNull("connection");
+  });
+
+  $it("Fill a recordset with 100000 rows", [this]() {
+    $requireBenchmarks();
+
+    size_t count = 0;
+    casmine::BenchmarkOptions options;
+    options.iterations = 5;
+    $benchmark("recordset/fill (100000 rows)", [&]() {
+      Recordset::Ref recordset = data->createRecordset();
+      recordset->reset(true);
+      count = recordset->row_count();
+    }, options);
+
+    $expect(count).toBe(rowCount);
+  });
+
+  $it("Sort a recordset with 100000 rows", [this]() {
+    $requireBenchmarks();
+
+    Recordset::Ref recordset = data->createRecordset();
+    recordset->reset(true);
+    $expect(recordset->row_count()).toBe(rowCount);
+
+    // Alternate the direction, so each iteration has to do the full work.
+    int direction = 1;
+    casmine::BenchmarkOptions options;
+    options.iterations = 10;
+    $benchmark("recordset/sort by text column (100000 rows)", [&]() {
+      recordset->sort_by(1, direction, false);
+      direction = -direction;
+    }, options);
+  });
+
+}
+
+}
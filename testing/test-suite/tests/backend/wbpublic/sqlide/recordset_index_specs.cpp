@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2020, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#include <algorithm>
+
+#include "sqlide/recordset_index.h"
+
+#include "casmine.h"
+
+using namespace sqlide;
+
+namespace {
+
+$ModuleEnvironment() {};
+
+static void addText(IndexColumn &column, const std::string &text) {
+  column.addText(text.data(), text.size());
+}
+
+$describe("Recordset in-memory index") {
+  $it("LIKE matching", []() {
+    auto like = [](const std::string &text, const std::string &pattern) {
+      return likeMatch(text.data(), text.size(), pattern);
+    };
+
+    $expect(like("abc", "abc")).toBeTrue();
+    $expect(like("ABC", "abc")).toBeTrue();
+    $expect(like("abc", "a%")).toBeTrue();
+    $expect(like("abc", "%c")).toBeTrue();
+    $expect(like("abc", "%b%")).toBeTrue();
+    $expect(like("abc", "a_c")).toBeTrue();
+    $expect(like("abc", "%")).toBeTrue();
+    $expect(like("", "%")).toBeTrue();
+    $expect(like("abc", "ab")).toBeFalse();
+    $expect(like("abc", "%d%")).toBeFalse();
+    $expect(like("abc", "a__c")).toBeFalse();
+    $expect(like("\xc3\xa4x", "_x")).toBeTrue(); // _ matches a whole UTF-8 sequence.
+  });
+
+  $it("Substring search marks the same rows as LIKE", []() {
+    IndexColumn column(IndexColumn::NoCase);
+    std::vector<std::string> values = { "Hello World", "hello", "", "no match here", "WORLDWIDE", "xhellox" };
+    for (auto &value : values)
+      addText(column, value);
+    column.addNull();
+
+    for (std::string needle : { "hello", "world", "o", "x", "zzz" }) {
+      std::vector<char> found(column.size(), 0);
+      column.markRowsContaining(needle, found);
+      for (size_t row = 0; row < column.size(); ++row) {
+        bool expected = !column.isNull(row) && column.matchesPattern(row, "%" + needle + "%");
+        $expect(found[row] != 0).toBe(expected, "needle: " + needle);
+      }
+    }
+  });
+
+  $it("Sorting is stable, puts NULLs first and supports descending order", []() {
+    IndexColumn numbers(IndexColumn::Numeric);
+    IndexColumn names(IndexColumn::NoCase);
+
+    numbers.addNumber(3);  names.addText("b", 1);
+    numbers.addNumber(-1); names.addText("a", 1);
+    numbers.addNull();     names.addText("B", 1);
+    numbers.addNumber(3);  names.addText("A", 1);
+    numbers.addNumber(10); names.addNull();
+
+    std::vector<size_t> rows = { 0, 1, 2, 3, 4 };
+    sortRows(rows, { { &numbers, 1 } });
+    $expect(rows).toEqual(std::vector<size_t>({ 2, 1, 0, 3, 4 }));
+
+    sortRows(rows, { { &numbers, -1 } });
+    $expect(rows).toEqual(std::vector<size_t>({ 4, 0, 3, 1, 2 }));
+
+    // Case insensitive names, equal names keep their previous order.
+    rows = { 0, 1, 2, 3, 4 };
+    sortRows(rows, { { &names, 1 } });
+    $expect(rows).toEqual(std::vector<size_t>({ 4, 1, 3, 0, 2 }));
+
+    rows = { 0, 1, 2, 3, 4 };
+    sortRows(rows, { { &names, 1 }, { &numbers, -1 } });
+    $expect(rows).toEqual(std::vector<size_t>({ 4, 3, 1, 0, 2 }));
+  });
+
+  $it("Sorting many rows gives the same result as a scalar sort", []() {
+    IndexColumn column(IndexColumn::Numeric);
+    size_t count = 300000;
+    column.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+      if (i % 97 == 0)
+        column.addNull();
+      else
+        column.addNumber((long double)((i * 7919) % 1000));
+    }
+
+    std::vector<size_t> rows(count);
+    for (size_t i = 0; i < count; ++i)
+      rows[i] = i;
+    std::vector<size_t> expected = rows;
+    std::stable_sort(expected.begin(), expected.end(),
+                     [&](size_t a, size_t b) { return column.compare(a, b) < 0; });
+
+    sortRows(rows, { { &column, 1 } });
+    $expect(rows == expected).toBeTrue();
+  });
+});
+
+}
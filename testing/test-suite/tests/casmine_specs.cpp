@@ -431,6 +431,27 @@ $describe("Casmine internal") {
     $expect(wp).Not.toBeNull();
     $expect(wp).toBeValid();
   });
+
+  $it("Benchmark statistics", []() {
+    std::vector<double> samples;
+    for (int i = 100; i > 0; --i)
+      samples.push_back(i);
+
+    BenchmarkStatistics statistics = BenchmarkStatistics::fromSamples(samples);
+    $expect(statistics.min).toBe(1.0);
+    $expect(statistics.max).toBe(100.0);
+    $expect(statistics.median).toBe(50.0);
+    $expect(statistics.p90).toBe(90.0);
+    $expect(statistics.p99).toBe(99.0);
+    $expect(statistics.mean).toBe(50.5);
+
+    statistics = BenchmarkStatistics::fromSamples({ 42 });
+    $expect(statistics.min).toBe(42.0);
+    $expect(statistics.p99).toBe(42.0);
+
+    statistics = BenchmarkStatistics::fromSamples({});
+    $expect(statistics.median).toBe(0.0);
+  });
 }
 
 }
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2020, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#include <thread>
+
+#include "base/profiling.h"
+
+#include "casmine.h"
+
+namespace {
+
+$ModuleEnvironment() {};
+
+static size_t countOccurrences(const std::string &text, const std::string &pattern) {
+  size_t count = 0;
+  for (size_t position = text.find(pattern); position != std::string::npos;
+       position = text.find(pattern, position + pattern.size()))
+    ++count;
+  return count;
+}
+
+$describe("Tracer") {
+  $beforeEach([]() {
+    base::Tracer::clear();
+  });
+
+  $afterEach([]() {
+    base::Tracer::stop();
+  });
+
+  $it("Records nothing when not enabled", []() {
+    $expect(base::Tracer::is_enabled()).toBeFalse();
+    {
+      TRACE_ZONE("disabled zone");
+      base::Tracer::instant("disabled instant");
+      base::Tracer::counter("disabled counter", 1);
+    }
+    $expect(base::Tracer::chrome_trace()).Not.toContain("disabled");
+  });
+
+  $it("Records zones, instants and counters", []() {
+    base::Tracer::start();
+    $expect(base::Tracer::is_enabled()).toBeTrue();
+    {
+      TRACE_ZONE("outer zone");
+      TRACE_ZONE(base::Tracer::intern(std::string("inner ") + "zone"));
+      base::Tracer::instant("something happened");
+      base::Tracer::counter("row count", 42);
+    }
+    base::Tracer::stop();
+
+    std::string trace = base::Tracer::chrome_trace();
+    $expect(trace).toContain("\"traceEvents\":[");
+    $expect(countOccurrences(trace, "\"name\":\"outer zone\"")).toBe(2u);
+    $expect(countOccurrences(trace, "\"name\":\"inner zone\"")).toBe(2u);
+    $expect(trace).toContain("\"name\":\"something happened\"");
+    $expect(trace).toContain("\"value\":42");
+
+    // Inner zone must be closed before the outer one.
+    $expect(trace.rfind("\"name\":\"inner zone\"")).toBeLessThan(trace.rfind("\"name\":\"outer zone\""));
+  });
+
+  $it("Interns names only once", []() {
+    const char *first = base::Tracer::intern("interned name");
+    const char *second = base::Tracer::intern(std::string("interned ") + "name");
+    $expect(first == second).toBeTrue();
+  });
+
+  $it("Keeps the events of other threads", []() {
+    base::Tracer::start();
+    std::thread worker([]() {
+      base::Tracer::set_thread_name("spec worker");
+      TRACE_ZONE("worker zone");
+    });
+    worker.join();
+    base::Tracer::stop();
+
+    std::string trace = base::Tracer::chrome_trace();
+    $expect(trace).toContain("\"name\":\"thread_name\"");
+    $expect(trace).toContain("\"spec worker\"");
+    $expect(trace).toContain("\"name\":\"worker zone\"");
+
+    // Buffers of finished threads are released on clear.
+    base::Tracer::clear();
+    $expect(base::Tracer::chrome_trace()).Not.toContain("spec worker");
+  });
+
+  $it("Keeps thread names without recording while not enabled", []() {
+    std::thread idle([]() {
+      base::Tracer::set_thread_name("idle worker");
+      TRACE_ZONE("idle zone");
+    });
+    idle.join();
+    $expect(base::Tracer::chrome_trace()).Not.toContain("idle worker");
+
+    // The name is still used once the thread records something.
+    std::thread late([]() {
+      base::Tracer::set_thread_name("late worker");
+      base::Tracer::start();
+      TRACE_ZONE("late zone");
+    });
+    late.join();
+    base::Tracer::stop();
+
+    std::string trace = base::Tracer::chrome_trace();
+    $expect(trace).toContain("\"late worker\"");
+    $expect(trace).toContain("\"name\":\"late zone\"");
+  });
+
+  $it("Escapes names for JSON", []() {
+    base::Tracer::start();
+    base::Tracer::instant(base::Tracer::intern("quoted \"name\"\\"));
+    base::Tracer::stop();
+
+    $expect(base::Tracer::chrome_trace()).toContain("quoted \\\"name\\\"\\\\");
+  });
+}
+
+}
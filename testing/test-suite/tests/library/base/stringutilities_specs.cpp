@@ -23,6 +23,8 @@
 
 #include "base/sqlstring.h"
 
+#include <random>
+
 #include "casmine.h"
 
 namespace {
@@ -33,6 +35,58 @@ $TestData {
   std::string long_random_string; // Content doesn't matter. There must be no crash using it.
 };
 
+// Char by char escaping, as done before the vectorized implementations. Used as reference.
+static std::string referenceEscape(const std::string &s, bool json, bool wildcards) {
+  std::string result;
+  for (auto ch : s) {
+    char escape = 0;
+    switch (ch) {
+      case 0:
+        escape = json ? 0 : '0';
+        break;
+      case '\n':
+        escape = 'n';
+        break;
+      case '\r':
+        escape = 'r';
+        break;
+      case '\\':
+        escape = '\\';
+        break;
+      case '\'':
+        escape = json ? 0 : '\'';
+        break;
+      case '"':
+        escape = '"';
+        break;
+      case '\032':
+        escape = json ? 0 : 'Z';
+        break;
+      case '\b':
+        escape = json ? 'b' : 0;
+        break;
+      case '\f':
+        escape = json ? 'f' : 0;
+        break;
+      case '\t':
+        escape = json ? 't' : 0;
+        break;
+      case '_':
+      case '%':
+        escape = (!json && wildcards) ? ch : 0;
+        break;
+    }
+    if (escape) {
+      result.push_back('\\');
+      result.push_back(escape);
+    } else
+      result.push_back(ch);
+  }
+  return result;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 $describe("string utilities") {
 
   $beforeAll([this]() {
@@ -228,6 +282,45 @@ $describe("string utilities") {
     $expect(test_result).toBe(long_string.substr(0, 1000));
   });
 
+  $it("SQL and JSON escaping", []() {
+    $expect(base::escape_sql_string("")).toBe("");
+    $expect(base::escape_sql_string("it's \"quoted\"\n")).toBe("it\\'s \\\"quoted\\\"\\n");
+    $expect(base::escape_sql_string(std::string("a\0b\032c", 5))).toBe("a\\0b\\Zc");
+    $expect(base::escape_sql_string("50%_off", false)).toBe("50%_off");
+    $expect(base::escape_sql_string("50%_off", true)).toBe("50\\%\\_off");
+    $expect(base::escape_json_string("tab\there\\ \"x\" 'y'\b\f\r")).toBe("tab\\there\\\\ \\\"x\\\" 'y'\\b\\f\\r");
+
+    std::string buffer = "prefix ";
+    base::append_escaped_sql_string(buffer, "'a'");
+    base::append_escaped_json_string(buffer, "\"b\"");
+    $expect(buffer).toBe("prefix \\'a\\'\\\"b\\\"");
+  });
+
+  $it("Escaping gives the same result as the char by char reference", []() {
+    // Mostly chars which need escaping or are close to those (and UTF-8 sequences), mixed with random bytes.
+    static const std::string interesting("ab_%'\"\\\n\r\t\b\f\032\x01\x1f\x7f\x80\xc3\xa4 \0", 21);
+
+    std::mt19937 random(4711);
+    for (size_t i = 0; i < 20000; ++i) {
+      std::string text;
+      size_t length = random() % 100;
+      for (size_t j = 0; j < length; ++j) {
+        if (random() % 3 == 0)
+          text.push_back(interesting[random() % interesting.size()]);
+        else
+          text.push_back((char)(random() % 256));
+      }
+
+      $expect(base::escape_sql_string(text, false)).toBe(referenceEscape(text, false, false));
+      $expect(base::escape_sql_string(text, true)).toBe(referenceEscape(text, false, true));
+      $expect(base::escape_json_string(text)).toBe(referenceEscape(text, true, false));
+
+      std::string buffer = "x";
+      base::append_escaped_sql_string(buffer, text.data(), text.size(), false);
+      $expect(buffer).toBe("x" + referenceEscape(text, false, false));
+    }
+  });
+
   $it("Text reflow", []() {
     std::string content1 = "11111111 22222 3333 444444 555555555 666666 77777777 88888 999999999 00000000";
     std::string content2 =
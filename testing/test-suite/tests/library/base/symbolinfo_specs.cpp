@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2020, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#include <set>
+
+#include "base/symbol-info.h"
+#include "base/string_utilities.h"
+
+#include "casmine.h"
+
+using namespace base;
+
+namespace {
+
+$ModuleEnvironment() {};
+
+$describe("MySQL symbol info") {
+  $it("Keyword lookup is case-insensitive and version aware", []() {
+    $expect(MySQLSymbolInfo::isKeyword("SELECT", MySQLVersion::MySQL80)).toBeTrue();
+    $expect(MySQLSymbolInfo::isKeyword("select", MySQLVersion::MySQL80)).toBeTrue();
+    $expect(MySQLSymbolInfo::isKeyword("SeLeCt", MySQLVersion::MySQL56)).toBeTrue();
+    $expect(MySQLSymbolInfo::isKeyword("selects", MySQLVersion::MySQL80)).toBeFalse();
+    $expect(MySQLSymbolInfo::isKeyword("selec", MySQLVersion::MySQL80)).toBeFalse();
+    $expect(MySQLSymbolInfo::isKeyword("", MySQLVersion::MySQL80)).toBeFalse();
+    $expect(MySQLSymbolInfo::isKeyword("customer", MySQLVersion::MySQL80)).toBeFalse();
+    $expect(MySQLSymbolInfo::isKeyword("select", MySQLVersion::Unknown)).toBeFalse();
+
+    $expect(MySQLSymbolInfo::isReservedKeyword("from", MySQLVersion::MySQL57)).toBeTrue();
+    $expect(MySQLSymbolInfo::isReservedKeyword("action", MySQLVersion::MySQL57)).toBeFalse();
+
+    // PERSIST came with 8.0, RANK is reserved since then.
+    KeywordInfo info = MySQLSymbolInfo::keywordInfo("persist", MySQLVersion::MySQL57);
+    $expect(info.id != KeywordInfo::NotAKeyword).toBeTrue();
+    $expect(info.keyword).toBeFalse();
+    $expect(info.since == MySQLVersion::MySQL80).toBeTrue();
+    $expect(MySQLSymbolInfo::keywordInfo("Persist", MySQLVersion::MySQL80).keyword).toBeTrue();
+    $expect(MySQLSymbolInfo::isReservedKeyword("rank", MySQLVersion::MySQL57)).toBeFalse();
+    $expect(MySQLSymbolInfo::isReservedKeyword("rank", MySQLVersion::MySQL80)).toBeTrue();
+  });
+
+  $it("Keyword ids are unique and match the keyword lists", []() {
+    size_t count = MySQLSymbolInfo::keywordCount();
+    std::set<size_t> ids;
+
+    for (auto version : { MySQLVersion::MySQL56, MySQLVersion::MySQL57, MySQLVersion::MySQL80 }) {
+      for (auto &keyword : MySQLSymbolInfo::keywordsForVersion(version)) {
+        KeywordInfo info = MySQLSymbolInfo::keywordInfo(keyword, version);
+        $expect(info.keyword).toBeTrue(keyword);
+        $expect(info.id < count).toBeTrue(keyword);
+        $expect(MySQLSymbolInfo::keywordInfo(base::tolower(keyword), version).id).toBe(info.id, keyword);
+        ids.insert(info.id);
+      }
+    }
+    $expect(ids.size()).toBe(count);
+  });
+
+  $it("Reserved keywords are quoted when needed", []() {
+    $expect(base::quoteIdentifierIfNeeded("select", '`', MySQLVersion::MySQL80)).toBe("`select`");
+    $expect(base::quoteIdentifierIfNeeded("Order", '`', MySQLVersion::MySQL80)).toBe("`Order`");
+    $expect(base::quoteIdentifierIfNeeded("action", '`', MySQLVersion::MySQL80)).toBe("action");
+    $expect(base::quoteIdentifierIfNeeded("rank", '`', MySQLVersion::MySQL57)).toBe("rank");
+    $expect(base::quoteIdentifierIfNeeded("rank", '`', MySQLVersion::MySQL80)).toBe("`rank`");
+  });
+});
+
+}
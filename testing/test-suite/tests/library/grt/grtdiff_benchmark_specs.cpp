@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2020, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#include "casmine.h"
+#include "wb_test_helpers.h"
+
+#include "grtdb/diff_dbobjectmatch.h"
+#include "diff/diffchange.h"
+#include "diff/grtdiff.h"
+
+// Benchmarks for the GRT diff of large catalogs. Run with --benchmarks.
+
+using namespace grt;
+
+namespace {
+
+$ModuleEnvironment() {};
+
+$TestData {
+  std::unique_ptr<WorkbenchTester> tester;
+
+  db_mysql_CatalogRef source;
+  db_mysql_CatalogRef copy;
+  db_mysql_CatalogRef target;
+
+  db_mysql_SchemaRef addSchema(db_mysql_CatalogRef catalog, std::string const& name) {
+    db_mysql_SchemaRef schema(grt::Initialized);
+    schema->owner(catalog);
+    schema->name(name);
+    catalog->schemata().insert(schema);
+    return schema;
+  }
+};
+
+$describe("GRT diff benchmarks") {
+
+  $beforeAll([this]() {
+    if (!casmine::benchmarksEnabled())
+      return;
+
+    data->tester.reset(new WorkbenchTester());
+    data->tester->initializeRuntime();
+
+    data->source = createEmptyCatalog();
+    addSyntheticTables(data->addSchema(data->source, "benchmark"), 2000, 20);
+
+    data->copy = createEmptyCatalog();
+    addSyntheticTables(data->addSchema(data->copy, "benchmark"), 2000, 20);
+
+    // The target differs in a small part only, which is the typical synchronization case.
+    data->target = createEmptyCatalog();
+    db_mysql_SchemaRef schema = data->addSchema(data->target, "benchmark");
+    addSyntheticTables(schema, 2000, 20);
+    for (size_t i = 0; i < schema->tables().count(); i += 50) {
+      db_TableRef table = schema->tables()[i];
+      table->columns()[3]->name("renamed_column");
+      table->comment("changed");
+    }
+    schema->tables().remove(schema->tables().count() - 1);
+    addSyntheticTables(schema, 20, 20, "new_table");
+  });
+
+  $it("Diff of two catalogs with 2000 tables each", [this]() {
+    $requireBenchmarks();
+
+    NormalizedComparer comparer;
+    DbObjectMatchAlterOmf omf;
+    comparer.init_omf(&omf);
+
+    std::shared_ptr<DiffChange> change;
+    casmine::BenchmarkOptions options;
+    options.iterations = 5;
+    $benchmark("grt/catalog diff (2000 tables)", [&]() {
+      change = diff_make(data->source, data->target, &omf);
+    }, options);
+
+    $expect(change.get()).Not.toBeNull();
+  });
+
+  $it("Diff of identical catalogs with 2000 tables each", [this]() {
+    $requireBenchmarks();
+
+    NormalizedComparer comparer;
+    DbObjectMatchAlterOmf omf;
+    comparer.init_omf(&omf);
+
+    casmine::BenchmarkOptions options;
+    options.iterations = 5;
+    $benchmark("grt/catalog diff (2000 tables, unchanged)", [&]() {
+      diff_make(data->source, data->copy, &omf);
+    }, options);
+  });
+
+}
+
+}
@@ -21,6 +21,8 @@
  * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
+#include <random>
+
 #include "casmine.h"
 
 #include "wb_test_helpers.h"
@@ -360,6 +362,226 @@ static bool versionMatches(std::string &statement, unsigned long serverVersion)
 
 //----------------------------------------------------------------------------------------------------------------------
 
+// The original character-by-character statement splitter. The services implementation skips over uninteresting
+// text in bulk and must produce exactly the same ranges as this one.
+
+static const unsigned char *skipLeadingWhitespace(const unsigned char *head, const unsigned char *tail) {
+  while (head < tail && *head <= ' ')
+    head++;
+  return head;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static bool isLineBreak(const unsigned char *head, const unsigned char *line_break) {
+  if (*line_break == '\0')
+    return false;
+
+  while (*head != '\0' && *line_break != '\0' && *head == *line_break) {
+    head++;
+    line_break++;
+  }
+  return *line_break == '\0';
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static size_t referenceStatementRanges(const char *sql, size_t length, const std::string &initialDelimiter,
+                                       std::vector<StatementRange> &ranges, const std::string &lineBreak) {
+
+  static const unsigned char keyword[] = "delimiter";
+
+  std::string delimiter = initialDelimiter.empty() ? ";" : initialDelimiter;
+  const unsigned char *delimiterHead = reinterpret_cast<const unsigned char *>(delimiter.c_str());
+
+  const unsigned char *start = reinterpret_cast<const unsigned char *>(sql);
+  const unsigned char *head = start;
+  const unsigned char *tail = head;
+  const unsigned char *end = head + length;
+  const unsigned char *newLine = reinterpret_cast<const unsigned char *>(lineBreak.c_str());
+
+  size_t currentLine = 0;
+  size_t statementStart = 0;
+  bool haveContent = false; // Set when anything else but comments were found for the current statement.
+
+  while (tail < end) {
+    switch (*tail) {
+      case '/': { // Possible multi line comment or hidden (conditional) command.
+        if (*(tail + 1) == '*') {
+          tail += 2;
+          bool isHiddenCommand = (*tail == '!');
+          while (true) {
+            while (tail < end && *tail != '*') {
+              if (isLineBreak(tail, newLine))
+                ++currentLine;
+              tail++;
+            }
+
+            if (tail == end) // Unfinished comment.
+              break;
+            else {
+              if (*++tail == '/') {
+                tail++; // Skip the slash too.
+                break;
+              }
+            }
+          }
+
+          if (isHiddenCommand)
+            haveContent = true;
+          if (!haveContent) {
+            head = tail; // Skip over the comment.
+            statementStart = currentLine;
+          }
+
+        } else
+          tail++;
+
+        break;
+      }
+
+      case '-': { // Possible single line comment.
+        const unsigned char *end_char = tail + 2;
+        if (*(tail + 1) == '-' && (*end_char == ' ' || *end_char == '\t' || isLineBreak(end_char, newLine))) {
+          // Skip everything until the end of the line.
+          tail += 2;
+          while (tail < end && !isLineBreak(tail, newLine))
+            tail++;
+
+          if (!haveContent) {
+            head = tail;
+            statementStart = currentLine;
+          }
+        } else
+          tail++;
+
+        break;
+      }
+
+      case '#': { // MySQL single line comment.
+        while (tail < end && !isLineBreak(tail, newLine))
+          tail++;
+
+        if (!haveContent) {
+          head = tail;
+          statementStart = currentLine;
+        }
+
+        break;
+      }
+
+      case '"':
+      case '\'':
+      case '`': { // Quoted string/id. Skip this in a local loop.
+        haveContent = true;
+        unsigned char quote = *tail++;
+        while (tail < end && *tail != quote) {
+          // Skip any escaped character too.
+          if (*tail == '\\')
+            tail++;
+          tail++;
+        }
+        if (*tail == quote)
+          tail++; // Skip trailing quote char if one was there.
+
+        break;
+      }
+
+      case 'd':
+      case 'D': {
+        haveContent = true;
+
+        // Possible start of the keyword DELIMITER. Must be at the start of the text or a character,
+        // which is not part of a regular MySQL identifier (0-9, A-Z, a-z, _, $, \u0080-\uffff).
+        unsigned char previous = tail > start ? *(tail - 1) : 0;
+        bool is_identifier_char = previous >= 0x80 || (previous >= '0' && previous <= '9') ||
+                                  ((previous | 0x20) >= 'a' && (previous | 0x20) <= 'z') || previous == '$' ||
+                                  previous == '_';
+        if (tail == start || !is_identifier_char) {
+          const unsigned char *run = tail + 1;
+          const unsigned char *kw = keyword + 1;
+          int count = 9;
+          while (count-- > 1 && (*run++ | 0x20) == *kw++)
+            ;
+          if (count == 0 && *run == ' ') {
+            // Delimiter keyword found. Get the new delimiter (everything until the end of the line).
+            tail = run++;
+            while (run < end && !isLineBreak(run, newLine))
+              ++run;
+            delimiter = base::trim(std::string(reinterpret_cast<const char *>(tail), run - tail));
+            delimiterHead = reinterpret_cast<const unsigned char *>(delimiter.c_str());
+
+            // Skip over the delimiter statement and any following line breaks.
+            while (isLineBreak(run, newLine)) {
+              ++currentLine;
+              ++run;
+            }
+            tail = run;
+            head = tail;
+            statementStart = currentLine;
+          } else
+            ++tail;
+        } else
+          ++tail;
+
+        break;
+      }
+
+      default:
+        if (isLineBreak(tail, newLine)) {
+          ++currentLine;
+          if (!haveContent)
+            ++statementStart;
+        }
+
+        if (*tail > ' ')
+          haveContent = true;
+        tail++;
+        break;
+    }
+
+    if (*tail == *delimiterHead) {
+      // Found possible start of the delimiter. Check if it really is.
+      size_t count = delimiter.size();
+      if (count == 1) {
+        // Most common case. Trim the statement and check if it is not empty before adding the range.
+        head = skipLeadingWhitespace(head, tail);
+        if (head < tail)
+          ranges.push_back({ statementStart, static_cast<size_t>(head - start), static_cast<size_t>(tail - head) });
+        head = ++tail;
+        statementStart = currentLine;
+        haveContent = false;
+      } else {
+        const unsigned char *run = tail + 1;
+        const unsigned char *del = delimiterHead + 1;
+        while (count-- > 1 && (*run++ == *del++))
+          ;
+
+        if (count == 0) {
+          // Multi char delimiter is complete. Tail still points to the start of the delimiter.
+          // Run points to the first character after the delimiter.
+          head = skipLeadingWhitespace(head, tail);
+          if (head < tail)
+            ranges.push_back({ statementStart, static_cast<size_t>(head - start), static_cast<size_t>(tail - head) });
+          tail = run;
+          head = run;
+          statementStart = currentLine;
+          haveContent = false;
+        }
+      }
+    }
+  }
+
+  // Add remaining text to the range list.
+  head = skipLeadingWhitespace(head, tail);
+  if (head < tail)
+    ranges.push_back({ statementStart, static_cast<size_t>(head - start), static_cast<size_t>(tail - head) });
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 class TestErrorListener : public BaseErrorListener {
 public:
   std::string lastErrors;
@@ -754,6 +976,60 @@ $describe("MySQL parser test suite (ANTLR)") {
 
   //--------------------------------------------------------------------------------------------------------------------
 
+  $it("Statement splitter gives the same ranges as the scalar reference", [this]() {
+    auto compare = [this](const std::string &sql, const std::string &delimiter, const std::string &lineBreak) {
+      std::vector<StatementRange> expected;
+      referenceStatementRanges(sql.c_str(), sql.size(), delimiter, expected, lineBreak);
+
+      std::vector<StatementRange> actual;
+      data->services->determineStatementRanges(sql.c_str(), sql.size(), delimiter, actual, lineBreak);
+
+      $expect(actual.size()).toBe(expected.size(), "Range count differs for:\n" + sql);
+      for (size_t i = 0; i < expected.size() && i < actual.size(); ++i) {
+        $expect(actual[i].line).toBe(expected[i].line, "Line differs for:\n" + sql);
+        $expect(actual[i].start).toBe(expected[i].start, "Start differs for:\n" + sql);
+        $expect(actual[i].length).toBe(expected[i].length, "Length differs for:\n" + sql);
+      }
+    };
+
+    for (auto entry : testFiles) {
+      std::string fileName = data->dataDir + entry.name;
+
+#ifdef _MSC_VER
+      std::ifstream stream(base::string_to_wstring(fileName), std::ios::binary);
+#else
+      std::ifstream stream(fileName, std::ios::binary);
+#endif
+      $expect(stream.good()).toBeTrue("Error loading sql file: " + fileName);
+      std::string sql((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+      compare(sql, entry.initial_delmiter, entry.line_break);
+    }
+
+    // Random mixes of everything the splitter has to care about, with runs of plain text in between
+    // (so that the bulk skipping kicks in) and unfinished strings and comments at the end.
+    static const std::vector<std::string> pieces = {
+      "select ", "d", "D", "delimiter $$\n", "DELIMITER ;\n", "DELIMITER //\r\n", "$$", "//", ";", "'", "\"", "`",
+      "\\", "/*", "*/", "/*!50003 ", "-- ", "--", "#", "\n", "\r\n", "\t", " ", "abc", "0", "*", "/", "-", "end",
+      "insert into t values (1, 'a\\'b');\n", "\xc3\xa4"
+    };
+    static const std::vector<std::string> lineBreaks = { "\n", "\r\n" };
+    static const std::vector<std::string> delimiters = { ";", "$$" };
+
+    std::mt19937 generator(20201019);
+    for (size_t i = 0; i < 5000; ++i) {
+      std::string sql;
+      size_t count = generator() % 60;
+      for (size_t j = 0; j < count; ++j) {
+        sql += pieces[generator() % pieces.size()];
+        if (generator() % 4 == 0)
+          sql += std::string(generator() % 70, static_cast<char>('a' + generator() % 3));
+      }
+      compare(sql, delimiters[generator() % delimiters.size()], lineBreaks[generator() % lineBreaks.size()]);
+    }
+  });
+
+  //--------------------------------------------------------------------------------------------------------------------
+
   $it("Parse a number of files with various statements", [this]() {
     std::size_t count = 0;
     for (auto entry : testFiles) {
@@ -984,5 +1260,35 @@ $describe("MySQL parser test suite (ANTLR)") {
 
   //--------------------------------------------------------------------------------------------------------------------
 
+  $it("Keywords following a dot are identifiers", [this]() {
+    data->lexer.serverVersion = 80019;
+    data->lexer.sqlModeFromString("");
+
+    $expect(data->lexer.isIdentifier(MySQLLexer::ORDER_SYMBOL)).toBeFalse();
+    $expect(data->lexer.isIdentifierAfter(MySQLLexer::ORDER_SYMBOL, MySQLLexer::IDENTIFIER)).toBeFalse();
+    $expect(data->lexer.isIdentifierAfter(MySQLLexer::ORDER_SYMBOL, MySQLLexer::DOT_SYMBOL)).toBeTrue();
+    $expect(data->lexer.isIdentifierAfter(MySQLLexer::IDENTIFIER, MySQLLexer::SELECT_SYMBOL)).toBeTrue();
+    $expect(data->lexer.isIdentifierAfter(MySQLLexer::DOT_SYMBOL, MySQLLexer::DOT_SYMBOL)).toBeFalse();
+    $expect(data->lexer.isIdentifierAfter(MySQLLexer::SINGLE_QUOTED_TEXT, MySQLLexer::DOT_SYMBOL)).toBeFalse();
+
+    // With spaces around the dot the reserved word comes as keyword token.
+    data->input.load("select t . order from t");
+    data->lexer.reset();
+    data->lexer.setInputStream(&data->input);
+
+    std::vector<size_t> types;
+    for (auto &token : data->lexer.getAllTokens()) {
+      if (token->getChannel() == Token::DEFAULT_CHANNEL)
+        types.push_back(token->getType());
+    }
+    $expect(types.size()).toBe(6U);
+    $expect(types[3]).toBe(static_cast<size_t>(MySQLLexer::ORDER_SYMBOL));
+    $expect(data->lexer.isIdentifierAfter(types[1], types[0])).toBeTrue();
+    $expect(data->lexer.isIdentifierAfter(types[3], types[2])).toBeTrue();
+    $expect(data->lexer.isIdentifierAfter(types[4], types[3])).toBeFalse();
+  });
+
+  //--------------------------------------------------------------------------------------------------------------------
+
 }
 }
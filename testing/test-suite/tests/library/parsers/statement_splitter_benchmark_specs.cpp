@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2020, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#include "casmine.h"
+#include "wb_test_helpers.h"
+
+#include "grtsqlparser/mysql_parser_services.h"
+
+// Benchmarks for the statement splitter. Run with --benchmarks.
+
+using namespace parsers;
+
+namespace {
+
+$ModuleEnvironment() {};
+
+$TestData {
+  std::unique_ptr<WorkbenchTester> tester;
+  MySQLParserServices::Ref services;
+
+  std::string script;
+  size_t statementCount = 0;
+
+  /**
+   * Builds a script of (at least) the given size from a mix of statements, including things the splitter has to
+   * handle with care: comments, quoted delimiters, multi line strings and long insert statements.
+   */
+  void generateScript(size_t size) {
+    static const std::vector<std::string> statements = {
+      "SET @OLD_UNIQUE_CHECKS=@@UNIQUE_CHECKS, UNIQUE_CHECKS=0;\n",
+      "-- A single line comment; with a delimiter.\n"
+        "CREATE TABLE IF NOT EXISTS `t1` (\n  `id` INT NOT NULL AUTO_INCREMENT,\n  `name` VARCHAR(45) NULL,\n"
+        "  PRIMARY KEY (`id`)) ENGINE = InnoDB;\n",
+      "/* A multi line comment;\n   spanning 2 lines. */ SELECT a, b, 'quoted ; delimiter' FROM t1 WHERE a > 1;\n",
+      "INSERT INTO `t1` VALUES (1, 'Lorem ipsum dolor sit amet'), (2, 'consectetur; adipiscing'), "
+        "(3, \"elit, sed do\"), (4, 'eiusmod\\'s tempor'), (5, `incididunt`), (6, 'ut labore et dolore');\n",
+      "UPDATE t1 SET name = 'multi\nline\nstring;' WHERE id = 2 # trailing comment; here\n;\n",
+    };
+
+    script.reserve(size + 1024);
+    statementCount = 0;
+    while (script.size() < size) {
+      for (auto const& statement : statements) {
+        script += statement;
+        ++statementCount;
+      }
+    }
+  }
+};
+
+$describe("Statement splitter benchmarks") {
+
+  $beforeAll([this]() {
+    if (!casmine::benchmarksEnabled())
+      return;
+
+    data->tester.reset(new WorkbenchTester());
+    data->tester->initializeRuntime();
+    data->services = MySQLParserServices::get();
+
+    data->generateScript(100 * 1024 * 1024);
+  });
+
+  $it("Statement ranges of a 100MB script", [this]() {
+    $requireBenchmarks();
+
+    std::vector<StatementRange> ranges;
+    casmine::BenchmarkOptions options;
+    options.iterations = 5;
+    $benchmark("parser/statement ranges (100MB)", [&]() {
+      ranges.clear();
+      data->services->determineStatementRanges(data->script.c_str(), data->script.size(), ";", ranges);
+    }, options);
+
+    $expect(ranges.size()).toBe(data->statementCount);
+  });
+
+}
+
+}
@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2020, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#include <cmath>
+
+#include "status_sampler.h"
+
+#include "casmine.h"
+
+namespace {
+
+$ModuleEnvironment() {};
+
+static StatusSeries::Rows rows(const std::vector<std::pair<std::string, std::string> > &values) {
+  return values;
+}
+
+$describe("Server status sampling") {
+  $it("Ring buffer overwrites the oldest items", []() {
+    RingBuffer<int> ring(3);
+    $expect(ring.capacity()).toBe(3U);
+    $expect(ring.size()).toBe(0U);
+
+    ring.push_back(1);
+    ring.push_back(2);
+    $expect(ring.size()).toBe(2U);
+    $expect(ring[0]).toBe(1);
+    $expect(ring.back()).toBe(2);
+
+    for (int i = 3; i <= 7; ++i)
+      ring.push_back(i);
+    $expect(ring.size()).toBe(3U);
+    $expect(ring[0]).toBe(5);
+    $expect(ring[1]).toBe(6);
+    $expect(ring[2]).toBe(7);
+    $expect(ring.back()).toBe(7);
+
+    RingBuffer<int> empty;
+    empty.push_back(1);
+    $expect(empty.size()).toBe(0U);
+  });
+
+  $it("Variables that appear late or go missing get NaN", []() {
+    StatusSeries series(10, 10, 10);
+    series.add_sample(1, rows({ { "a", "1" }, { "mode", "ON" } }));
+    series.add_sample(2, rows({ { "a", "2" }, { "b", "5" } }));
+    series.add_sample(3, rows({ { "a", "3" } }));
+
+    $expect(series.last_time()).toBe(3.0);
+    $expect(series.times(false) == std::vector<double>({ 1, 2, 3 })).toBeTrue();
+    $expect(series.values("a", false) == std::vector<double>({ 1, 2, 3 })).toBeTrue();
+
+    std::vector<double> b = series.values("b", false);
+    $expect(b.size()).toBe(3U);
+    $expect(std::isnan(b[0])).toBeTrue();
+    $expect(b[1]).toBe(5.0);
+    $expect(std::isnan(b[2])).toBeTrue();
+
+    double value = 0;
+    $expect(series.value("a", value)).toBeTrue();
+    $expect(value).toBe(3.0);
+    $expect(series.value("b", value)).toBeFalse();
+
+    // Non-numeric variables are only kept with the last rows.
+    $expect(series.values("mode", false).empty()).toBeTrue();
+    $expect(series.last_rows().size()).toBe(1U);
+  });
+
+  $it("Completed buckets go into the history", []() {
+    StatusSeries series(100, 10, 3);
+    series.add_sample(100, rows({ { "a", "1" } }));
+    series.add_sample(105, rows({ { "a", "3" } }));
+    $expect(series.times(true).empty()).toBeTrue();
+
+    // The bucket is closed with the first sample outside of it, which starts the next one.
+    series.add_sample(110, rows({ { "a", "10" }, { "b", "4" } }));
+    $expect(series.times(true) == std::vector<double>({ 102.5 })).toBeTrue();
+    $expect(series.values("a", true) == std::vector<double>({ 2 })).toBeTrue();
+    std::vector<double> b = series.values("b", true);
+    $expect(b.size()).toBe(1U);
+    $expect(std::isnan(b[0])).toBeTrue();
+
+    // Samples missing a variable don't count for its average.
+    series.add_sample(115, rows({ { "b", "6" } }));
+    series.add_sample(120, rows({ { "a", "0" } }));
+    $expect(series.times(true) == std::vector<double>({ 102.5, 112.5 })).toBeTrue();
+    $expect(series.values("a", true) == std::vector<double>({ 2, 10 })).toBeTrue();
+    $expect(series.values("b", true)[1]).toBe(5.0);
+
+    // The history is a ring too.
+    for (double time = 130; time <= 150; time += 10)
+      series.add_sample(time, rows({ { "a", "1" } }));
+    $expect(series.times(true) == std::vector<double>({ 120, 130, 140 })).toBeTrue();
+  });
+
+  $it("Rates use the shortest window of at least the given span", []() {
+    StatusSeries series(100, 1000, 10);
+    const char *counters[] = { "0", "10", "20", "40", "80" };
+    for (int i = 0; i < 5; ++i)
+      series.add_sample(i, rows({ { "counter", counters[i] } }));
+
+    double rate = 0;
+    $expect(series.rate("counter", 0.5, rate)).toBeTrue();
+    $expect(rate).toBe(40.0);
+    $expect(series.rate("counter", 1, rate)).toBeTrue();
+    $expect(rate).toBe(40.0);
+    $expect(series.rate("counter", 2, rate)).toBeTrue();
+    $expect(rate).toBe(30.0);
+    $expect(series.rate("counter", 100, rate)).toBeTrue(); // longer than the series: everything there is
+    $expect(rate).toBe(20.0);
+    $expect(series.rate("unknown", 1, rate)).toBeFalse();
+
+    // Gaps are skipped.
+    series.add_sample(5, rows({}));
+    series.add_sample(6, rows({ { "counter", "100" } }));
+    $expect(series.rate("counter", 1, rate)).toBeTrue();
+    $expect(rate).toBe(10.0);
+
+    StatusSeries single(100, 1000, 10);
+    single.add_sample(0, rows({ { "counter", "1" } }));
+    $expect(single.rate("counter", 1, rate)).toBeFalse();
+  });
+
+  $it("Counter resets give a rate of 0", []() {
+    StatusSeries series(100, 1000, 10);
+    series.add_sample(0, rows({ { "counter", "100" } }));
+    series.add_sample(1, rows({ { "counter", "150" } }));
+    series.add_sample(2, rows({ { "counter", "20" } }));
+
+    double rate = -1;
+    $expect(series.rate("counter", 1, rate)).toBeTrue();
+    $expect(rate).toBe(0.0);
+    $expect(series.rates("counter", false) == std::vector<double>({ 50, 0 })).toBeTrue();
+  });
+}
+
+}
@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2020, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#include "grtdb/db_helpers.h"
+#include "mysql_sql_parser_fe.h"
+#include "mysql_sql_schema_qualifiers.h"
+#include "mysql_sql_schema_rename.h"
+
+#include "casmine.h"
+#include "wb_test_helpers.h"
+
+namespace {
+
+$ModuleEnvironment() {};
+
+// Gives access to the rename done by a full parse with the old parser, which the token scan must match.
+class FullParseSchemaRename : public Mysql_sql_schema_rename {
+public:
+  std::string rename(std::string sql, const std::string &old_schema_name, const std::string &new_schema_name) {
+    _old_schema_name = old_schema_name;
+    _new_schema_name = new_schema_name;
+    _process_sql_statement = [this](const SqlAstNode *tree) { return process_sql_statement(tree); };
+
+    Mysql_sql_parser_fe sql_parser_fe("");
+    sql_parser_fe.ignore_dml = false;
+    Mysql_sql_schema_rename::rename_schema_references(sql, sql_parser_fe, 1);
+    return sql;
+  }
+};
+
+struct RenameCase {
+  std::string oldName;
+  std::string newName;
+  std::string sql;
+  std::string expected;
+  Mysql_sql_schema_qualifiers::Result result;
+};
+
+$TestData {
+  std::unique_ptr<WorkbenchTester> tester;
+
+  void checkRename(const std::vector<RenameCase> &cases) {
+    for (auto &entry : cases) {
+      std::string sql = entry.sql;
+      Mysql_sql_schema_qualifiers qualifiers(bec::version_to_int(bec::parse_version("8.0.20")), "", entry.oldName,
+                                             entry.newName, true);
+      $expect((int)qualifiers.rename(sql)).toBe((int)entry.result, entry.sql);
+      if (entry.result != Mysql_sql_schema_qualifiers::Ambiguous)
+        $expect(sql).toBe(entry.expected, entry.sql);
+
+      FullParseSchemaRename fullParse;
+      fullParse.case_sensitive_identifiers(true);
+      $expect(fullParse.rename(entry.sql, entry.oldName, entry.newName)).toBe(entry.expected, entry.sql);
+
+      // Ambiguous texts end up with the full parse as well.
+      sql = entry.sql;
+      Mysql_sql_schema_rename::Ref renamer = Mysql_sql_schema_rename::create();
+      renamer->case_sensitive_identifiers(true);
+      renamer->rename_schema_references(sql, entry.oldName, entry.newName);
+      $expect(sql).toBe(entry.expected, entry.sql);
+    }
+  }
+};
+
+$describe("Schema renaming on the token stream") {
+  $beforeAll([this]() {
+    data->tester.reset(new WorkbenchTester());
+  });
+
+  $it("Qualified names", [this]() {
+    data->checkRename({
+      { "sakila", "world", "SELECT * FROM actor", "SELECT * FROM actor", Mysql_sql_schema_qualifiers::Unchanged },
+      { "sakila", "world", "SELECT 'sakila.actor' FROM actor", "SELECT 'sakila.actor' FROM actor",
+        Mysql_sql_schema_qualifiers::Unchanged },
+      { "sakila", "world", "SELECT * FROM sakila.actor", "SELECT * FROM world.actor",
+        Mysql_sql_schema_qualifiers::Renamed },
+      { "sakila", "world", "SELECT sakila.actor.first_name FROM sakila.actor",
+        "SELECT world.actor.first_name FROM world.actor", Mysql_sql_schema_qualifiers::Renamed },
+      { "sakila", "world", "SELECT sakila.get_customer_balance(1, NOW())",
+        "SELECT world.get_customer_balance(1, NOW())", Mysql_sql_schema_qualifiers::Renamed },
+      { "sakila", "world", "SELECT * FROM Sakila.actor", "SELECT * FROM Sakila.actor",
+        Mysql_sql_schema_qualifiers::Unchanged },
+    });
+  });
+
+  $it("Quoted and unquoted names", [this]() {
+    data->checkRename({
+      { "sakila", "world", "SELECT * FROM `sakila`.`actor` JOIN sakila.film_actor USING (actor_id)",
+        "SELECT * FROM `world`.`actor` JOIN world.film_actor USING (actor_id)", Mysql_sql_schema_qualifiers::Renamed },
+      { "sakila", "", "SELECT * FROM `sakila`.actor, sakila.`film`", "SELECT * FROM actor, `film`",
+        Mysql_sql_schema_qualifiers::Renamed },
+    });
+  });
+
+  $it("Names that could be a schema or a table go through the full parse", [this]() {
+    data->checkRename({
+      { "sakila", "world", "SELECT sakila.actor_id FROM actor sakila JOIN sakila.film_actor f USING (actor_id)",
+        "SELECT sakila.actor_id FROM actor sakila JOIN world.film_actor f USING (actor_id)",
+        Mysql_sql_schema_qualifiers::Ambiguous },
+    });
+  });
+
+  $it("Multi-byte characters before and in names", [this]() {
+    // The lexer counts code points, the edits are done on bytes.
+    data->checkRename({
+      { "sakila", "world", "SELECT 'äöü' AS `größe`, sakila.actor.first_name FROM sakila.actor",
+        "SELECT 'äöü' AS `größe`, world.actor.first_name FROM world.actor", Mysql_sql_schema_qualifiers::Renamed },
+      { "schéma", "ñame", "SELECT * FROM schéma.tablé JOIN `schéma`.t2", "SELECT * FROM ñame.tablé JOIN `ñame`.t2",
+        Mysql_sql_schema_qualifiers::Renamed },
+    });
+  });
+
+  $it("NEW and OLD in triggers are not schemas", [this]() {
+    data->checkRename({
+      { "new", "archive", "SELECT * FROM new.audit", "SELECT * FROM archive.audit",
+        Mysql_sql_schema_qualifiers::Renamed },
+      { "new", "archive", "CREATE TRIGGER t_bu BEFORE UPDATE ON t FOR EACH ROW SET new.total = new.price * 2",
+        "CREATE TRIGGER t_bu BEFORE UPDATE ON t FOR EACH ROW SET new.total = new.price * 2",
+        Mysql_sql_schema_qualifiers::Ambiguous },
+      { "new", "archive",
+        "CREATE TRIGGER t_bu BEFORE UPDATE ON t FOR EACH ROW BEGIN SET new.total = old.total; "
+        "INSERT INTO new.audit VALUES (new.total); END",
+        "CREATE TRIGGER t_bu BEFORE UPDATE ON t FOR EACH ROW BEGIN SET new.total = old.total; "
+        "INSERT INTO archive.audit VALUES (new.total); END",
+        Mysql_sql_schema_qualifiers::Ambiguous },
+      { "old", "archive", "CREATE TRIGGER t_bu BEFORE UPDATE ON t FOR EACH ROW SET new.total = old.total + 1",
+        "CREATE TRIGGER t_bu BEFORE UPDATE ON t FOR EACH ROW SET new.total = old.total + 1",
+        Mysql_sql_schema_qualifiers::Ambiguous },
+    });
+  });
+}
+
+}
@@ -464,6 +464,97 @@ $describe("SQL code generation") {
     }
   });
 
+  $it("Parallel generation gives the same output as sequential generation", [this]() {
+    ValueRef e;
+    NormalizedComparer cmp;
+    DbObjectMatchAlterOmf omf;
+    cmp.init_omf(&omf);
+
+    // Enough tables, views and routines to have their SQL generated on several threads.
+    db_mysql_CatalogRef catalog = createEmptyCatalog();
+    db_mysql_SchemaRef schema(grt::Initialized);
+    schema->owner(catalog);
+    schema->name("parallel");
+    catalog->schemata().insert(schema);
+    addSyntheticTables(schema, 200, 10);
+    for (size_t i = 0; i < 40; ++i) {
+      db_mysql_ViewRef view(grt::Initialized);
+      view->owner(schema);
+      view->name("view_" + std::to_string(i));
+      view->sqlDefinition("CREATE VIEW view_" + std::to_string(i) + " AS SELECT column_0, column_1 FROM table_" +
+                          std::to_string(i));
+      schema->views().insert(view);
+
+      db_mysql_RoutineRef routine(grt::Initialized);
+      routine->owner(schema);
+      routine->name("routine_" + std::to_string(i));
+      routine->routineType("procedure");
+      routine->sqlDefinition("CREATE PROCEDURE routine_" + std::to_string(i) +
+                             "()\nBEGIN\n  SELECT COUNT(*) FROM table_" + std::to_string(i) + ";\nEND");
+      schema->routines().insert(routine);
+    }
+
+    std::shared_ptr<DiffChange> create_change = diff_make(e, catalog, &omf);
+    std::shared_ptr<DiffChange> drop_change = diff_make(catalog, e, &omf);
+
+    struct Output {
+      std::string script;
+      std::vector<std::string> statements;
+      ListRef<GrtNamedObject> objects;
+    };
+
+    auto generate = [&](int threads) {
+      Output output;
+
+      DictRef create_map(true);
+      DictRef drop_map(true);
+      DictRef options(true);
+      options.set("WorkerThreadCount", grt::IntegerRef(threads));
+      options.set("UseFilteredLists", grt::IntegerRef(0));
+      options.set("CaseSensitive", grt::IntegerRef(omf.case_sensitive));
+      options.set("GenerateSchemaDrops", grt::IntegerRef(1));
+      options.set("GenerateDrops", grt::IntegerRef(1));
+      options.set("OutputContainer", create_map);
+      data->diffsqlModule->generateSQL(catalog, options, create_change);
+      options.set("OutputContainer", drop_map);
+      data->diffsqlModule->generateSQL(catalog, options, drop_change);
+      data->diffsqlModule->makeSQLExportScript(catalog, options, create_map, drop_map);
+      output.script = options.get_string("OutputScript");
+
+      StringListRef create_list(grt::Initialized);
+      output.objects = ListRef<GrtNamedObject>(grt::Initialized);
+      options.set("OutputContainer", create_list);
+      options.set("OutputObjectContainer", output.objects);
+      data->diffsqlModule->generateSQL(catalog, options, create_change);
+      for (size_t i = 0; i < create_list.count(); ++i)
+        output.statements.push_back(create_list[i]);
+
+      return output;
+    };
+
+    Output sequential = generate(1);
+    Output parallel = generate(4);
+
+    $expect(parallel.script.empty()).toBeFalse();
+    $expect(parallel.script).toEqual(sequential.script, "create and drop script");
+
+    $expect(parallel.statements.size()).toBe(sequential.statements.size());
+    $expect(parallel.objects.count()).toBe(sequential.objects.count());
+    for (size_t i = 0; i < sequential.statements.size(); ++i)
+      $expect(parallel.statements[i]).toEqual(sequential.statements[i], "statement " + std::to_string(i));
+    for (size_t i = 0; i < sequential.objects.count(); ++i)
+      $expect(parallel.objects[i] == sequential.objects[i]).toBeTrue("object " + std::to_string(i));
+
+    // The schema comes first, followed by the tables in model order.
+    $expect(parallel.objects[0] == schema).toBeTrue();
+    for (size_t i = 0; i < schema->tables().count(); ++i) {
+      db_mysql_TableRef table = schema->tables()[i];
+      $expect(parallel.objects[i + 1] == table).toBeTrue("Table " + *table->name() + " is out of order");
+      $expect(parallel.statements[i + 1].find("CREATE TABLE IF NOT EXISTS `parallel`.`" + *table->name() + "`"))
+        .toEqual((size_t)0);
+    }
+  });
+
   $it("Forward engineering after renaming a schema", [this]() {
     ValueRef e;
     std::unique_ptr<sql::Statement> stmt(data->connection->createStatement());
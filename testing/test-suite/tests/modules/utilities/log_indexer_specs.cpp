@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2020, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <functional>
+
+#include "log_indexer.h"
+
+#include "casmine.h"
+
+namespace {
+
+$ModuleEnvironment() {};
+
+// 2019-01-31 12:00:00 UTC
+static const time_t BaseTime = 1548936000;
+
+static std::string slowRecord(int second, const std::string &query) {
+  char time[32];
+  snprintf(time, sizeof(time), "%02d:%02d", second / 60, second % 60);
+  return std::string("# Time: 2019-01-31T12:") + time + ".000000Z\n# User@Host: root[root] @ localhost []\n" +
+         "# Query_time: 1.0  Lock_time: 0.0 Rows_sent: 1  Rows_examined: 1\n" + query + ";\n";
+}
+
+static void writeFile(const std::string &path, const std::string &content) {
+  std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+  stream << content;
+}
+
+$describe("Server log indexer") {
+  $it("Finds the record starts of the error log", []() {
+    std::string log =
+      "2019-01-31T12:00:00.123456Z 0 [Note] first\n"
+      "\n"
+      "2019-01-31T13:00:00Z 1 [Warning] second\r\n"
+      "plain continuation\n"
+      "2019-01-31T14:00:00Z 0 [Note] third, incomplete";
+
+    // Fed byte by byte, records must not depend on how the data is split.
+    LogIndexer indexer(LogIndexer::ErrorLog);
+    for (char c : log)
+      indexer.add_data(&c, 1);
+
+    $expect(indexer.record_count()).toBe(3U);
+    $expect(indexer.record_start(0)).toBe(0U);
+    $expect(indexer.record_start(1)).toBe(44U);
+    $expect(indexer.record_time(0)).toBe(BaseTime);
+    $expect(indexer.record_time(1)).toBe(BaseTime + 3600);
+    $expect(indexer.record_time(2)).toBe(BaseTime + 3600); // a line without a time stamp keeps the previous one
+
+    // The last line only becomes a record once it is complete.
+    indexer.add_data("\n", 1);
+    $expect(indexer.record_count()).toBe(4U);
+    $expect(indexer.record_time(3)).toBe(BaseTime + 7200);
+    $expect(indexer.record_end(3)).toBe(indexer.size());
+  });
+
+  $it("Finds the record starts of the general and slow logs", []() {
+    std::string general =
+      "2019-01-31T12:00:00.000000Z\t    5 Connect\troot@localhost on\n"
+      "\t\t    5 Query\tselect 1\n"
+      "from dual\n"
+      "2019-01-31T12:00:05.000000Z\t    6 Query\tselect 2\n";
+    LogIndexer indexer(LogIndexer::GeneralLog);
+    indexer.add_data(general.data(), general.size());
+    $expect(indexer.record_count()).toBe(3U);
+    $expect(indexer.record_end(1)).toBe(indexer.record_start(2));
+    $expect(indexer.record_time(1)).toBe(BaseTime);
+    $expect(indexer.record_time(2)).toBe(BaseTime + 5);
+
+    std::string slow = slowRecord(0, "SELECT 1") + slowRecord(1, "SELECT 2");
+    LogIndexer slowIndexer(LogIndexer::SlowLog);
+    slowIndexer.add_data(slow.data(), slow.size());
+    $expect(slowIndexer.record_count()).toBe(2U);
+    $expect(slowIndexer.record_start(1)).toBe(slowRecord(0, "SELECT 1").size());
+
+    // Indexing the tail of a file skips the partial first line.
+    LogIndexer tail(LogIndexer::SlowLog);
+    tail.reset(10);
+    tail.add_data(slow.data() + 10, slow.size() - 10);
+    $expect(tail.record_count()).toBe(1U);
+    $expect(tail.record_start(0)).toBe(slowIndexer.record_start(1));
+  });
+
+  $it("Pages are limited by record count and size", []() {
+    std::string log;
+    for (int i = 0; i < 1000; ++i)
+      log += slowRecord(i % 3600, "SELECT 1"); // all records have the same size
+    LogIndexer indexer(LogIndexer::SlowLog);
+    indexer.add_data(log.data(), log.size());
+    $expect(indexer.record_count()).toBe(1000U);
+
+    const uint64_t recordSize = indexer.record_end(0) - indexer.record_start(0);
+    $expect(indexer.page_end(0, 50, 1000000)).toBe(50U);
+    $expect(indexer.page_end(0, 50, recordSize * 6 + 1)).toBe(6U);
+    $expect(indexer.page_end(995, 50, 1000000)).toBe(1000U);
+    $expect(indexer.page_end(3, 50, 0)).toBe(4U); // at least one record
+
+    $expect(indexer.page_start(1000, 50, 1000000)).toBe(950U);
+    $expect(indexer.page_start(1000, 50, recordSize * 6 + 1)).toBe(994U);
+    $expect(indexer.page_start(3, 50, 1000000)).toBe(0U);
+    $expect(indexer.page_start(10, 50, 0)).toBe(9U);
+  });
+
+  $it("Finds the first record at or after a time", []() {
+    std::string log;
+    for (int i = 0; i < 100; ++i)
+      log += slowRecord(i * 2, "SELECT " + std::to_string(i));
+    LogIndexer indexer(LogIndexer::SlowLog);
+    indexer.add_data(log.data(), log.size());
+
+    $expect(indexer.find_time(0)).toBe(0U);
+    $expect(indexer.find_time(BaseTime)).toBe(0U);
+    $expect(indexer.find_time(BaseTime + 1)).toBe(1U);
+    $expect(indexer.find_time(BaseTime + 2)).toBe(1U);
+    $expect(indexer.find_time(BaseTime + 99)).toBe(50U);
+    $expect(indexer.find_time(BaseTime + 198)).toBe(99U);
+    $expect(indexer.find_time(BaseTime + 199)).toBe(100U);
+  });
+
+  $it("Finds hits spanning the blocks of a file search once", []() {
+    // The file is searched in blocks of 1MB, put a hit right across the first block boundary.
+    const size_t blockSize = 1024 * 1024;
+    std::string filler(60, 'x');
+    std::string log;
+    while (log.size() < blockSize - 400)
+      log += slowRecord(0, "SELECT '" + filler + "'");
+
+    std::string head = slowRecord(1, "SELECT '");
+    head.resize(head.size() - 2); // drop the closing ";\n"
+    size_t straddling = log.size() / (slowRecord(0, "SELECT '" + filler + "'").size());
+    log += head + std::string(blockSize - 3 - log.size() - head.size(), 'y') + "Needle';\n";
+    for (int i = 0; i < 1000; ++i)
+      log += slowRecord(2, "SELECT '" + filler + "'");
+    size_t last = straddling + 1001;
+    log += slowRecord(3, "SELECT 'needle'");
+
+    std::string path = casmine::CasmineContext::get()->outputDir() + "/log_indexer_search.log";
+    writeFile(path, log);
+
+    LogIndexer indexer(LogIndexer::SlowLog);
+    $expect(indexer.update_from_file(path)).toBeTrue();
+    $expect(indexer.record_count()).toBe(last + 1);
+
+    std::vector<size_t> records;
+    $expect(indexer.search_file(path, "NEEDLE", 0, 10, records)).toBeTrue();
+    $expect(records == std::vector<size_t>({ straddling, last })).toBeTrue();
+
+    $expect(indexer.search_file(path, "needle", straddling + 1, 10, records)).toBeTrue();
+    $expect(records == std::vector<size_t>({ last })).toBeTrue();
+
+    // Every filler record matches, none may be reported twice where the blocks overlap.
+    $expect(indexer.search_file(path, "xxx", 0, 100000, records)).toBeTrue();
+    $expect(records.size()).toBe(last - 1);
+    $expect(std::adjacent_find(records.begin(), records.end(), std::greater_equal<size_t>()) == records.end())
+      .toBeTrue();
+  });
+}
+
+}
@@ -36,7 +36,6 @@
 
 #include "structs.test.h"
 #include "sqlide/wb_sql_editor_form.h"
-#include "sqlide/wb_sql_editor_help.h"
 #include "wb_test_helpers.h"
 
 #include "grtdb/db_helpers.h"
@@ -179,9 +178,6 @@ WorkbenchTester::WorkbenchTester(bool initPython, const base::Size &apage_size,
   wboptions->testing = true;
   wbui->init(&_wbcallbacks, wboptions);
 
-  // we have to wait for it as it's triggered in the c-tor
-  help::DbSqlEditorContextHelp::get()->waitForLoading();
-
   {
     db_mgmt_RdbmsRef rdbms = db_mgmt_RdbmsRef::cast_from(
       grt::GRT::get()->unserialize(bec::GRTManager::get()->get_basedir() + "/modules/data/mysql_rdbms_info.xml"));
@@ -319,6 +315,55 @@ db_mysql_CatalogRef createEmptyCatalog() {
 
 //----------------------------------------------------------------------------------------------------------------------
 
+void addSyntheticTables(db_mysql_SchemaRef schema, size_t tableCount, size_t columnCount, std::string const& prefix) {
+  db_mysql_CatalogRef catalog = db_mysql_CatalogRef::cast_from(schema->owner());
+  grt::ListRef<db_SimpleDatatype> dataTypes = catalog->simpleDatatypes();
+
+  // Cycle through a few common types to get some variety in the generated DDL.
+  static const char *typeNames[] = { "int", "varchar", "datetime", "decimal", "text" };
+  db_SimpleDatatypeRef types[UPPER_BOUND(typeNames)];
+  for (size_t i = 0; i < UPPER_BOUND(typeNames); ++i)
+    types[i] = parsers::MySQLParserServices::findDataType(dataTypes, catalog->version(), typeNames[i]);
+
+  for (size_t i = 0; i < tableCount; ++i) {
+    db_mysql_TableRef table(grt::Initialized);
+    table->owner(schema);
+    table->name(prefix + "_" + std::to_string(i));
+    table->tableEngine("InnoDB");
+
+    for (size_t j = 0; j < columnCount; ++j) {
+      db_mysql_ColumnRef column(grt::Initialized);
+      column->owner(table);
+      column->name("column_" + std::to_string(j));
+      column->simpleType(types[j % UPPER_BOUND(typeNames)]);
+      if (j % UPPER_BOUND(typeNames) == 1)
+        column->length(45);
+      column->isNotNull(j == 0 ? 1 : 0);
+      table->columns().insert(column);
+    }
+
+    if (columnCount > 0) {
+      db_mysql_IndexRef primaryKey(grt::Initialized);
+      primaryKey->owner(table);
+      primaryKey->name("PRIMARY");
+      primaryKey->isPrimary(1);
+      primaryKey->indexType("PRIMARY");
+
+      db_mysql_IndexColumnRef indexColumn(grt::Initialized);
+      indexColumn->owner(primaryKey);
+      indexColumn->referencedColumn(table->columns()[0]);
+      primaryKey->columns().insert(indexColumn);
+
+      table->indices().insert(primaryKey);
+      table->primaryKey(primaryKey);
+    }
+
+    schema->tables().insert(table);
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 static mforms::DialogResult messageOtherCallback() {
   return mforms::ResultOther; // Indicates to ignore any pending changes.
 }
@@ -112,3 +112,8 @@ private:
 };
 
 db_mysql_CatalogRef createEmptyCatalog();
+
+// Adds tableCount tables with columnCount columns each (and a primary key on the first column) to the given schema.
+// Used to generate large models for benchmarks.
+void addSyntheticTables(db_mysql_SchemaRef schema, size_t tableCount, size_t columnCount,
+  std::string const& prefix = "table");
@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2020, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+// Converts the context help JSON files into the binary index, which is memory mapped by the SQL editor at runtime.
+// Usage: genhelpindex <help json file> <index file>
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#include "sqlide/wb_sql_editor_help_index.h"
+
+int main(int argc, char **argv) {
+  if (argc != 3) {
+    printf("usage: %s <help json file> <index file>\n", argv[0]);
+    return 1;
+  }
+
+  std::ifstream input(argv[1], std::ios::binary);
+  if (!input.good()) {
+    printf("cannot open %s\n", argv[1]);
+    return 1;
+  }
+  std::string json((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+
+  std::string index;
+  try {
+    index = help::HelpIndex::build(json);
+  } catch (std::exception &e) {
+    printf("error while converting %s: %s\n", argv[1], e.what());
+    return 1;
+  }
+
+  std::ofstream output(argv[2], std::ios::binary | std::ios::trunc);
+  output.write(index.data(), static_cast<std::streamsize>(index.size()));
+  if (!output.good()) {
+    printf("cannot write %s\n", argv[2]);
+    return 1;
+  }
+
+  return 0;
+}